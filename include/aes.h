@@ -10,20 +10,238 @@
 //! Majority of this has to be redocumented.
 
 
+/// @brief The block cipher implementation behind every AES function.
+typedef enum
+{
+    aes_backend_auto = 0,       //* Fastest backend supported by this CPU.
+    aes_backend_bytewise = 1,   //* Reference implementation, byte by byte (SubBytes, ShiftRows, MixColumns).
+    aes_backend_ttable = 2,     //* 32-bit T-table implementation, default software backend.
+    aes_backend_aesni = 3,      //* x86-64 AES-NI instructions, pipelined 8 blocks at a time.
+    aes_backend_bitslice = 4,   //* Constant-time bitsliced implementation (no secret-indexed tables), 8 blocks at a time.
+    aes_backend_vperm = 5,      //* x86 SSSE3 vector permute (PSHUFB) implementation, constant-time and fast on single blocks.
+} AESBackend;
+
+/// @brief A pre-expanded AES-256 key, so bulk encryption never re-derives the key schedule.
+/// @param EncKey The 15 encryption round Keys (240 bytes).
+/// @param DecKey The 15 decryption round Keys (240 bytes), in reverse order.
+/// @param SliceKey The 15 round Keys in bit planes (aes_backend_bitslice only).
+/// @param PermKey The 15 encryption and 15 decryption round Keys in nibble bases (aes_backend_vperm only).
+/// @param Backend The backend selected when the key was initialized.
+/// @note Initialize with aes_key_init(), wipe with aes_key_clear() when no longer needed.
+typedef struct
+{
+    uint8_t EncKey[240];
+    uint8_t DecKey[240];
+    union
+    {
+        uint64_t SliceKey[120];
+        uint8_t PermKey[480];
+    };
+    AESBackend Backend;
+} AESKey;
+
+/// @brief The GF(2^128) multiplication behind GHASH (GCM) and POLYVAL (GCM-SIV).
+typedef enum
+{
+    ghash_backend_auto = 0,         //* Fastest backend supported by this CPU.
+    ghash_backend_bitserial = 1,    //* Reference implementation, one bit of the multiplier at a time.
+    ghash_backend_clmul = 2,        //* x86-64 PCLMULQDQ, Karatsuba products and one reduction per 8 blocks.
+    ghash_backend_table4 = 3,       //* Shoup's 4-bit table (256 bytes per key), 32 lookups per block. Default software backend.
+    ghash_backend_table8 = 4,       //* 8-bit tables (64 KiB per key, heap allocated), 16 lookups per block.
+} GHashBackend;
+
+/// @brief A GHASH multiplication key (the hash subkey H), with everything its backend precomputes.
+/// @param H The 16-byte hash subkey.
+/// @param Pow H^1..H^8, byte reversed (ghash_backend_clmul only).
+/// @param Table4 H times every 4-bit value, as big endian word pairs (ghash_backend_table4 only).
+/// @param Table8 H times every byte value at every byte position, 64 KiB (ghash_backend_table8 only, NULL otherwise).
+/// @param Backend The GHASH backend selected when the key was initialized.
+typedef struct
+{
+    uint8_t H[16];
+    uint8_t Pow[8][16];
+    uint64_t Table4[16][2];
+    uint64_t (*Table8)[256][2];
+    GHashBackend Backend;
+} GHashKey;
+
+/// @brief A pre-expanded AES-256 key for GCM: the cipher key and its GHASH key, so neither is rebuilt per message.
+/// @note Initialize with aes_gcm_key_init(), wipe with aes_gcm_key_clear() when no longer needed.
+typedef struct
+{
+    AESKey Cipher;
+    GHashKey Hash;
+} AESGCMKey;
+
+/// @brief An AES-GCM message in progress, for the aes_gcm_stream_* functions.
+/// @param Key The GCM key, must stay valid (and unchanged) until the stream is finished.
+/// @param J The pre-counter block J0, encrypted into the Tag at the end.
+/// @param Counter The counter block for the next keystream block.
+/// @param Hash The running GHASH value.
+/// @param Buffer Bytes of AAD or Ciphertext waiting for a whole block before they are hashed.
+/// @param Stream The keystream block for a partial data block, StreamUsed bytes of it already used (16 if none).
+/// @param ASize, Size The AAD and data sizes so far, in bytes.
+/// @param Encrypt True for encryption, False for decryption.
+/// @param DataStarted True once data has been passed in (no more AAD allowed).
+/// @note Initialize with aes_gcm_stream_init(), wiped by aes_gcm_stream_final() and aes_gcm_stream_verify().
+typedef struct
+{
+    const AESGCMKey* Key;
+    uint8_t J[16];
+    uint8_t Counter[16];
+    uint8_t Hash[16];
+    uint8_t Buffer[16];
+    size_t BufSize;
+    uint8_t Stream[16];
+    size_t StreamUsed;
+    uint64_t ASize;
+    uint64_t Size;
+    bool Encrypt;
+    bool DataStarted;
+} AESGCMStream;
+
+
+/// @brief Size of Size bytes of Plaintext after PKCS#7 padding (ECB and CBC), always 1 to 16 bytes larger.
+#define AES_PADDED_SIZE(Size) ((Size) + 16 - (Size) % 16)
+
+/// @brief One message for aes_cbc_enc_batch().
+/// @param Plaintext Plaintext of any size (at least 1 byte).
+/// @param Size Size of Plaintext in bytes.
+/// @param Ctx The initialized AESKey for this message, messages may use different keys.
+/// @param IV The 16-byte IV for this message.
+/// @param Out Pre-allocated array of AES_PADDED_SIZE(Size) bytes for the Ciphertext, may be Plaintext if it is large enough.
+/// @param OutSize Set to the size of the Ciphertext in bytes.
+typedef struct
+{
+    const uint8_t* Plaintext;
+    size_t Size;
+    const AESKey* Ctx;
+    const uint8_t* IV;
+    uint8_t* Out;
+    size_t OutSize;
+} AESCBCJob;
+
+/// @brief One message for the GCM and GCM-SIV batch functions (aes_gcm_enc_batch() and the like).
+/// @param IV The 12-byte IV (nonce) for this message, never reused with the same key (GCM).
+/// @param AAD Additional authenticated data, may be NULL if ASize is 0.
+/// @param ASize Size of AAD in bytes.
+/// @param In Size bytes of Plaintext (seal) or Ciphertext (open).
+/// @param Size Size of In in bytes.
+/// @param Out Pre-allocated array of Size bytes for the result, may be In.
+/// @param Tag The 16-byte Tag, written by seal and checked by open.
+/// @param Result Set for every message: success, unknown_error if Tag is invalid (open, Out is then zeroed), or a key setup error.
+typedef struct
+{
+    const uint8_t* IV;
+    const uint8_t* AAD;
+    size_t ASize;
+    const uint8_t* In;
+    size_t Size;
+    uint8_t* Out;
+    uint8_t* Tag;
+    ErrorCode Result;
+} AESAEADJob;
+
+/// @brief An AES-CBC message in progress, for the aes_cbc_stream_* functions.
+/// @param Key The expanded key, must stay valid until the stream is finished.
+/// @param Chain The last Ciphertext block (or the IV).
+/// @param Buffer Input bytes waiting for a whole block. Decryption always holds back the last block, it carries the padding.
+/// @param Encrypt True for encryption, False for decryption.
+/// @note Initialize with aes_cbc_stream_init(), wiped by aes_cbc_stream_final().
+typedef struct
+{
+    const AESKey* Key;
+    uint8_t Chain[16];
+    uint8_t Buffer[16];
+    size_t BufSize;
+    bool Encrypt;
+} AESCBCStream;
+
+//* AES Backend selection
+
+/// @brief Selects the backend used by every AESKey initialized afterwards (including the raw Key functions).
+/// @param Backend The backend to use, aes_backend_auto selects the fastest one supported.
+/// @returns ErrorCode (success, unknown_error if Backend is not supported by this CPU or build)
+ErrorCode aes_set_backend(AESBackend Backend);
+
+/// @brief Returns the backend that aes_key_init() currently selects (never aes_backend_auto).
+AESBackend aes_get_backend(void);
+
+/// @brief Selects the GHASH backend used by every GCM key initialized afterwards (and by GCM-SIV).
+/// @param Backend The backend to use, ghash_backend_auto selects the fastest one supported.
+/// @returns ErrorCode (success, unknown_error if Backend is not supported by this CPU or build)
+ErrorCode aes_set_ghash_backend(GHashBackend Backend);
+
+/// @brief Returns the GHASH backend currently selected (never ghash_backend_auto).
+GHashBackend aes_get_ghash_backend(void);
+
+
+//* Multithreading
+
+/// @brief Default size (1 MiB) below which a message is never split across threads.
+#define AES_THREAD_THRESHOLD (1 << 20)
+
+/// @brief Splits large GCM and GCM-SIV messages across threads (opt-in, every call is single-threaded by default).
+/// @param Threads The number of threads one call may use, 0 for every online core, 1 to disable.
+/// @param Threshold Messages smaller than Threshold bytes stay single-threaded (AES_THREAD_THRESHOLD is a good default).
+/// @returns ErrorCode (success)
+/// @note Not thread safe itself, set once before encrypting. The output is identical to the single-threaded output.
+ErrorCode aes_set_threads(unsigned Threads, size_t Threshold);
+
+/// @brief Returns the number of threads a large message is split across (1 if multithreading is disabled).
+unsigned aes_get_threads(void);
+
+//* AES Key context
+
+/// @brief Expands Key into Ctx once, for use with the *_ctx functions.
+/// @param Ctx The AESKey to initialize.
+/// @param Key 32 bytes of a key.
+/// @returns ErrorCode (success)
+ErrorCode aes_key_init(AESKey* Ctx, const uint8_t* Key);
+
+/// @brief Overwrites every round Key in Ctx with 0's.
+/// @param Ctx The AESKey to wipe.
+void aes_key_clear(AESKey* Ctx);
+
+/// @brief Expands Key and derives the GHASH key (H = AES(Key, 0)) once, for use with the aes_gcm_*_ctx functions.
+/// @param Ctx The AESGCMKey to initialize.
+/// @param Key 32 bytes of a key.
+/// @returns ErrorCode (success, malloc_error)
+ErrorCode aes_gcm_key_init(AESGCMKey* Ctx, const uint8_t* Key);
+
+/// @brief Overwrites the round Keys and the GHASH key in Ctx with 0's, and frees the GHASH tables.
+/// @param Ctx The AESGCMKey to wipe.
+void aes_gcm_key_clear(AESGCMKey* Ctx);
+
+
 //* AES Standards
 
 /// @brief Encrypts Plaintext with Key to the AES-256 standard.
 /// @param Plaintext 16 bytes of Plaintext to encrypt, directly altered into Ciphertext.
 /// @param Key 32 bytes of a key, used to encrypt Plaintext.
-/// @returns ErrorCode (success, malloc_error)
+/// @returns ErrorCode (success)
+/// @note Expands Key on every call. Use aes_key_init() and aes_std_enc_ctx() for more than one block.
 ErrorCode aes_std_enc(uint8_t* Plaintext, const uint8_t* Key);
 
 /// @brief Decrypts Ciphertext with Key to the AES-256 standard.
 /// @param Ciphertext 16 bytes of Ciphertext to decrypt, directly altered into Plaintext.
 /// @param Key 32 bytes of a key, used to decrypt Ciphertext.
-/// @returns ErrorCode (success, malloc_error)
+/// @returns ErrorCode (success)
+/// @note Expands Key on every call. Use aes_key_init() and aes_std_dec_ctx() for more than one block.
 ErrorCode aes_std_dec(uint8_t* Ciphertext, const uint8_t* Key);
 
+/// @brief Encrypts Plaintext with a pre-expanded key (see aes_std_enc).
+/// @param Plaintext 16 bytes of Plaintext to encrypt, directly altered into Ciphertext.
+/// @param Ctx An AESKey initialized by aes_key_init().
+/// @returns ErrorCode (success)
+ErrorCode aes_std_enc_ctx(uint8_t* Plaintext, const AESKey* Ctx);
+
+/// @brief Decrypts Ciphertext with a pre-expanded key (see aes_std_dec).
+/// @param Ciphertext 16 bytes of Ciphertext to decrypt, directly altered into Plaintext.
+/// @param Ctx An AESKey initialized by aes_key_init().
+/// @returns ErrorCode (success)
+ErrorCode aes_std_dec_ctx(uint8_t* Ciphertext, const AESKey* Ctx);
+
 
 //* AES Implementations
 
@@ -61,6 +279,30 @@ ErrorCode aes_cbc_enc(const uint8_t* Plaintext, size_t Size, const uint8_t* Key,
 /// @returns ErrorCode (success, unknown_error, malloc_error)
 ErrorCode aes_cbc_dec(const uint8_t* Ciphertext, size_t Size, const uint8_t* Key, const uint8_t* IV, ByteArr* Ret);
 
+/// @brief aes_ecb_enc() into a caller buffer, without any allocation.
+/// @param Out Pre-allocated array of AES_PADDED_SIZE(Size) bytes, may be Plaintext (in place) if it is large enough.
+/// @param OutSize Set to the size of the Ciphertext in bytes.
+/// @returns ErrorCode (success, unknown_error)
+ErrorCode aes_ecb_enc_into(const uint8_t* Plaintext, size_t Size, const uint8_t* Key, uint8_t* Out, size_t* OutSize);
+
+/// @brief aes_ecb_dec() into a caller buffer, without any allocation.
+/// @param Out Pre-allocated array of Size bytes, may be Ciphertext (in place).
+/// @param OutSize Set to the size of the Plaintext in bytes, without the padding.
+/// @returns ErrorCode (success, unknown_error if Size or the padding is invalid)
+ErrorCode aes_ecb_dec_into(const uint8_t* Ciphertext, size_t Size, const uint8_t* Key, uint8_t* Out, size_t* OutSize);
+
+/// @brief aes_cbc_enc() into a caller buffer, without any allocation.
+/// @param Out Pre-allocated array of AES_PADDED_SIZE(Size) bytes, may be Plaintext (in place) if it is large enough.
+/// @param OutSize Set to the size of the Ciphertext in bytes.
+/// @returns ErrorCode (success, unknown_error)
+ErrorCode aes_cbc_enc_into(const uint8_t* Plaintext, size_t Size, const uint8_t* Key, const uint8_t* IV, uint8_t* Out, size_t* OutSize);
+
+/// @brief aes_cbc_dec() into a caller buffer, without any allocation.
+/// @param Out Pre-allocated array of Size bytes, may be Ciphertext (in place).
+/// @param OutSize Set to the size of the Plaintext in bytes, without the padding.
+/// @returns ErrorCode (success, unknown_error if Size or the padding is invalid)
+ErrorCode aes_cbc_dec_into(const uint8_t* Ciphertext, size_t Size, const uint8_t* Key, const uint8_t* IV, uint8_t* Out, size_t* OutSize);
+
 /// @brief Encrypts Plaintext while also generating Tag to prove that neither AAD or Ciphertext were been altered (Authenticated Encryption).
 /// @param Plaintext Plaintext of any size, directly altered into Ciphertext.
 /// @param PSize Size of Plaintext in bytes.
@@ -83,6 +325,19 @@ ErrorCode aes_gcm_enc(uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size
 /// @returns ErrorCode (Success, unknown_error, malloc_error)
 ErrorCode aes_gcm_dec(uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, const uint8_t* Tag);
 
+/// @brief Decrypts Ciphertext into a separate buffer in a single pass, while also validating Tag (Authenticated Decryption).
+/// @param Ciphertext Ciphertext of any size, not altered.
+/// @param CSize Size of Ciphertext (and Plaintext) in bytes.
+/// @param AAD Additional Authenticated Data (AAD) associated with Ciphertext (generated together) to validate.
+/// @param ASize Size of AAD in bytes.
+/// @param Key 256-bit (32 byte) key.
+/// @param IV 96-bit (12 byte) IV.
+/// @param Tag 128-bit (16 byte) tag that validates that Ciphertext and AAD have not been altered.
+/// @param Plaintext Pre-allocated, CSize-byte array to store the Plaintext in. Zeroed if Tag is invalid.
+/// @returns ErrorCode (success, unknown_error, malloc_error)
+/// @note Faster than aes_gcm_dec() on large buffers, Ciphertext is only read once.
+ErrorCode aes_gcm_dec_into(const uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, const uint8_t* Tag, uint8_t* Plaintext);
+
 /// @brief Encrypts Plaintext while also generating Tag to prove that neither the AAD or Ciphertext were altered (Authenticated Encryption).
 /// @param Plaintext Plaintext of any size, directly altered into Ciphertext.
 /// @param PSize Size of Plaintext in bytes.
@@ -103,10 +358,273 @@ ErrorCode aes_siv_enc(uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size
 /// @param Tag 128-bit (16 byte) tag that validates that Ciphertext and AAD have not been altered.
 /// @param Key 256-bit (32 byte) key.
 /// @param IV 96-bit (12 byte) randomly generated value.
-/// @returns ErrorCode (Success, unknown_error, malloc_error)
+/// @returns ErrorCode (Success, unknown_error)
 /// @note GCM-SIV has an advantage over plain GCM in the fact that it is resistant to reusing random values for IV.
+/// @note Ciphertext is decrypted and hashed in one pass. If Tag is invalid it is encrypted back, so Ciphertext is returned unaltered.
 ErrorCode aes_siv_dec(uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, const uint8_t* Tag);
 
+/// @brief Encrypts Plaintext into a separate buffer while also generating Tag (Authenticated Encryption).
+/// @param Plaintext Plaintext of any size, not altered.
+/// @param PSize Size of Plaintext (and Ciphertext) in bytes.
+/// @param AAD Additional Authenticated Data (AAD). Not encrypted, but factored into the Tag.
+/// @param ASize Size of AAD in bytes.
+/// @param Key 256-bit (32 byte) key.
+/// @param IV 96-bit (12 byte) randomly generated value.
+/// @param Ciphertext Pre-allocated, PSize-byte array to store the Ciphertext in, may be Plaintext.
+/// @param Tag A pointer to a 128-bit (16 byte) tag that validates that Ciphertext and AAD have not been altered.
+/// @returns ErrorCode (success)
+/// @note The Tag needs all of Plaintext before the first block is encrypted, so Plaintext is read twice (POLYVAL, then CTR).
+ErrorCode aes_siv_enc_into(const uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, uint8_t* Ciphertext, uint8_t* Tag);
+
+/// @brief Decrypts Ciphertext into a separate buffer in a single pass, while also validating Tag (Authenticated Decryption).
+/// @param Ciphertext Ciphertext of any size, not altered.
+/// @param CSize Size of Ciphertext (and Plaintext) in bytes.
+/// @param AAD Additional Authenticated Data (AAD) associated with Ciphertext (generated together) to validate.
+/// @param ASize Size of AAD in bytes.
+/// @param Key 256-bit (32 byte) key.
+/// @param IV 96-bit (12 byte) IV.
+/// @param Tag 128-bit (16 byte) tag that validates that Ciphertext and AAD have not been altered.
+/// @param Plaintext Pre-allocated, CSize-byte array to store the Plaintext in. Zeroed if Tag is invalid.
+/// @returns ErrorCode (success, unknown_error)
+/// @note No heap allocation: each piece is decrypted and hashed while it is still in L1, Ciphertext is only read once.
+ErrorCode aes_siv_dec_into(const uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, const uint8_t* Tag, uint8_t* Plaintext);
+
+
+//* AES Implementations (pre-expanded key)
+//* Identical to the functions above, but take an AESKey from aes_key_init() instead of a raw 32-byte Key.
+
+/// @brief aes_ecb_enc() with a pre-expanded key.
+/// @returns ErrorCode (success, unknown_error, malloc_error)
+ErrorCode aes_ecb_enc_ctx(const uint8_t* Plaintext, size_t Size, const AESKey* Ctx, ByteArr* Ret);
+
+/// @brief aes_ecb_dec() with a pre-expanded key.
+/// @returns ErrorCode (success, unknown_error, malloc_error)
+ErrorCode aes_ecb_dec_ctx(const uint8_t* Ciphertext, size_t Size, const AESKey* Ctx, ByteArr* Ret);
+
+/// @brief aes_ecb_enc() into a caller buffer, split across threads for large messages (see aes_set_threads()).
+/// @param Plaintext Plaintext of any size.
+/// @param Size Size of Plaintext in bytes.
+/// @param Ctx An initialized AESKey.
+/// @param Out Pre-allocated array of AES_PADDED_SIZE(Size) bytes for the Ciphertext, may be Plaintext (in place) if it is large enough.
+/// @param OutSize Set to the size of the Ciphertext in bytes (always AES_PADDED_SIZE(Size)).
+/// @returns ErrorCode (success, unknown_error)
+ErrorCode aes_ecb_enc_into_ctx(const uint8_t* Plaintext, size_t Size, const AESKey* Ctx, uint8_t* Out, size_t* OutSize);
+
+/// @brief aes_ecb_dec() into a caller buffer, split across threads for large messages (see aes_set_threads()).
+/// @param Ciphertext Ciphertext, a multiple of 16 bytes.
+/// @param Size Size of Ciphertext in bytes.
+/// @param Ctx An initialized AESKey.
+/// @param Out Pre-allocated array of Size bytes, may be Ciphertext (in place). Holds the padding as well.
+/// @param OutSize Set to the size of the Plaintext in bytes, without the padding.
+/// @returns ErrorCode (success, unknown_error if Size or the padding is invalid)
+ErrorCode aes_ecb_dec_into_ctx(const uint8_t* Ciphertext, size_t Size, const AESKey* Ctx, uint8_t* Out, size_t* OutSize);
+
+/// @brief aes_cbc_enc() with a pre-expanded key.
+/// @returns ErrorCode (success, unknown_error, malloc_error)
+ErrorCode aes_cbc_enc_ctx(const uint8_t* Plaintext, size_t Size, const AESKey* Ctx, const uint8_t* IV, ByteArr* Ret);
+
+/// @brief aes_cbc_enc() into a caller buffer.
+/// @param Plaintext Plaintext of any size.
+/// @param Size Size of Plaintext in bytes.
+/// @param Ctx An initialized AESKey.
+/// @param IV A 16-byte, randomly chosen, Initialization vector.
+/// @param Out Pre-allocated array of AES_PADDED_SIZE(Size) bytes for the Ciphertext, may be Plaintext (in place) if it is large enough.
+/// @param OutSize Set to the size of the Ciphertext in bytes (always AES_PADDED_SIZE(Size)).
+/// @returns ErrorCode (success, unknown_error)
+ErrorCode aes_cbc_enc_into_ctx(const uint8_t* Plaintext, size_t Size, const AESKey* Ctx, const uint8_t* IV, uint8_t* Out, size_t* OutSize);
+
+/// @brief CBC encrypts Count independent messages, interleaving up to 8 of them one block each per step (multi-buffer).
+/// @param Jobs Count messages, each OutSize is set on success.
+/// @param Count Number of messages.
+/// @returns ErrorCode (success, unknown_error if any message is empty, before anything is encrypted)
+/// @note CBC encryption is serial within a message, so this is the fast path for many small messages.
+ErrorCode aes_cbc_enc_batch(AESCBCJob* Jobs, size_t Count);
+
+/// @brief aes_cbc_dec() with a pre-expanded key.
+/// @returns ErrorCode (success, unknown_error, malloc_error)
+ErrorCode aes_cbc_dec_ctx(const uint8_t* Ciphertext, size_t Size, const AESKey* Ctx, const uint8_t* IV, ByteArr* Ret);
+
+/// @brief aes_cbc_dec() into a caller buffer, split across threads for large messages (see aes_set_threads()).
+/// @param Ciphertext Ciphertext, a multiple of 16 bytes.
+/// @param Size Size of Ciphertext in bytes.
+/// @param Ctx An initialized AESKey.
+/// @param IV The 16-byte IV used for encryption.
+/// @param Out Pre-allocated array of Size bytes, may be Ciphertext (in place). Holds the padding as well.
+/// @param OutSize Set to the size of the Plaintext in bytes, without the padding.
+/// @returns ErrorCode (success, unknown_error if Size or the padding is invalid)
+ErrorCode aes_cbc_dec_into_ctx(const uint8_t* Ciphertext, size_t Size, const AESKey* Ctx, const uint8_t* IV, uint8_t* Out, size_t* OutSize);
+
+/// @brief aes_gcm_enc() with a pre-expanded key from aes_gcm_key_init().
+/// @returns ErrorCode (success)
+ErrorCode aes_gcm_enc_ctx(uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const AESGCMKey* Ctx, const uint8_t* IV, uint8_t* Tag);
+
+/// @brief aes_gcm_dec() with a pre-expanded key from aes_gcm_key_init().
+/// @returns ErrorCode (success, unknown_error)
+ErrorCode aes_gcm_dec_ctx(uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const AESGCMKey* Ctx, const uint8_t* IV, const uint8_t* Tag);
+
+/// @brief aes_gcm_dec_into() with a pre-expanded key from aes_gcm_key_init().
+/// @returns ErrorCode (success, unknown_error)
+ErrorCode aes_gcm_dec_into_ctx(const uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const AESGCMKey* Ctx, const uint8_t* IV, const uint8_t* Tag, uint8_t* Plaintext);
+
+
+
+//* AES-CBC streaming
+//* For messages that do not fit in memory at once: data may be passed in chunks of any size, PKCS#7 is applied (or checked) by aes_cbc_stream_final().
+
+/// @brief Starts a CBC message.
+/// @param Ctx The AESCBCStream to initialize.
+/// @param Key An initialized AESKey, used until the stream is finished.
+/// @param IV The 16-byte IV.
+/// @param Encrypt True to encrypt, False to decrypt.
+/// @returns ErrorCode (success)
+ErrorCode aes_cbc_stream_init(AESCBCStream* Ctx, const AESKey* Key, const uint8_t* IV, bool Encrypt);
+
+/// @brief Encrypts (or decrypts) the next Size bytes of the message, writing every whole block that is ready.
+/// @param Ctx An initialized AESCBCStream.
+/// @param In Size bytes of Plaintext (or Ciphertext).
+/// @param Size Size of In in bytes, does not have to be a multiple of 16.
+/// @param Out Pre-allocated array of Size + 16 bytes, must not overlap In.
+/// @param OutSize Set to the number of bytes written to Out (a multiple of 16).
+/// @returns ErrorCode (success)
+ErrorCode aes_cbc_stream_update(AESCBCStream* Ctx, const uint8_t* In, size_t Size, uint8_t* Out, size_t* OutSize);
+
+/// @brief Finishes the message: pads and encrypts the last block, or decrypts it and removes its padding. Then wipes Ctx.
+/// @param Ctx An initialized AESCBCStream.
+/// @param Out Pre-allocated, 16-byte array for the last bytes of the message.
+/// @param OutSize Set to the number of bytes written to Out (16 when encrypting, 0 to 15 when decrypting).
+/// @returns ErrorCode (success, unknown_error if the Ciphertext was not a whole number of blocks or the padding is invalid)
+ErrorCode aes_cbc_stream_final(AESCBCStream* Ctx, uint8_t* Out, size_t* OutSize);
+
+//* AES-GCM streaming
+//* For messages that do not fit in memory at once: AAD and data may be passed in chunks of any size.
+
+/// @brief Starts a GCM message.
+/// @param Ctx The AESGCMStream to initialize.
+/// @param Key A GCM key from aes_gcm_key_init(), used until the stream is finished.
+/// @param IV 96-bit (12 byte) IV.
+/// @param Encrypt True to encrypt, False to decrypt.
+/// @returns ErrorCode (success)
+ErrorCode aes_gcm_stream_init(AESGCMStream* Ctx, const AESGCMKey* Key, const uint8_t* IV, bool Encrypt);
+
+/// @brief Adds AAD to the message, may be called any number of times before the first aes_gcm_stream_update().
+/// @param Ctx An initialized AESGCMStream.
+/// @param AAD ASize bytes of Additional Authenticated Data.
+/// @param ASize Size of AAD in bytes.
+/// @returns ErrorCode (success, unknown_error if data has already been passed in)
+ErrorCode aes_gcm_stream_aad(AESGCMStream* Ctx, const uint8_t* AAD, size_t ASize);
+
+/// @brief Encrypts (or decrypts) the next Size bytes of the message in place.
+/// @param Ctx An initialized AESGCMStream.
+/// @param Data Size bytes of Plaintext (or Ciphertext), directly altered.
+/// @param Size Size of Data in bytes, does not have to be a multiple of 16.
+/// @returns ErrorCode (success)
+/// @warning When decrypting, Data is not authenticated until aes_gcm_stream_verify() succeeds. Do not act on it before then.
+ErrorCode aes_gcm_stream_update(AESGCMStream* Ctx, uint8_t* Data, size_t Size);
+
+/// @brief Finishes an encryption stream and writes its Tag, then wipes Ctx.
+/// @param Ctx An AESGCMStream initialized for encryption.
+/// @param Tag A pre-allocated, 16-byte array to store the Tag in.
+/// @returns ErrorCode (success, unknown_error if Ctx is a decryption stream)
+ErrorCode aes_gcm_stream_final(AESGCMStream* Ctx, uint8_t* Tag);
+
+/// @brief Finishes a decryption stream and checks Tag in constant time, then wipes Ctx.
+/// @param Ctx An AESGCMStream initialized for decryption.
+/// @param Tag The 16-byte Tag received with the message.
+/// @returns ErrorCode (success, unknown_error if Tag is invalid or Ctx is an encryption stream)
+ErrorCode aes_gcm_stream_verify(AESGCMStream* Ctx, const uint8_t* Tag);
+
+
+//* AES-GCM-SIV (pre-expanded key)
+
+/// @brief aes_siv_enc() with a pre-expanded master key. The per-IV EncKey is still derived (and expanded once) per call.
+/// @returns ErrorCode (success)
+ErrorCode aes_siv_enc_ctx(uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const AESKey* Ctx, const uint8_t* IV, uint8_t* Tag);
+
+/// @brief aes_siv_dec() with a pre-expanded master key. The per-IV EncKey is still derived (and expanded once) per call.
+/// @returns ErrorCode (success, unknown_error)
+ErrorCode aes_siv_dec_ctx(uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const AESKey* Ctx, const uint8_t* IV, const uint8_t* Tag);
+
+/// @brief aes_siv_enc_into() with a pre-expanded master key.
+/// @returns ErrorCode (success)
+ErrorCode aes_siv_enc_into_ctx(const uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const AESKey* Ctx, const uint8_t* IV, uint8_t* Ciphertext, uint8_t* Tag);
+
+/// @brief aes_siv_dec_into() with a pre-expanded master key.
+/// @returns ErrorCode (success, unknown_error)
+ErrorCode aes_siv_dec_into_ctx(const uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const AESKey* Ctx, const uint8_t* IV, const uint8_t* Tag, uint8_t* Plaintext);
+
+
+//* AES-GCM and AES-GCM-SIV over Base64
+//* For Ciphertexts that travel as Base64 text: decoding and decryption (or encryption and encoding) run together a few KiB at a time, so
+//* no decoded Ciphertext (or binary Ciphertext) is ever held in full. Size the buffers with BASE64_DECODED_MAX() and BASE64_ENCODED_SIZE() (base64.h).
+
+/// @brief Decodes Base64 Ciphertext and GCM decrypts it straight into Plaintext, a few KiB at a time.
+/// @param B64 Len characters of Base64 Ciphertext (no '\0' needed).
+/// @param Len Number of characters in B64.
+/// @param AAD, ASize, Ctx, IV, Tag As for aes_gcm_dec_into_ctx().
+/// @param Plaintext Pre-allocated array of BASE64_DECODED_MAX(Len) bytes, zeroed if the Base64 or the Tag is invalid.
+/// @param PSize Set to the size of the Plaintext in bytes.
+/// @returns ErrorCode (success, unknown_error if B64 is not valid Base64 or Tag is invalid)
+ErrorCode aes_gcm_dec_base64_ctx(const char* B64, size_t Len, const uint8_t* AAD, size_t ASize, const AESGCMKey* Ctx, const uint8_t* IV, const uint8_t* Tag, uint8_t* Plaintext, size_t* PSize);
+
+/// @brief GCM encrypts Plaintext and writes the Ciphertext as Base64, a few KiB at a time (Plaintext is not altered).
+/// @param Plaintext, PSize, AAD, ASize, Ctx, IV As for aes_gcm_enc_ctx().
+/// @param Out Pre-allocated array of BASE64_ENCODED_SIZE(PSize) characters, no '\0' is written.
+/// @param OutLen Set to the number of characters written.
+/// @param Tag Pre-allocated 16-byte array for the Tag.
+/// @returns ErrorCode (success)
+ErrorCode aes_gcm_enc_base64_ctx(const uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const AESGCMKey* Ctx, const uint8_t* IV, char* Out, size_t* OutLen, uint8_t* Tag);
+
+/// @brief Decodes Base64 Ciphertext and GCM-SIV decrypts it straight into Plaintext, POLYVAL runs on each piece as it is decrypted.
+/// @param B64 Len characters of Base64 Ciphertext (no '\0' needed).
+/// @param Len Number of characters in B64.
+/// @param AAD, ASize, Ctx, IV, Tag As for aes_siv_dec_ctx().
+/// @param Plaintext Pre-allocated array of BASE64_DECODED_MAX(Len) bytes, zeroed if the Base64 or the Tag is invalid.
+/// @param PSize Set to the size of the Plaintext in bytes.
+/// @returns ErrorCode (success, unknown_error if B64 is not valid Base64 or Tag is invalid)
+ErrorCode aes_siv_dec_base64_ctx(const char* B64, size_t Len, const uint8_t* AAD, size_t ASize, const AESKey* Ctx, const uint8_t* IV, const uint8_t* Tag, uint8_t* Plaintext, size_t* PSize);
+
+/// @brief GCM-SIV encrypts Plaintext and writes the Ciphertext as Base64 (Plaintext is not altered).
+/// @param Plaintext, PSize, AAD, ASize, Ctx, IV As for aes_siv_enc_ctx().
+/// @param Out Pre-allocated array of BASE64_ENCODED_SIZE(PSize) characters, no '\0' is written.
+/// @param OutLen Set to the number of characters written.
+/// @param Tag Pre-allocated 16-byte array for the Tag.
+/// @returns ErrorCode (success)
+/// @note The Tag needs all of Plaintext first, so Plaintext is read twice (POLYVAL, then CTR and encoding a few KiB at a time).
+ErrorCode aes_siv_enc_base64_ctx(const uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const AESKey* Ctx, const uint8_t* IV, char* Out, size_t* OutLen, uint8_t* Tag);
+
+//* Batched AES-GCM and AES-GCM-SIV
+//* Many small messages under one key in one call. Only the single-block steps of each message (GCM's Tag mask E(J), GCM-SIV's
+//* key derivation and Tag) are encrypted together across messages. Each message's data still runs through its own CTR and
+//* GHASH (or POLYVAL) pass, the same as aes_gcm_dec_into_ctx(), not interleaved with other messages.
+
+/// @brief GCM encrypts Count messages under one key, writing each Ciphertext to Out and each Tag to Tag.
+/// @param Ctx The expanded GCM key, shared by every message.
+/// @param Jobs Count messages, see AESAEADJob.
+/// @param Count Number of messages.
+/// @returns ErrorCode (success)
+ErrorCode aes_gcm_enc_batch(const AESGCMKey* Ctx, AESAEADJob* Jobs, size_t Count);
+
+/// @brief GCM decrypts and checks Count messages under one key, each message is checked (and its Result set) on its own.
+/// @param Ctx The expanded GCM key, shared by every message.
+/// @param Jobs Count messages, see AESAEADJob. Out is zeroed for every message with an invalid Tag.
+/// @param Count Number of messages.
+/// @returns ErrorCode (success, unknown_error if any Tag is invalid)
+ErrorCode aes_gcm_dec_batch(const AESGCMKey* Ctx, AESAEADJob* Jobs, size_t Count);
+
+/// @brief GCM-SIV encrypts Count messages under one master key, writing each Ciphertext to Out and each Tag to Tag.
+/// @param Ctx The expanded master key, shared by every message.
+/// @param Jobs Count messages, see AESAEADJob.
+/// @param Count Number of messages.
+/// @returns ErrorCode (success, or a key setup error: every message not yet finished then has that Result)
+ErrorCode aes_siv_enc_batch(const AESKey* Ctx, AESAEADJob* Jobs, size_t Count);
+
+/// @brief GCM-SIV decrypts and checks Count messages under one master key, each message is checked (and its Result set) on its own.
+/// @param Ctx The expanded master key, shared by every message.
+/// @param Jobs Count messages, see AESAEADJob. Out is zeroed for every message with an invalid Tag.
+/// @param Count Number of messages.
+/// @returns ErrorCode (success, unknown_error if any Tag is invalid, or a key setup error: every message not yet finished then has that Result, and its Out zeroed)
+ErrorCode aes_siv_dec_batch(const AESKey* Ctx, AESAEADJob* Jobs, size_t Count);
+
 //* Non-standard generator functions
 
 /// @brief Generates a random 16-byte IV for use with CBC.
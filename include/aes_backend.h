@@ -0,0 +1,172 @@
+#ifndef AES_BACKEND_H
+#define AES_BACKEND_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "../include/aes.h"
+#include "../include/cpu.h"
+
+//* Internal interface between aes.c and the block cipher backends. Not part of the public API.
+//* Every backend encrypts/decrypts Blocks consecutive 16-byte blocks from In to Out (In may equal Out).
+
+
+/// @brief Independent messages CBC encrypted at once by the *_cbc_enc_lanes() kernels.
+#define AES_LANES 8
+
+/// @brief Counter block layouts used by the CTR modes.
+typedef enum
+{
+    aes_counter_gcm = 0,    //* 32-bit big endian counter in the last 4 bytes.
+    aes_counter_siv = 1,    //* 32-bit little endian counter in the first 4 bytes.
+} AESCounter;
+
+
+//? T-table backend (aes_ttable.c)
+
+/// @brief Builds the 32-bit round tables from SBox and InvSBox. Called once by aes.c, before any key is initialized.
+/// @param SBox The initialized 256-byte SBox.
+/// @param InvSBox The initialized 256-byte InvSBox.
+void aes_ttable_init(const uint8_t* SBox, const uint8_t* InvSBox);
+
+/// @brief Encrypts Blocks 16-byte blocks with four 256-entry tables per round.
+/// @param Ctx An AESKey initialized by aes_key_init().
+/// @param In Blocks*16 bytes of Plaintext.
+/// @param Out Blocks*16 bytes to store the Ciphertext in, may be In.
+/// @param Blocks Number of 16-byte blocks.
+void aes_ttable_enc(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks);
+
+/// @brief Decrypts Blocks 16-byte blocks with four 256-entry tables per round.
+/// @param Ctx An AESKey initialized by aes_key_init().
+/// @param In Blocks*16 bytes of Ciphertext.
+/// @param Out Blocks*16 bytes to store the Plaintext in, may be In.
+/// @param Blocks Number of 16-byte blocks.
+void aes_ttable_dec(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks);
+
+/// @brief CBC encrypts Blocks blocks of up to AES_LANES independent messages, one block of each per step (rounds interleaved across messages).
+/// @param Keys One AESKey per lane, initialized by aes_key_init().
+/// @param Chain The previous Ciphertext block (or IV) of each lane, updated to the last block written.
+/// @param In Blocks*16 bytes of Plaintext per lane.
+/// @param Out Blocks*16 bytes per lane to store the Ciphertext in, may be In.
+/// @param Lanes Number of lanes in use (1 to AES_LANES).
+/// @param Blocks Number of 16-byte blocks per lane.
+void aes_ttable_cbc_enc_lanes(const AESKey* const* Keys, uint8_t (*Chain)[16], const uint8_t* const* In, uint8_t* const* Out, int Lanes, size_t Blocks);
+
+
+//? Bitsliced backend (aes_bitslice.c), constant-time on every platform.
+
+/// @brief Expands Key into Ctx->EncKey and Ctx->SliceKey, running SubWord through the Boolean S-box circuit.
+/// @param Ctx The AESKey to fill (Ctx->DecKey is zeroed, decryption runs the inverse cipher on SliceKey).
+/// @param Key 32 bytes of a key.
+void aes_bitslice_key_init(AESKey* Ctx, const uint8_t* Key);
+
+/// @brief Encrypts Blocks 16-byte blocks, 8 per pass (a partial pass is padded, never branched on data).
+void aes_bitslice_enc(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks);
+
+/// @brief Decrypts Blocks 16-byte blocks, 8 per pass.
+void aes_bitslice_dec(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks);
+
+
+//? AES-NI backend (aes_ni.c), only call when cpu_has_aesni() is true.
+#ifdef CPU_X86_SIMD
+
+/// @brief Expands Key with AESKEYGENASSIST into Ctx->EncKey, and Ctx->DecKey with AESIMC.
+/// @param Ctx The AESKey to fill (same layout as the software key schedule).
+/// @param Key 32 bytes of a key.
+void aes_ni_key_init(AESKey* Ctx, const uint8_t* Key);
+
+/// @brief Encrypts Blocks 16-byte blocks, 8 at a time in parallel.
+void aes_ni_enc(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks);
+
+/// @brief Decrypts Blocks 16-byte blocks, 8 at a time in parallel.
+void aes_ni_dec(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks);
+
+/// @brief aes_ttable_cbc_enc_lanes() with AES-NI: every AESENC has one from each other lane in flight.
+void aes_ni_cbc_enc_lanes(const AESKey* const* Keys, uint8_t (*Chain)[16], const uint8_t* const* In, uint8_t* const* Out, int Lanes, size_t Blocks);
+
+/// @brief Encrypts (and decrypts) Data in counter mode, 8 counter blocks at a time.
+/// @param Ctx An AESKey initialized for aes_backend_aesni.
+/// @param Type The counter layout (GCM or GCM-SIV).
+/// @param ICB The 16-byte Initial Counter Block, not altered.
+/// @param Data Size bytes of data, directly altered.
+/// @param Size The size of Data in bytes, does not have to be a multiple of 16.
+void aes_ni_ctr(const AESKey* Ctx, AESCounter Type, const uint8_t* ICB, uint8_t* Data, size_t Size);
+
+
+
+//? Vector permute backend (aes_vperm.c), only call when cpu_has_ssse3() is true.
+
+/// @brief Builds the GF(2^4) nibble tables. Called once by aes.c, before any key is initialized.
+void aes_vperm_init(void);
+
+/// @brief Expands Key into Ctx->EncKey, Ctx->DecKey and Ctx->PermKey, SubWord through PSHUFB lookups.
+/// @param Ctx The AESKey to fill (same EncKey/DecKey layout as the software key schedule).
+/// @param Key 32 bytes of a key.
+void aes_vperm_key_init(AESKey* Ctx, const uint8_t* Key);
+
+/// @brief Encrypts Blocks 16-byte blocks, one at a time.
+void aes_vperm_enc(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks);
+
+/// @brief Decrypts Blocks 16-byte blocks, one at a time.
+void aes_vperm_dec(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks);
+
+#endif // CPU_X86_SIMD
+
+
+//? GHASH (ghash.c), GF(2^128) in the GCM bit order.
+
+/// @brief Precomputes Key for the selected GHASH backend.
+/// @param Key The GHashKey to fill.
+/// @param H The 16-byte hash subkey.
+/// @returns ErrorCode (success, malloc_error)
+ErrorCode ghash_key_init(GHashKey* Key, const uint8_t* H);
+
+/// @brief Overwrites H and everything derived from it with 0's, and frees Key->Table8.
+void ghash_key_clear(GHashKey* Key);
+
+/// @brief Absorbs Data into the running hash Y (Y = (Y ^ Block) * H for every block).
+/// @param Key A GHashKey initialized by ghash_key_init().
+/// @param Y The 16-byte running hash, directly altered.
+/// @param Data Size bytes to hash, a final incomplete block is padded with 0's.
+/// @param Size The size of Data in bytes.
+void ghash_update(const GHashKey* Key, uint8_t* Y, const uint8_t* Data, size_t Size);
+
+/// @brief Precomputes Key for POLYVAL (GCM-SIV), as the GHASH key mulX_GHASH(ByteReverse(H)) (RFC 8452, Appendix A).
+/// @param Key The GHashKey to fill. ghash_backend_table8 falls back to table4, since POLYVAL keys change every message.
+/// @param H The 16-byte POLYVAL key (little endian).
+/// @returns ErrorCode (success)
+ErrorCode polyval_key_init(GHashKey* Key, const uint8_t* H);
+
+/// @brief Absorbs Data into the running POLYVAL hash Y, one multiplication per block (no separate x^-128 step).
+/// @param Key A GHashKey initialized by polyval_key_init().
+/// @param Y The 16-byte running hash (little endian), directly altered.
+/// @param Data Size bytes to hash, a final incomplete block is padded with 0's.
+/// @param Size The size of Data in bytes.
+void polyval_update(const GHashKey* Key, uint8_t* Y, const uint8_t* Data, size_t Size);
+
+
+/// @brief Appends a hash computed separately: Y = Y * H^Blocks ^ Part, so hashing A and B from 0 and combining them equals hashing A || B.
+/// @param Key A GHashKey initialized by ghash_key_init().
+/// @param Y The 16-byte running hash of the data before Part, directly altered.
+/// @param Part The 16-byte hash of the following data, started from 0.
+/// @param Blocks The number of 16-byte blocks (padded) hashed into Part.
+void ghash_combine(const GHashKey* Key, uint8_t* Y, const uint8_t* Part, uint64_t Blocks);
+
+/// @brief ghash_combine() for POLYVAL (Key from polyval_key_init(), Y and Part little endian).
+void polyval_combine(const GHashKey* Key, uint8_t* Y, const uint8_t* Part, uint64_t Blocks);
+
+//? PCLMULQDQ GHASH (ghash_clmul.c), only call when cpu_has_pclmul() is true.
+#ifdef CPU_X86_SIMD
+
+/// @brief Fills Key->Pow with H^1..H^8 (byte reversed).
+void ghash_clmul_init(GHashKey* Key);
+
+/// @brief Absorbs Blocks full 16-byte blocks into Y, 8 blocks per reduction.
+void ghash_clmul_update(const GHashKey* Key, uint8_t* Y, const uint8_t* Data, size_t Blocks);
+
+/// @brief ghash_clmul_update() for POLYVAL blocks (Key from polyval_key_init()).
+void polyval_clmul_update(const GHashKey* Key, uint8_t* Y, const uint8_t* Data, size_t Blocks);
+
+#endif // CPU_X86_SIMD
+
+#endif // AES_BACKEND_H
@@ -3,6 +3,9 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include "../include/aes.h"
+#include "../include/aes_backend.h"
 
 
 //? Directives and Arrays
@@ -12,15 +15,115 @@
 /// @param shift Number of bits to shift by.
 #define ROTL8(x, shift) ((x<<shift) | (x >> (8 - shift)))
 
-/// @brief Accesses byte array X as if it were a bit array, reads bytes from 7->0.
-/// @param x A uint8_t[16].
-/// @param bit The bit to access, from 0-127.
-#define BITARR128(x, bit) ((x[bit>>3] >> (7-(bit%8))) & 1)
-
-/// @brief Accesses byte array X as if it were a bit array, reads bytes from 0->7.
-/// @param x A uint8_t[16].
-/// @param bit The bit to access, from 0-127.
-#define SIVBITARR(x, bit) ((x[bit>>3] >> ((bit%8))) & 1)
+/// @brief Counter blocks generated and encrypted per pass by ctr_xor().
+#define CTR_BLOCKS 16
+
+/// @brief Bytes of GCM (or GCM-SIV) data encrypted and hashed together per pass by gcm_stitch() and siv_stitch(), small enough to stay in L1.
+#define GCM_STITCH_SIZE 4096
+
+/// @brief Bytes decrypted (or encrypted) per piece by the Base64 pipelines: whole AES blocks and whole Base64 quartets, small enough to stay in L1.
+#define AES_BASE64_STAGE 3072
+
+/// @brief Messages whose Tag masks (E(J)) are encrypted together by gcm_batch().
+#define AES_BATCH_BLOCKS 64
+
+/// @brief Smallest range of a message worth handing to its own thread (thread start up costs ~10 us).
+#define THREAD_MIN_PART (64 * 1024)
+
+/// @brief What gcm_part() does with its range of a GCM message.
+typedef enum
+{
+    gcm_job_encrypt = 0,    //* CTR, then GHASH the Ciphertext (stitched).
+    gcm_job_decrypt = 1,    //* GHASH the Ciphertext, then CTR (stitched).
+    gcm_job_hash = 2,       //* GHASH only.
+    gcm_job_ctr = 3,        //* CTR only.
+} GCMJob;
+
+/// @brief One thread's range of a GCM message.
+/// @param Ctx The expanded GCM key.
+/// @param In Size bytes of input.
+/// @param Out Size bytes of output, may be In (unused by gcm_job_hash).
+/// @param ICB The counter block of the first block in the range.
+/// @param Hash The GHASH of the range, started from 0 (or from the running hash when there is only one range).
+/// @param Job What to do with the range.
+typedef struct
+{
+    const AESGCMKey* Ctx;
+    const uint8_t* In;
+    uint8_t* Out;
+    size_t Size;
+    uint8_t ICB[16];
+    uint8_t Hash[16];
+    GCMJob Job;
+} GCMPart;
+
+/// @brief What siv_part() does with its range of a GCM-SIV message.
+typedef enum
+{
+    siv_job_hash = 0,   //* POLYVAL only.
+    siv_job_ctr = 1,    //* CTR only (GCM-SIV counter).
+    siv_job_decrypt = 2,//* CTR, then POLYVAL the Plaintext (stitched).
+} SIVJob;
+
+/// @brief One thread's range of a GCM-SIV message.
+/// @param Cipher The expanded per-message EncKey (unused by siv_job_hash).
+/// @param Auth The per-message POLYVAL key (unused by siv_job_ctr).
+/// @param In Size bytes of input.
+/// @param Out Size bytes of output, may be In (unused by siv_job_hash).
+/// @param ICB The counter block of the first block in the range.
+/// @param Y The POLYVAL of the range, started from 0 (or from the running hash when there is only one range).
+/// @param Job What to do with the range.
+typedef struct
+{
+    const AESKey* Cipher;
+    const GHashKey* Auth;
+    const uint8_t* In;
+    uint8_t* Out;
+    size_t Size;
+    uint8_t ICB[16];
+    uint8_t Y[16];
+    SIVJob Job;
+} SIVPart;
+
+/// @brief What block_part() does with its range of an ECB or CBC message.
+typedef enum
+{
+    block_job_ecb_enc = 0,
+    block_job_ecb_dec = 1,
+    block_job_cbc_dec = 2,
+} BlockJob;
+
+/// @brief One thread's range of an ECB or CBC message.
+/// @param Ctx The expanded key.
+/// @param In Blocks*16 bytes of input.
+/// @param Out Blocks*16 bytes of output, may be In.
+/// @param Prev The Ciphertext block before the range (or the IV), saved before any thread writes (block_job_cbc_dec only).
+/// @param Job What to do with the range.
+typedef struct
+{
+    const AESKey* Ctx;
+    const uint8_t* In;
+    uint8_t* Out;
+    size_t Blocks;
+    uint8_t Prev[16];
+    BlockJob Job;
+} BlockPart;
+
+/// @brief One message in flight in aes_cbc_enc_batch().
+/// @param In The next whole block of Plaintext to encrypt.
+/// @param Out Where the next Ciphertext block goes.
+/// @param Blocks Blocks left before the padded one (or 1 once Padded is set).
+/// @param Padded True once only the padded final block (Last) is left.
+/// @param Last The final Plaintext bytes and their PKCS#7 padding, saved when the message starts (Out may be Plaintext).
+typedef struct
+{
+    const AESKey* Ctx;
+    const uint8_t* In;
+    uint8_t* Out;
+    size_t Blocks;
+    bool Padded;
+    uint8_t Last[16];
+} CBCLane;
 
 /// @brief SBox array to allow for much faster encryption.
 static uint8_t SBox[256];
@@ -38,9 +141,14 @@ static void add_round_key(uint8_t* State, const uint8_t* EKey);
 
 /// @brief Performs repeat transformations on Key to produce an Expanded round Key for each round.
 /// @param Key The Key input into both Encrypt and Decrypt functions.
-/// @returns A pointer to the Expanded round Key. Must be freed after use.
-/// @warning Returns an allocated array full of key information. Must be overwritten first, then freed.
-static uint8_t* expand_key_256(const uint8_t* Key);
+/// @param EKey A 240-byte array to store the 15 Expanded round Keys in.
+/// @warning EKey is full of key information. Must be overwritten after use.
+static void expand_key_256(const uint8_t* Key, uint8_t* EKey);
+
+/// @brief Converts Expanded round Keys into decryption round Keys (reversed, InvMixColumns applied to the middle 13).
+/// @param EKey The 240-byte Expanded round Key from expand_key_256().
+/// @param DKey A 240-byte array to store the decryption round Keys in.
+static void invert_key_256(const uint8_t* EKey, uint8_t* DKey);
 
 /// @brief Rotates a 4-byte word by each byte, to the left.
 /// @param Word 4-byte array (includes uint32_t) to alter.
@@ -53,6 +161,24 @@ static void sub_word(uint8_t* Word);
 
 //? Encryption functions
 
+/// @brief Encrypts a single 16-byte Block with a pre-expanded key.
+/// @param Block 16 bytes of Plaintext, directly altered into Ciphertext.
+/// @param Ctx An initialized AESKey.
+static void encrypt_block(uint8_t* Block, const AESKey* Ctx);
+
+/// @brief Encrypts Blocks consecutive 16-byte blocks with the backend selected in Ctx.
+/// @param Ctx An initialized AESKey.
+/// @param In Blocks*16 bytes of Plaintext.
+/// @param Out Blocks*16 bytes to store the Ciphertext in, may be In.
+/// @param Blocks Number of 16-byte blocks.
+static void encrypt_blocks(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks);
+
+/// @brief Reference encryption of a single block (byte-wise SubBytes, ShiftRows, MixColumns).
+/// @param Block 16 bytes of Plaintext.
+/// @param Out 16 bytes to store the Ciphertext in, may be Block.
+/// @param Ctx An initialized AESKey.
+static void bytewise_encrypt_block(const uint8_t* Block, uint8_t* Out, const AESKey* Ctx);
+
 /// @brief Shifts each row of State left by an amount equal to the row number.
 /// @param State A 16-byte array, interpreted as a 4x4 byte array.
 static void shift_rows(uint8_t* State);
@@ -68,6 +194,24 @@ static void mix_columns(uint8_t* State);
 
 //? Decryption functions
 
+/// @brief Decrypts a single 16-byte Block with a pre-expanded key.
+/// @param Block 16 bytes of Ciphertext, directly altered into Plaintext.
+/// @param Ctx An initialized AESKey.
+static void decrypt_block(uint8_t* Block, const AESKey* Ctx);
+
+/// @brief Decrypts Blocks consecutive 16-byte blocks with the backend selected in Ctx.
+/// @param Ctx An initialized AESKey.
+/// @param In Blocks*16 bytes of Ciphertext.
+/// @param Out Blocks*16 bytes to store the Plaintext in, may be In.
+/// @param Blocks Number of 16-byte blocks.
+static void decrypt_blocks(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks);
+
+/// @brief Reference decryption of a single block (byte-wise InvSubBytes, InvShiftRows, InvMixColumns).
+/// @param Block 16 bytes of Ciphertext.
+/// @param Out 16 bytes to store the Plaintext in, may be Block.
+/// @param Ctx An initialized AESKey.
+static void bytewise_decrypt_block(const uint8_t* Block, uint8_t* Out, const AESKey* Ctx);
+
 /// @brief Shifts each row of State right by an amount equal to the row number (Inverse of ShiftRows).
 /// @param State A 16-byte array, interpreted as a 4x4 byte array.
 static void inv_shift_rows(uint8_t* State);
@@ -91,54 +235,194 @@ static uint8_t gmul(uint8_t x, uint8_t y);
 /// @returns The Multiplicative Inverse of Byte.
 static uint8_t ginv(uint8_t Byte);
 
-/// @brief Increments the last 32 bits of a 128-bit Block (as if it were a 128-bit number).
-/// @param Block A uint8_t[16] representing a 128-bit number.
-static void ginc32(uint8_t* Block);
-
-/// @brief Returns X*Y in GF(2^128) into Result (GCM).
-/// @param X A uint8_t[16] that represents a 128-bit number.
-/// @param Y A uint8_t[16] that represents a 128-bit number.
-/// @param Result The product, can be X, Y, or any other uint8_t[16].
-static void gblockmul(const uint8_t* X, const uint8_t* Y, uint8_t* Result);
-
-/// @brief Performs the GHash on Block, of Size bytes. If Size is not a multiple of 16, 0's will be padded to the end.
-/// @param H The Hash Subkey, internal to GCM.
-/// @param Block A uint8_t[] of any size. Contains the data to hash.
-/// @param Size The size of the Block, in bytes.
-/// @param Output A uint8_t[16] to write the final hash to.
-/// @note Due to how the GHash function works, the final hash block can be put into Output to "concatenate" the byte strings (on full 16-byte blocks).
-static void ghash(const uint8_t* H, const uint8_t* Block, size_t Size, uint8_t* Output);
-
 /// @brief Encrypts (and decrypts) Plaintext.
 /// @param Plaintext The plaintext of any size, overwritten by result (Ciphertext).
 /// @param Size The Size of Plaintext (and Ciphertext) in bytes.
-/// @param Key The key to encrypt Plaintext and decrypt Ciphertext with. 
+/// @param Ctx The expanded key to encrypt Plaintext and decrypt Ciphertext with. 
 /// @param ICB The Initial Counter Block (IV).
 /// @note This function works forwards and backwards. Plaintext is encrypted on the first run, and decrypted on the second (identical) run.
-static ErrorCode gctr(uint8_t* Plaintext, size_t Size, const uint8_t* Key, const uint8_t* ICB);
+static void gctr(uint8_t* Plaintext, size_t Size, const AESKey* Ctx, const uint8_t* ICB);
+
+/// @brief The counter mode core behind gctr() and sivctr(): CTR_BLOCKS counters per pass, encrypted with encrypt_blocks().
+/// @param Data Size bytes of data, directly altered.
+/// @param Size The size of Data in bytes, does not have to be a multiple of 16.
+/// @param Ctx The expanded key.
+/// @param Type The counter layout (GCM or GCM-SIV), the counter wraps at 32 bits.
+/// @param ICB The 16-byte Initial Counter Block, not altered.
+static void ctr_xor(uint8_t* Data, size_t Size, const AESKey* Ctx, AESCounter Type, const uint8_t* ICB);
+
+/// @brief XORs Size bytes of Stream into Data, a word at a time.
+static void xor_bytes(uint8_t* Data, const uint8_t* Stream, size_t Size);
+
+/// @brief Builds the final GHASH block: the AAD and data lengths in bits, as two 64-bit big endian values.
+/// @param ASize Size of AAD in bytes.
+/// @param Size Size of Plaintext (or Ciphertext) in bytes.
+/// @param LenBuf Pre-allocated, 16-byte array to store the block in.
+static void gcm_length_block(uint64_t ASize, uint64_t Size, uint8_t* LenBuf);
+
+/// @brief Runs gctr() and ghash over Size bytes together, GCM_STITCH_SIZE bytes at a time.
+/// @param Ctx The expanded GCM key.
+/// @param In Size bytes of Plaintext (Encrypt) or Ciphertext (!Encrypt).
+/// @param Out Size bytes to store the result in, may be In.
+/// @param Size The size of In in bytes, does not have to be a multiple of 16.
+/// @param ICB The Initial Counter Block (J + 1).
+/// @param Hash The running 16-byte GHASH value, updated with the Ciphertext.
+/// @param Encrypt True to hash the output of CTR, False to hash its input.
+static void gcm_stitch(const AESGCMKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Size, const uint8_t* ICB, uint8_t* Hash, bool Encrypt);
+
+/// @brief Runs Job over Blocks blocks, split across threads when the message is large enough (see aes_set_threads()).
+/// @param Ctx The expanded key.
+/// @param In Blocks*16 bytes of input.
+/// @param Out Blocks*16 bytes of output, may be In.
+/// @param Blocks Number of 16-byte blocks.
+/// @param IV The 16-byte IV (block_job_cbc_dec only, NULL otherwise).
+/// @param Job What to do with the message.
+static void block_run(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks, const uint8_t* IV, BlockJob Job);
+
+/// @brief thread_run() entry point, runs one BlockPart.
+static void block_part(void* Arg);
+
+/// @brief CBC decrypts Blocks blocks, CTR_BLOCKS at a time. Each chunk of Ciphertext is copied first, so Out may be In.
+/// @param Prev The Ciphertext block before In (or the IV).
+static void cbc_dec_blocks(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks, const uint8_t* Prev);
+
+/// @brief Starts Job in Lane: saves the padded final block and loads the IV into Chain.
+static void cbc_lane_start(CBCLane* Lane, uint8_t* Chain, AESCBCJob* Job);
+
+/// @brief CBC encrypts Blocks blocks in each of Lanes messages, with the interleaved backend kernel when every key has one.
+static void cbc_enc_lanes(const AESKey* const* Keys, uint8_t (*Chain)[16], const uint8_t* const* In, uint8_t* const* Out, int Lanes, size_t Blocks);
+
+/// @brief CBC encrypts Blocks blocks of a single message (one lane of cbc_enc_lanes()), updating Chain.
+static void cbc_enc_blocks(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks, uint8_t* Chain);
+
+/// @brief Checks PKCS#7 padding on the last block of a decrypted message.
+/// @param Data Size bytes of decrypted data, Size a non-zero multiple of 16.
+/// @param Size Size of Data in bytes.
+/// @param OutSize Set to Size without the padding if it is valid.
+/// @returns ErrorCode (success, unknown_error if the padding is invalid)
+static ErrorCode pkcs7_unpad(const uint8_t* Data, size_t Size, size_t* OutSize);
+
+/// @brief Sets CB to ICB plus Blocks, in the GCM counter (last 4 bytes, big endian, wraps at 32 bits).
+static void gcm_counter_add(uint8_t* CB, const uint8_t* ICB, uint64_t Blocks);
+
+/// @brief Runs Job over Size bytes, split across threads when the message is large enough (see aes_set_threads()).
+/// @param Ctx The expanded GCM key.
+/// @param In Size bytes of input.
+/// @param Out Size bytes of output, may be In (unused by gcm_job_hash).
+/// @param Size The size of In in bytes.
+/// @param ICB The Initial Counter Block (J + 1).
+/// @param Hash The running 16-byte GHASH value, updated as if the message was hashed in one piece.
+/// @param Job What to do with the message.
+static void gcm_run(const AESGCMKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Size, const uint8_t* ICB, uint8_t* Hash, GCMJob Job);
+
+/// @brief thread_run() entry point, runs one GCMPart.
+static void gcm_part(void* Arg);
+
+/// @brief Picks how many threads to split Size bytes across.
+/// @returns 1 if multithreading is disabled or Size is too small, otherwise at most aes_get_threads().
+static unsigned thread_parts(size_t Size);
+
+/// @brief Hashes Data through Ctx->Buffer, so the GHASH input is split into blocks across calls.
+static void gcm_stream_absorb(AESGCMStream* Ctx, const uint8_t* Data, size_t Size);
+
+/// @brief Hashes a partial block of AAD (zero padded) before the first data, and checks AAD is not passed in afterwards.
+static void gcm_stream_start_data(AESGCMStream* Ctx);
+
+/// @brief Pads the last partial block, hashes the length block and encrypts the hash into Tag (shared by final and verify).
+static void gcm_stream_tag(AESGCMStream* Ctx, uint8_t* Tag);
+
+/// @brief Compares two 16-byte tags in constant time.
+/// @returns True if Tag and Hash are identical.
+static bool gcm_tag_equal(const uint8_t* Tag, const uint8_t* Hash);
+
+/// @brief Seals or opens GCM messages, the Tag masks of AES_BATCH_BLOCKS messages are encrypted together in one pass.
+/// @param Ctx The expanded GCM key.
+/// @param Jobs Count messages.
+/// @param Encrypt True to seal, false to open.
+/// @returns ErrorCode (success, unknown_error if any Tag is invalid)
+static ErrorCode gcm_batch(const AESGCMKey* Ctx, AESAEADJob* Jobs, size_t Count, bool Encrypt);
+
+/// @brief Seals or opens GCM-SIV messages AES_LANES at a time, their Tag blocks are encrypted together (one key per lane).
+/// @param Ctx The expanded master key.
+/// @param Jobs Count messages.
+/// @param Encrypt True to seal, false to open.
+/// @returns ErrorCode (success, unknown_error if any Tag is invalid, or an error from the per-message key setup)
+static ErrorCode siv_batch(const AESKey* Ctx, AESAEADJob* Jobs, size_t Count, bool Encrypt);
+
+/// @brief Derives one message's keys and expands them, wiping the raw EncKey and AuthKey before returning.
+/// @param MasterCtx The expanded master key.
+/// @param IV The 12-byte IV.
+/// @param EncCtx Set to the expanded EncKey, wipe with aes_key_clear().
+/// @param AuthHash Set to the POLYVAL key from AuthKey, wipe with ghash_key_clear().
+/// @returns ErrorCode (success, or the error of aes_key_init() / polyval_key_init(), with nothing left to wipe)
+static ErrorCode siv_message_keys(const AESKey* MasterCtx, const uint8_t* IV, AESKey* EncCtx, GHashKey* AuthHash);
 
 /// @brief Derives EncKey and AuthKey from MasterKey, using the existing IV.
-/// @param MasterKey The 32-byte key given in the GCM-SIV function call.
+/// @param MasterCtx The expanded 32-byte key given in the GCM-SIV function call.
 /// @param IV The 12-byte IV given in the GCM-SIV function call.
 /// @param EncKey Pre-allocated, 32-byte array to store EncKey in.
-/// @param AuthKey Pre-allocated, 32-byte array to store AuthKey in.
-static ErrorCode siv_derive_keys(const uint8_t* MasterKey, const uint8_t* IV, uint8_t* EncKey, uint8_t* AuthKey);
-
-/// @brief Returns X*Y in GF(2^128) into Result (GCM-SIV).
-/// @param X A uint8_t[16] that represents a 128-bit number.
-/// @param Y A uint8_t[16] that represents a 128-bit number.
-/// @param Result The product, can be X, Y, or any other uint8_t[16].
-static void sblockmul(const uint8_t* X, const uint8_t* Y, uint8_t* Result);
-
-/// @brief Performs the PolyVal hash on Block, of Size bytes. If Size is not a multiple of 16, 0's will be padded to the end.
-/// @param H The Hash Subkey, internal to GCM-SIV.
-/// @param Block A uint8_t[] of any size. Contains the data to hash.
-/// @param Size The size of the Block, in bytes.
-/// @param Output A uint8_t[16] to write the final hash to.
-/// @note Due to how the GHash function works, the final hash block can be put into Output to "concatenate" the byte strings (on full 16-byte blocks).
-static void polyval(const uint8_t* H, const uint8_t* Block, size_t Size, uint8_t* Output);
-
-static ErrorCode sivctr(uint8_t* Plaintext, size_t Size, const uint8_t* Key, const uint8_t* IV);
+/// @param AuthKey Pre-allocated, 16-byte array to store AuthKey in.
+static void siv_derive_keys(const AESKey* MasterCtx, const uint8_t* IV, uint8_t* EncKey, uint8_t* AuthKey);
+
+/// @brief siv_derive_keys() for Count nonces at once: all 6*Count derivation blocks go through AES in one pass.
+/// @param MasterCtx The expanded master key, shared by every nonce.
+/// @param IVs Count 12-byte IVs.
+/// @param Count Number of nonces (1 to AES_LANES).
+/// @param EncKeys Pre-allocated array of Count*32 bytes, EncKey of nonce n at EncKeys + n*32.
+/// @param AuthKeys Pre-allocated array of Count*16 bytes, AuthKey of nonce n at AuthKeys + n*16.
+static void siv_derive_keys_batch(const AESKey* MasterCtx, const uint8_t* const* IVs, int Count, uint8_t* EncKeys, uint8_t* AuthKeys);
+
+/// @brief Turns a POLYVAL result into the GCM-SIV Tag: XOR the IV in, clear the top bit, encrypt with EncKey.
+/// @param EncCtx The expanded per-message EncKey.
+/// @param Hash The 16-byte POLYVAL of AAD, Plaintext and the length block, altered into the Tag.
+/// @param IV The 12-byte IV.
+static void siv_tag(const AESKey* EncCtx, uint8_t* Hash, const uint8_t* IV);
+
+/// @brief Encrypts (and decrypts) Plaintext with the GCM-SIV counter (32-bit little endian counter in the first 4 bytes).
+/// @param Plaintext The plaintext of any size, overwritten by result (Ciphertext).
+/// @param Size The Size of Plaintext (and Ciphertext) in bytes.
+/// @param Ctx The expanded EncKey.
+/// @param IV The Initial Counter Block, derived from the Tag.
+static void sivctr(uint8_t* Plaintext, size_t Size, const AESKey* Ctx, const uint8_t* IV);
+
+/// @brief Sets CB to ICB plus Blocks, in the GCM-SIV counter (first 4 bytes, little endian, wraps at 32 bits).
+static void siv_counter_add(uint8_t* CB, const uint8_t* ICB, uint64_t Blocks);
+
+/// @brief Runs sivctr() and POLYVAL over Size bytes of Ciphertext together, GCM_STITCH_SIZE bytes at a time (POLYVAL hashes the Plaintext).
+/// @param Cipher The expanded EncKey.
+/// @param Auth The POLYVAL key.
+/// @param In Size bytes of Ciphertext.
+/// @param Out Size bytes to store the Plaintext in, may be In.
+/// @param Size The size of In in bytes, does not have to be a multiple of 16.
+/// @param ICB The Initial Counter Block, derived from the Tag.
+/// @param Y The running 16-byte POLYVAL value, updated with the Plaintext.
+static void siv_stitch(const AESKey* Cipher, const GHashKey* Auth, const uint8_t* In, uint8_t* Out, size_t Size, const uint8_t* ICB, uint8_t* Y);
+
+/// @brief Runs Job over Size bytes, split across threads when the message is large enough (see aes_set_threads()).
+/// @param Cipher The expanded EncKey (unused by siv_job_hash).
+/// @param Auth The POLYVAL key (unused by siv_job_ctr).
+/// @param In Size bytes of input.
+/// @param Out Size bytes of output, may be In (unused by siv_job_hash).
+/// @param Size The size of In in bytes.
+/// @param ICB The Initial Counter Block, derived from the Tag (unused by siv_job_hash).
+/// @param Y The running 16-byte POLYVAL value, updated as if the message was hashed in one piece (unused by siv_job_ctr).
+/// @param Job What to do with the message.
+static void siv_run(const AESKey* Cipher, const GHashKey* Auth, const uint8_t* In, uint8_t* Out, size_t Size, const uint8_t* ICB, uint8_t* Y, SIVJob Job);
+
+/// @brief thread_run() entry point, runs one SIVPart.
+static void siv_part(void* Arg);
+
+/// @brief Splits Size bytes into Count ranges: every range but the last is the same whole number of blocks.
+/// @returns The size of every range but the last, in bytes.
+static size_t thread_part_size(size_t Size, unsigned Count);
+
+/// @brief Checks whether Backend can run in this build and on this CPU.
+/// @returns True if Backend is supported.
+static bool backend_supported(AESBackend Backend);
+
+/// @brief Picks the fastest supported backend.
+/// @returns The backend aes_backend_auto resolves to.
+static AESBackend best_backend(void);
 
 /// @brief Applies SBox[] to a Byte, but via calculations instead of an array.
 /// @returns SBox[Byte].
@@ -154,4 +438,7 @@ void init_sbox();
 /// @brief Initializes the internal "InvSBox" of AESDec to allow for proper decryption.
 void init_inv_sbox();
 
+/// @brief Builds SBox, InvSBox, the T-tables and the vector permute tables and resolves AutoBackend, run once through TablesOnce.
+static void init_tables(void);
+
 #endif // AES_PRIVATE_H
\ No newline at end of file
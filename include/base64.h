@@ -8,6 +8,33 @@
 #include "../include/bytearr.h"
 #include "../include/error.h"
 
+/// @brief Number of characters base64_convert_string_into() writes for Size bytes (no '\0').
+#define BASE64_ENCODED_SIZE(Size) (4*(((Size) + 2)/3))
+
+/// @brief Upper bound on the bytes decoded from Len characters (exact without padding).
+#define BASE64_DECODED_MAX(Len) (((Len)/4)*3)
+
+/// @brief A Base64 decode in progress, for the base64_dec_stream_* functions.
+/// @param Buffer Characters waiting for a whole quartet (up to 3).
+/// @param SkipSpace True to ignore whitespace and line breaks anywhere in the input.
+/// @param Finished True once a padded quartet was decoded, nothing but whitespace may follow.
+/// @note Initialize with base64_dec_stream_init().
+typedef struct
+{
+    char Buffer[4];
+    size_t BufSize;
+    bool SkipSpace;
+    bool Finished;
+} Base64DecStream;
+
+/// @brief A Base64 encode in progress, for the base64_enc_stream_* functions.
+/// @param Buffer Bytes waiting for a whole triplet (up to 2).
+/// @note Initialize with base64_enc_stream_init().
+typedef struct
+{
+    uint8_t Buffer[3];
+    size_t BufSize;
+} Base64EncStream;
 
 
 /// @brief Checks whether a string is Base64 encoding.
@@ -28,4 +55,65 @@ ErrorCode base64_convert_byte(const char* B64String, ByteArr *Ret);
 /// @returns ErrorCode (success, malloc_error)
 ErrorCode base64_convert_string(const uint8_t* Array, size_t Size, char** RetStr);
 
+/// @brief base64_convert_byte() on Len characters (no '\0' needed) into a caller buffer, without any allocation.
+/// @param B64String Len characters of Base64, a multiple of 4 (0 decodes to 0 bytes).
+/// @param Len Number of characters in B64String.
+/// @param Out Pre-allocated array of BASE64_DECODED_MAX(Len) bytes.
+/// @param OutSize Set to the number of bytes decoded.
+/// @returns ErrorCode (success, unknown_error if B64String is not valid Base64)
+ErrorCode base64_convert_byte_into(const char* B64String, size_t Len, uint8_t* Out, size_t* OutSize);
+
+/// @brief base64_convert_string() into a caller buffer, without any allocation.
+/// @param Array The byte array to be translated to Base64.
+/// @param Size The size of the byte array to translate.
+/// @param Out Pre-allocated array of BASE64_ENCODED_SIZE(Size) characters, no '\0' is written.
+/// @param OutLen Set to the number of characters written.
+/// @returns ErrorCode (success)
+ErrorCode base64_convert_string_into(const uint8_t* Array, size_t Size, char* Out, size_t* OutLen);
+
+
+//* Base64 streaming
+//* For input that arrives in pieces (socket buffers, files): chunks of any size, only a partial quartet (or triplet) is carried between calls.
+
+/// @brief Starts a Base64 decode.
+/// @param Ctx The Base64DecStream to initialize.
+/// @param SkipSpace True to ignore whitespace and line breaks (MIME and PEM style input).
+/// @returns ErrorCode (success)
+ErrorCode base64_dec_stream_init(Base64DecStream* Ctx, bool SkipSpace);
+
+/// @brief Decodes the next Len characters, writing every whole quartet.
+/// @param Ctx An initialized Base64DecStream.
+/// @param In Len characters of Base64, no '\0' needed.
+/// @param Len Number of characters in In, does not have to be a multiple of 4.
+/// @param Out Pre-allocated array of BASE64_DECODED_MAX(Len + 3) bytes.
+/// @param OutSize Set to the number of bytes written to Out.
+/// @returns ErrorCode (success, unknown_error on an invalid character or data after the padding)
+ErrorCode base64_dec_stream_update(Base64DecStream* Ctx, const char* In, size_t Len, uint8_t* Out, size_t* OutSize);
+
+/// @brief Finishes the decode.
+/// @param Ctx An initialized Base64DecStream.
+/// @returns ErrorCode (success, unknown_error if the input stopped inside a quartet)
+ErrorCode base64_dec_stream_final(Base64DecStream* Ctx);
+
+/// @brief Starts a Base64 encode.
+/// @param Ctx The Base64EncStream to initialize.
+/// @returns ErrorCode (success)
+ErrorCode base64_enc_stream_init(Base64EncStream* Ctx);
+
+/// @brief Encodes the next Size bytes, writing every whole triplet.
+/// @param Ctx An initialized Base64EncStream.
+/// @param Array Size bytes to encode.
+/// @param Size Size of Array in bytes, does not have to be a multiple of 3.
+/// @param Out Pre-allocated array of BASE64_ENCODED_SIZE(Size + 2) characters.
+/// @param OutLen Set to the number of characters written to Out.
+/// @returns ErrorCode (success)
+ErrorCode base64_enc_stream_update(Base64EncStream* Ctx, const uint8_t* Array, size_t Size, char* Out, size_t* OutLen);
+
+/// @brief Finishes the encode, writing the last (padded) quartet if any bytes are left.
+/// @param Ctx An initialized Base64EncStream.
+/// @param Out Pre-allocated array of 4 characters.
+/// @param OutLen Set to the number of characters written to Out (0 or 4).
+/// @returns ErrorCode (success)
+ErrorCode base64_enc_stream_final(Base64EncStream* Ctx, char* Out, size_t* OutLen);
+
 #endif // BASE64_H
\ No newline at end of file
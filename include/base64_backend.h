@@ -0,0 +1,35 @@
+#ifndef BASE64_BACKEND_H
+#define BASE64_BACKEND_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../include/cpu.h"
+
+//* Internal interface between base64.c and the SIMD kernels. Not part of the public API.
+//* Kernels only handle whole steps (12 <-> 16 bytes for SSSE3, 24 <-> 32 for AVX2) and return how much input they used, base64.c does the rest.
+
+#ifdef CPU_X86_SIMD
+
+/// @brief Encodes 12 bytes into 16 characters per step with SSSE3.
+/// @param In Size bytes to encode, every step reads 16 bytes.
+/// @param Size Size of In in bytes.
+/// @param Out 4 characters per 3 bytes consumed.
+/// @returns Number of bytes consumed (a multiple of 12), at most Size - 4.
+size_t base64_ssse3_enc(const uint8_t* In, size_t Size, char* Out);
+
+/// @brief Decodes and validates 16 characters into 12 bytes per step with SSSE3.
+/// @param In Len characters, without padding.
+/// @param Len Number of characters in In.
+/// @param Out 3 bytes per 4 characters consumed.
+/// @returns Number of characters consumed (a multiple of 16), stops before the first step holding a character outside the Base64 alphabet.
+size_t base64_ssse3_dec(const char* In, size_t Len, uint8_t* Out);
+
+/// @brief base64_ssse3_enc() with AVX2, 24 bytes into 32 characters per step (reads 28 bytes per step, at most Size - 4 consumed).
+size_t base64_avx2_enc(const uint8_t* In, size_t Size, char* Out);
+
+/// @brief base64_ssse3_dec() with AVX2, 32 characters into 24 bytes per step.
+size_t base64_avx2_dec(const char* In, size_t Len, uint8_t* Out);
+
+#endif // CPU_X86_SIMD
+
+#endif // BASE64_BACKEND_H
@@ -0,0 +1,31 @@
+#ifndef CPU_H
+#define CPU_H
+
+#include <stdbool.h>
+
+//* x86 SIMD code is compiled per function (target attributes) and only called after a runtime check.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define CPU_X86_SIMD 1
+#endif
+
+/// @brief Checks whether the running CPU supports the AES-NI instructions (AESENC, AESDEC, AESKEYGENASSIST).
+/// @returns A boolean True/False, always False on non-x86 builds.
+bool cpu_has_aesni(void);
+
+/// @brief Checks whether the running CPU supports the SSSE3 instructions (PSHUFB).
+/// @returns A boolean True/False, always False on non-x86 builds.
+bool cpu_has_ssse3(void);
+
+/// @brief Checks whether the running CPU supports the PCLMULQDQ instruction (carry-less multiply).
+/// @returns A boolean True/False, always False on non-x86 builds.
+bool cpu_has_pclmul(void);
+
+/// @brief Checks whether the running CPU supports the SSE2 instructions.
+/// @returns A boolean True/False, always False on non-x86 builds.
+bool cpu_has_sse2(void);
+
+/// @brief Checks whether the running CPU (and OS, for the 256-bit registers) supports the AVX2 instructions.
+/// @returns A boolean True/False, always False on non-x86 builds.
+bool cpu_has_avx2(void);
+
+#endif // CPU_H
@@ -5,11 +5,61 @@
 #include <stdlib.h>
 #include "../include/error.h"
 
+/// @brief An MD5 hash in progress, for the hash_md5_* functions.
+/// @param State The four chaining words (A, B, C, D).
+/// @param Buffer Input bytes waiting for a whole 64-byte block.
+/// @param BufSize Number of bytes in Buffer.
+/// @param Length Total number of bytes hashed so far.
+/// @note Initialize with hash_md5_init(), wiped by hash_md5_final().
+typedef struct
+{
+    uint32_t State[4];
+    uint8_t Buffer[64];
+    size_t BufSize;
+    uint64_t Length;
+} MD5Ctx;
+
+/// @brief One message for hash_md5_batch().
+/// @param Data An array of bytes to be hashed.
+/// @param Size The size of the Data array, in bytes.
+/// @param RetArr Pre-allocated array of 16 bytes to hold hash.
+typedef struct
+{
+    const void* Data;
+    size_t Size;
+    uint8_t* RetArr;
+} MD5Job;
+
 /// @brief Hashes Data of variable size with the MD5 standard.
 /// @param Data An array of bytes to be hashed.
 /// @param Size The size of the Data array, in bytes.
 /// @param RetArr Pre-allocated array of 16 bytes to hold hash.
-/// @returns Error codes (Finish when rewrite).
-ErrorCode hash_md5(void* Data, size_t Size, uint8_t* RetArr);
+/// @returns ErrorCode (success)
+ErrorCode hash_md5(const void* Data, size_t Size, uint8_t* RetArr);
+
+/// @brief Starts an MD5 hash.
+/// @param Ctx The MD5Ctx to initialize.
+/// @returns ErrorCode (success)
+ErrorCode hash_md5_init(MD5Ctx* Ctx);
+
+/// @brief Hashes the next Size bytes of the message. Whole blocks are read straight from Data, only a partial block is kept.
+/// @param Ctx An initialized MD5Ctx.
+/// @param Data Size bytes of the message.
+/// @param Size Size of Data in bytes, does not have to be a multiple of 64.
+/// @returns ErrorCode (success)
+ErrorCode hash_md5_update(MD5Ctx* Ctx, const void* Data, size_t Size);
+
+/// @brief Pads the message, writes the hash and wipes Ctx.
+/// @param Ctx An initialized MD5Ctx.
+/// @param RetArr Pre-allocated array of 16 bytes to hold hash.
+/// @returns ErrorCode (success)
+ErrorCode hash_md5_final(MD5Ctx* Ctx, uint8_t* RetArr);
+
+/// @brief Hashes Count independent messages, up to 8 at once in SIMD lanes (AVX2, or two SSE2 groups of 4). A finished message's lane is refilled with the next one.
+/// @param Jobs Count messages, each RetArr is set to its hash.
+/// @param Count Number of messages.
+/// @returns ErrorCode (success)
+/// @note MD5 is serial within a message, so this is the fast path for many small messages.
+ErrorCode hash_md5_batch(MD5Job* Jobs, size_t Count);
 
-#endif // MD5_H
\ No newline at end of file
+#endif // MD5_H
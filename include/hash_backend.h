@@ -0,0 +1,32 @@
+#ifndef HASH_BACKEND_H
+#define HASH_BACKEND_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../include/cpu.h"
+
+//* Internal interface between hash.c and the multi-buffer MD5 kernels. Not part of the public API.
+//* Every kernel hashes Blocks consecutive 64-byte blocks of each lane, one lane per 32-bit vector element.
+
+
+/// @brief Independent messages hashed at once by hash_md5_batch() (the AVX2 vector width).
+#define MD5_LANES 8
+
+/// @brief The 64 MD5 round constants (floor(abs(sin(i + 1)) * 2^32)).
+extern const uint32_t MD5T[64];
+
+#ifdef CPU_X86_SIMD
+
+/// @brief Hashes Blocks blocks of up to 4 independent messages at once with SSE2.
+/// @param State The four chaining words of each lane, updated in place.
+/// @param In Blocks*64 bytes per lane.
+/// @param Lanes Number of lanes in use (1 to 4).
+/// @param Blocks Number of 64-byte blocks per lane.
+void md5_sse2_lanes(uint32_t (*State)[4], const uint8_t* const* In, int Lanes, size_t Blocks);
+
+/// @brief md5_sse2_lanes() with AVX2, up to MD5_LANES messages at once.
+void md5_avx2_lanes(uint32_t (*State)[4], const uint8_t* const* In, int Lanes, size_t Blocks);
+
+#endif // CPU_X86_SIMD
+
+#endif // HASH_BACKEND_H
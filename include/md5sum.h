@@ -0,0 +1,11 @@
+#ifndef MD5SUM_H
+#define MD5SUM_H
+
+/// @brief Runs the md5sum compatible mode of the FullCrypto executable.
+/// @param Argc Number of arguments in Argv, starting with the mode name ("md5sum").
+/// @param Argv The options, then files or directories to hash (directories are walked recursively, "-" or nothing for stdin).
+/// @returns The process exit status: 0 if every file was read (and matched, with -c), 1 otherwise.
+/// @note Files are hashed in groups of 8 by a pool of worker threads, see Manual/MD5.md.
+int md5sum_run(int Argc, char** Argv);
+
+#endif // MD5SUM_H
@@ -0,0 +1,22 @@
+#ifndef THREAD_H
+#define THREAD_H
+
+#include <stddef.h>
+
+//* Internal fork/join helper for the parallel modes. Not part of the public API.
+
+/// @brief Upper limit on the threads a single call can split its work across.
+#define THREAD_MAX 64
+
+/// @brief Runs Func on Count jobs at once and waits for all of them: Count - 1 new threads, the last job on the caller.
+/// @param Func The job function, called with a pointer to its job.
+/// @param Jobs An array of Count jobs, ArgSize bytes each.
+/// @param ArgSize The size of one job in bytes.
+/// @param Count The number of jobs, at most THREAD_MAX.
+/// @note If a thread cannot be created, its job runs on the caller instead, so every job always runs.
+void thread_run(void (*Func)(void*), void* Jobs, size_t ArgSize, unsigned Count);
+
+/// @brief Returns the number of online CPU cores (at least 1, at most THREAD_MAX).
+unsigned thread_cores(void);
+
+#endif // THREAD_H
@@ -0,0 +1,13 @@
+#ifndef WIPE_H
+#define WIPE_H
+
+#include <stddef.h>
+
+//* Internal helper for clearing key material. Not part of the public API.
+
+/// @brief Overwrites Size bytes of Data with 0's, in a way the compiler cannot remove as a dead store.
+/// @param Data The memory to clear (keys, round keys, key streams, hash state), any alignment.
+/// @param Size The number of bytes to clear.
+void wipe_bytes(void* Data, size_t Size);
+
+#endif // WIPE_H
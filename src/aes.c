@@ -1,133 +1,173 @@
+#include <string.h>
+#include <pthread.h>
 #include "../include/aes.h"
 #include "../include/aes_private.h"
+#include "../include/aes_backend.h"
+#include "../include/thread.h"
+#include "../include/wipe.h"
+#include "../include/base64.h"
+
+//* Backend chosen by aes_key_init(), auto stands for AutoBackend.
+static AESBackend DefaultBackend = aes_backend_auto;
+
+//* Built once by init_tables(), keys may be initialized from several threads at once.
+static pthread_once_t TablesOnce = PTHREAD_ONCE_INIT;
+static AESBackend AutoBackend;
+
+//* Multithreading is off until aes_set_threads() is called.
+static unsigned Threads = 1;
+static size_t ThreadThreshold = AES_THREAD_THRESHOLD;
 
 //* Public functions
-//? AES standard implementation
+//? AES backend selection
 
-ErrorCode aes_std_enc(uint8_t* Plaintext, const uint8_t* Key)
+ErrorCode aes_set_backend(AESBackend Backend)
 {
-    //? If SBox has never been run before, initialize.
-    if (SBox[0] != 0x63)
-        init_sbox();
-
-    //? Fill state sideways
-    uint8_t State[16] = 
-    {
-        Plaintext[0], Plaintext[4], Plaintext[8], Plaintext[12],
-        Plaintext[1], Plaintext[5], Plaintext[9], Plaintext[13],  
-        Plaintext[2], Plaintext[6], Plaintext[10], Plaintext[14],  
-        Plaintext[3], Plaintext[7], Plaintext[11], Plaintext[15]
-    };
+    if (Backend == aes_backend_auto)
+        Backend = best_backend();
+    if (!backend_supported(Backend))
+        return unknown_error;
 
-    //? Key expansion
-    uint8_t* EKey = expand_key_256(Key);
-    if (EKey == NULL)
-        return malloc_error;
+    DefaultBackend = Backend;
+    return success;
+}
 
-    //? Xor first Key
-    add_round_key(State, (EKey + 0*4));
+AESBackend aes_get_backend(void)
+{
+    if (DefaultBackend != aes_backend_auto)
+        return DefaultBackend;
+    pthread_once(&TablesOnce, init_tables);
+    return AutoBackend;
+}
 
-    //? Rounds
-    for (int i = 1; i < 14; i++)
-    {
-        sub_bytes(State);
-        shift_rows(State);
-        mix_columns(State);
-        add_round_key(State, (EKey+(i*16)));
-    }
 
-    //? Final round without Mix Columns
-    sub_bytes(State);
-    shift_rows(State);
-    add_round_key(State, (EKey+(14*16)));
 
-    //? Clear and de-allocate Expanded Key
-    for (int i = 0; i < 240; i++)
-        EKey[i] = 0;
-    free(EKey);
+//? Multithreading
 
-    //? Fill Data sideways
-    Plaintext[0] = State[0];
-    Plaintext[1] = State[4];
-    Plaintext[2] = State[8];
-    Plaintext[3] = State[12];
-    Plaintext[4] = State[1];
-    Plaintext[5] = State[5];
-    Plaintext[6] = State[9];
-    Plaintext[7] = State[13];
-    Plaintext[8] = State[2];
-    Plaintext[9] = State[6];
-    Plaintext[10] = State[10];
-    Plaintext[11] = State[14];
-    Plaintext[12] = State[3];
-    Plaintext[13] = State[7];
-    Plaintext[14] = State[11];
-    Plaintext[15] = State[15];
+ErrorCode aes_set_threads(unsigned Count, size_t Threshold)
+{
+    if (Count == 0)
+        Count = thread_cores();
+    if (Count > THREAD_MAX)
+        Count = THREAD_MAX;
 
+    Threads = Count;
+    ThreadThreshold = Threshold;
     return success;
 }
 
-ErrorCode aes_std_dec(uint8_t* Ciphertext, const uint8_t* Key)
+unsigned aes_get_threads(void)
 {
-    //? If InvSBox has never been run before, initialize.
-    if (InvSBox[0] != 0x63)
-        init_inv_sbox();
-    
+    return Threads;
+}
 
-    //? Fill state sideways
-    uint8_t State[] = 
-    {
-        Ciphertext[0], Ciphertext[4], Ciphertext[8], Ciphertext[12],
-        Ciphertext[1], Ciphertext[5], Ciphertext[9], Ciphertext[13],
-        Ciphertext[2], Ciphertext[6], Ciphertext[10], Ciphertext[14],
-        Ciphertext[3], Ciphertext[7], Ciphertext[11], Ciphertext[15]
-    };
 
-    //? Key expansion
-    uint8_t* EKey = expand_key_256(Key);
-    if (EKey == NULL)
-        return malloc_error;
+//? AES key context
 
-    //? Xor last key
-    add_round_key(State, (EKey + 14*16));
+ErrorCode aes_key_init(AESKey* Ctx, const uint8_t* Key)
+{
+    pthread_once(&TablesOnce, init_tables);
+    Ctx->Backend = aes_get_backend();
 
-    //? Rounds in reverse
-    for (int i = 14; i > 1; i--)
+#ifdef CPU_X86_SIMD
+    //? AES-NI expands both key schedules in hardware.
+    if (Ctx->Backend == aes_backend_aesni)
     {
-        inv_shift_rows(State);
-        inv_sub_bytes(State);
-        add_round_key(State, EKey+((i - 1)*16));
-        inv_mix_columns(State);
+        aes_ni_key_init(Ctx, Key);
+        return success;
     }
 
-    //? Last round without mix columns
-    inv_shift_rows(State);
-    inv_sub_bytes(State);
-    add_round_key(State, EKey + 0);
-    
-    //? Clear and de-allocate Expanded Key
-    for (int i = 0; i < 240; i++)
-        EKey[i] = 0;
-    free(EKey);
+    //? Vector permute expands both key schedules with PSHUFB lookups.
+    if (Ctx->Backend == aes_backend_vperm)
+    {
+        aes_vperm_key_init(Ctx, Key);
+        return success;
+    }
+#endif
 
-    //? Fill Data sideways
-    Ciphertext[0] = State[0];
-    Ciphertext[1] = State[4];
-    Ciphertext[2] = State[8];
-    Ciphertext[3] = State[12];
-    Ciphertext[4] = State[1];
-    Ciphertext[5] = State[5];
-    Ciphertext[6] = State[9];
-    Ciphertext[7] = State[13];
-    Ciphertext[8] = State[2];
-    Ciphertext[9] = State[6];
-    Ciphertext[10] = State[10];
-    Ciphertext[11] = State[14];
-    Ciphertext[12] = State[3];
-    Ciphertext[13] = State[7];
-    Ciphertext[14] = State[11];
-    Ciphertext[15] = State[15];
+    //? The bitsliced backend expands without table lookups, and needs no DecKey.
+    if (Ctx->Backend == aes_backend_bitslice)
+    {
+        aes_bitslice_key_init(Ctx, Key);
+        return success;
+    }
+
+    //? Expand the encryption keys once, then derive the decryption keys from them.
+    expand_key_256(Key, Ctx->EncKey);
+    invert_key_256(Ctx->EncKey, Ctx->DecKey);
+    return success;
+}
+
+void aes_key_clear(AESKey* Ctx)
+{
+    //* AESKey holds uint64_t's, so it is 8-byte aligned and sized: 8 bytes per store (GCM-SIV clears a key per message).
+    wipe_bytes(Ctx, sizeof(AESKey));
+    return;
+}
+
+ErrorCode aes_gcm_key_init(AESGCMKey* Ctx, const uint8_t* Key)
+{
+    ErrorCode TempError = aes_key_init(&Ctx->Cipher, Key);
+    if (TempError != success)
+        return TempError;
+
+    //* Hash subkey H is the encrypted zero block.
+    uint8_t H[16] = {0};
+    encrypt_block(H, &Ctx->Cipher);
+    TempError = ghash_key_init(&Ctx->Hash, H);
+    for (int i = 0; i < 16; i++)
+        H[i] = 0;
+
+    if (TempError != success)
+        aes_key_clear(&Ctx->Cipher);
+    return TempError;
+}
+
+void aes_gcm_key_clear(AESGCMKey* Ctx)
+{
+    aes_key_clear(&Ctx->Cipher);
+    ghash_key_clear(&Ctx->Hash);
+    return;
+}
+
+
+//? AES standard implementation
+
+ErrorCode aes_std_enc(uint8_t* Plaintext, const uint8_t* Key)
+{
+    //? Key expansion (on the stack, wiped afterwards)
+    AESKey Ctx;
+    ErrorCode TempError = aes_key_init(&Ctx, Key);
+    if (TempError != success)
+        return TempError;
+
+    TempError = aes_std_enc_ctx(Plaintext, &Ctx);
+    aes_key_clear(&Ctx);
+    return TempError;
+}
+
+ErrorCode aes_std_dec(uint8_t* Ciphertext, const uint8_t* Key)
+{
+    //? Key expansion (on the stack, wiped afterwards)
+    AESKey Ctx;
+    ErrorCode TempError = aes_key_init(&Ctx, Key);
+    if (TempError != success)
+        return TempError;
+
+    TempError = aes_std_dec_ctx(Ciphertext, &Ctx);
+    aes_key_clear(&Ctx);
+    return TempError;
+}
 
+ErrorCode aes_std_enc_ctx(uint8_t* Plaintext, const AESKey* Ctx)
+{
+    encrypt_block(Plaintext, Ctx);
+    return success;
+}
+
+ErrorCode aes_std_dec_ctx(uint8_t* Ciphertext, const AESKey* Ctx)
+{
+    decrypt_block(Ciphertext, Ctx);
     return success;
 }
 
@@ -135,409 +175,963 @@ ErrorCode aes_std_dec(uint8_t* Ciphertext, const uint8_t* Key)
 //? AES-ECB implementation
 
 ErrorCode aes_ecb_enc(const uint8_t* Plaintext, size_t Size, const uint8_t* Key, ByteArr* Ret)
+{
+    AESKey Ctx;
+    ErrorCode TempError = aes_key_init(&Ctx, Key);
+    if (TempError != success)
+        return TempError;
+
+    TempError = aes_ecb_enc_ctx(Plaintext, Size, &Ctx, Ret);
+    aes_key_clear(&Ctx);
+    return TempError;
+}
+
+ErrorCode aes_ecb_dec(const uint8_t* Ciphertext, size_t Size, const uint8_t* Key, ByteArr* Ret)
+{
+    AESKey Ctx;
+    ErrorCode TempError = aes_key_init(&Ctx, Key);
+    if (TempError != success)
+        return TempError;
+
+    TempError = aes_ecb_dec_ctx(Ciphertext, Size, &Ctx, Ret);
+    aes_key_clear(&Ctx);
+    return TempError;
+}
+
+ErrorCode aes_ecb_enc_into(const uint8_t* Plaintext, size_t Size, const uint8_t* Key, uint8_t* Out, size_t* OutSize)
+{
+    AESKey Ctx;
+    ErrorCode TempError = aes_key_init(&Ctx, Key);
+    if (TempError != success)
+        return TempError;
+
+    TempError = aes_ecb_enc_into_ctx(Plaintext, Size, &Ctx, Out, OutSize);
+    aes_key_clear(&Ctx);
+    return TempError;
+}
+
+ErrorCode aes_ecb_dec_into(const uint8_t* Ciphertext, size_t Size, const uint8_t* Key, uint8_t* Out, size_t* OutSize)
+{
+    AESKey Ctx;
+    ErrorCode TempError = aes_key_init(&Ctx, Key);
+    if (TempError != success)
+        return TempError;
+
+    TempError = aes_ecb_dec_into_ctx(Ciphertext, Size, &Ctx, Out, OutSize);
+    aes_key_clear(&Ctx);
+    return TempError;
+}
+
+ErrorCode aes_ecb_enc_ctx(const uint8_t* Plaintext, size_t Size, const AESKey* Ctx, ByteArr* Ret)
 {
     if (Size == 0)
         return unknown_error;
 
     //? Declare variables & ByteArr struct
-    uint8_t PadByte = 16 - (Size%16);
-    Ret->Size = Size + PadByte;
+    Ret->Size = AES_PADDED_SIZE(Size);
     Ret->Arr = malloc(Ret->Size);
     if (Ret->Arr == NULL)
         return malloc_error;
 
-    //? Copy over Plaintext to NewArr, then Pad to a multiple of 16
-    for (size_t i = 0; i < Size; i++)
-        Ret->Arr[i] = Plaintext[i];
-    for (size_t i = Size; i < Ret->Size; i++)
-        Ret->Arr[i] = PadByte;
+    return aes_ecb_enc_into_ctx(Plaintext, Size, Ctx, Ret->Arr, &Ret->Size);
+}
+
+ErrorCode aes_ecb_dec_ctx(const uint8_t* Ciphertext, size_t Size, const AESKey* Ctx, ByteArr* Ret)
+{
+    if (Size == 0 || Size%16 != 0)
+        return unknown_error;
+
+    //? Decrypt straight into Ret, the padding is only cut off Ret->Size.
+    Ret->Arr = malloc(Size);
+    if (Ret->Arr == NULL)
+        return malloc_error;
 
-    //? Encrypt each 16 byte block.
-    for (size_t i = 0; i < Ret->Size; i+=16)
+    ErrorCode TempError = aes_ecb_dec_into_ctx(Ciphertext, Size, Ctx, Ret->Arr, &Ret->Size);
+    if (TempError != success)
     {
-        ErrorCode TempError = aes_std_enc(Ret->Arr + i, Key);
-        if (TempError != success)
-        {
-            free(Ret->Arr);
-            return TempError;
-        }
+        free(Ret->Arr);
+        Ret->Arr = NULL;
     }
+    return TempError;
+}
+
+ErrorCode aes_ecb_enc_into_ctx(const uint8_t* Plaintext, size_t Size, const AESKey* Ctx, uint8_t* Out, size_t* OutSize)
+{
+    if (Size == 0)
+        return unknown_error;
+
+    //? Pad to a multiple of 16 (before anything is written, in case Out is Plaintext).
+    uint8_t Last[16];
+    uint8_t PadByte = 16 - (Size%16);
+    size_t Tail = Size - (Size%16);
+    for (size_t i = 0; i < Size%16; i++)
+        Last[i] = Plaintext[Tail + i];
+    for (size_t i = Size%16; i < 16; i++)
+        Last[i] = PadByte;
+
+    //? Encrypt every whole block, then the padded one.
+    block_run(Ctx, Plaintext, Out, Tail/16, NULL, block_job_ecb_enc);
+    encrypt_blocks(Ctx, Last, Out + Tail, 1);
 
+    *OutSize = Tail + 16;
     return success;
 }
 
-ErrorCode aes_ecb_dec(const uint8_t* Ciphertext, size_t Size, const uint8_t* Key, ByteArr* Ret)
+ErrorCode aes_ecb_dec_into_ctx(const uint8_t* Ciphertext, size_t Size, const AESKey* Ctx, uint8_t* Out, size_t* OutSize)
 {
     if (Size == 0 || Size%16 != 0)
         return unknown_error;
 
-    //? Copy over Ciphertext
-    uint8_t* Temp = malloc(Size);
-    if (Temp == NULL)
+    //? Decrypt every 16 byte block.
+    block_run(Ctx, Ciphertext, Out, Size/16, NULL, block_job_ecb_dec);
+    return pkcs7_unpad(Out, Size, OutSize);
+}
+
+
+//? AES-CBC implementation
+
+ErrorCode aes_cbc_enc(const uint8_t* Plaintext, size_t Size, const uint8_t* Key, const uint8_t* IV, ByteArr* Ret)
+{
+    AESKey Ctx;
+    ErrorCode TempError = aes_key_init(&Ctx, Key);
+    if (TempError != success)
+        return TempError;
+
+    TempError = aes_cbc_enc_ctx(Plaintext, Size, &Ctx, IV, Ret);
+    aes_key_clear(&Ctx);
+    return TempError;
+}
+
+ErrorCode aes_cbc_dec(const uint8_t* Ciphertext, size_t Size, const uint8_t* Key, const uint8_t* IV, ByteArr* Ret)
+{
+    AESKey Ctx;
+    ErrorCode TempError = aes_key_init(&Ctx, Key);
+    if (TempError != success)
+        return TempError;
+
+    TempError = aes_cbc_dec_ctx(Ciphertext, Size, &Ctx, IV, Ret);
+    aes_key_clear(&Ctx);
+    return TempError;
+}
+
+ErrorCode aes_cbc_enc_into(const uint8_t* Plaintext, size_t Size, const uint8_t* Key, const uint8_t* IV, uint8_t* Out, size_t* OutSize)
+{
+    AESKey Ctx;
+    ErrorCode TempError = aes_key_init(&Ctx, Key);
+    if (TempError != success)
+        return TempError;
+
+    TempError = aes_cbc_enc_into_ctx(Plaintext, Size, &Ctx, IV, Out, OutSize);
+    aes_key_clear(&Ctx);
+    return TempError;
+}
+
+ErrorCode aes_cbc_dec_into(const uint8_t* Ciphertext, size_t Size, const uint8_t* Key, const uint8_t* IV, uint8_t* Out, size_t* OutSize)
+{
+    AESKey Ctx;
+    ErrorCode TempError = aes_key_init(&Ctx, Key);
+    if (TempError != success)
+        return TempError;
+
+    TempError = aes_cbc_dec_into_ctx(Ciphertext, Size, &Ctx, IV, Out, OutSize);
+    aes_key_clear(&Ctx);
+    return TempError;
+}
+
+ErrorCode aes_cbc_enc_ctx(const uint8_t* Plaintext, size_t Size, const AESKey* Ctx, const uint8_t* IV, ByteArr* Ret)
+{
+    if (Size == 0)
+        return unknown_error;
+
+    Ret->Size = AES_PADDED_SIZE(Size);
+    Ret->Arr = malloc(Ret->Size);
+    if (Ret->Arr == NULL)
         return malloc_error;
-    for (size_t i = 0; i < Size; i++)
-        Temp[i] = Ciphertext[i];
 
-    //? Decrypt Temp, 16 bytes at a time
-    for (size_t i = 0; i < Size; i+=16)
+    return aes_cbc_enc_into_ctx(Plaintext, Size, Ctx, IV, Ret->Arr, &Ret->Size);
+}
+
+ErrorCode aes_cbc_enc_into_ctx(const uint8_t* Plaintext, size_t Size, const AESKey* Ctx, const uint8_t* IV, uint8_t* Out, size_t* OutSize)
+{
+    if (Size == 0)
+        return unknown_error;
+
+    //? Pad to a multiple of 16 (before anything is written, in case Out is Plaintext).
+    uint8_t Last[16];
+    uint8_t PadByte = 16 - (Size%16);
+    size_t Tail = Size - (Size%16);
+    for (size_t i = 0; i < Size%16; i++)
+        Last[i] = Plaintext[Tail + i];
+    for (size_t i = Size%16; i < 16; i++)
+        Last[i] = PadByte;
+
+    //? Chain every whole block, then the padded one.
+    uint8_t Chain[16];
+    memcpy(Chain, IV, 16);
+    cbc_enc_blocks(Ctx, Plaintext, Out, Tail/16, Chain);
+    cbc_enc_blocks(Ctx, Last, Out + Tail, 1, Chain);
+
+    *OutSize = Tail + 16;
+    return success;
+}
+
+ErrorCode aes_cbc_enc_batch(AESCBCJob* Jobs, size_t Count)
+{
+    for (size_t i = 0; i < Count; i++)
+        if (Jobs[i].Size == 0)
+            return unknown_error;
+
+    CBCLane Lanes[AES_LANES];
+    uint8_t Chain[AES_LANES][16];
+    int Active = 0;
+    size_t Next = 0;
+
+    while (true)
     {
-        ErrorCode TempError = aes_std_dec(Temp + i, Key);
-        if (TempError != success)
+        //* Refill every free lane with the next message.
+        while (Active < AES_LANES && Next < Count)
+        {
+            cbc_lane_start(&Lanes[Active], Chain[Active], &Jobs[Next]);
+            Active++;
+            Next++;
+        }
+        if (Active == 0)
+            break;
+
+        //* Run every lane until the shortest one reaches the end of its whole blocks (or its padded block).
+        const AESKey* Keys[AES_LANES];
+        const uint8_t* In[AES_LANES];
+        uint8_t* Out[AES_LANES];
+        size_t Steps = Lanes[0].Blocks;
+        for (int l = 0; l < Active; l++)
+        {
+            Keys[l] = Lanes[l].Ctx;
+            In[l] = Lanes[l].Padded ? Lanes[l].Last : Lanes[l].In;
+            Out[l] = Lanes[l].Out;
+            if (Lanes[l].Blocks < Steps)
+                Steps = Lanes[l].Blocks;
+        }
+        cbc_enc_lanes(Keys, Chain, In, Out, Active, Steps);
+
+        for (int l = 0; l < Active; l++)
         {
-            free(Temp);
-            return TempError;
+            CBCLane* Lane = &Lanes[l];
+            Lane->In += Steps*16;
+            Lane->Out += Steps*16;
+            Lane->Blocks -= Steps;
+            if (Lane->Blocks != 0)
+                continue;
+
+            if (!Lane->Padded)
+            {
+                Lane->Padded = true;
+                Lane->Blocks = 1;
+                continue;
+            }
+
+            //* Finished, move the last active lane into this one.
+            Active--;
+            if (l != Active)
+            {
+                Lanes[l] = Lanes[Active];
+                memcpy(Chain[l], Chain[Active], 16);
+                l--;
+            }
         }
     }
+    return success;
+}
 
-    //? Declare ByteArr Struct
-    Ret->Size = Size - Temp[Size-1];
-    Ret->Arr = malloc(Ret->Size);
+ErrorCode aes_cbc_dec_ctx(const uint8_t* Ciphertext, size_t Size, const AESKey* Ctx, const uint8_t* IV, ByteArr* Ret)
+{
+    if (Size == 0 || Size%16 != 0)
+        return unknown_error;
+
+    //? Decrypt straight into Ret, the padding is only cut off Ret->Size.
+    Ret->Arr = malloc(Size);
     if (Ret->Arr == NULL)
-    {
-        free(Temp);
         return malloc_error;
+
+    ErrorCode TempError = aes_cbc_dec_into_ctx(Ciphertext, Size, Ctx, IV, Ret->Arr, &Ret->Size);
+    if (TempError != success)
+    {
+        free(Ret->Arr);
+        Ret->Arr = NULL;
     }
+    return TempError;
+}
+
+ErrorCode aes_cbc_dec_into_ctx(const uint8_t* Ciphertext, size_t Size, const AESKey* Ctx, const uint8_t* IV, uint8_t* Out, size_t* OutSize)
+{
+    if (Size == 0 || Size%16 != 0)
+        return unknown_error;
 
-    //? Copy over Temp to ByteArr
-    for (size_t i = 0; i < Size-Temp[Size-1]; i++)
-        Ret->Arr[i] = Temp[i];
+    //? P_i = D(C_i) ^ C_(i-1) has no serial dependency, so every block decrypts independently.
+    block_run(Ctx, Ciphertext, Out, Size/16, IV, block_job_cbc_dec);
+    return pkcs7_unpad(Out, Size, OutSize);
+}
 
-    //? Free allocated Temp
-    free (Temp);
 
+//? AES-CBC streaming
+
+ErrorCode aes_cbc_stream_init(AESCBCStream* Ctx, const AESKey* Key, const uint8_t* IV, bool Encrypt)
+{
+    Ctx->Key = Key;
+    memcpy(Ctx->Chain, IV, 16);
+    Ctx->BufSize = 0;
+    Ctx->Encrypt = Encrypt;
     return success;
 }
 
+ErrorCode aes_cbc_stream_update(AESCBCStream* Ctx, const uint8_t* In, size_t Size, uint8_t* Out, size_t* OutSize)
+{
+    *OutSize = 0;
 
-//? AES-CBC implementation
+    //* Decryption holds back the last block until aes_cbc_stream_final() (it carries the padding), encryption does not need to.
+    size_t Hold = 0;
+    if (!Ctx->Encrypt)
+        Hold = ((Ctx->BufSize + Size) % 16 == 0) ? 16 : 0;
 
-ErrorCode aes_cbc_enc(const uint8_t* Plaintext, size_t Size, const uint8_t* Key, const uint8_t* IV, ByteArr* Ret)
-{
-    if (Size == 0)
-        return unknown_error;
+    //* Fill the partial block from the last call first, if this call completes it (and it is not the held block).
+    size_t i = 0;
+    if (Ctx->BufSize != 0)
+    {
+        for (; i < Size && Ctx->BufSize < 16; i++)
+            Ctx->Buffer[Ctx->BufSize++] = In[i];
+        if (Ctx->BufSize < 16 || Size - i < Hold)
+            return success;
 
-    uint8_t PadByte = 16 - (Size%16);
-    Ret->Size = PadByte + Size;
-    Ret->Arr = malloc(Ret->Size);
-    if (Ret->Arr == NULL)
-        return malloc_error;
+        if (Ctx->Encrypt)
+            cbc_enc_blocks(Ctx->Key, Ctx->Buffer, Out, 1, Ctx->Chain);
+        else
+        {
+            cbc_dec_blocks(Ctx->Key, Ctx->Buffer, Out, 1, Ctx->Chain);
+            memcpy(Ctx->Chain, Ctx->Buffer, 16);
+        }
+        Ctx->BufSize = 0;
+        *OutSize = 16;
+    }
+
+    //* Every whole block but the held one, then keep the rest for the next call.
+    size_t Whole = ((Size - i) & ~(size_t) 15);
+    Whole = (Whole >= Hold) ? Whole - Hold : 0;
+    if (Whole != 0)
+    {
+        if (Ctx->Encrypt)
+            cbc_enc_blocks(Ctx->Key, In + i, Out + *OutSize, Whole/16, Ctx->Chain);
+        else
+        {
+            block_run(Ctx->Key, In + i, Out + *OutSize, Whole/16, Ctx->Chain, block_job_cbc_dec);
+            memcpy(Ctx->Chain, In + i + Whole - 16, 16);
+        }
+        *OutSize += Whole;
+        i += Whole;
+    }
+    for (; i < Size; i++)
+        Ctx->Buffer[Ctx->BufSize++] = In[i];
+    return success;
+}
 
-    //? Fill NewArr with relevant data and padding.
-    for (size_t i = 0; i < Size; i++)
-        Ret->Arr[i] = Plaintext[i];
-    for (size_t i = Size; i < Ret->Size; i++)
-        Ret->Arr[i] = PadByte;
+ErrorCode aes_cbc_stream_final(AESCBCStream* Ctx, uint8_t* Out, size_t* OutSize)
+{
+    ErrorCode TempError = success;
+    *OutSize = 0;
 
-    for (int i = 0; i < 16; i++)
-        Ret->Arr[i] ^= IV[i];
-    for (size_t i = 0; i < Ret->Size - 16; i+=16)
+    if (Ctx->Encrypt)
     {
-        ErrorCode TempError = aes_std_enc(Ret->Arr+i, Key);
-        if (TempError != success)
+        //* Pad whatever is left (a whole block of padding if nothing is).
+        uint8_t PadByte = 16 - Ctx->BufSize;
+        for (size_t i = Ctx->BufSize; i < 16; i++)
+            Ctx->Buffer[i] = PadByte;
+        cbc_enc_blocks(Ctx->Key, Ctx->Buffer, Out, 1, Ctx->Chain);
+        *OutSize = 16;
+    }
+    else if (Ctx->BufSize != 16)
+        TempError = unknown_error;
+    else
+    {
+        //* Unpad in a local block, so Out never holds padding.
+        uint8_t Last[16];
+        cbc_dec_blocks(Ctx->Key, Ctx->Buffer, Last, 1, Ctx->Chain);
+        size_t LastSize;
+        TempError = pkcs7_unpad(Last, 16, &LastSize);
+        if (TempError == success)
         {
-            free(Ret->Arr);
-            return TempError;
+            memcpy(Out, Last, LastSize);
+            *OutSize = LastSize;
         }
-        for (int j = 0; j < 16; j++)
-            Ret->Arr[i+16 + j] ^= Ret->Arr[i + j];
+        wipe_bytes(Last, 16);
     }
-    // Final one without CBC function
-    ErrorCode TempError = aes_std_enc(Ret->Arr+Ret->Size-16, Key);
+
+    wipe_bytes(Ctx, sizeof(AESCBCStream));
+    return TempError;
+}
+
+//? AES-GCM implementation
+
+ErrorCode aes_gcm_enc(uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, uint8_t* Tag)
+{
+    AESGCMKey Ctx;
+    ErrorCode TempError = aes_gcm_key_init(&Ctx, Key);
+    if (TempError != success)
+        return TempError;
+
+    TempError = aes_gcm_enc_ctx(Plaintext, PSize, AAD, ASize, &Ctx, IV, Tag);
+    aes_gcm_key_clear(&Ctx);
+    return TempError;
+}
+
+ErrorCode aes_gcm_dec(uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, const uint8_t* Tag)
+{
+    AESGCMKey Ctx;
+    ErrorCode TempError = aes_gcm_key_init(&Ctx, Key);
+    if (TempError != success)
+        return TempError;
+
+    TempError = aes_gcm_dec_ctx(Ciphertext, CSize, AAD, ASize, &Ctx, IV, Tag);
+    aes_gcm_key_clear(&Ctx);
+    return TempError;
+}
+
+ErrorCode aes_gcm_dec_into(const uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, const uint8_t* Tag, uint8_t* Plaintext)
+{
+    AESGCMKey Ctx;
+    ErrorCode TempError = aes_gcm_key_init(&Ctx, Key);
     if (TempError != success)
+        return TempError;
+
+    TempError = aes_gcm_dec_into_ctx(Ciphertext, CSize, AAD, ASize, &Ctx, IV, Tag, Plaintext);
+    aes_gcm_key_clear(&Ctx);
+    return TempError;
+}
+
+ErrorCode aes_gcm_enc_ctx(uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const AESGCMKey* Ctx, const uint8_t* IV, uint8_t* Tag)
+{
+    //* J (IV) and JInc (J + 1)
+    uint8_t J[16] =    {IV[0],IV[1],IV[2],IV[3],IV[4],IV[5],IV[6],IV[7],IV[8],IV[9],IV[10],IV[11],0,0,0,1};
+    uint8_t JInc[16] = {IV[0],IV[1],IV[2],IV[3],IV[4],IV[5],IV[6],IV[7],IV[8],IV[9],IV[10],IV[11],0,0,0,2};
+
+    //* Initial hash block must be 0.
+    uint8_t Hash[16] = {0};
+    uint8_t LenBuf[16];
+    gcm_length_block(ASize, PSize, LenBuf);
+
+    //* Hash = ghash(AAD+0 Pad + PSize + 0 Pad + ASize[bits] + PSize[bits])
+    //* Using ghash's last block as a first block works the same as concatenating the entire bit string.
+    ghash_update(&Ctx->Hash, Hash, AAD, ASize);
+
+    //* Encrypt Plaintext (Ciphertext) and hash it in the same pass.
+    gcm_run(Ctx, Plaintext, Plaintext, PSize, JInc, Hash, gcm_job_encrypt);
+    ghash_update(&Ctx->Hash, Hash, LenBuf, 16);
+
+    //* Encrypt Hash with Key (Tag)
+    gctr(Hash, 16, &Ctx->Cipher, J);
+
+    //* Assume tag is allocated
+    for (int i = 0; i < 16; i++)
+        Tag[i] = Hash[i];
+
+    return success;
+}
+
+ErrorCode aes_gcm_dec_ctx(uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const AESGCMKey* Ctx, const uint8_t* IV, const uint8_t* Tag)
+{
+    //* J (IV) and JInc (J + 1)
+    uint8_t J[16] =    {IV[0],IV[1],IV[2],IV[3],IV[4],IV[5],IV[6],IV[7],IV[8],IV[9],IV[10],IV[11],0,0,0,1};
+    uint8_t JInc[16] = {IV[0],IV[1],IV[2],IV[3],IV[4],IV[5],IV[6],IV[7],IV[8],IV[9],IV[10],IV[11],0,0,0,2};
+
+    //* Initial hash block must be 0.
+    uint8_t Hash[16] = {0};
+    uint8_t LenBuf[16];
+    gcm_length_block(ASize, CSize, LenBuf);
+
+    //* Hash = ghash(AAD+0 Pad + PSize + 0 Pad + ASize[bits] + PSize[bits])
+    //* Using ghash's last block as a first block works the same as concatenating the entire bit string.
+    ghash_update(&Ctx->Hash, Hash, AAD, ASize);
+    gcm_run(Ctx, Ciphertext, NULL, CSize, JInc, Hash, gcm_job_hash);
+    ghash_update(&Ctx->Hash, Hash, LenBuf, 16);
+
+    //* Encrypt Hash with Key (Tag)
+    gctr(Hash, 16, &Ctx->Cipher, J);
+
+    //* If invalid, return without modifying Ciphertext.
+    //! In place, this has to stay two passes: a single pass would overwrite Ciphertext before the Tag is known.
+    if (!gcm_tag_equal(Tag, Hash))
+        return unknown_error;
+    
+    //* Decipher Ciphertext and return.
+    gcm_run(Ctx, Ciphertext, Ciphertext, CSize, JInc, NULL, gcm_job_ctr);
+    return success;
+}
+
+ErrorCode aes_gcm_dec_into_ctx(const uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const AESGCMKey* Ctx, const uint8_t* IV, const uint8_t* Tag, uint8_t* Plaintext)
+{
+    //* J (IV) and JInc (J + 1)
+    uint8_t J[16] =    {IV[0],IV[1],IV[2],IV[3],IV[4],IV[5],IV[6],IV[7],IV[8],IV[9],IV[10],IV[11],0,0,0,1};
+    uint8_t JInc[16] = {IV[0],IV[1],IV[2],IV[3],IV[4],IV[5],IV[6],IV[7],IV[8],IV[9],IV[10],IV[11],0,0,0,2};
+
+    //* Initial hash block must be 0.
+    uint8_t Hash[16] = {0};
+    uint8_t LenBuf[16];
+    gcm_length_block(ASize, CSize, LenBuf);
+
+    //* Hash the Ciphertext and decrypt it into Plaintext in the same pass.
+    ghash_update(&Ctx->Hash, Hash, AAD, ASize);
+    gcm_run(Ctx, Ciphertext, Plaintext, CSize, JInc, Hash, gcm_job_decrypt);
+    ghash_update(&Ctx->Hash, Hash, LenBuf, 16);
+
+    //* Encrypt Hash with Key (Tag)
+    gctr(Hash, 16, &Ctx->Cipher, J);
+
+    //* Plaintext is only released on a valid Tag, otherwise it is wiped.
+    if (!gcm_tag_equal(Tag, Hash))
     {
-        free(Ret->Arr);
-        return TempError;
+        memset(Plaintext, 0, CSize);
+        return unknown_error;
     }
-    
     return success;
 }
 
-ErrorCode aes_cbc_dec(const uint8_t* Ciphertext, size_t Size, const uint8_t* Key, const uint8_t* IV, ByteArr* Ret)
+
+//? AES-GCM streaming
+
+ErrorCode aes_gcm_stream_init(AESGCMStream* Ctx, const AESGCMKey* Key, const uint8_t* IV, bool Encrypt)
 {
-    if (Size == 0 || Size%16 != 0)
+    //* J (IV) and Counter (J + 1)
+    for (int i = 0; i < 12; i++)
+        Ctx->J[i] = IV[i];
+    Ctx->J[12] = 0;
+    Ctx->J[13] = 0;
+    Ctx->J[14] = 0;
+    Ctx->J[15] = 1;
+    gcm_counter_add(Ctx->Counter, Ctx->J, 1);
+
+    Ctx->Key = Key;
+    memset(Ctx->Hash, 0, 16);
+    Ctx->BufSize = 0;
+    Ctx->StreamUsed = 16;
+    Ctx->ASize = 0;
+    Ctx->Size = 0;
+    Ctx->Encrypt = Encrypt;
+    Ctx->DataStarted = false;
+    return success;
+}
+
+ErrorCode aes_gcm_stream_aad(AESGCMStream* Ctx, const uint8_t* AAD, size_t ASize)
+{
+    if (Ctx->DataStarted)
         return unknown_error;
 
-    //? Copy over Ciphertext
-    uint8_t* Temp = malloc(Size);
-    if (Temp == NULL)
-        return malloc_error;
-    for (size_t i = 0; i < Size; i++)
-        Temp[i] = Ciphertext[i];
+    gcm_stream_absorb(Ctx, AAD, ASize);
+    Ctx->ASize += ASize;
+    return success;
+}
+
+ErrorCode aes_gcm_stream_update(AESGCMStream* Ctx, uint8_t* Data, size_t Size)
+{
+    gcm_stream_start_data(Ctx);
+    Ctx->Size += Size;
 
-    //? Decrypt Temp, 16 bytes at a time
-    for (size_t i = 0; i < Size; i+=16)
+    //* Finish the partial block left by the last call with its remaining keystream.
+    size_t i = 0;
+    for (; i < Size && Ctx->StreamUsed < 16; i++)
     {
-        ErrorCode TempError = aes_std_dec(Temp + i, Key);
-        if (TempError != success)
-        {
-            free(Temp);
-            return TempError;
-        }
+        if (!Ctx->Encrypt)
+            gcm_stream_absorb(Ctx, Data + i, 1);
+        Data[i] ^= Ctx->Stream[Ctx->StreamUsed++];
+        if (Ctx->Encrypt)
+            gcm_stream_absorb(Ctx, Data + i, 1);
     }
 
-    //? XOR each Ciphertext
-    for (int i = 0; i < 16; i++)
-        Temp[i] ^= IV[i];
-    for (size_t i = 16; i < Size; i++)
-        Temp[i] ^= Ciphertext[i-16];
+    //* Whole blocks are block aligned in the message again, so they take the stitched (and threaded) path.
+    size_t Whole = (Size - i) & ~(size_t) 15;
+    if (Whole != 0)
+    {
+        gcm_run(Ctx->Key, Data + i, Data + i, Whole, Ctx->Counter, Ctx->Hash, Ctx->Encrypt ? gcm_job_encrypt : gcm_job_decrypt);
+        gcm_counter_add(Ctx->Counter, Ctx->Counter, Whole / 16);
+        i += Whole;
+    }
 
-    //? Declare ByteArr Struct
-    Ret->Size = Size - Temp[Size - 1];
-    Ret->Arr = malloc(Ret->Size);
-    if (Ret->Arr == NULL)
+    //* Start a new partial block, keeping the rest of its keystream for the next call.
+    if (i < Size)
     {
-        free(Temp);   
-        return malloc_error;
+        memcpy(Ctx->Stream, Ctx->Counter, 16);
+        encrypt_block(Ctx->Stream, &Ctx->Key->Cipher);
+        gcm_counter_add(Ctx->Counter, Ctx->Counter, 1);
+        Ctx->StreamUsed = 0;
+
+        if (!Ctx->Encrypt)
+            gcm_stream_absorb(Ctx, Data + i, Size - i);
+        for (; i < Size; i++)
+            Data[i] ^= Ctx->Stream[Ctx->StreamUsed++];
+        if (Ctx->Encrypt)
+            gcm_stream_absorb(Ctx, Data + Size - Ctx->StreamUsed, Ctx->StreamUsed);
     }
+    return success;
+}
 
-    //? Copy over Temp to ByteArr
-    for (size_t i = 0; i < Ret->Size; i++)
-        Ret->Arr[i] = Temp[i];
-        
-    //? Free allocated Temp
-    free(Temp);
-    
+ErrorCode aes_gcm_stream_final(AESGCMStream* Ctx, uint8_t* Tag)
+{
+    if (!Ctx->Encrypt)
+        return unknown_error;
+
+    gcm_stream_tag(Ctx, Tag);
     return success;
 }
 
+ErrorCode aes_gcm_stream_verify(AESGCMStream* Ctx, const uint8_t* Tag)
+{
+    if (Ctx->Encrypt)
+        return unknown_error;
 
-//? AES-GCM implementation
+    uint8_t Hash[16];
+    gcm_stream_tag(Ctx, Hash);
+    bool IsValid = gcm_tag_equal(Tag, Hash);
+    wipe_bytes(Hash, 16);
+    return IsValid ? success : unknown_error;
+}
 
-ErrorCode aes_gcm_enc(uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, uint8_t* Tag)
+//? AES-GCM-SIV Implementation
+
+ErrorCode aes_siv_enc(uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, uint8_t* Tag)
 {
-    //* Zero block (encrypted)
-    uint8_t H[16] = {0};
-    ErrorCode TempError;
-    TempError = aes_std_enc(H, Key);
+    AESKey Ctx;
+    ErrorCode TempError = aes_key_init(&Ctx, Key);
     if (TempError != success)
         return TempError;
 
-    //* J (IV) and JInc (ginc32(J))
-    uint8_t J[16] =    {IV[0],IV[1],IV[2],IV[3],IV[4],IV[5],IV[6],IV[7],IV[8],IV[9],IV[10],IV[11],0,0,0,1};
-    uint8_t JInc[16] = {IV[0],IV[1],IV[2],IV[3],IV[4],IV[5],IV[6],IV[7],IV[8],IV[9],IV[10],IV[11],0,0,0,2};
+    TempError = aes_siv_enc_ctx(Plaintext, PSize, AAD, ASize, &Ctx, IV, Tag);
+    aes_key_clear(&Ctx);
+    return TempError;
+}
 
-    //* Encrypt Plaintext here via gctr. (Ciphertext)
-    TempError = gctr(Plaintext, PSize, Key, JInc);
+ErrorCode aes_siv_dec(uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, const uint8_t* Tag)
+{
+    AESKey Ctx;
+    ErrorCode TempError = aes_key_init(&Ctx, Key);
     if (TempError != success)
         return TempError;
 
-    //* Initial hash block must be 0.
-    uint8_t* Hash = calloc(16, 1);
-    if (Hash == NULL)
-        return malloc_error;
-    uint8_t LenBuf[16];
-    //^ TempSizes are endian dependent. Convert (even if already) little endian
-    size_t TempASize = ASize<<3;
-    size_t TempPSize = PSize<<3;
-    for(int i = 0; i < 8; i++)
-    {
-        // LenBuf[i] = ((uint8_t*) &TempASize)[7-i];
-        // LenBuf[i+8] = ((uint8_t*) &TempPSize)[7-i];
+    TempError = aes_siv_dec_ctx(Ciphertext, CSize, AAD, ASize, &Ctx, IV, Tag);
+    aes_key_clear(&Ctx);
+    return TempError;
+}
 
-        //^ Take Largest to Smallest TempSize
-        //! Untested
-        LenBuf[i] = (TempASize >> (7-i)*(8)) & 0xFF;
-        LenBuf[i + 8] = (TempPSize >> (7-i)*(8)) & 0xFF;
-    }
+ErrorCode aes_siv_enc_into(const uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, uint8_t* Ciphertext, uint8_t* Tag)
+{
+    AESKey Ctx;
+    ErrorCode TempError = aes_key_init(&Ctx, Key);
+    if (TempError != success)
+        return TempError;
 
-    //* Hash = ghash(AAD+0 Pad + PSize + 0 Pad + ASize[bits] + PSize[bits])
-    //* Using ghash's last block as a first block works the same as concatenating the entire bit string.
-    ghash(H, AAD, ASize, Hash);
-    ghash(H, Plaintext, PSize, Hash);
-    ghash(H, LenBuf, 16, Hash);
+    TempError = aes_siv_enc_into_ctx(Plaintext, PSize, AAD, ASize, &Ctx, IV, Ciphertext, Tag);
+    aes_key_clear(&Ctx);
+    return TempError;
+}
 
-    //* Encrypt Hash with Key (Tag)
-    TempError = gctr(Hash, 16, Key, J);
+ErrorCode aes_siv_dec_into(const uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, const uint8_t* Tag, uint8_t* Plaintext)
+{
+    AESKey Ctx;
+    ErrorCode TempError = aes_key_init(&Ctx, Key);
     if (TempError != success)
-    {
-        free(Hash);
         return TempError;
-    }
 
-    //* Assume tag is allocated
-    for (int i = 0; i < 16; i++)
-        Tag[i] = Hash[i];
+    TempError = aes_siv_dec_into_ctx(Ciphertext, CSize, AAD, ASize, &Ctx, IV, Tag, Plaintext);
+    aes_key_clear(&Ctx);
+    return TempError;
+}
 
-    return success;
+ErrorCode aes_siv_enc_ctx(uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const AESKey* Ctx, const uint8_t* IV, uint8_t* Tag)
+{
+    return aes_siv_enc_into_ctx(Plaintext, PSize, AAD, ASize, Ctx, IV, Plaintext, Tag);
 }
 
-ErrorCode aes_gcm_dec(uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, const uint8_t* Tag)
+ErrorCode aes_siv_dec_ctx(uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const AESKey* Ctx, const uint8_t* IV, const uint8_t* Tag)
 {
-    //* Zero block (encrypted)
-    uint8_t H[16] = {0};
-    ErrorCode TempError;
-    TempError = aes_std_enc(H, Key);
+    //* In place, an invalid Tag encrypts the buffer back instead of wiping it (see aes_siv_dec_into_ctx()).
+    return aes_siv_dec_into_ctx(Ciphertext, CSize, AAD, ASize, Ctx, IV, Tag, Ciphertext);
+}
+
+ErrorCode aes_siv_enc_into_ctx(const uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const AESKey* Ctx, const uint8_t* IV, uint8_t* Ciphertext, uint8_t* Tag)
+{
+    //* Derive and expand EncKey (once, for the tag and every sivctr block) and AuthKey (POLYVAL, one multiplication per block).
+    AESKey EncCtx;
+    GHashKey AuthHash;
+    ErrorCode TempError = siv_message_keys(Ctx, IV, &EncCtx, &AuthHash);
     if (TempError != success)
         return TempError;
 
-    //* J (IV) and JInc (ginc32(J))
-    uint8_t J[16] =    {IV[0],IV[1],IV[2],IV[3],IV[4],IV[5],IV[6],IV[7],IV[8],IV[9],IV[10],IV[11],0,0,0,1};
-    uint8_t JInc[16] = {IV[0],IV[1],IV[2],IV[3],IV[4],IV[5],IV[6],IV[7],IV[8],IV[9],IV[10],IV[11],0,0,0,2};
+    //* Calculate Length Block for polyval later. (Bit size)
+    uint64_t LenBlock[2] = {(ASize<<3), (PSize<<3)};
 
-    //* Initial hash block must be 0.
-    uint8_t Hash[16] = {0};     // Changed from calloc(16,1);
+    //* Run polyval for AAD, Plaintext, LenBlock in sequence (Plaintext split across threads).
+    uint8_t PolyHash[16] = {0};
+    polyval_update(&AuthHash, PolyHash, AAD, ASize);
+    siv_run(&EncCtx, &AuthHash, Plaintext, NULL, PSize, NULL, PolyHash, siv_job_hash);
+    polyval_update(&AuthHash, PolyHash, ((uint8_t*) LenBlock), 16);
+    ghash_key_clear(&AuthHash);
 
-    uint8_t LenBuf[16];
-    size_t TempASize = ASize<<3;
-    size_t TempCSize = CSize<<3;
-    for(int i = 0; i < 8; i++)
-    {
-        // LenBuf[i] = ((uint8_t*) &TempASize)[7-i];
-        // LenBuf[i+8] = ((uint8_t*) &TempCSize)[7-i];
+    //* Produce final Tag version
+    siv_tag(&EncCtx, PolyHash, IV);
 
-        //! Untested
-        LenBuf[i] = (TempASize >> (7-i)*(8)) & 0xFF;
-        LenBuf[i + 8] = (TempCSize >> (7-i)*(8)) & 0xFF;
-    }
+    //* Generates ICB for SivCtr
+    uint8_t ICB[16] = {PolyHash[0], PolyHash[1], PolyHash[2], PolyHash[3], PolyHash[4], PolyHash[5], PolyHash[6], PolyHash[7], PolyHash[8], PolyHash[9], PolyHash[10], PolyHash[11], PolyHash[12], PolyHash[13], PolyHash[14], (PolyHash[15] | 0x80)};
 
-    //* Hash = ghash(AAD+0 Pad + PSize + 0 Pad + ASize[bits] + PSize[bits])
-    //* Using ghash's last block as a first block works the same as concatenating the entire bit string.
-    ghash(H, AAD, ASize, Hash);
-    ghash(H, Ciphertext, CSize, Hash);
-    ghash(H, LenBuf, 16, Hash);
+    //* Encrypt Plaintext into Ciphertext with SivCtr, split across threads by counter range.
+    siv_run(&EncCtx, NULL, Plaintext, Ciphertext, PSize, ICB, NULL, siv_job_ctr);
+    aes_key_clear(&EncCtx);
 
-    //* Encrypt Hash with Key (Tag)
-    TempError = gctr(Hash, 16, Key, J);
+    //* Assume tag is allocated
+    for (int i = 0; i < 16; i++)
+        Tag[i] = PolyHash[i];
+    return success;
+}
+
+ErrorCode aes_siv_dec_into_ctx(const uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const AESKey* Ctx, const uint8_t* IV, const uint8_t* Tag, uint8_t* Plaintext)
+{
+    //* Derive and expand EncKey (once, for the tag and every sivctr block) and AuthKey (POLYVAL, one multiplication per block).
+    AESKey EncCtx;
+    GHashKey AuthHash;
+    ErrorCode TempError = siv_message_keys(Ctx, IV, &EncCtx, &AuthHash);
     if (TempError != success)
         return TempError;
 
-    //* Validates (Ciphertext + AAD + Tag)
-    bool IsValid = true;
-    for (int i = 0; i < 16; i++)
-        if (Tag[i] != Hash[i])
-            IsValid = false;
-    
-    //* If invalid, return without modifying Ciphertext.
-    if (IsValid == false)
-        return unknown_error;
-    
-    //* Decipher Ciphertext and return.
-    return gctr(Ciphertext, CSize, Key, JInc);
-}
+    //* Generates ICB for SivCtr
+    uint8_t ICB[16] = {Tag[0], Tag[1], Tag[2], Tag[3], Tag[4], Tag[5], Tag[6], Tag[7], Tag[8], Tag[9], Tag[10], Tag[11], Tag[12], Tag[13], Tag[14], (Tag[15] | 0x80)};
+
+    //* Calculate Length Block for polyval later.
+    uint64_t LenBlock[2] = {(ASize<<3), (CSize<<3)};
 
+    //* Decrypt Ciphertext into Plaintext and run polyval over each piece while it is still in L1 (split across threads).
+    uint8_t PolyHash[16] = {0};
+    polyval_update(&AuthHash, PolyHash, AAD, ASize);
+    siv_run(&EncCtx, &AuthHash, Ciphertext, Plaintext, CSize, ICB, PolyHash, siv_job_decrypt);
+    polyval_update(&AuthHash, PolyHash, ((uint8_t*) LenBlock), 16);
+    ghash_key_clear(&AuthHash);
+    siv_tag(&EncCtx, PolyHash, IV);
+
+    //* Plaintext is only released on a valid Tag.
+    //* Otherwise it is wiped, or encrypted back when in place so the caller gets its Ciphertext back unaltered.
+    bool IsInvalid = !gcm_tag_equal(Tag, PolyHash);
+    if (IsInvalid)
+    {
+        if (Plaintext == Ciphertext)
+            siv_run(&EncCtx, NULL, Plaintext, Plaintext, CSize, ICB, NULL, siv_job_ctr);
+        else
+            memset(Plaintext, 0, CSize);
+    }
+    aes_key_clear(&EncCtx);
+    return IsInvalid ? unknown_error : success;
+}
 
-//? AES-GCM-SIV Implementation
+//? AES-GCM and AES-GCM-SIV over Base64
+//* Every piece is AES_BASE64_STAGE bytes (BASE64_ENCODED_SIZE(AES_BASE64_STAGE) characters) except the last,
+//* so counters and hashes carry over whole blocks and only the last quartet of the text may hold padding.
 
-ErrorCode aes_siv_enc(uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, uint8_t* Tag)
+ErrorCode aes_gcm_dec_base64_ctx(const char* B64, size_t Len, const uint8_t* AAD, size_t ASize, const AESGCMKey* Ctx, const uint8_t* IV, const uint8_t* Tag, uint8_t* Plaintext, size_t* PSize)
 {
-    //* Allocate and initialize EncKey and AuthKey
-    uint8_t EncKey[32];
-    uint8_t AuthKey[16];
-    ErrorCode TempError;
-    TempError = siv_derive_keys(Key, IV, EncKey, AuthKey);
-    if (TempError != success)
-        return TempError;
+    if (Len % 4 != 0)
+        return unknown_error;
 
-    //* Assume RetTag is already allocated (Dynamic or Static) (initialized to 0).
-    for (int i = 0; i < 16; i++)
-        Tag[i] = 0;
+    //* J (IV) and JInc (J + 1)
+    uint8_t J[16] =    {IV[0],IV[1],IV[2],IV[3],IV[4],IV[5],IV[6],IV[7],IV[8],IV[9],IV[10],IV[11],0,0,0,1};
+    uint8_t JInc[16] = {IV[0],IV[1],IV[2],IV[3],IV[4],IV[5],IV[6],IV[7],IV[8],IV[9],IV[10],IV[11],0,0,0,2};
 
-    //* Calculate Length Block for polyval later. (Bit size)
-    uint64_t LenBlock[2] = {(ASize<<3), (PSize<<3)};
-    
-    //* Run polyval for AAD, Plaintext, LenBlock in sequence.
-    polyval(AuthKey, AAD, ASize, Tag);
-    polyval(AuthKey, Plaintext, PSize, Tag);
-    polyval(AuthKey, ((uint8_t*) LenBlock), 16, Tag);
+    uint8_t Hash[16] = {0};
+    ghash_update(&Ctx->Hash, Hash, AAD, ASize);
 
-    //* Xor first 12 bytes of Tag with IV
-    for (int i = 0; i < 12; i++)
-        Tag[i] ^= IV[i];
+    //* Decode a piece into its place in Plaintext, then hash and decrypt it while it is still in L1.
+    size_t Total = 0;
+    for (size_t i = 0; i < Len; i += BASE64_ENCODED_SIZE(AES_BASE64_STAGE))
+    {
+        size_t Chars = (Len - i < BASE64_ENCODED_SIZE(AES_BASE64_STAGE)) ? Len - i : BASE64_ENCODED_SIZE(AES_BASE64_STAGE);
+        size_t Size;
+        bool Last = (i + Chars == Len);
+        if (base64_convert_byte_into(B64 + i, Chars, Plaintext + Total, &Size) != success || (!Last && Size != AES_BASE64_STAGE))
+        {
+            memset(Plaintext, 0, BASE64_DECODED_MAX(Len));
+            return unknown_error;
+        }
 
-    //* Clear MSB of last byte in Tag
-    Tag[15]  &= 0x7F;
+        uint8_t CB[16];
+        gcm_counter_add(CB, JInc, Total / 16);
+        gcm_run(Ctx, Plaintext + Total, Plaintext + Total, Size, CB, Hash, gcm_job_decrypt);
+        Total += Size;
+    }
 
-    //* Produce final Tag version
-    TempError = aes_std_enc(Tag, EncKey);
-    if (TempError != success)
+    uint8_t LenBuf[16];
+    gcm_length_block(ASize, Total, LenBuf);
+    ghash_update(&Ctx->Hash, Hash, LenBuf, 16);
+    gctr(Hash, 16, &Ctx->Cipher, J);
+
+    //* Plaintext is only released on a valid Tag, otherwise it is wiped.
+    if (!gcm_tag_equal(Tag, Hash))
     {
-        free(Tag);
-        return TempError;
+        memset(Plaintext, 0, BASE64_DECODED_MAX(Len));
+        return unknown_error;
     }
+    *PSize = Total;
+    return success;
+}
 
-    //* Generates ICB for SivCtr
-    uint8_t ICB[16] = {Tag[0], Tag[1], Tag[2], Tag[3], Tag[4], Tag[5], Tag[6], Tag[7], Tag[8], Tag[9], Tag[10], Tag[11], Tag[12], Tag[13], Tag[14], (Tag[15] | 0x80)};
+ErrorCode aes_gcm_enc_base64_ctx(const uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const AESGCMKey* Ctx, const uint8_t* IV, char* Out, size_t* OutLen, uint8_t* Tag)
+{
+    //* J (IV) and JInc (J + 1)
+    uint8_t J[16] =    {IV[0],IV[1],IV[2],IV[3],IV[4],IV[5],IV[6],IV[7],IV[8],IV[9],IV[10],IV[11],0,0,0,1};
+    uint8_t JInc[16] = {IV[0],IV[1],IV[2],IV[3],IV[4],IV[5],IV[6],IV[7],IV[8],IV[9],IV[10],IV[11],0,0,0,2};
 
-    //* Encrypt Plaintext with SivCtr (Ciphertext)
-    TempError = sivctr(Plaintext, PSize, EncKey, ICB);
-    if (TempError != success)
+    uint8_t Hash[16] = {0};
+    ghash_update(&Ctx->Hash, Hash, AAD, ASize);
+
+    //* Encrypt and hash a piece into Stage, then encode it straight into Out.
+    uint8_t Stage[AES_BASE64_STAGE];
+    size_t Length = 0;
+    for (size_t i = 0; i < PSize; i += AES_BASE64_STAGE)
     {
-        free(Tag);
-        return TempError;
+        size_t Size = (PSize - i < AES_BASE64_STAGE) ? PSize - i : AES_BASE64_STAGE;
+        uint8_t CB[16];
+        gcm_counter_add(CB, JInc, i / 16);
+        gcm_run(Ctx, Plaintext + i, Stage, Size, CB, Hash, gcm_job_encrypt);
+
+        size_t Chars;
+        base64_convert_string_into(Stage, Size, Out + Length, &Chars);
+        Length += Chars;
     }
 
+    uint8_t LenBuf[16];
+    gcm_length_block(ASize, PSize, LenBuf);
+    ghash_update(&Ctx->Hash, Hash, LenBuf, 16);
+    gctr(Hash, 16, &Ctx->Cipher, J);
+
+    for (int i = 0; i < 16; i++)
+        Tag[i] = Hash[i];
+    *OutLen = Length;
     return success;
 }
 
-ErrorCode aes_siv_dec(uint8_t* Ciphertext, size_t CSize, const uint8_t* AAD, size_t ASize, const uint8_t* Key, const uint8_t* IV, const uint8_t* Tag)
+ErrorCode aes_siv_dec_base64_ctx(const char* B64, size_t Len, const uint8_t* AAD, size_t ASize, const AESKey* Ctx, const uint8_t* IV, const uint8_t* Tag, uint8_t* Plaintext, size_t* PSize)
 {
-    //* Allocate and initialize EncKey and AuthKey
-    uint8_t EncKey[32];
-    uint8_t AuthKey[16];
-    ErrorCode TempError;
-    TempError = siv_derive_keys(Key, IV, EncKey, AuthKey);
+    if (Len % 4 != 0)
+        return unknown_error;
+
+    //* Derive and expand EncKey (once, for the tag and every sivctr block) and AuthKey.
+    AESKey EncCtx;
+    GHashKey AuthHash;
+    ErrorCode TempError = siv_message_keys(Ctx, IV, &EncCtx, &AuthHash);
     if (TempError != success)
         return TempError;
 
     //* Generates ICB for SivCtr
     uint8_t ICB[16] = {Tag[0], Tag[1], Tag[2], Tag[3], Tag[4], Tag[5], Tag[6], Tag[7], Tag[8], Tag[9], Tag[10], Tag[11], Tag[12], Tag[13], Tag[14], (Tag[15] | 0x80)};
 
-    //* Malloc a Plaintext for indirect encryption, to prevent unauthenticated output.
-    uint8_t* Plaintext = malloc(CSize);
-    if (Plaintext == NULL)
-        return malloc_error;
-    for(int i = 0; i < CSize; i++)
-        Plaintext[i] = Ciphertext[i];
+    uint8_t PolyHash[16] = {0};
+    polyval_update(&AuthHash, PolyHash, AAD, ASize);
 
-    //* Decrypt Plaintext with SivCtr
-    TempError = sivctr(Plaintext, CSize, EncKey, ICB);
-    if (TempError != success)
+    //* Decode a piece into its place in Plaintext, decrypt it, then run POLYVAL over it while it is still in L1.
+    //* Plaintext holds unauthenticated data until the Tag is checked, it is wiped on every failure.
+    size_t Total = 0;
+    bool IsInvalid = false;
+    for (size_t i = 0; i < Len; i += BASE64_ENCODED_SIZE(AES_BASE64_STAGE))
     {
-        free(Plaintext);
-        return TempError;
-    }
+        size_t Chars = (Len - i < BASE64_ENCODED_SIZE(AES_BASE64_STAGE)) ? Len - i : BASE64_ENCODED_SIZE(AES_BASE64_STAGE);
+        size_t Size;
+        bool Last = (i + Chars == Len);
+        if (base64_convert_byte_into(B64 + i, Chars, Plaintext + Total, &Size) != success || (!Last && Size != AES_BASE64_STAGE))
+        {
+            IsInvalid = true;
+            break;
+        }
 
-    //* mallloc Tag (initialized to 0).
-    //// uint8_t* PolyHash = calloc(16, 1);
-    uint8_t PolyHash[16] = {0}; //! Untested
+        uint8_t CB[16];
+        siv_counter_add(CB, ICB, Total / 16);
+        sivctr(Plaintext + Total, Size, &EncCtx, CB);
+        polyval_update(&AuthHash, PolyHash, Plaintext + Total, Size);
+        Total += Size;
+    }
 
-    //* Calculate Length Block for polyval later.
-    uint64_t LenBlock[2] = {(ASize<<3), (CSize<<3)};
-    
-    //* Run polyval for AAD, Plaintext, LenBlock in sequence.
-    polyval(AuthKey, AAD, ASize, PolyHash);
-    polyval(AuthKey, Plaintext, CSize, PolyHash);
-    polyval(AuthKey, ((uint8_t*) LenBlock), 16, PolyHash);
+    if (!IsInvalid)
+    {
+        uint64_t LenBlock[2] = {(ASize<<3), (Total<<3)};
+        polyval_update(&AuthHash, PolyHash, ((uint8_t*) LenBlock), 16);
+        siv_tag(&EncCtx, PolyHash, IV);
+        IsInvalid = !gcm_tag_equal(Tag, PolyHash);
+    }
+    ghash_key_clear(&AuthHash);
+    aes_key_clear(&EncCtx);
 
-    //* Xor first 12 bytes of Tag with IV
-    for (int i = 0; i < 12; i++)
-        PolyHash[i] ^= IV[i];
+    if (IsInvalid)
+    {
+        memset(Plaintext, 0, BASE64_DECODED_MAX(Len));
+        return unknown_error;
+    }
+    *PSize = Total;
+    return success;
+}
 
-    //* Clear MSB of last byte in Tag, then encrypt.
-    PolyHash[15]  &= 0x7F;
-    TempError = aes_std_enc(PolyHash, EncKey);
+ErrorCode aes_siv_enc_base64_ctx(const uint8_t* Plaintext, size_t PSize, const uint8_t* AAD, size_t ASize, const AESKey* Ctx, const uint8_t* IV, char* Out, size_t* OutLen, uint8_t* Tag)
+{
+    //* Derive and expand EncKey (once, for the tag and every sivctr block) and AuthKey.
+    AESKey EncCtx;
+    GHashKey AuthHash;
+    ErrorCode TempError = siv_message_keys(Ctx, IV, &EncCtx, &AuthHash);
     if (TempError != success)
-    {
-        free(Plaintext);
         return TempError;
+
+    //* POLYVAL over AAD, Plaintext, LenBlock, then the Tag (and ICB) from the result.
+    uint8_t PolyHash[16] = {0};
+    uint64_t LenBlock[2] = {(ASize<<3), (PSize<<3)};
+    polyval_update(&AuthHash, PolyHash, AAD, ASize);
+    siv_run(&EncCtx, &AuthHash, Plaintext, NULL, PSize, NULL, PolyHash, siv_job_hash);
+    polyval_update(&AuthHash, PolyHash, ((uint8_t*) LenBlock), 16);
+    ghash_key_clear(&AuthHash);
+    siv_tag(&EncCtx, PolyHash, IV);
+
+    uint8_t ICB[16] = {PolyHash[0], PolyHash[1], PolyHash[2], PolyHash[3], PolyHash[4], PolyHash[5], PolyHash[6], PolyHash[7], PolyHash[8], PolyHash[9], PolyHash[10], PolyHash[11], PolyHash[12], PolyHash[13], PolyHash[14], (PolyHash[15] | 0x80)};
+
+    //* Encrypt a piece into Stage, then encode it straight into Out.
+    uint8_t Stage[AES_BASE64_STAGE];
+    size_t Length = 0;
+    for (size_t i = 0; i < PSize; i += AES_BASE64_STAGE)
+    {
+        size_t Size = (PSize - i < AES_BASE64_STAGE) ? PSize - i : AES_BASE64_STAGE;
+        uint8_t CB[16];
+        siv_counter_add(CB, ICB, i / 16);
+        memcpy(Stage, Plaintext + i, Size);
+        sivctr(Stage, Size, &EncCtx, CB);
+
+        size_t Chars;
+        base64_convert_string_into(Stage, Size, Out + Length, &Chars);
+        Length += Chars;
     }
+    aes_key_clear(&EncCtx);
 
-    //* Validate Tag in constant time.
-    bool IsInvalid = false;
     for (int i = 0; i < 16; i++)
-        IsInvalid |= !(Tag[i] == PolyHash[i]);
+        Tag[i] = PolyHash[i];
+    *OutLen = Length;
+    return success;
+}
 
-    //* Handle decryption if Tag happens to be invalid, never overwriting plaintext unless the check was successful.
-    if (!IsInvalid)
-    {
-        for (int i = 0; i < CSize; i++)
-            Ciphertext[i] = Plaintext[i];    
-        free(Plaintext);
-        return success;
-    }
-    
-    free(Plaintext);
-    return unknown_error;
+
+//? Batched AES-GCM and AES-GCM-SIV
+
+ErrorCode aes_gcm_enc_batch(const AESGCMKey* Ctx, AESAEADJob* Jobs, size_t Count)
+{
+    return gcm_batch(Ctx, Jobs, Count, true);
+}
+
+ErrorCode aes_gcm_dec_batch(const AESGCMKey* Ctx, AESAEADJob* Jobs, size_t Count)
+{
+    return gcm_batch(Ctx, Jobs, Count, false);
+}
+
+ErrorCode aes_siv_enc_batch(const AESKey* Ctx, AESAEADJob* Jobs, size_t Count)
+{
+    return siv_batch(Ctx, Jobs, Count, true);
+}
+
+ErrorCode aes_siv_dec_batch(const AESKey* Ctx, AESAEADJob* Jobs, size_t Count)
+{
+    return siv_batch(Ctx, Jobs, Count, false);
 }
 
 
@@ -565,45 +1159,63 @@ static void add_round_key(uint8_t* State, const uint8_t* EKey)
     return;
 }
 
-static uint8_t* expand_key_256(const uint8_t* Key)
+static void expand_key_256(const uint8_t* Key, uint8_t* EKey)
 {
-    //? Malloc a 256-bit expanded key (constant size).
-    uint32_t* EKey = malloc(240);
-    if (EKey == NULL)
-        return NULL;
-
     //? First 8 words are the cipherkey, set as bytes.
     for (int i = 0; i < 8*4; i++)
-        ((uint8_t*) EKey)[i] = Key[i];
+        EKey[i] = Key[i];
     
-    //? Generate 60 words (15 keys), first 4 set.
+    //? Generate 60 words (15 keys), first 8 set.
     //* RCON is the round constant, set to initial value of 1.
     uint8_t RCON = 1;
     for (int i = 8; i < (15*4); i++)
     {
         //* Prev is the last word generated.
-        //* Prev is a seperate memory pointer from w[], to allow for memory manipulation without affecting previously generated keys.
-        uint32_t Prev = *(EKey + i - 1);
+        //* Prev is a seperate copy from EKey[], to allow for manipulation without affecting previously generated keys.
+        uint8_t Prev[4] = {EKey[(i-1)*4 + 0], EKey[(i-1)*4 + 1], EKey[(i-1)*4 + 2], EKey[(i-1)*4 + 3]};
 
         //? Transformes specific bytes in w[i].
         if (i % 8 == 0)
         {
-            rot_word((uint8_t*) &Prev);
-            sub_word((uint8_t*) &Prev);
-            //* RCON is XOR'd directly because of Prev's endianness
-            Prev ^= RCON;
+            rot_word(Prev);
+            sub_word(Prev);
+            Prev[0] ^= RCON;
             RCON = gmul(RCON, 0x02);
         }
         else if ((i+4)%8 == 0)
         {
-            sub_word((uint8_t*) &Prev);
+            sub_word(Prev);
         }
 
-        EKey[i] = EKey[i-8] ^ Prev;
+        for (int j = 0; j < 4; j++)
+            EKey[i*4 + j] = EKey[(i-8)*4 + j] ^ Prev[j];
+    }
+
+    return;
+}
+
+static void invert_key_256(const uint8_t* EKey, uint8_t* DKey)
+{
+    //? Decryption uses the round keys in reverse order.
+    for (int i = 0; i < 15; i++)
+        for (int j = 0; j < 16; j++)
+            DKey[i*16 + j] = EKey[(14-i)*16 + j];
+
+    //? Apply InvMixColumns to every middle round key (Equivalent Inverse Cipher).
+    //* Round keys are stored column by column, State is stored row by row.
+    for (int i = 1; i < 14; i++)
+    {
+        uint8_t Temp[16];
+        for (int j = 0; j < 4; j++)
+            for (int k = 0; k < 4; k++)
+                Temp[k*4 + j] = DKey[i*16 + j*4 + k];
+        inv_mix_columns(Temp);
+        for (int j = 0; j < 4; j++)
+            for (int k = 0; k < 4; k++)
+                DKey[i*16 + j*4 + k] = Temp[k*4 + j];
     }
 
-    //! Expanded key must be freed at the end of the AES run.
-    return (uint8_t*) EKey;
+    return;
 }
 
 static void rot_word(uint8_t* Word)
@@ -616,18 +1228,85 @@ static void rot_word(uint8_t* Word)
     return;
 }
 
-static void sub_word(uint8_t* Word)
-{
-    Word[0] = SBox[Word[0]];
-    Word[1] = SBox[Word[1]];
-    Word[2] = SBox[Word[2]];
-    Word[3] = SBox[Word[3]];
+static void sub_word(uint8_t* Word)
+{
+    Word[0] = SBox[Word[0]];
+    Word[1] = SBox[Word[1]];
+    Word[2] = SBox[Word[2]];
+    Word[3] = SBox[Word[3]];
+    return;
+}
+
+
+//? Encryption functions
+
+static void encrypt_block(uint8_t* Block, const AESKey* Ctx)
+{
+    encrypt_blocks(Ctx, Block, Block, 1);
+    return;
+}
+
+static void encrypt_blocks(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks)
+{
+    switch (Ctx->Backend)
+    {
+        case aes_backend_ttable:
+            aes_ttable_enc(Ctx, In, Out, Blocks);
+            break;
+        case aes_backend_bitslice:
+            aes_bitslice_enc(Ctx, In, Out, Blocks);
+            break;
+#ifdef CPU_X86_SIMD
+        case aes_backend_aesni:
+            aes_ni_enc(Ctx, In, Out, Blocks);
+            break;
+        case aes_backend_vperm:
+            aes_vperm_enc(Ctx, In, Out, Blocks);
+            break;
+#endif
+        default:
+            for (size_t i = 0; i < Blocks; i++)
+                bytewise_encrypt_block(In + i*16, Out + i*16, Ctx);
+            break;
+    }
+    return;
+}
+
+static void bytewise_encrypt_block(const uint8_t* Block, uint8_t* Out, const AESKey* Ctx)
+{
+    //? Fill state sideways
+    uint8_t State[16] = 
+    {
+        Block[0], Block[4], Block[8], Block[12],
+        Block[1], Block[5], Block[9], Block[13],  
+        Block[2], Block[6], Block[10], Block[14],  
+        Block[3], Block[7], Block[11], Block[15]
+    };
+
+    //? Xor first Key
+    add_round_key(State, Ctx->EncKey);
+
+    //? Rounds
+    for (int i = 1; i < 14; i++)
+    {
+        sub_bytes(State);
+        shift_rows(State);
+        mix_columns(State);
+        add_round_key(State, Ctx->EncKey + i*16);
+    }
+
+    //? Final round without Mix Columns
+    sub_bytes(State);
+    shift_rows(State);
+    add_round_key(State, Ctx->EncKey + 14*16);
+
+    //? Fill Data sideways
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 4; j++)
+            Out[i*4 + j] = State[j*4 + i];
     return;
 }
 
-
-//? Encryption functions
-
 static void shift_rows(uint8_t* State)
 {
     uint8_t Temp[16];
@@ -668,6 +1347,73 @@ static void mix_columns(uint8_t* State)
 
 //? Decryption functions
 
+static void decrypt_block(uint8_t* Block, const AESKey* Ctx)
+{
+    decrypt_blocks(Ctx, Block, Block, 1);
+    return;
+}
+
+static void decrypt_blocks(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks)
+{
+    switch (Ctx->Backend)
+    {
+        case aes_backend_ttable:
+            aes_ttable_dec(Ctx, In, Out, Blocks);
+            break;
+        case aes_backend_bitslice:
+            aes_bitslice_dec(Ctx, In, Out, Blocks);
+            break;
+#ifdef CPU_X86_SIMD
+        case aes_backend_aesni:
+            aes_ni_dec(Ctx, In, Out, Blocks);
+            break;
+        case aes_backend_vperm:
+            aes_vperm_dec(Ctx, In, Out, Blocks);
+            break;
+#endif
+        default:
+            for (size_t i = 0; i < Blocks; i++)
+                bytewise_decrypt_block(In + i*16, Out + i*16, Ctx);
+            break;
+    }
+    return;
+}
+
+static void bytewise_decrypt_block(const uint8_t* Block, uint8_t* Out, const AESKey* Ctx)
+{
+    //? Fill state sideways
+    uint8_t State[16] = 
+    {
+        Block[0], Block[4], Block[8], Block[12],
+        Block[1], Block[5], Block[9], Block[13],  
+        Block[2], Block[6], Block[10], Block[14],  
+        Block[3], Block[7], Block[11], Block[15]
+    };
+
+    //? Xor last key (DecKey is stored in reverse order)
+    add_round_key(State, Ctx->DecKey);
+
+    //? Rounds in reverse (Equivalent Inverse Cipher, DecKey already has InvMixColumns applied)
+    for (int i = 1; i < 14; i++)
+    {
+        inv_sub_bytes(State);
+        inv_shift_rows(State);
+        inv_mix_columns(State);
+        add_round_key(State, Ctx->DecKey + i*16);
+    }
+
+    //? Last round without mix columns
+    inv_sub_bytes(State);
+    inv_shift_rows(State);
+    add_round_key(State, Ctx->DecKey + 14*16);
+
+    //? Fill Data sideways
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 4; j++)
+            Out[i*4 + j] = State[j*4 + i];
+    return;
+}
+
 static void inv_shift_rows(uint8_t* State)
 {
     uint8_t Temp[16];
@@ -747,295 +1493,757 @@ static uint8_t ginv(uint8_t Byte)
     return gmul(b,b);
 }
 
-static void ginc32(uint8_t* Block)
+static void gctr(uint8_t* Plaintext, size_t Size, const AESKey* Ctx, const uint8_t* ICB)
 {
-    //^ endian depdenent? 
-    //* Reverses the endian of Block (as a 128-bit number) to allow for proper increment.
-    uint32_t Temp = (Block[12] << 24) | (Block[13] << 16) | (Block[14] << 8) | Block[15];
-    Temp++;
-    Block[12] = (Temp >> 24) & 0xFF;
-    Block[13] = (Temp >> 16) & 0xFF;
-    Block[14] = (Temp >> 8) & 0xFF;
-    Block[15] = Temp & 0xFF;
+    ctr_xor(Plaintext, Size, Ctx, aes_counter_gcm, ICB);
     return;
 }
 
-static void gblockmul(const uint8_t* X, const uint8_t* Y, uint8_t* Result)
+static void ctr_xor(uint8_t* Data, size_t Size, const AESKey* Ctx, AESCounter Type, const uint8_t* ICB)
 {
-    //? Each block is a uint8_t[16] array, which represents a 128-bit number.
-    uint8_t XCpy[16];
-    uint8_t YCpy[16];
-    for (int i = 0 ; i < 16; i++)
+#ifdef CPU_X86_SIMD
+    if (Ctx->Backend == aes_backend_aesni)
     {
-        XCpy[i] = X[i];
-        YCpy[i] = Y[i];
-        Result[i] = 0;
+        aes_ni_ctr(Ctx, Type, ICB, Data, Size);
+        return;
     }
-
-    for (int i = 0; i < 128; i++)
+#endif
+
+    //* Read the counter word once, in its own byte order.
+    const size_t Pos = (Type == aes_counter_gcm) ? 12 : 0;
+    uint32_t Counter;
+    if (Type == aes_counter_gcm)
+        Counter = ((uint32_t) ICB[12] << 24) | ((uint32_t) ICB[13] << 16) | ((uint32_t) ICB[14] << 8) | ICB[15];
+    else
+        Counter = (uint32_t) ICB[0] | ((uint32_t) ICB[1] << 8) | ((uint32_t) ICB[2] << 16) | ((uint32_t) ICB[3] << 24);
+
+    uint8_t Stream[CTR_BLOCKS*16];
+    for (size_t i = 0; i < Size; i += sizeof(Stream))
     {
-        if (BITARR128(YCpy, i) == 1)
-            for (int i = 0 ; i < 16; i++)
-                Result[i] ^= XCpy[i];
-
-        if (BITARR128(XCpy, 127) == 0)
-        {            
-            for (int i = 15; i > 0; i--)
-                XCpy[i] = ((XCpy[i-1] & 1) << 7) | (XCpy[i] >> 1);
-            XCpy[0] = (XCpy[0] >> 1);
-        }
-        else
+        //* Only as many counter blocks as the remaining data needs (the partial tail shares the last pass).
+        size_t Len = (Size - i < sizeof(Stream)) ? Size - i : sizeof(Stream);
+        size_t Blocks = (Len + 15) / 16;
+
+        //* Generate counters, encrypt them in one interleaved pass, XOR the keystream in.
+        for (size_t j = 0; j < Blocks; j++, Counter++)
         {
-            for (int i = 15; i > 0; i--)
-                XCpy[i] = ((XCpy[i-1] & 1) << 7) | (XCpy[i] >> 1);
-            XCpy[0] = (XCpy[0] >> 1);
-            
-            //* V ^= R
-            XCpy[0] ^= 0xE1;
+            uint8_t* CB = Stream + j*16;
+            for (int k = 0; k < 16; k++)
+                CB[k] = ICB[k];
+            if (Type == aes_counter_gcm)
+            {
+                CB[Pos] = Counter >> 24;
+                CB[Pos + 1] = Counter >> 16;
+                CB[Pos + 2] = Counter >> 8;
+                CB[Pos + 3] = Counter;
+            }
+            else
+            {
+                CB[Pos] = Counter;
+                CB[Pos + 1] = Counter >> 8;
+                CB[Pos + 2] = Counter >> 16;
+                CB[Pos + 3] = Counter >> 24;
+            }
         }
+        encrypt_blocks(Ctx, Stream, Stream, Blocks);
+        xor_bytes(Data + i, Stream, Len);
     }
     return;
 }
 
-static void ghash(const uint8_t* H, const uint8_t* Block, size_t Size, uint8_t* Output)
-{   
-    for (size_t i = 0; i < (Size>>4); i++)
+static void xor_bytes(uint8_t* Data, const uint8_t* Stream, size_t Size)
+{
+    //* 8 bytes at a time (memcpy compiles to plain loads, without alignment or aliasing issues).
+    size_t i = 0;
+    for (; i + 8 <= Size; i += 8)
     {
-        for (int j = 0; j < 16; j++)
-            Output[j] ^= Block[i*16+j];
-        gblockmul(Output, H, Output);
+        uint64_t A, B;
+        memcpy(&A, Data + i, 8);
+        memcpy(&B, Stream + i, 8);
+        A ^= B;
+        memcpy(Data + i, &A, 8);
     }
-    
-    //* If final Block is incomplete, pad with 0's first
-    if (Size % 16 != 0)
+    for (; i < Size; i++)
+        Data[i] ^= Stream[i];
+    return;
+}
+
+static void gcm_length_block(uint64_t ASize, uint64_t Size, uint8_t* LenBuf)
+{
+    //^ TempSizes are endian dependent. Convert (even if already) little endian
+    uint64_t TempASize = ASize<<3;
+    uint64_t TempSize = Size<<3;
+    for(int i = 0; i < 8; i++)
     {
-        for (size_t j = 0; j < Size%16; j++)
-            Output[j] ^= Block[Size-(Size%16)+j];
-        for (int j = Size%16; j < 16; j++)
-            Output[j] ^= 0;
-        gblockmul(Output, H, Output);
+        //^ Take Largest to Smallest TempSize
+        LenBuf[i] = (TempASize >> (7-i)*(8)) & 0xFF;
+        LenBuf[i + 8] = (TempSize >> (7-i)*(8)) & 0xFF;
     }
-    
     return;
 }
 
-static ErrorCode gctr(uint8_t* Plaintext, size_t Size, const uint8_t* Key, const uint8_t* ICB)
+static void gcm_stitch(const AESGCMKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Size, const uint8_t* ICB, uint8_t* Hash, bool Encrypt)
 {
-    //* Prevent Size overflow on last block.
-    if (Size == 0)
-        return success;
-
-    uint8_t Temp[16];
+    //* Each chunk is read from memory once: CTR and GHASH both run on it while it is still in L1.
     uint8_t CB[16];
-    for (int i = 0; i < 16; i++)
-        CB[i] = ICB[i];
+    for (size_t i = 0; i < Size; i += GCM_STITCH_SIZE)
+    {
+        size_t Len = (Size - i < GCM_STITCH_SIZE) ? Size - i : GCM_STITCH_SIZE;
+        gcm_counter_add(CB, ICB, i / 16);
+
+        //* Ciphertext is hashed, so that is after CTR on encryption and before it on decryption.
+        if (!Encrypt)
+            ghash_update(&Ctx->Hash, Hash, In + i, Len);
+        if (Out != In)
+            memcpy(Out + i, In + i, Len);
+        ctr_xor(Out + i, Len, &Ctx->Cipher, aes_counter_gcm, CB);
+        if (Encrypt)
+            ghash_update(&Ctx->Hash, Hash, Out + i, Len);
+    }
+    return;
+}
 
-    //* Generate counter, Encrypt Counter, XOR plaintext block with counter.
-    for (size_t i = 0; i < Size-(Size%16); i+=16)
+static void block_run(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks, const uint8_t* IV, BlockJob Job)
+{
+    BlockPart Parts[THREAD_MAX];
+    unsigned Count = thread_parts(Blocks*16);
+
+    size_t PartBlocks = thread_part_size(Blocks*16, Count) / 16;
+    size_t Offset = 0;
+    for (unsigned i = 0; i < Count; i++)
     {
-        for (size_t j = 0; j < 16; j++)
-            Temp[j] = CB[j];
-        if (aes_std_enc(Temp, Key) != success)
-            return unknown_error;
-        for (int j = 0; j < 16; j++)
-            Plaintext[i+j] ^= Temp[j];
-        ginc32(CB);
-    } 
-    //* Final Block (works on incomplete blocks)
-    for (int j = 0; j < 16; j++)
-        Temp[j] = CB[j];
-    if (aes_std_enc(Temp, Key) != success)
-        return unknown_error;
-    for (size_t j = 0; j < Size%16; j++)
-        Plaintext[Size-(Size%16)+j] ^= Temp[j];
+        BlockPart* Part = &Parts[i];
+        Part->Ctx = Ctx;
+        Part->In = In + Offset*16;
+        Part->Out = Out + Offset*16;
+        Part->Blocks = (i + 1 == Count) ? Blocks - Offset : PartBlocks;
+        Part->Job = Job;
+
+        //* In place, the block before a range is overwritten by the previous thread, so it is saved here first.
+        if (Job == block_job_cbc_dec)
+            memcpy(Part->Prev, (Offset == 0) ? IV : In + Offset*16 - 16, 16);
+        Offset += Part->Blocks;
+    }
 
-    return success;
+    if (Count == 1)
+        block_part(&Parts[0]);
+    else
+        thread_run(block_part, Parts, sizeof(BlockPart), Count);
+    return;
 }
 
-static ErrorCode siv_derive_keys(const uint8_t* MasterKey, const uint8_t* IV, uint8_t* EncKey, uint8_t* AuthKey)
+static void block_part(void* Arg)
 {
-    //? AuthKey
-    //* Generates TempAuthKey for AuthKey (16 bytes)
-    uint8_t TempAuthKey[2][16];
-    for (int i = 0; i < 2; i++)
+    BlockPart* Part = Arg;
+    switch (Part->Job)
     {
-        //^ Endian Dependent
-        //! Neither endian's in this func are tested
-        //* Should be little endian
-        // ((uint32_t*) TempAuthKey[i])[0] = i;
-        TempAuthKey[i][0] = i;
-        TempAuthKey[i][1] = 0;
-        TempAuthKey[i][2] = 0;
-        TempAuthKey[i][3] = 0;
-
-
-        //* Rest is IV
-        for (int j = 0; j < 12; j++)
-            TempAuthKey[i][j+4] =  IV[j];
+        case block_job_ecb_enc:
+            encrypt_blocks(Part->Ctx, Part->In, Part->Out, Part->Blocks);
+            break;
+        case block_job_ecb_dec:
+            decrypt_blocks(Part->Ctx, Part->In, Part->Out, Part->Blocks);
+            break;
+        case block_job_cbc_dec:
+            cbc_dec_blocks(Part->Ctx, Part->In, Part->Out, Part->Blocks, Part->Prev);
+            break;
     }
+    return;
+}
+
+static void cbc_dec_blocks(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks, const uint8_t* Prev)
+{
+    uint8_t Chain[16];
+    uint8_t Chunk[CTR_BLOCKS*16];
+    memcpy(Chain, Prev, 16);
 
-    //* Encrypts each block in TempAuthKey
-    for (int i = 0; i < 2; i++)
+    for (size_t i = 0; i < Blocks; i += CTR_BLOCKS)
     {
-        ErrorCode TempError = aes_std_enc(TempAuthKey[i], MasterKey);
-        if (TempError != success)
-            return TempError;
+        size_t Len = ((Blocks - i < CTR_BLOCKS) ? Blocks - i : CTR_BLOCKS) * 16;
+
+        //* Keep the Ciphertext chunk, decrypt it (interleaved), then XOR each block with the one before it.
+        memcpy(Chunk, In + i*16, Len);
+        decrypt_blocks(Ctx, Chunk, Out + i*16, Len/16);
+        xor_bytes(Out + i*16, Chain, 16);
+        xor_bytes(Out + i*16 + 16, Chunk, Len - 16);
+        memcpy(Chain, Chunk + Len - 16, 16);
     }
+    return;
+}
 
-    //* Assigns the first 8 bytes of TempAuthKey[i] to AuthKey (16 bytes)
-    for (int i = 0; i < 2; i++)
-        for (int j = 0; j < 8; j++)
-            AuthKey[i*8+j] = TempAuthKey[i][j];
+static void cbc_lane_start(CBCLane* Lane, uint8_t* Chain, AESCBCJob* Job)
+{
+    uint8_t PadByte = 16 - (Job->Size%16);
+    size_t Tail = Job->Size - (Job->Size%16);
+    for (size_t i = 0; i < Job->Size%16; i++)
+        Lane->Last[i] = Job->Plaintext[Tail + i];
+    for (size_t i = Job->Size%16; i < 16; i++)
+        Lane->Last[i] = PadByte;
+    memcpy(Chain, Job->IV, 16);
+
+    Lane->Ctx = Job->Ctx;
+    Lane->In = Job->Plaintext;
+    Lane->Out = Job->Out;
+    Lane->Blocks = Tail/16;
+    Lane->Padded = (Lane->Blocks == 0);
+    if (Lane->Padded)
+        Lane->Blocks = 1;
+    Job->OutSize = Tail + 16;
+    return;
+}
 
+static void cbc_enc_lanes(const AESKey* const* Keys, uint8_t (*Chain)[16], const uint8_t* const* In, uint8_t* const* Out, int Lanes, size_t Blocks)
+{
+    bool AllNI = true, AllTTable = true;
+    for (int l = 0; l < Lanes; l++)
+    {
+        AllNI &= (Keys[l]->Backend == aes_backend_aesni);
+        AllTTable &= (Keys[l]->Backend == aes_backend_ttable);
+    }
 
-    //? EncKey
-    //* Generates TempEncKey for EncKey (32 bytes)
-    uint8_t TempEncKey[4][16];
-    for (int i = 0; i < 4; i++)
+#ifdef CPU_X86_SIMD
+    if (AllNI)
+    {
+        aes_ni_cbc_enc_lanes(Keys, Chain, In, Out, Lanes, Blocks);
+        return;
+    }
+#endif
+    if (AllTTable)
     {
-        //^ Endian Dependent
-        //* Should be little endian
-        // ((uint32_t*) TempEncKey[i])[0] = i+2;
-        TempEncKey[i][0] = i+2;
-        TempEncKey[i][1] = 0;
-        TempEncKey[i][2] = 0;
-        TempEncKey[i][3] = 0;
-
-
-        //* Rest is IV
-        for (int j = 0; j < 12; j++)
-            TempEncKey[i][j+4] =  IV[j];
+        aes_ttable_cbc_enc_lanes(Keys, Chain, In, Out, Lanes, Blocks);
+        return;
     }
 
-    //* Encrypts each block in TempEncKey
-    for (int i = 0; i < 4; i++)
+    //* Mixed or single-block backends, one lane at a time.
+    for (int l = 0; l < Lanes; l++)
     {
-        ErrorCode TempError = aes_std_enc(TempEncKey[i], MasterKey);
-        if (TempError != success)
-            return TempError;
+        for (size_t b = 0; b < Blocks; b++)
+        {
+            xor_bytes(Chain[l], In[l] + b*16, 16);
+            encrypt_blocks(Keys[l], Chain[l], Chain[l], 1);
+            memcpy(Out[l] + b*16, Chain[l], 16);
+        }
     }
-    
-    //* Assigns the first 8 bytes of TempEncKey[i] to EncKey (32 bytes)
-    for (int i = 0; i < 4; i++)
-        for (int j = 0; j < 8; j++)
-            EncKey[i*8+j] = TempEncKey[i][j];
-    
+    return;
+}
+
+static void cbc_enc_blocks(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks, uint8_t* Chain)
+{
+    cbc_enc_lanes(&Ctx, (uint8_t (*)[16]) Chain, &In, &Out, 1, Blocks);
+    return;
+}
+
+static ErrorCode pkcs7_unpad(const uint8_t* Data, size_t Size, size_t* OutSize)
+{
+    //* Every padding byte must equal the padding length (1 to 16).
+    uint8_t PadByte = Data[Size - 1];
+    if (PadByte == 0 || PadByte > 16)
+        return unknown_error;
+    for (size_t i = Size - PadByte; i < Size; i++)
+        if (Data[i] != PadByte)
+            return unknown_error;
+
+    *OutSize = Size - PadByte;
     return success;
 }
 
-static void polyval(const uint8_t* H, const uint8_t* Block, size_t Size, uint8_t* Output)
+static void gcm_counter_add(uint8_t* CB, const uint8_t* ICB, uint64_t Blocks)
+{
+    uint32_t Counter = ((uint32_t) ICB[12] << 24) | ((uint32_t) ICB[13] << 16) | ((uint32_t) ICB[14] << 8) | ICB[15];
+    Counter += (uint32_t) Blocks;
+    for (int i = 0; i < 12; i++)
+        CB[i] = ICB[i];
+    CB[12] = Counter >> 24;
+    CB[13] = Counter >> 16;
+    CB[14] = Counter >> 8;
+    CB[15] = Counter;
+    return;
+}
+
+static void gcm_run(const AESGCMKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Size, const uint8_t* ICB, uint8_t* Hash, GCMJob Job)
 {
-    //* Dot Constant (Little Endian)
-    //* Dot (X,Y) = X*Y*Dot;
-    const uint8_t Dot[16] = {0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x92};
+    GCMPart Parts[THREAD_MAX];
+    unsigned Count = thread_parts(Size);
 
-    for (size_t i = 0; i < (Size>>4); i++)
+    size_t PartSize = thread_part_size(Size, Count);
+    size_t Offset = 0;
+    for (unsigned i = 0; i < Count; i++)
     {
+        GCMPart* Part = &Parts[i];
+        Part->Ctx = Ctx;
+        Part->In = In + Offset;
+        Part->Out = (Out != NULL) ? Out + Offset : NULL;
+        Part->Size = (i + 1 == Count) ? Size - Offset : PartSize;
+        Part->Job = Job;
+        gcm_counter_add(Part->ICB, ICB, Offset / 16);
         for (int j = 0; j < 16; j++)
-            Output[j] ^= Block[i*16+j];
-        sblockmul(Output, H, Output);
-        sblockmul(Output, Dot, Output);
+            Part->Hash[j] = (Count == 1 && Hash != NULL) ? Hash[j] : 0;
+        Offset += Part->Size;
     }
-    
-    //* If final Block is incomplete, pad with 0's first
-    if (Size % 16 != 0)
+
+    if (Count == 1)
+        gcm_part(&Parts[0]);
+    else
+        thread_run(gcm_part, Parts, sizeof(GCMPart), Count);
+
+    //* Hash = Hash * H^Blocks ^ Part for each range in order, the same as hashing the ranges in one run.
+    if (Job != gcm_job_ctr)
     {
-        for (size_t j = 0; j < Size%16; j++)
-            Output[j] ^= Block[Size-(Size%16)+j];
-        for (int j = Size%16; j < 16; j++)
-                    Output[j] ^= 0;
-        //* Dot (X, Y) = (X * Y * Dot)
-        sblockmul(Output, H, Output);
-        sblockmul(Output, Dot, Output);
+        if (Count == 1)
+            for (int j = 0; j < 16; j++)
+                Hash[j] = Parts[0].Hash[j];
+        else
+            for (unsigned i = 0; i < Count; i++)
+                ghash_combine(&Ctx->Hash, Hash, Parts[i].Hash, (Parts[i].Size + 15) / 16);
     }
-    
+    return;
+}
+
+static void gcm_part(void* Arg)
+{
+    GCMPart* Part = Arg;
+    switch (Part->Job)
+    {
+        case gcm_job_encrypt:
+            gcm_stitch(Part->Ctx, Part->In, Part->Out, Part->Size, Part->ICB, Part->Hash, true);
+            break;
+        case gcm_job_decrypt:
+            gcm_stitch(Part->Ctx, Part->In, Part->Out, Part->Size, Part->ICB, Part->Hash, false);
+            break;
+        case gcm_job_hash:
+            ghash_update(&Part->Ctx->Hash, Part->Hash, Part->In, Part->Size);
+            break;
+        case gcm_job_ctr:
+            if (Part->Out != Part->In)
+                memcpy(Part->Out, Part->In, Part->Size);
+            ctr_xor(Part->Out, Part->Size, &Part->Ctx->Cipher, aes_counter_gcm, Part->ICB);
+            break;
+    }
+    return;
+}
+
+static unsigned thread_parts(size_t Size)
+{
+    if (Threads <= 1 || Size < ThreadThreshold)
+        return 1;
+
+    //* Never hand a thread less than THREAD_MIN_PART bytes.
+    size_t Max = Size / THREAD_MIN_PART;
+    if (Max < 1)
+        return 1;
+    return (Max < Threads) ? (unsigned) Max : Threads;
+}
+
+static size_t thread_part_size(size_t Size, unsigned Count)
+{
+    //* Every range but the last is a whole number of blocks, so its counters and hash blocks line up.
+    return ((Size / Count) + 15) & ~(size_t) 15;
 }
 
-static void sblockmul(const uint8_t* X, const uint8_t* Y, uint8_t* Result)
+static void gcm_stream_absorb(AESGCMStream* Ctx, const uint8_t* Data, size_t Size)
 {
-    //* X and Y are Little-Endian
-    //* They are currently read from bit order high to low (left to right) 89ABCDEF 01234567
-    //* Change that to be from bit order low to high (right to left)       FEDCBA98 76543210
-    uint8_t XCpy[16];
-    uint8_t YCpy[16];
-    for (int i = 0 ; i < 16; i++)
+    size_t i = 0;
+    if (Ctx->BufSize != 0)
     {
-        XCpy[i] = X[i];
-        YCpy[i] = Y[i];
-        Result[i] = 0;
+        for (; i < Size && Ctx->BufSize < 16; i++)
+            Ctx->Buffer[Ctx->BufSize++] = Data[i];
+        if (Ctx->BufSize < 16)
+            return;
+        ghash_update(&Ctx->Key->Hash, Ctx->Hash, Ctx->Buffer, 16);
+        Ctx->BufSize = 0;
     }
 
-    for (int i = 0; i < 128; i++)
+    size_t Whole = (Size - i) & ~(size_t) 15;
+    ghash_update(&Ctx->Key->Hash, Ctx->Hash, Data + i, Whole);
+    for (i += Whole; i < Size; i++)
+        Ctx->Buffer[Ctx->BufSize++] = Data[i];
+    return;
+}
+
+static void gcm_stream_start_data(AESGCMStream* Ctx)
+{
+    if (Ctx->DataStarted)
+        return;
+
+    //* AAD is zero padded to a whole block before the data (ghash_update() pads a partial block).
+    ghash_update(&Ctx->Key->Hash, Ctx->Hash, Ctx->Buffer, Ctx->BufSize);
+    Ctx->BufSize = 0;
+    Ctx->DataStarted = true;
+    return;
+}
+
+static void gcm_stream_tag(AESGCMStream* Ctx, uint8_t* Tag)
+{
+    gcm_stream_start_data(Ctx);
+    ghash_update(&Ctx->Key->Hash, Ctx->Hash, Ctx->Buffer, Ctx->BufSize);
+
+    uint8_t LenBuf[16];
+    gcm_length_block(Ctx->ASize, Ctx->Size, LenBuf);
+    ghash_update(&Ctx->Key->Hash, Ctx->Hash, LenBuf, 16);
+
+    //* Encrypt Hash with Key (Tag)
+    for (int i = 0; i < 16; i++)
+        Tag[i] = Ctx->Hash[i];
+    gctr(Tag, 16, &Ctx->Key->Cipher, Ctx->J);
+    wipe_bytes(Ctx, sizeof(AESGCMStream));
+    return;
+}
+
+static bool gcm_tag_equal(const uint8_t* Tag, const uint8_t* Hash)
+{
+    //* Constant time, every byte is compared.
+    uint8_t Diff = 0;
+    for (int i = 0; i < 16; i++)
+        Diff |= Tag[i] ^ Hash[i];
+    return Diff == 0;
+}
+
+static ErrorCode gcm_batch(const AESGCMKey* Ctx, AESAEADJob* Jobs, size_t Count, bool Encrypt)
+{
+    uint8_t Masks[AES_BATCH_BLOCKS][16];
+    ErrorCode Result = success;
+    for (size_t First = 0; First < Count; First += AES_BATCH_BLOCKS)
     {
-        //* BitArr is depedent, double check math on BitArr. Currently pulls Little-Endian, left to right (76543210)
-        if (SIVBITARR(YCpy, i) == 1)
-            for (int i = 0 ; i < 16; i++)
-                Result[i] ^= XCpy[i];
-
-        //* BitArr is dependent, Shift is depedent
-        if (SIVBITARR(XCpy, 127) == 0)
-        {            
-            // Bigger bits -> Smaller bits
-            // x[14] -> x[15]
-            // x[15] = (x[14] & 1) ++ (X[15] >> 1) = aaaaaaa(a) ++ (bbbbbbb)b = abbbbbbb
-
-            // FEDCBA98 76543210 -> EDCBA98_ 6543210F
-            // Bigger bits -> Smaller bits
-            // x[14] -> x[15]
-            // x[15] = (x[15] << 1) ++ (x[14] & 0x80) = (bbbbbbb)b + (a)aaaaaaa = bbbbbbba 
-            for (int i = 15; i > 0; i--)
-                XCpy[i] = ((XCpy[i]) << 1) | (XCpy[i-1] >> 7);
-            XCpy[0] = (XCpy[0] << 1);
+        size_t Group = (Count - First < AES_BATCH_BLOCKS) ? Count - First : AES_BATCH_BLOCKS;
+
+        //* E(J) masks every Tag. One block per message is all latency, so they are encrypted together in one pass.
+        for (size_t i = 0; i < Group; i++)
+        {
+            memcpy(Masks[i], Jobs[First + i].IV, 12);
+            Masks[i][12] = 0;
+            Masks[i][13] = 0;
+            Masks[i][14] = 0;
+            Masks[i][15] = 1;
         }
-        else
+        encrypt_blocks(&Ctx->Cipher, Masks[0], Masks[0], Group);
+
+        for (size_t i = 0; i < Group; i++)
         {
-            for (int i = 15; i > 0; i--)
-                XCpy[i] = ((XCpy[i]) << 1) | (XCpy[i-1] >> 7);
-            XCpy[0] = (XCpy[0] << 1);
-            
-            //* V ^= R
-            //! Endian-ness accounted for, and bit order.
-            XCpy[15] ^= 0b11000010;
-            XCpy[0]  ^= 0b00000001;
+            AESAEADJob* Job = &Jobs[First + i];
+            const uint8_t* IV = Job->IV;
+            uint8_t JInc[16] = {IV[0],IV[1],IV[2],IV[3],IV[4],IV[5],IV[6],IV[7],IV[8],IV[9],IV[10],IV[11],0,0,0,2};
+            uint8_t Hash[16] = {0};
+            uint8_t LenBuf[16];
+            gcm_length_block(Job->ASize, Job->Size, LenBuf);
+
+            //* CTR and GHASH stitched (and threaded when large enough), as in aes_gcm_dec_into_ctx().
+            ghash_update(&Ctx->Hash, Hash, Job->AAD, Job->ASize);
+            gcm_run(Ctx, Job->In, Job->Out, Job->Size, JInc, Hash, Encrypt ? gcm_job_encrypt : gcm_job_decrypt);
+            ghash_update(&Ctx->Hash, Hash, LenBuf, 16);
+            xor_bytes(Hash, Masks[i], 16);
+
+            Job->Result = success;
+            if (Encrypt)
+                memcpy(Job->Tag, Hash, 16);
+            else if (!gcm_tag_equal(Job->Tag, Hash))
+            {
+                memset(Job->Out, 0, Job->Size);
+                Job->Result = unknown_error;
+                Result = unknown_error;
+            }
         }
     }
-    return;
+    return Result;
 }
 
-static ErrorCode sivctr(uint8_t* Plaintext, size_t Size, const uint8_t* Key, const uint8_t* IV)
+static ErrorCode siv_batch(const AESKey* Ctx, AESAEADJob* Jobs, size_t Count, bool Encrypt)
 {
-    //* Setup CtrBlock and StreamBlock
-    uint8_t CtrBlock[16] = {IV[0], IV[1], IV[2], IV[3], IV[4], IV[5], IV[6], IV[7], IV[8], IV[9], IV[10], IV[11], IV[12], IV[13], IV[14], IV[15]};
-    uint8_t StreamBlock[16];
+    ErrorCode Result = success;
+    for (size_t First = 0; First < Count; First += AES_LANES)
+    {
+        int Lanes = (Count - First < AES_LANES) ? (int) (Count - First) : AES_LANES;
+        AESKey EncCtx[AES_LANES];
+        const AESKey* Keys[AES_LANES];
+        uint8_t Hash[AES_LANES][16];
+        const uint8_t* In[AES_LANES];
+        uint8_t* Out[AES_LANES];
+
+        //* Every message has its own keys, derived for the whole group in one pass.
+        const uint8_t* IVs[AES_LANES];
+        uint8_t EncKeys[AES_LANES*32];
+        uint8_t AuthKeys[AES_LANES*16];
+        for (int l = 0; l < Lanes; l++)
+            IVs[l] = Jobs[First + l].IV;
+        siv_derive_keys_batch(Ctx, IVs, Lanes, EncKeys, AuthKeys);
+
+        //* Expand every lane's keys before anything is written, so a setup error never leaves unauthenticated output behind.
+        GHashKey AuthHash[AES_LANES];
+        for (int l = 0; l < Lanes; l++)
+        {
+            ErrorCode TempError = aes_key_init(&EncCtx[l], EncKeys + l*32);
+            if (TempError == success)
+            {
+                TempError = polyval_key_init(&AuthHash[l], AuthKeys + l*16);
+                if (TempError != success)
+                    aes_key_clear(&EncCtx[l]);
+            }
+            if (TempError != success)
+            {
+                for (int k = 0; k < l; k++)
+                {
+                    aes_key_clear(&EncCtx[k]);
+                    ghash_key_clear(&AuthHash[k]);
+                }
+                wipe_bytes(EncKeys, sizeof(EncKeys));
+                wipe_bytes(AuthKeys, sizeof(AuthKeys));
+
+                //* Earlier groups are finished and checked, every message from this group on fails with TempError.
+                for (size_t i = First; i < Count; i++)
+                {
+                    if (!Encrypt)
+                        memset(Jobs[i].Out, 0, Jobs[i].Size);
+                    Jobs[i].Result = TempError;
+                }
+                return TempError;
+            }
+        }
 
-    for (int i = 0; i < Size/16; i++)
+        //* Decrypt (open), then POLYVAL the Plaintext.
+        for (int l = 0; l < Lanes; l++)
+        {
+            AESAEADJob* Job = &Jobs[First + l];
+            uint64_t LenBlock[2] = {(Job->ASize<<3), (Job->Size<<3)};
+            memset(Hash[l], 0, 16);
+            polyval_update(&AuthHash[l], Hash[l], Job->AAD, Job->ASize);
+            if (Encrypt)
+                siv_run(&EncCtx[l], &AuthHash[l], Job->In, NULL, Job->Size, NULL, Hash[l], siv_job_hash);
+            else
+            {
+                //* Opening counts from the received Tag, so each piece is decrypted, then hashed while still in L1.
+                const uint8_t* Tag = Job->Tag;
+                uint8_t ICB[16] = {Tag[0], Tag[1], Tag[2], Tag[3], Tag[4], Tag[5], Tag[6], Tag[7], Tag[8], Tag[9], Tag[10], Tag[11], Tag[12], Tag[13], Tag[14], (Tag[15] | 0x80)};
+                siv_run(&EncCtx[l], &AuthHash[l], Job->In, Job->Out, Job->Size, ICB, Hash[l], siv_job_decrypt);
+            }
+            polyval_update(&AuthHash[l], Hash[l], ((uint8_t*) LenBlock), 16);
+            ghash_key_clear(&AuthHash[l]);
+
+            //* Xor first 12 bytes with IV and clear MSB of the last byte, the encryption is shared below.
+            for (int i = 0; i < 12; i++)
+                Hash[l][i] ^= Job->IV[i];
+            Hash[l][15] &= 0x7F;
+            Keys[l] = &EncCtx[l];
+            In[l] = Hash[l];
+            Out[l] = Hash[l];
+        }
+
+        //* One Tag block per lane. With a zero chain, a CBC lane is a single AES block under that lane's key.
+        uint8_t Chain[AES_LANES][16] = {{0}};
+        cbc_enc_lanes(Keys, Chain, In, Out, Lanes, 1);
+
+        for (int l = 0; l < Lanes; l++)
+        {
+            AESAEADJob* Job = &Jobs[First + l];
+            Job->Result = success;
+            if (Encrypt)
+            {
+                const uint8_t* Tag = Hash[l];
+                uint8_t ICB[16] = {Tag[0], Tag[1], Tag[2], Tag[3], Tag[4], Tag[5], Tag[6], Tag[7], Tag[8], Tag[9], Tag[10], Tag[11], Tag[12], Tag[13], Tag[14], (Tag[15] | 0x80)};
+                siv_run(&EncCtx[l], NULL, Job->In, Job->Out, Job->Size, ICB, NULL, siv_job_ctr);
+                memcpy(Job->Tag, Hash[l], 16);
+            }
+            else if (!gcm_tag_equal(Job->Tag, Hash[l]))
+            {
+                memset(Job->Out, 0, Job->Size);
+                Job->Result = unknown_error;
+                Result = unknown_error;
+            }
+            aes_key_clear(&EncCtx[l]);
+        }
+        wipe_bytes(EncKeys, sizeof(EncKeys));
+        wipe_bytes(AuthKeys, sizeof(AuthKeys));
+    }
+    return Result;
+}
+
+static ErrorCode siv_message_keys(const AESKey* MasterCtx, const uint8_t* IV, AESKey* EncCtx, GHashKey* AuthHash)
+{
+    uint8_t EncKey[32];
+    uint8_t AuthKey[16];
+    siv_derive_keys(MasterCtx, IV, EncKey, AuthKey);
+    ErrorCode TempError = aes_key_init(EncCtx, EncKey);
+    if (TempError == success)
     {
-        //* Gen StreamBlock
-        for (int j = 0; j < 16; j++)
-            StreamBlock[j] = CtrBlock[j];
-        ErrorCode TempError = aes_std_enc(StreamBlock, Key);
+        TempError = polyval_key_init(AuthHash, AuthKey);
         if (TempError != success)
-            return TempError;
+            aes_key_clear(EncCtx);
+    }
+
+    //* Only the expanded keys are kept.
+    wipe_bytes(EncKey, sizeof(EncKey));
+    wipe_bytes(AuthKey, sizeof(AuthKey));
+    return TempError;
+}
 
-        //* Increment CtrBlock (First 4 bytes as uint32_t LE)
-        ((uint32_t*) CtrBlock)[0]++;
+static void siv_derive_keys(const AESKey* MasterCtx, const uint8_t* IV, uint8_t* EncKey, uint8_t* AuthKey)
+{
+    siv_derive_keys_batch(MasterCtx, &IV, 1, EncKey, AuthKey);
+    return;
+}
+
+static void siv_derive_keys_batch(const AESKey* MasterCtx, const uint8_t* const* IVs, int Count, uint8_t* EncKeys, uint8_t* AuthKeys)
+{
+    //* Per nonce, blocks 0-1 make AuthKey and 2-5 EncKey: a 32-bit little endian index, then the IV.
+    uint8_t Blocks[AES_LANES*6][16];
+    for (int n = 0; n < Count; n++)
+    {
+        for (int i = 0; i < 6; i++)
+        {
+            uint8_t* Block = Blocks[n*6 + i];
+            Block[0] = i;
+            Block[1] = 0;
+            Block[2] = 0;
+            Block[3] = 0;
+            memcpy(Block + 4, IVs[n], 12);
+        }
+    }
+
+    //* The blocks are independent: one pass keeps the backend's pipeline full (8 in flight with AES-NI or bitslice)
+    //* instead of one serial block at a time.
+    encrypt_blocks(MasterCtx, Blocks[0], Blocks[0], (size_t) Count*6);
+
+    //* Only the first 8 bytes of each block are kept.
+    for (int n = 0; n < Count; n++)
+    {
+        for (int i = 0; i < 2; i++)
+            memcpy(AuthKeys + n*16 + i*8, Blocks[n*6 + i], 8);
+        for (int i = 0; i < 4; i++)
+            memcpy(EncKeys + n*32 + i*8, Blocks[n*6 + 2 + i], 8);
+    }
+    wipe_bytes(Blocks, sizeof(Blocks));
+    return;
+}
+
+static void siv_tag(const AESKey* EncCtx, uint8_t* Hash, const uint8_t* IV)
+{
+    //* Xor first 12 bytes with IV, clear MSB of the last byte, then encrypt.
+    for (int i = 0; i < 12; i++)
+        Hash[i] ^= IV[i];
+    Hash[15] &= 0x7F;
+    encrypt_block(Hash, EncCtx);
+    return;
+}
+
+static void sivctr(uint8_t* Plaintext, size_t Size, const AESKey* Ctx, const uint8_t* IV)
+{
+    ctr_xor(Plaintext, Size, Ctx, aes_counter_siv, IV);
+    return;
+}
+
+static void siv_counter_add(uint8_t* CB, const uint8_t* ICB, uint64_t Blocks)
+{
+    uint32_t Counter = (uint32_t) ICB[0] | ((uint32_t) ICB[1] << 8) | ((uint32_t) ICB[2] << 16) | ((uint32_t) ICB[3] << 24);
+    Counter += (uint32_t) Blocks;
+    CB[0] = Counter;
+    CB[1] = Counter >> 8;
+    CB[2] = Counter >> 16;
+    CB[3] = Counter >> 24;
+    for (int i = 4; i < 16; i++)
+        CB[i] = ICB[i];
+    return;
+}
+
+static void siv_stitch(const AESKey* Cipher, const GHashKey* Auth, const uint8_t* In, uint8_t* Out, size_t Size, const uint8_t* ICB, uint8_t* Y)
+{
+    //* Each chunk is read from memory once: CTR, then POLYVAL on the Plaintext while it is still in L1.
+    uint8_t CB[16];
+    for (size_t i = 0; i < Size; i += GCM_STITCH_SIZE)
+    {
+        size_t Len = (Size - i < GCM_STITCH_SIZE) ? Size - i : GCM_STITCH_SIZE;
+        siv_counter_add(CB, ICB, i / 16);
+        if (Out != In)
+            memcpy(Out + i, In + i, Len);
+        sivctr(Out + i, Len, Cipher, CB);
+        polyval_update(Auth, Y, Out + i, Len);
+    }
+    return;
+}
 
-        //* Encrypt Plaintext
+static void siv_run(const AESKey* Cipher, const GHashKey* Auth, const uint8_t* In, uint8_t* Out, size_t Size, const uint8_t* ICB, uint8_t* Y, SIVJob Job)
+{
+    SIVPart Parts[THREAD_MAX];
+    unsigned Count = thread_parts(Size);
+
+    size_t PartSize = thread_part_size(Size, Count);
+    size_t Offset = 0;
+    for (unsigned i = 0; i < Count; i++)
+    {
+        SIVPart* Part = &Parts[i];
+        Part->Cipher = Cipher;
+        Part->Auth = Auth;
+        Part->In = In + Offset;
+        Part->Out = (Out != NULL) ? Out + Offset : NULL;
+        Part->Size = (i + 1 == Count) ? Size - Offset : PartSize;
+        Part->Job = Job;
+        if (ICB != NULL)
+            siv_counter_add(Part->ICB, ICB, Offset / 16);
         for (int j = 0; j < 16; j++)
-            Plaintext[i*16+j] ^= StreamBlock[j];
+            Part->Y[j] = (Count == 1 && Y != NULL) ? Y[j] : 0;
+        Offset += Part->Size;
     }
-    //* Gen StreamBlock
-    for (int j = 0; j < 16; j++)
-        StreamBlock[j] = CtrBlock[j];
-    ErrorCode TempError = aes_std_enc(StreamBlock, Key);
-    if (TempError != success)
-        return TempError;
 
-    //* Encrypt Plaintext (Incomplete block)
-    for (size_t j = 0; j < Size%16; j++)
-        Plaintext[Size-(Size%16)+j] ^= StreamBlock[j];
+    if (Count == 1)
+        siv_part(&Parts[0]);
+    else
+        thread_run(siv_part, Parts, sizeof(SIVPart), Count);
 
-    return success;
+    //* Y = Y * H^Blocks ^ Part for each range in order, the same as hashing the ranges in one run.
+    if (Job != siv_job_ctr)
+    {
+        if (Count == 1)
+            for (int j = 0; j < 16; j++)
+                Y[j] = Parts[0].Y[j];
+        else
+            for (unsigned i = 0; i < Count; i++)
+                polyval_combine(Auth, Y, Parts[i].Y, (Parts[i].Size + 15) / 16);
+    }
+    return;
+}
+
+static void siv_part(void* Arg)
+{
+    SIVPart* Part = Arg;
+    switch (Part->Job)
+    {
+        case siv_job_hash:
+            polyval_update(Part->Auth, Part->Y, Part->In, Part->Size);
+            break;
+        case siv_job_ctr:
+            if (Part->Out != Part->In)
+                memcpy(Part->Out, Part->In, Part->Size);
+            sivctr(Part->Out, Part->Size, Part->Cipher, Part->ICB);
+            break;
+        case siv_job_decrypt:
+            siv_stitch(Part->Cipher, Part->Auth, Part->In, Part->Out, Part->Size, Part->ICB, Part->Y);
+            break;
+    }
+    return;
+}
+
+static bool backend_supported(AESBackend Backend)
+{
+    switch (Backend)
+    {
+        case aes_backend_bytewise:
+        case aes_backend_ttable:
+        case aes_backend_bitslice:
+            return true;
+#ifdef CPU_X86_SIMD
+        case aes_backend_aesni:
+            return cpu_has_aesni();
+        case aes_backend_vperm:
+            return cpu_has_ssse3();
+#endif
+        default:
+            return false;
+    }
+}
+
+static AESBackend best_backend(void)
+{
+    if (backend_supported(aes_backend_aesni))
+        return aes_backend_aesni;
+    if (backend_supported(aes_backend_vperm))
+        return aes_backend_vperm;
+    return aes_backend_ttable;
 }
 
 static uint8_t sbox_func(uint8_t Byte)
@@ -1063,3 +2271,16 @@ void init_inv_sbox()
         InvSBox[i] = inv_sbox_func(i);
     return;
 }
+
+static void init_tables(void)
+{
+    init_sbox();
+    init_inv_sbox();
+    aes_ttable_init(SBox, InvSBox);
+#ifdef CPU_X86_SIMD
+    if (cpu_has_ssse3())
+        aes_vperm_init();
+#endif
+    AutoBackend = best_backend();
+    return;
+}
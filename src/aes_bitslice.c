@@ -0,0 +1,559 @@
+#include "../include/aes_backend.h"
+
+//* Bitsliced AES-256: 4 blocks are spread over 8 uint64_t bit planes (q[0] holds bit 0 of every byte),
+//* and two such sets are processed together for 8 blocks per call. SubBytes is a Boolean circuit,
+//* so no memory access ever depends on secret data.
+
+#define LOAD32LE(x) ((uint32_t) (x)[0] | ((uint32_t) (x)[1] << 8) | ((uint32_t) (x)[2] << 16) | ((uint32_t) (x)[3] << 24))
+#define STORE32LE(x, v) do { (x)[0] = (v); (x)[1] = (v) >> 8; (x)[2] = (v) >> 16; (x)[3] = (v) >> 24; } while (0)
+
+/// @brief Swaps the bits selected by Low in X with the bits selected by High in Y (shifted by Shift).
+#define SWAPN(Low, High, Shift, X, Y) do { \
+    uint64_t A = (X), B = (Y); \
+    (X) = (A & (uint64_t) (Low)) | ((B & (uint64_t) (Low)) << (Shift)); \
+    (Y) = ((A & (uint64_t) (High)) >> (Shift)) | (B & (uint64_t) (High)); \
+} while (0)
+#define SWAP2(X, Y) SWAPN(0x5555555555555555, 0xAAAAAAAAAAAAAAAA, 1, X, Y)
+#define SWAP4(X, Y) SWAPN(0x3333333333333333, 0xCCCCCCCCCCCCCCCC, 2, X, Y)
+#define SWAP8(X, Y) SWAPN(0x0F0F0F0F0F0F0F0F, 0xF0F0F0F0F0F0F0F0, 4, X, Y)
+
+
+//? Layout functions
+
+/// @brief Transposes q[8] between byte order and bit planes (its own inverse).
+static void ortho(uint64_t* q)
+{
+    SWAP2(q[0], q[1]);
+    SWAP2(q[2], q[3]);
+    SWAP2(q[4], q[5]);
+    SWAP2(q[6], q[7]);
+
+    SWAP4(q[0], q[2]);
+    SWAP4(q[1], q[3]);
+    SWAP4(q[4], q[6]);
+    SWAP4(q[5], q[7]);
+
+    SWAP8(q[0], q[4]);
+    SWAP8(q[1], q[5]);
+    SWAP8(q[2], q[6]);
+    SWAP8(q[3], q[7]);
+    return;
+}
+
+/// @brief Spreads the 4 little endian words of one block over two 64-bit words (16 bits per column).
+static void interleave_in(uint64_t* Q0, uint64_t* Q1, const uint32_t* W)
+{
+    uint64_t X0 = W[0], X1 = W[1], X2 = W[2], X3 = W[3];
+    X0 |= (X0 << 16);
+    X1 |= (X1 << 16);
+    X2 |= (X2 << 16);
+    X3 |= (X3 << 16);
+    X0 &= (uint64_t) 0x0000FFFF0000FFFF;
+    X1 &= (uint64_t) 0x0000FFFF0000FFFF;
+    X2 &= (uint64_t) 0x0000FFFF0000FFFF;
+    X3 &= (uint64_t) 0x0000FFFF0000FFFF;
+    X0 |= (X0 << 8);
+    X1 |= (X1 << 8);
+    X2 |= (X2 << 8);
+    X3 |= (X3 << 8);
+    X0 &= (uint64_t) 0x00FF00FF00FF00FF;
+    X1 &= (uint64_t) 0x00FF00FF00FF00FF;
+    X2 &= (uint64_t) 0x00FF00FF00FF00FF;
+    X3 &= (uint64_t) 0x00FF00FF00FF00FF;
+    *Q0 = X0 | (X2 << 8);
+    *Q1 = X1 | (X3 << 8);
+    return;
+}
+
+/// @brief Inverse of interleave_in().
+static void interleave_out(uint32_t* W, uint64_t Q0, uint64_t Q1)
+{
+    uint64_t X0 = Q0 & (uint64_t) 0x00FF00FF00FF00FF;
+    uint64_t X1 = Q1 & (uint64_t) 0x00FF00FF00FF00FF;
+    uint64_t X2 = (Q0 >> 8) & (uint64_t) 0x00FF00FF00FF00FF;
+    uint64_t X3 = (Q1 >> 8) & (uint64_t) 0x00FF00FF00FF00FF;
+    X0 |= (X0 >> 8);
+    X1 |= (X1 >> 8);
+    X2 |= (X2 >> 8);
+    X3 |= (X3 >> 8);
+    X0 &= (uint64_t) 0x0000FFFF0000FFFF;
+    X1 &= (uint64_t) 0x0000FFFF0000FFFF;
+    X2 &= (uint64_t) 0x0000FFFF0000FFFF;
+    X3 &= (uint64_t) 0x0000FFFF0000FFFF;
+    W[0] = (uint32_t) X0 | (uint32_t) (X0 >> 16);
+    W[1] = (uint32_t) X1 | (uint32_t) (X1 >> 16);
+    W[2] = (uint32_t) X2 | (uint32_t) (X2 >> 16);
+    W[3] = (uint32_t) X3 | (uint32_t) (X3 >> 16);
+    return;
+}
+
+/// @brief Loads 4 blocks (64 bytes) into bit planes.
+static void load_four(uint64_t* q, const uint8_t* In)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        uint32_t W[4] = {LOAD32LE(In + i*16), LOAD32LE(In + i*16 + 4), LOAD32LE(In + i*16 + 8), LOAD32LE(In + i*16 + 12)};
+        interleave_in(&q[i], &q[i + 4], W);
+    }
+    ortho(q);
+    return;
+}
+
+/// @brief Stores bit planes back into 4 blocks (64 bytes).
+static void store_four(uint8_t* Out, uint64_t* q)
+{
+    ortho(q);
+    for (int i = 0; i < 4; i++)
+    {
+        uint32_t W[4];
+        interleave_out(W, q[i], q[i + 4]);
+        for (int j = 0; j < 4; j++)
+            STORE32LE(Out + i*16 + j*4, W[j]);
+    }
+    return;
+}
+
+
+//? Round functions
+
+/// @brief SubBytes on every byte of q[8] (Boyar-Peralta circuit: 32 AND, 83 XOR/XNOR).
+static void bs_sbox(uint64_t* q)
+{
+    uint64_t x0, x1, x2, x3, x4, x5, x6, x7;
+    uint64_t y1, y2, y3, y4, y5, y6, y7, y8, y9;
+    uint64_t y10, y11, y12, y13, y14, y15, y16, y17, y18, y19;
+    uint64_t y20, y21;
+    uint64_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+    uint64_t z10, z11, z12, z13, z14, z15, z16, z17;
+    uint64_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    uint64_t t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    uint64_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+    uint64_t t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    uint64_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+    uint64_t t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+    uint64_t t60, t61, t62, t63, t64, t65, t66, t67;
+    uint64_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7];
+    x1 = q[6];
+    x2 = q[5];
+    x3 = q[4];
+    x4 = q[3];
+    x5 = q[2];
+    x6 = q[1];
+    x7 = q[0];
+
+    //* Top linear transformation.
+    y14 = x3 ^ x5;
+    y13 = x0 ^ x6;
+    y9 = x0 ^ x3;
+    y8 = x0 ^ x5;
+    t0 = x1 ^ x2;
+    y1 = t0 ^ x7;
+    y4 = y1 ^ x3;
+    y12 = y13 ^ y14;
+    y2 = y1 ^ x0;
+    y5 = y1 ^ x6;
+    y3 = y5 ^ y8;
+    t1 = x4 ^ y12;
+    y15 = t1 ^ x5;
+    y20 = t1 ^ x1;
+    y6 = y15 ^ x7;
+    y10 = y15 ^ t0;
+    y11 = y20 ^ y9;
+    y7 = x7 ^ y11;
+    y17 = y10 ^ y11;
+    y19 = y10 ^ y8;
+    y16 = t0 ^ y11;
+    y21 = y13 ^ y16;
+    y18 = x0 ^ y16;
+
+    //* Non-linear section (inversion in GF(2^4)^2).
+    t2 = y12 & y15;
+    t3 = y3 & y6;
+    t4 = t3 ^ t2;
+    t5 = y4 & x7;
+    t6 = t5 ^ t2;
+    t7 = y13 & y16;
+    t8 = y5 & y1;
+    t9 = t8 ^ t7;
+    t10 = y2 & y7;
+    t11 = t10 ^ t7;
+    t12 = y9 & y11;
+    t13 = y14 & y17;
+    t14 = t13 ^ t12;
+    t15 = y8 & y10;
+    t16 = t15 ^ t12;
+    t17 = t4 ^ t14;
+    t18 = t6 ^ t16;
+    t19 = t9 ^ t14;
+    t20 = t11 ^ t16;
+    t21 = t17 ^ y20;
+    t22 = t18 ^ y19;
+    t23 = t19 ^ y21;
+    t24 = t20 ^ y18;
+
+    t25 = t21 ^ t22;
+    t26 = t21 & t23;
+    t27 = t24 ^ t26;
+    t28 = t25 & t27;
+    t29 = t28 ^ t22;
+    t30 = t23 ^ t24;
+    t31 = t22 ^ t26;
+    t32 = t31 & t30;
+    t33 = t32 ^ t24;
+    t34 = t23 ^ t33;
+    t35 = t27 ^ t33;
+    t36 = t24 & t35;
+    t37 = t36 ^ t34;
+    t38 = t27 ^ t36;
+    t39 = t29 & t38;
+    t40 = t25 ^ t39;
+
+    t41 = t40 ^ t37;
+    t42 = t29 ^ t33;
+    t43 = t29 ^ t40;
+    t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z0 = t44 & y15;
+    z1 = t37 & y6;
+    z2 = t33 & x7;
+    z3 = t43 & y16;
+    z4 = t40 & y1;
+    z5 = t29 & y7;
+    z6 = t42 & y11;
+    z7 = t45 & y17;
+    z8 = t41 & y10;
+    z9 = t44 & y12;
+    z10 = t37 & y3;
+    z11 = t33 & y4;
+    z12 = t43 & y13;
+    z13 = t40 & y5;
+    z14 = t29 & y2;
+    z15 = t42 & y9;
+    z16 = t45 & y14;
+    z17 = t41 & y8;
+
+    //* Bottom linear transformation (includes the affine constant 0x63).
+    t46 = z15 ^ z16;
+    t47 = z10 ^ z11;
+    t48 = z5 ^ z13;
+    t49 = z9 ^ z10;
+    t50 = z2 ^ z12;
+    t51 = z2 ^ z5;
+    t52 = z7 ^ z8;
+    t53 = z0 ^ z3;
+    t54 = z6 ^ z7;
+    t55 = z16 ^ z17;
+    t56 = z12 ^ t48;
+    t57 = t50 ^ t53;
+    t58 = z4 ^ t46;
+    t59 = z3 ^ t54;
+    t60 = t46 ^ t57;
+    t61 = z14 ^ t57;
+    t62 = t52 ^ t58;
+    t63 = t49 ^ t58;
+    t64 = z4 ^ t59;
+    t65 = t61 ^ t62;
+    t66 = z1 ^ t63;
+    s0 = t59 ^ t63;
+    s6 = t56 ^ ~t62;
+    s7 = t48 ^ ~t60;
+    t67 = t64 ^ t65;
+    s3 = t53 ^ t66;
+    s4 = t51 ^ t66;
+    s5 = t47 ^ t65;
+    s1 = t64 ^ ~s3;
+    s2 = t55 ^ ~t67;
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+    return;
+}
+
+/// @brief Applies the inverse affine map (x ROTL 1 ^ x ROTL 3 ^ x ROTL 6 ^ 0x05) to every byte of q[8].
+static void bs_inv_affine(uint64_t* q)
+{
+    uint64_t p[8];
+    for (int i = 0; i < 8; i++)
+        p[i] = q[i];
+    for (int i = 0; i < 8; i++)
+        q[i] = p[(i + 7) & 7] ^ p[(i + 5) & 7] ^ p[(i + 2) & 7];
+    q[0] = ~q[0];
+    q[2] = ~q[2];
+    return;
+}
+
+/// @brief InvSubBytes on every byte of q[8], reusing the forward circuit: InvS(x) = A^-1(S(A^-1(x))).
+static void bs_inv_sbox(uint64_t* q)
+{
+    bs_inv_affine(q);
+    bs_sbox(q);
+    bs_inv_affine(q);
+    return;
+}
+
+/// @brief ShiftRows on every plane (each row is 16 bits: 4 columns of 4 blocks).
+static void bs_shift_rows(uint64_t* q)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        uint64_t x = q[i];
+        q[i] = (x & (uint64_t) 0x000000000000FFFF)
+            | ((x & (uint64_t) 0x00000000FFF00000) >> 4)
+            | ((x & (uint64_t) 0x00000000000F0000) << 12)
+            | ((x & (uint64_t) 0x0000FF0000000000) >> 8)
+            | ((x & (uint64_t) 0x000000FF00000000) << 8)
+            | ((x & (uint64_t) 0xF000000000000000) >> 12)
+            | ((x & (uint64_t) 0x0FFF000000000000) << 4);
+    }
+    return;
+}
+
+/// @brief Inverse of bs_shift_rows().
+static void bs_inv_shift_rows(uint64_t* q)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        uint64_t x = q[i];
+        q[i] = (x & (uint64_t) 0x000000000000FFFF)
+            | ((x & (uint64_t) 0x000000000FFF0000) << 4)
+            | ((x & (uint64_t) 0x00000000F0000000) >> 12)
+            | ((x & (uint64_t) 0x000000FF00000000) << 8)
+            | ((x & (uint64_t) 0x0000FF0000000000) >> 8)
+            | ((x & (uint64_t) 0x000F000000000000) << 12)
+            | ((x & (uint64_t) 0xFFF0000000000000) >> 4);
+    }
+    return;
+}
+
+/// @brief Rotates a plane by 2 rows (32 bits).
+static uint64_t rotr32(uint64_t x)
+{
+    return (x << 32) | (x >> 32);
+}
+
+/// @brief MixColumns on every column (rows are rotated with 16-bit rotations).
+static void bs_mix_columns(uint64_t* q)
+{
+    uint64_t q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3], q4 = q[4], q5 = q[5], q6 = q[6], q7 = q[7];
+    uint64_t r0 = (q0 >> 16) | (q0 << 48);
+    uint64_t r1 = (q1 >> 16) | (q1 << 48);
+    uint64_t r2 = (q2 >> 16) | (q2 << 48);
+    uint64_t r3 = (q3 >> 16) | (q3 << 48);
+    uint64_t r4 = (q4 >> 16) | (q4 << 48);
+    uint64_t r5 = (q5 >> 16) | (q5 << 48);
+    uint64_t r6 = (q6 >> 16) | (q6 << 48);
+    uint64_t r7 = (q7 >> 16) | (q7 << 48);
+
+    q[0] = q7 ^ r7 ^ r0 ^ rotr32(q0 ^ r0);
+    q[1] = q0 ^ r0 ^ q7 ^ r7 ^ r1 ^ rotr32(q1 ^ r1);
+    q[2] = q1 ^ r1 ^ r2 ^ rotr32(q2 ^ r2);
+    q[3] = q2 ^ r2 ^ q7 ^ r7 ^ r3 ^ rotr32(q3 ^ r3);
+    q[4] = q3 ^ r3 ^ q7 ^ r7 ^ r4 ^ rotr32(q4 ^ r4);
+    q[5] = q4 ^ r4 ^ r5 ^ rotr32(q5 ^ r5);
+    q[6] = q5 ^ r5 ^ r6 ^ rotr32(q6 ^ r6);
+    q[7] = q6 ^ r6 ^ r7 ^ rotr32(q7 ^ r7);
+    return;
+}
+
+/// @brief InvMixColumns on every column, as MixColumns(05*x ^ 04*(x rotated by 2 rows)).
+static void bs_inv_mix_columns(uint64_t* q)
+{
+    //* T = 04 * (x ^ x rotated 2 rows), each xtime moves plane 7 back into planes 0, 1, 3, 4.
+    uint64_t t[8];
+    for (int i = 0; i < 8; i++)
+        t[i] = q[i] ^ rotr32(q[i]);
+    for (int k = 0; k < 2; k++)
+    {
+        uint64_t Hi = t[7];
+        t[7] = t[6];
+        t[6] = t[5];
+        t[5] = t[4];
+        t[4] = t[3] ^ Hi;
+        t[3] = t[2] ^ Hi;
+        t[2] = t[1];
+        t[1] = t[0] ^ Hi;
+        t[0] = Hi;
+    }
+    for (int i = 0; i < 8; i++)
+        q[i] ^= t[i];
+    bs_mix_columns(q);
+    return;
+}
+
+/// @brief Xors one bitsliced round Key into q[8].
+static void bs_add_round_key(uint64_t* q, const uint64_t* SK)
+{
+    for (int i = 0; i < 8; i++)
+        q[i] ^= SK[i];
+    return;
+}
+
+
+//? Key functions
+
+/// @brief SubWord of a little endian word through the circuit (key expansion stays constant-time).
+static uint32_t bs_sub_word(uint32_t Word)
+{
+    uint64_t q[8] = {0};
+    q[0] = Word;
+    ortho(q);
+    bs_sbox(q);
+    ortho(q);
+    return (uint32_t) q[0];
+}
+
+void aes_bitslice_key_init(AESKey* Ctx, const uint8_t* Key)
+{
+    //? Standard AES-256 key schedule on little endian words.
+    uint32_t W[60];
+    for (int i = 0; i < 8; i++)
+        W[i] = LOAD32LE(Key + i*4);
+
+    uint32_t RCON = 1;
+    for (int i = 8; i < 60; i++)
+    {
+        uint32_t Prev = W[i - 1];
+        if (i % 8 == 0)
+        {
+            //* RotWord is a right rotation on little endian words.
+            Prev = bs_sub_word((Prev >> 8) | (Prev << 24)) ^ RCON;
+            RCON = (RCON << 1) ^ (0x1B & -(RCON >> 7));
+        }
+        else if (i % 8 == 4)
+        {
+            Prev = bs_sub_word(Prev);
+        }
+        W[i] = W[i - 8] ^ Prev;
+    }
+    for (int i = 0; i < 60; i++)
+        STORE32LE(Ctx->EncKey + i*4, W[i]);
+
+    //? Bitslice every round Key, replicated over all 4 block positions.
+    for (int i = 0; i < 15; i++)
+    {
+        uint64_t* q = Ctx->SliceKey + i*8;
+        interleave_in(&q[0], &q[4], W + i*4);
+        q[1] = q[0];
+        q[2] = q[0];
+        q[3] = q[0];
+        q[5] = q[4];
+        q[6] = q[4];
+        q[7] = q[4];
+        ortho(q);
+    }
+
+    //* Decryption runs the inverse cipher directly on SliceKey, DecKey is unused.
+    for (int i = 0; i < 240; i++)
+        Ctx->DecKey[i] = 0;
+    for (int i = 0; i < 60; i++)
+        W[i] = 0;
+    return;
+}
+
+
+//? Block functions
+
+/// @brief Encrypts 8 blocks (two sets of 4 in bit planes).
+static void encrypt_eight(const AESKey* Ctx, const uint8_t* In, uint8_t* Out)
+{
+    uint64_t q[8], p[8];
+    load_four(q, In);
+    load_four(p, In + 64);
+
+    bs_add_round_key(q, Ctx->SliceKey);
+    bs_add_round_key(p, Ctx->SliceKey);
+    for (int i = 1; i < 14; i++)
+    {
+        bs_sbox(q);
+        bs_sbox(p);
+        bs_shift_rows(q);
+        bs_shift_rows(p);
+        bs_mix_columns(q);
+        bs_mix_columns(p);
+        bs_add_round_key(q, Ctx->SliceKey + i*8);
+        bs_add_round_key(p, Ctx->SliceKey + i*8);
+    }
+    bs_sbox(q);
+    bs_sbox(p);
+    bs_shift_rows(q);
+    bs_shift_rows(p);
+    bs_add_round_key(q, Ctx->SliceKey + 14*8);
+    bs_add_round_key(p, Ctx->SliceKey + 14*8);
+
+    store_four(Out, q);
+    store_four(Out + 64, p);
+    return;
+}
+
+/// @brief Decrypts 8 blocks (two sets of 4 in bit planes).
+static void decrypt_eight(const AESKey* Ctx, const uint8_t* In, uint8_t* Out)
+{
+    uint64_t q[8], p[8];
+    load_four(q, In);
+    load_four(p, In + 64);
+
+    bs_add_round_key(q, Ctx->SliceKey + 14*8);
+    bs_add_round_key(p, Ctx->SliceKey + 14*8);
+    for (int i = 13; i > 0; i--)
+    {
+        bs_inv_shift_rows(q);
+        bs_inv_shift_rows(p);
+        bs_inv_sbox(q);
+        bs_inv_sbox(p);
+        bs_add_round_key(q, Ctx->SliceKey + i*8);
+        bs_add_round_key(p, Ctx->SliceKey + i*8);
+        bs_inv_mix_columns(q);
+        bs_inv_mix_columns(p);
+    }
+    bs_inv_shift_rows(q);
+    bs_inv_shift_rows(p);
+    bs_inv_sbox(q);
+    bs_inv_sbox(p);
+    bs_add_round_key(q, Ctx->SliceKey);
+    bs_add_round_key(p, Ctx->SliceKey);
+
+    store_four(Out, q);
+    store_four(Out + 64, p);
+    return;
+}
+
+/// @brief Runs Func over Blocks blocks, 8 at a time, padding the last group through a stack buffer.
+static void run_blocks(void (*Func)(const AESKey*, const uint8_t*, uint8_t*), const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks)
+{
+    size_t i = 0;
+    for (; i + 8 <= Blocks; i += 8)
+        Func(Ctx, In + i*16, Out + i*16);
+
+    if (i < Blocks)
+    {
+        uint8_t Temp[128] = {0};
+        size_t Left = (Blocks - i)*16;
+        for (size_t j = 0; j < Left; j++)
+            Temp[j] = In[i*16 + j];
+        Func(Ctx, Temp, Temp);
+        for (size_t j = 0; j < Left; j++)
+            Out[i*16 + j] = Temp[j];
+    }
+    return;
+}
+
+void aes_bitslice_enc(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks)
+{
+    run_blocks(encrypt_eight, Ctx, In, Out, Blocks);
+    return;
+}
+
+void aes_bitslice_dec(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks)
+{
+    run_blocks(decrypt_eight, Ctx, In, Out, Blocks);
+    return;
+}
+
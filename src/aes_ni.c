@@ -0,0 +1,240 @@
+#include "../include/aes_backend.h"
+#include "../include/cpu.h"
+#include "../include/wipe.h"
+
+#ifdef CPU_X86_SIMD
+#include <immintrin.h>
+
+#define AESNI_TARGET __attribute__((target("aes,ssse3")))
+
+//* Applies one AES instruction with the same round Key to all 8 blocks.
+#define ROUND8(Op, B, K) do { \
+    B[0] = Op(B[0], K); B[1] = Op(B[1], K); B[2] = Op(B[2], K); B[3] = Op(B[3], K); \
+    B[4] = Op(B[4], K); B[5] = Op(B[5], K); B[6] = Op(B[6], K); B[7] = Op(B[7], K); \
+} while (0)
+
+
+//? Key functions
+
+/// @brief Produces the next even round Key from the two previous ones.
+/// @param Prev The round Key two steps back.
+/// @param Assist AESKEYGENASSIST of the previous round Key (SubWord(RotWord(w)) ^ RCON in word 3).
+static AESNI_TARGET __m128i expand_even(__m128i Prev, __m128i Assist)
+{
+    //* Prefix-XOR the 4 words of Prev, then add the broadcast assist word.
+    Assist = _mm_shuffle_epi32(Assist, 0xFF);
+    Prev = _mm_xor_si128(Prev, _mm_slli_si128(Prev, 4));
+    Prev = _mm_xor_si128(Prev, _mm_slli_si128(Prev, 8));
+    return _mm_xor_si128(Prev, Assist);
+}
+
+/// @brief Produces the next odd round Key (SubWord without RotWord or RCON).
+/// @param Prev The round Key two steps back.
+/// @param Last The round Key that was just generated.
+static AESNI_TARGET __m128i expand_odd(__m128i Prev, __m128i Last)
+{
+    __m128i Assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(Last, 0x00), 0xAA);
+    Prev = _mm_xor_si128(Prev, _mm_slli_si128(Prev, 4));
+    Prev = _mm_xor_si128(Prev, _mm_slli_si128(Prev, 8));
+    return _mm_xor_si128(Prev, Assist);
+}
+
+AESNI_TARGET void aes_ni_key_init(AESKey* Ctx, const uint8_t* Key)
+{
+    __m128i K[15];
+    K[0] = _mm_loadu_si128((const __m128i*) Key);
+    K[1] = _mm_loadu_si128((const __m128i*) (Key + 16));
+
+    //* AESKEYGENASSIST needs RCON as an immediate, so every step is written out.
+    K[2] = expand_even(K[0], _mm_aeskeygenassist_si128(K[1], 0x01));
+    K[3] = expand_odd(K[1], K[2]);
+    K[4] = expand_even(K[2], _mm_aeskeygenassist_si128(K[3], 0x02));
+    K[5] = expand_odd(K[3], K[4]);
+    K[6] = expand_even(K[4], _mm_aeskeygenassist_si128(K[5], 0x04));
+    K[7] = expand_odd(K[5], K[6]);
+    K[8] = expand_even(K[6], _mm_aeskeygenassist_si128(K[7], 0x08));
+    K[9] = expand_odd(K[7], K[8]);
+    K[10] = expand_even(K[8], _mm_aeskeygenassist_si128(K[9], 0x10));
+    K[11] = expand_odd(K[9], K[10]);
+    K[12] = expand_even(K[10], _mm_aeskeygenassist_si128(K[11], 0x20));
+    K[13] = expand_odd(K[11], K[12]);
+    K[14] = expand_even(K[12], _mm_aeskeygenassist_si128(K[13], 0x40));
+
+    //* Same layout as the software key schedule: EncKey in order, DecKey reversed with InvMixColumns.
+    for (int i = 0; i < 15; i++)
+        _mm_storeu_si128((__m128i*) (Ctx->EncKey + i*16), K[i]);
+    _mm_storeu_si128((__m128i*) Ctx->DecKey, K[14]);
+    for (int i = 1; i < 14; i++)
+        _mm_storeu_si128((__m128i*) (Ctx->DecKey + i*16), _mm_aesimc_si128(K[14 - i]));
+    _mm_storeu_si128((__m128i*) (Ctx->DecKey + 14*16), K[0]);
+
+    //* The round keys are copied to the stack in every function here, clear them before returning.
+    wipe_bytes(K, sizeof(K));
+    return;
+}
+
+
+//? Block functions
+
+/// @brief Encrypts one block held in a register.
+static AESNI_TARGET __m128i encrypt_one(const __m128i* K, __m128i Block)
+{
+    Block = _mm_xor_si128(Block, K[0]);
+    for (int i = 1; i < 14; i++)
+        Block = _mm_aesenc_si128(Block, K[i]);
+    return _mm_aesenclast_si128(Block, K[14]);
+}
+
+/// @brief Encrypts 8 independent blocks, interleaved so every AESENC has 7 others in flight.
+static AESNI_TARGET void encrypt_eight(const __m128i* K, __m128i* B)
+{
+    for (int j = 0; j < 8; j++)
+        B[j] = _mm_xor_si128(B[j], K[0]);
+    for (int i = 1; i < 14; i++)
+        ROUND8(_mm_aesenc_si128, B, K[i]);
+    ROUND8(_mm_aesenclast_si128, B, K[14]);
+    return;
+}
+
+AESNI_TARGET void aes_ni_enc(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks)
+{
+    __m128i K[15];
+    for (int i = 0; i < 15; i++)
+        K[i] = _mm_loadu_si128((const __m128i*) (Ctx->EncKey + i*16));
+
+    size_t i = 0;
+    for (; i + 8 <= Blocks; i += 8)
+    {
+        __m128i B[8];
+        for (int j = 0; j < 8; j++)
+            B[j] = _mm_loadu_si128((const __m128i*) (In + (i + j)*16));
+        encrypt_eight(K, B);
+        for (int j = 0; j < 8; j++)
+            _mm_storeu_si128((__m128i*) (Out + (i + j)*16), B[j]);
+    }
+    for (; i < Blocks; i++)
+        _mm_storeu_si128((__m128i*) (Out + i*16), encrypt_one(K, _mm_loadu_si128((const __m128i*) (In + i*16))));
+    wipe_bytes(K, sizeof(K));
+    return;
+}
+
+AESNI_TARGET void aes_ni_dec(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks)
+{
+    __m128i K[15];
+    for (int i = 0; i < 15; i++)
+        K[i] = _mm_loadu_si128((const __m128i*) (Ctx->DecKey + i*16));
+
+    size_t i = 0;
+    for (; i + 8 <= Blocks; i += 8)
+    {
+        __m128i B[8];
+        for (int j = 0; j < 8; j++)
+            B[j] = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (In + (i + j)*16)), K[0]);
+        for (int r = 1; r < 14; r++)
+            ROUND8(_mm_aesdec_si128, B, K[r]);
+        ROUND8(_mm_aesdeclast_si128, B, K[14]);
+        for (int j = 0; j < 8; j++)
+            _mm_storeu_si128((__m128i*) (Out + (i + j)*16), B[j]);
+    }
+    for (; i < Blocks; i++)
+    {
+        __m128i Block = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (In + i*16)), K[0]);
+        for (int r = 1; r < 14; r++)
+            Block = _mm_aesdec_si128(Block, K[r]);
+        _mm_storeu_si128((__m128i*) (Out + i*16), _mm_aesdeclast_si128(Block, K[14]));
+    }
+    wipe_bytes(K, sizeof(K));
+    return;
+}
+
+
+//? Multi-buffer CBC
+
+AESNI_TARGET void aes_ni_cbc_enc_lanes(const AESKey* const* Keys, uint8_t (*Chain)[16], const uint8_t* const* In, uint8_t* const* Out, int Lanes, size_t Blocks)
+{
+    //* CBC is serial within a message, so the pipeline is filled with one block from each message instead.
+    __m128i K[AES_LANES][15];
+    __m128i C[AES_LANES];
+    for (int l = 0; l < Lanes; l++)
+    {
+        for (int i = 0; i < 15; i++)
+            K[l][i] = _mm_loadu_si128((const __m128i*) (Keys[l]->EncKey + i*16));
+        C[l] = _mm_loadu_si128((const __m128i*) Chain[l]);
+    }
+
+    for (size_t b = 0; b < Blocks; b++)
+    {
+        for (int l = 0; l < Lanes; l++)
+            C[l] = _mm_xor_si128(_mm_xor_si128(C[l], _mm_loadu_si128((const __m128i*) (In[l] + b*16))), K[l][0]);
+        for (int i = 1; i < 14; i++)
+            for (int l = 0; l < Lanes; l++)
+                C[l] = _mm_aesenc_si128(C[l], K[l][i]);
+        for (int l = 0; l < Lanes; l++)
+        {
+            C[l] = _mm_aesenclast_si128(C[l], K[l][14]);
+            _mm_storeu_si128((__m128i*) (Out[l] + b*16), C[l]);
+        }
+    }
+
+    for (int l = 0; l < Lanes; l++)
+        _mm_storeu_si128((__m128i*) Chain[l], C[l]);
+    wipe_bytes(K, sizeof(K));
+    return;
+}
+
+
+//? Counter mode
+
+AESNI_TARGET void aes_ni_ctr(const AESKey* Ctx, AESCounter Type, const uint8_t* ICB, uint8_t* Data, size_t Size)
+{
+    __m128i K[15];
+    for (int i = 0; i < 15; i++)
+        K[i] = _mm_loadu_si128((const __m128i*) (Ctx->EncKey + i*16));
+
+    //* GCM counts big endian in the last 4 bytes: reverse the block so it is lane 0 (little endian) like GCM-SIV.
+    const __m128i Reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const bool Swap = (Type == aes_counter_gcm);
+    __m128i Counter = _mm_loadu_si128((const __m128i*) ICB);
+    if (Swap)
+        Counter = _mm_shuffle_epi8(Counter, Reverse);
+    const __m128i One = _mm_set_epi32(0, 0, 0, 1);
+
+    size_t i = 0;
+    for (; i + 128 <= Size; i += 128)
+    {
+        //* 8 consecutive counter blocks (32-bit lane 0 wraps on its own, like the software counter).
+        __m128i B[8];
+        for (int j = 0; j < 8; j++)
+        {
+            B[j] = Swap ? _mm_shuffle_epi8(Counter, Reverse) : Counter;
+            Counter = _mm_add_epi32(Counter, One);
+        }
+        encrypt_eight(K, B);
+        for (int j = 0; j < 8; j++)
+        {
+            __m128i Text = _mm_loadu_si128((const __m128i*) (Data + i + j*16));
+            _mm_storeu_si128((__m128i*) (Data + i + j*16), _mm_xor_si128(Text, B[j]));
+        }
+    }
+    for (; i + 16 <= Size; i += 16)
+    {
+        __m128i Stream = encrypt_one(K, Swap ? _mm_shuffle_epi8(Counter, Reverse) : Counter);
+        Counter = _mm_add_epi32(Counter, One);
+        __m128i Text = _mm_loadu_si128((const __m128i*) (Data + i));
+        _mm_storeu_si128((__m128i*) (Data + i), _mm_xor_si128(Text, Stream));
+    }
+
+    //* Final Block (incomplete)
+    if (i < Size)
+    {
+        uint8_t Stream[16];
+        _mm_storeu_si128((__m128i*) Stream, encrypt_one(K, Swap ? _mm_shuffle_epi8(Counter, Reverse) : Counter));
+        for (size_t j = 0; i + j < Size; j++)
+            Data[i + j] ^= Stream[j];
+        wipe_bytes(Stream, sizeof(Stream));
+    }
+    wipe_bytes(K, sizeof(K));
+    return;
+}
+
+#endif // CPU_X86_SIMD
@@ -0,0 +1,177 @@
+#include "../include/aes_backend.h"
+
+//* Column words are big endian: row 0 is the most significant byte.
+#define LOAD32(x) (((uint32_t) (x)[0] << 24) | ((uint32_t) (x)[1] << 16) | ((uint32_t) (x)[2] << 8) | (uint32_t) (x)[3])
+#define STORE32(x, v) do { (x)[0] = (v) >> 24; (x)[1] = (v) >> 16; (x)[2] = (v) >> 8; (x)[3] = (v); } while (0)
+#define ROTR32(x, shift) (((x) >> (shift)) | ((x) << (32 - (shift))))
+
+/// @brief SubBytes + MixColumns for each row position (ShiftRows is applied by the word indices).
+static uint32_t Te[4][256];
+
+/// @brief InvSubBytes + InvMixColumns for each row position.
+static uint32_t Td[4][256];
+
+/// @brief Copies of SBox and InvSBox for the final round.
+static uint8_t Se[256];
+static uint8_t Sd[256];
+
+/// @brief Multiplies Byte by x within GF(2^8).
+static uint8_t xtime(uint8_t Byte)
+{
+    return (Byte << 1) ^ ((Byte & 0x80) ? 0x1B : 0x00);
+}
+
+void aes_ttable_init(const uint8_t* SBox, const uint8_t* InvSBox)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        //* Encryption column (2s, s, s, 3s)
+        uint8_t S = SBox[i];
+        uint8_t S2 = xtime(S);
+        uint32_t Word = ((uint32_t) S2 << 24) | ((uint32_t) S << 16) | ((uint32_t) S << 8) | (uint32_t) (S2 ^ S);
+
+        //* Decryption column (14d, 9d, 13d, 11d)
+        uint8_t D = InvSBox[i];
+        uint8_t D2 = xtime(D);
+        uint8_t D4 = xtime(D2);
+        uint8_t D8 = xtime(D4);
+        uint32_t InvWord = ((uint32_t) (D8 ^ D4 ^ D2) << 24) | ((uint32_t) (D8 ^ D) << 16) | ((uint32_t) (D8 ^ D4 ^ D) << 8) | (uint32_t) (D8 ^ D2 ^ D);
+
+        for (int j = 0; j < 4; j++)
+        {
+            Te[j][i] = j ? ROTR32(Word, 8*j) : Word;
+            Td[j][i] = j ? ROTR32(InvWord, 8*j) : InvWord;
+        }
+        Se[i] = S;
+        Sd[i] = D;
+    }
+    return;
+}
+
+void aes_ttable_enc(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks)
+{
+    const uint8_t* RK = Ctx->EncKey;
+
+    for (size_t b = 0; b < Blocks; b++, In += 16, Out += 16)
+    {
+        //? Load columns, Xor first Key
+        uint32_t S0 = LOAD32(In + 0) ^ LOAD32(RK + 0);
+        uint32_t S1 = LOAD32(In + 4) ^ LOAD32(RK + 4);
+        uint32_t S2 = LOAD32(In + 8) ^ LOAD32(RK + 8);
+        uint32_t S3 = LOAD32(In + 12) ^ LOAD32(RK + 12);
+        uint32_t T0, T1, T2, T3;
+
+        //? Rounds (SubBytes, ShiftRows and MixColumns in 16 lookups)
+        for (int i = 1; i < 14; i++)
+        {
+            const uint8_t* Key = RK + i*16;
+            T0 = Te[0][S0 >> 24] ^ Te[1][(S1 >> 16) & 0xFF] ^ Te[2][(S2 >> 8) & 0xFF] ^ Te[3][S3 & 0xFF] ^ LOAD32(Key + 0);
+            T1 = Te[0][S1 >> 24] ^ Te[1][(S2 >> 16) & 0xFF] ^ Te[2][(S3 >> 8) & 0xFF] ^ Te[3][S0 & 0xFF] ^ LOAD32(Key + 4);
+            T2 = Te[0][S2 >> 24] ^ Te[1][(S3 >> 16) & 0xFF] ^ Te[2][(S0 >> 8) & 0xFF] ^ Te[3][S1 & 0xFF] ^ LOAD32(Key + 8);
+            T3 = Te[0][S3 >> 24] ^ Te[1][(S0 >> 16) & 0xFF] ^ Te[2][(S1 >> 8) & 0xFF] ^ Te[3][S2 & 0xFF] ^ LOAD32(Key + 12);
+            S0 = T0; S1 = T1; S2 = T2; S3 = T3;
+        }
+
+        //? Final round without Mix Columns
+        const uint8_t* Key = RK + 14*16;
+        T0 = ((uint32_t) Se[S0 >> 24] << 24) ^ ((uint32_t) Se[(S1 >> 16) & 0xFF] << 16) ^ ((uint32_t) Se[(S2 >> 8) & 0xFF] << 8) ^ Se[S3 & 0xFF] ^ LOAD32(Key + 0);
+        T1 = ((uint32_t) Se[S1 >> 24] << 24) ^ ((uint32_t) Se[(S2 >> 16) & 0xFF] << 16) ^ ((uint32_t) Se[(S3 >> 8) & 0xFF] << 8) ^ Se[S0 & 0xFF] ^ LOAD32(Key + 4);
+        T2 = ((uint32_t) Se[S2 >> 24] << 24) ^ ((uint32_t) Se[(S3 >> 16) & 0xFF] << 16) ^ ((uint32_t) Se[(S0 >> 8) & 0xFF] << 8) ^ Se[S1 & 0xFF] ^ LOAD32(Key + 8);
+        T3 = ((uint32_t) Se[S3 >> 24] << 24) ^ ((uint32_t) Se[(S0 >> 16) & 0xFF] << 16) ^ ((uint32_t) Se[(S1 >> 8) & 0xFF] << 8) ^ Se[S2 & 0xFF] ^ LOAD32(Key + 12);
+
+        STORE32(Out + 0, T0);
+        STORE32(Out + 4, T1);
+        STORE32(Out + 8, T2);
+        STORE32(Out + 12, T3);
+    }
+    return;
+}
+
+void aes_ttable_cbc_enc_lanes(const AESKey* const* Keys, uint8_t (*Chain)[16], const uint8_t* const* In, uint8_t* const* Out, int Lanes, size_t Blocks)
+{
+    //* The chain stays in column words between steps, each round runs on every lane before the next.
+    uint32_t S[AES_LANES][4];
+    for (int l = 0; l < Lanes; l++)
+        for (int c = 0; c < 4; c++)
+            S[l][c] = LOAD32(Chain[l] + 4*c);
+
+    for (size_t b = 0; b < Blocks; b++)
+    {
+        //? Xor Plaintext and the first Key into the chain
+        for (int l = 0; l < Lanes; l++)
+            for (int c = 0; c < 4; c++)
+                S[l][c] ^= LOAD32(In[l] + b*16 + 4*c) ^ LOAD32(Keys[l]->EncKey + 4*c);
+
+        //? Rounds (SubBytes, ShiftRows and MixColumns in 16 lookups)
+        for (int i = 1; i < 14; i++)
+        {
+            for (int l = 0; l < Lanes; l++)
+            {
+                const uint8_t* Key = Keys[l]->EncKey + i*16;
+                uint32_t S0 = S[l][0], S1 = S[l][1], S2 = S[l][2], S3 = S[l][3];
+                S[l][0] = Te[0][S0 >> 24] ^ Te[1][(S1 >> 16) & 0xFF] ^ Te[2][(S2 >> 8) & 0xFF] ^ Te[3][S3 & 0xFF] ^ LOAD32(Key + 0);
+                S[l][1] = Te[0][S1 >> 24] ^ Te[1][(S2 >> 16) & 0xFF] ^ Te[2][(S3 >> 8) & 0xFF] ^ Te[3][S0 & 0xFF] ^ LOAD32(Key + 4);
+                S[l][2] = Te[0][S2 >> 24] ^ Te[1][(S3 >> 16) & 0xFF] ^ Te[2][(S0 >> 8) & 0xFF] ^ Te[3][S1 & 0xFF] ^ LOAD32(Key + 8);
+                S[l][3] = Te[0][S3 >> 24] ^ Te[1][(S0 >> 16) & 0xFF] ^ Te[2][(S1 >> 8) & 0xFF] ^ Te[3][S2 & 0xFF] ^ LOAD32(Key + 12);
+            }
+        }
+
+        //? Final round without Mix Columns
+        for (int l = 0; l < Lanes; l++)
+        {
+            const uint8_t* Key = Keys[l]->EncKey + 14*16;
+            uint32_t S0 = S[l][0], S1 = S[l][1], S2 = S[l][2], S3 = S[l][3];
+            S[l][0] = ((uint32_t) Se[S0 >> 24] << 24) ^ ((uint32_t) Se[(S1 >> 16) & 0xFF] << 16) ^ ((uint32_t) Se[(S2 >> 8) & 0xFF] << 8) ^ Se[S3 & 0xFF] ^ LOAD32(Key + 0);
+            S[l][1] = ((uint32_t) Se[S1 >> 24] << 24) ^ ((uint32_t) Se[(S2 >> 16) & 0xFF] << 16) ^ ((uint32_t) Se[(S3 >> 8) & 0xFF] << 8) ^ Se[S0 & 0xFF] ^ LOAD32(Key + 4);
+            S[l][2] = ((uint32_t) Se[S2 >> 24] << 24) ^ ((uint32_t) Se[(S3 >> 16) & 0xFF] << 16) ^ ((uint32_t) Se[(S0 >> 8) & 0xFF] << 8) ^ Se[S1 & 0xFF] ^ LOAD32(Key + 8);
+            S[l][3] = ((uint32_t) Se[S3 >> 24] << 24) ^ ((uint32_t) Se[(S0 >> 16) & 0xFF] << 16) ^ ((uint32_t) Se[(S1 >> 8) & 0xFF] << 8) ^ Se[S2 & 0xFF] ^ LOAD32(Key + 12);
+            for (int c = 0; c < 4; c++)
+                STORE32(Out[l] + b*16 + 4*c, S[l][c]);
+        }
+    }
+
+    for (int l = 0; l < Lanes; l++)
+        for (int c = 0; c < 4; c++)
+            STORE32(Chain[l] + 4*c, S[l][c]);
+    return;
+}
+
+void aes_ttable_dec(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks)
+{
+    //* DecKey is reversed with InvMixColumns already applied, so rounds mirror encryption.
+    const uint8_t* RK = Ctx->DecKey;
+
+    for (size_t b = 0; b < Blocks; b++, In += 16, Out += 16)
+    {
+        //? Load columns, Xor last Key
+        uint32_t S0 = LOAD32(In + 0) ^ LOAD32(RK + 0);
+        uint32_t S1 = LOAD32(In + 4) ^ LOAD32(RK + 4);
+        uint32_t S2 = LOAD32(In + 8) ^ LOAD32(RK + 8);
+        uint32_t S3 = LOAD32(In + 12) ^ LOAD32(RK + 12);
+        uint32_t T0, T1, T2, T3;
+
+        //? Rounds in reverse (InvShiftRows rotates the other way)
+        for (int i = 1; i < 14; i++)
+        {
+            const uint8_t* Key = RK + i*16;
+            T0 = Td[0][S0 >> 24] ^ Td[1][(S3 >> 16) & 0xFF] ^ Td[2][(S2 >> 8) & 0xFF] ^ Td[3][S1 & 0xFF] ^ LOAD32(Key + 0);
+            T1 = Td[0][S1 >> 24] ^ Td[1][(S0 >> 16) & 0xFF] ^ Td[2][(S3 >> 8) & 0xFF] ^ Td[3][S2 & 0xFF] ^ LOAD32(Key + 4);
+            T2 = Td[0][S2 >> 24] ^ Td[1][(S1 >> 16) & 0xFF] ^ Td[2][(S0 >> 8) & 0xFF] ^ Td[3][S3 & 0xFF] ^ LOAD32(Key + 8);
+            T3 = Td[0][S3 >> 24] ^ Td[1][(S2 >> 16) & 0xFF] ^ Td[2][(S1 >> 8) & 0xFF] ^ Td[3][S0 & 0xFF] ^ LOAD32(Key + 12);
+            S0 = T0; S1 = T1; S2 = T2; S3 = T3;
+        }
+
+        //? Last round without mix columns
+        const uint8_t* Key = RK + 14*16;
+        T0 = ((uint32_t) Sd[S0 >> 24] << 24) ^ ((uint32_t) Sd[(S3 >> 16) & 0xFF] << 16) ^ ((uint32_t) Sd[(S2 >> 8) & 0xFF] << 8) ^ Sd[S1 & 0xFF] ^ LOAD32(Key + 0);
+        T1 = ((uint32_t) Sd[S1 >> 24] << 24) ^ ((uint32_t) Sd[(S0 >> 16) & 0xFF] << 16) ^ ((uint32_t) Sd[(S3 >> 8) & 0xFF] << 8) ^ Sd[S2 & 0xFF] ^ LOAD32(Key + 4);
+        T2 = ((uint32_t) Sd[S2 >> 24] << 24) ^ ((uint32_t) Sd[(S1 >> 16) & 0xFF] << 16) ^ ((uint32_t) Sd[(S0 >> 8) & 0xFF] << 8) ^ Sd[S3 & 0xFF] ^ LOAD32(Key + 8);
+        T3 = ((uint32_t) Sd[S3 >> 24] << 24) ^ ((uint32_t) Sd[(S2 >> 16) & 0xFF] << 16) ^ ((uint32_t) Sd[(S1 >> 8) & 0xFF] << 8) ^ Sd[S0 & 0xFF] ^ LOAD32(Key + 12);
+
+        STORE32(Out + 0, T0);
+        STORE32(Out + 4, T1);
+        STORE32(Out + 8, T2);
+        STORE32(Out + 12, T3);
+    }
+    return;
+}
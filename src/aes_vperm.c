@@ -0,0 +1,436 @@
+#include "../include/aes_backend.h"
+#include "../include/cpu.h"
+
+#ifdef CPU_X86_SIMD
+#include <immintrin.h>
+
+#define VPERM_TARGET __attribute__((target("ssse3")))
+
+//* Vector permute AES: GF(2^8) is written as GF(2^4)[t]/(t^2 + t + Lambda), so inverting a byte only
+//* needs inverses in GF(2^4). Those are 16-entry tables, and PSHUFB looks up all 16 bytes at once
+//* with the nibbles as indices. The state stays in this nibble basis between rounds (Phi for
+//* encryption, Psi for decryption), the tables convert back to bytes only at the end.
+
+//* An index with the high bit set (0x80) makes PSHUFB return 0, standing in for 1/0 = infinity.
+#define VP_INF 0x80
+
+#define ROTL8(x, shift) ((uint8_t) (((x) << (shift)) | ((x) >> (8 - (shift)))))
+
+
+//? Tables (built by aes_vperm_init)
+
+//* Basis change from bytes to nibbles (high nibble i, low nibble i^j), split by input nibble.
+static uint8_t PhiLo[16], PhiHi[16], PsiLo[16], PsiHi[16];
+
+//* GF(2^4) inverse, and A/k with A = 1/Lambda (both VP_INF for 0).
+static uint8_t Inv[16], AOverK[16];
+
+//* Encryption outputs, in Phi (S, 2*S) and in bytes for the last round.
+static uint8_t EncS1[16], EncS2[16], EncS1x2[16], EncS2x2[16], EncOut1[16], EncOut2[16];
+
+//* Decryption outputs, in Psi times 14, 11, 13 and 9 (InvMixColumns), and in bytes for the last round.
+static uint8_t DecM[4][2][16], DecOut1[16], DecOut2[16];
+
+//* Byte constants folded into the round keys.
+static uint8_t PhiAffine, PhiInvAffine;
+
+/// @brief GF(2^8) multiplication (AES polynomial), only used to build tables.
+static uint8_t gmul8(uint8_t A, uint8_t B)
+{
+    uint8_t P = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        if (B & 1)
+            P ^= A;
+        A = (A << 1) ^ ((A & 0x80) ? 0x1B : 0x00);
+        B >>= 1;
+    }
+    return P;
+}
+
+/// @brief GF(2^4) multiplication modulo x^4 + x + 1.
+static uint8_t gmul4(uint8_t A, uint8_t B)
+{
+    uint8_t P = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        if (B & 1)
+            P ^= A;
+        A = (A << 1) ^ ((A & 0x08) ? 0x13 : 0x00);
+        B >>= 1;
+    }
+    return P;
+}
+
+/// @brief GF(2^4) inverse, 0 maps to 0.
+static uint8_t ginv4(uint8_t A)
+{
+    for (uint8_t B = 1; B < 16; B++)
+        if (gmul4(A, B) == 1)
+            return B;
+    return 0;
+}
+
+/// @brief The linear part of the SubBytes affine map (without 0x63).
+static uint8_t affine(uint8_t X)
+{
+    return X ^ ROTL8(X, 1) ^ ROTL8(X, 2) ^ ROTL8(X, 3) ^ ROTL8(X, 4);
+}
+
+/// @brief The inverse of affine().
+static uint8_t inv_affine(uint8_t X)
+{
+    return ROTL8(X, 1) ^ ROTL8(X, 3) ^ ROTL8(X, 6);
+}
+
+void aes_vperm_init(void)
+{
+    //? Embed GF(2^4) in GF(2^8) through a root Beta of x^4 + x + 1.
+    uint8_t Beta = 2;
+    for (int b = 2; b < 256; b++)
+    {
+        uint8_t B2 = gmul8(b, b);
+        if ((gmul8(B2, B2) ^ b ^ 1) == 0)
+        {
+            Beta = b;
+            break;
+        }
+    }
+    uint8_t Emb[16];
+    for (int c = 0; c < 16; c++)
+    {
+        uint8_t E = 0, Pow = 1;
+        for (int m = 0; m < 4; m++, Pow = gmul8(Pow, Beta))
+            if ((c >> m) & 1)
+                E ^= Pow;
+        Emb[c] = E;
+    }
+
+    //? Pick Lambda and a root T of t^2 + t + Lambda outside GF(2^4).
+    uint8_t Lambda = 0, T = 0;
+    for (int l = 1; l < 16 && !Lambda; l++)
+    {
+        for (int t = 2; t < 256; t++)
+        {
+            bool Sub = false;
+            for (int c = 0; c < 16; c++)
+                Sub |= (Emb[c] == t);
+            if (!Sub && (gmul8(t, t) ^ t) == Emb[l])
+            {
+                Lambda = l;
+                T = t;
+                break;
+            }
+        }
+    }
+
+    //? Phi: the byte i*T + j*(T+1) becomes the nibbles (i, i^j). Psi also undoes the affine map.
+    uint8_t Phi[256], Psi[256];
+    for (int i = 0; i < 16; i++)
+        for (int j = 0; j < 16; j++)
+            Phi[gmul8(Emb[i], T) ^ gmul8(Emb[j], T ^ 1)] = (i << 4) | (i ^ j);
+    for (int x = 0; x < 256; x++)
+        Psi[x] = Phi[inv_affine(x)];
+
+    for (int n = 0; n < 16; n++)
+    {
+        PhiLo[n] = Phi[n];
+        PhiHi[n] = Phi[n << 4];
+        PsiLo[n] = Psi[n];
+        PsiHi[n] = Psi[n << 4];
+    }
+
+    //? For x = i*T + j*(T+1), k = i^j and A = 1/Lambda:
+    //*   io = 1/(1/i + A/k) + j,  jo = 1/(1/j + A/k) + i
+    //*   1/x = (1/io)*(T + Lambda + 1) + (1/jo)*(T + Lambda)
+    const uint8_t A = ginv4(Lambda);
+    const uint8_t C1 = T ^ Emb[Lambda] ^ 1;
+    const uint8_t C2 = T ^ Emb[Lambda];
+    const uint8_t Mul[4] = {14, 11, 13, 9};
+    for (int n = 0; n < 16; n++)
+    {
+        Inv[n] = n ? ginv4(n) : VP_INF;
+        AOverK[n] = n ? gmul4(A, ginv4(n)) : VP_INF;
+
+        uint8_t U1 = gmul8(Emb[ginv4(n)], C1);
+        uint8_t U2 = gmul8(Emb[ginv4(n)], C2);
+        EncS1[n] = Phi[affine(U1)];
+        EncS2[n] = Phi[affine(U2)];
+        EncS1x2[n] = Phi[gmul8(2, affine(U1))];
+        EncS2x2[n] = Phi[gmul8(2, affine(U2))];
+        EncOut1[n] = affine(U1);
+        EncOut2[n] = affine(U2);
+
+        for (int m = 0; m < 4; m++)
+        {
+            DecM[m][0][n] = Psi[gmul8(Mul[m], U1)];
+            DecM[m][1][n] = Psi[gmul8(Mul[m], U2)];
+        }
+        DecOut1[n] = U1;
+        DecOut2[n] = U2;
+    }
+
+    PhiAffine = Phi[0x63];
+    PhiInvAffine = Phi[0x05];
+    return;
+}
+
+
+//? Vector helpers
+
+#define LOAD(x) _mm_loadu_si128((const __m128i*) (x))
+#define STORE(x, v) _mm_storeu_si128((__m128i*) (x), (v))
+
+/// @brief Every table a round needs, loaded into registers once per call.
+typedef struct
+{
+    __m128i Nibble, Inv, AOverK;
+    __m128i InLo, InHi;
+    __m128i Mid[4][2];
+    __m128i Out1, Out2;
+    __m128i Rot[4];
+} VPermRegs;
+
+/// @brief Looks up both nibbles of every byte in Lo/Hi and combines them (a linear basis change).
+static VPERM_TARGET __m128i transform(const VPermRegs* R, __m128i X)
+{
+    __m128i Lo = _mm_and_si128(X, R->Nibble);
+    __m128i Hi = _mm_and_si128(_mm_srli_epi32(X, 4), R->Nibble);
+    return _mm_xor_si128(_mm_shuffle_epi8(R->InLo, Lo), _mm_shuffle_epi8(R->InHi, Hi));
+}
+
+/// @brief Inverts every byte of X (in nibble basis), returning the two output table indices.
+static VPERM_TARGET void invert(const VPermRegs* R, __m128i X, __m128i* IO, __m128i* JO)
+{
+    __m128i K = _mm_and_si128(X, R->Nibble);
+    __m128i I = _mm_and_si128(_mm_srli_epi32(X, 4), R->Nibble);
+    __m128i J = _mm_xor_si128(I, K);
+
+    __m128i AK = _mm_shuffle_epi8(R->AOverK, K);
+    __m128i IAK = _mm_xor_si128(_mm_shuffle_epi8(R->Inv, I), AK);
+    __m128i JAK = _mm_xor_si128(_mm_shuffle_epi8(R->Inv, J), AK);
+    *IO = _mm_xor_si128(_mm_shuffle_epi8(R->Inv, IAK), J);
+    *JO = _mm_xor_si128(_mm_shuffle_epi8(R->Inv, JAK), I);
+    return;
+}
+
+/// @brief Output table lookup, 1/x times the constant each table was built with.
+static VPERM_TARGET __m128i lookup(__m128i T1, __m128i T2, __m128i IO, __m128i JO)
+{
+    return _mm_xor_si128(_mm_shuffle_epi8(T1, IO), _mm_shuffle_epi8(T2, JO));
+}
+
+/// @brief Builds the byte shuffle for ShiftRows (Dir 1) or InvShiftRows (Dir 3), followed by rotating each column up by Rot rows.
+static VPERM_TARGET __m128i shift_mask(int Dir, int Rot)
+{
+    uint8_t Mask[16];
+    for (int c = 0; c < 4; c++)
+    {
+        for (int r = 0; r < 4; r++)
+        {
+            int Row = (r + Rot) & 3;
+            Mask[4*c + r] = 4*((c + Dir*Row) & 3) + Row;
+        }
+    }
+    return LOAD(Mask);
+}
+
+/// @brief Fills the encryption registers.
+static VPERM_TARGET void enc_regs(VPermRegs* R)
+{
+    R->Nibble = _mm_set1_epi8(0x0F);
+    R->Inv = LOAD(Inv);
+    R->AOverK = LOAD(AOverK);
+    R->InLo = LOAD(PhiLo);
+    R->InHi = LOAD(PhiHi);
+    R->Mid[0][0] = LOAD(EncS1x2);
+    R->Mid[0][1] = LOAD(EncS2x2);
+    R->Mid[1][0] = LOAD(EncS1);
+    R->Mid[1][1] = LOAD(EncS2);
+    R->Out1 = LOAD(EncOut1);
+    R->Out2 = LOAD(EncOut2);
+    for (int i = 0; i < 4; i++)
+        R->Rot[i] = shift_mask(1, i);
+    return;
+}
+
+/// @brief Fills the decryption registers.
+static VPERM_TARGET void dec_regs(VPermRegs* R)
+{
+    R->Nibble = _mm_set1_epi8(0x0F);
+    R->Inv = LOAD(Inv);
+    R->AOverK = LOAD(AOverK);
+    R->InLo = LOAD(PsiLo);
+    R->InHi = LOAD(PsiHi);
+    for (int m = 0; m < 4; m++)
+    {
+        R->Mid[m][0] = LOAD(DecM[m][0]);
+        R->Mid[m][1] = LOAD(DecM[m][1]);
+    }
+    R->Out1 = LOAD(DecOut1);
+    R->Out2 = LOAD(DecOut2);
+    for (int i = 0; i < 4; i++)
+        R->Rot[i] = shift_mask(3, i);
+    return;
+}
+
+
+//? Key functions
+
+/// @brief SubWord on a little endian word, through the same constant-time inversion.
+static VPERM_TARGET uint32_t sub_word(const VPermRegs* R, uint32_t Word)
+{
+    __m128i IO, JO;
+    invert(R, transform(R, _mm_cvtsi32_si128(Word)), &IO, &JO);
+    return (uint32_t) _mm_cvtsi128_si32(lookup(R->Out1, R->Out2, IO, JO)) ^ 0x63636363;
+}
+
+/// @brief Multiplies every byte by 2 in GF(2^8).
+static VPERM_TARGET __m128i xtime(__m128i X)
+{
+    __m128i Carry = _mm_cmpgt_epi8(_mm_setzero_si128(), X);
+    return _mm_xor_si128(_mm_add_epi8(X, X), _mm_and_si128(Carry, _mm_set1_epi8(0x1B)));
+}
+
+/// @brief InvMixColumns on a round Key, without tables.
+static VPERM_TARGET __m128i inv_mix_columns(__m128i X)
+{
+    const __m128i Rot1 = _mm_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+    const __m128i Rot2 = _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m128i Rot3 = _mm_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+    __m128i X2 = xtime(X), X4 = xtime(X2), X8 = xtime(X4);
+    __m128i M9 = _mm_xor_si128(X8, X);
+    __m128i M11 = _mm_xor_si128(M9, X2);
+    __m128i M13 = _mm_xor_si128(M9, X4);
+    __m128i M14 = _mm_xor_si128(_mm_xor_si128(X8, X4), X2);
+
+    //* Row r: 14*a[r] ^ 11*a[r+1] ^ 13*a[r+2] ^ 9*a[r+3]
+    __m128i Ret = _mm_xor_si128(M14, _mm_shuffle_epi8(M11, Rot1));
+    Ret = _mm_xor_si128(Ret, _mm_shuffle_epi8(M13, Rot2));
+    return _mm_xor_si128(Ret, _mm_shuffle_epi8(M9, Rot3));
+}
+
+VPERM_TARGET void aes_vperm_key_init(AESKey* Ctx, const uint8_t* Key)
+{
+    VPermRegs R;
+    enc_regs(&R);
+
+    //? Standard AES-256 key schedule on little endian words.
+    uint32_t W[60];
+    for (int i = 0; i < 8; i++)
+        W[i] = (uint32_t) Key[i*4] | ((uint32_t) Key[i*4 + 1] << 8) | ((uint32_t) Key[i*4 + 2] << 16) | ((uint32_t) Key[i*4 + 3] << 24);
+
+    uint32_t RCON = 1;
+    for (int i = 8; i < 60; i++)
+    {
+        uint32_t Prev = W[i - 1];
+        if (i % 8 == 0)
+        {
+            //* RotWord is a right rotation on little endian words.
+            Prev = sub_word(&R, (Prev >> 8) | (Prev << 24)) ^ RCON;
+            RCON = (RCON << 1) ^ (0x1B & -(RCON >> 7));
+        }
+        else if (i % 8 == 4)
+        {
+            Prev = sub_word(&R, Prev);
+        }
+        W[i] = W[i - 8] ^ Prev;
+    }
+    for (int i = 0; i < 60; i++)
+    {
+        Ctx->EncKey[i*4] = W[i];
+        Ctx->EncKey[i*4 + 1] = W[i] >> 8;
+        Ctx->EncKey[i*4 + 2] = W[i] >> 16;
+        Ctx->EncKey[i*4 + 3] = W[i] >> 24;
+        W[i] = 0;
+    }
+
+    //? Equivalent Inverse Cipher keys, same layout as invert_key_256().
+    STORE(Ctx->DecKey, LOAD(Ctx->EncKey + 14*16));
+    for (int i = 1; i < 14; i++)
+        STORE(Ctx->DecKey + i*16, inv_mix_columns(LOAD(Ctx->EncKey + (14 - i)*16)));
+    STORE(Ctx->DecKey + 14*16, LOAD(Ctx->EncKey));
+
+    //? Move the round Keys into the state bases, folding in the affine constants.
+    //* Encryption: Phi(k0), Phi(k ^ 0x63) for rounds 1-13, bytes for round 14.
+    const __m128i Affine = _mm_set1_epi8(0x63);
+    const __m128i PhiAff = _mm_set1_epi8((char) PhiAffine);
+    const __m128i PhiInvAff = _mm_set1_epi8((char) PhiInvAffine);
+    STORE(Ctx->PermKey, transform(&R, LOAD(Ctx->EncKey)));
+    for (int i = 1; i < 14; i++)
+        STORE(Ctx->PermKey + i*16, _mm_xor_si128(transform(&R, LOAD(Ctx->EncKey + i*16)), PhiAff));
+    STORE(Ctx->PermKey + 14*16, _mm_xor_si128(LOAD(Ctx->EncKey + 14*16), Affine));
+
+    //* Decryption: Psi(k) ^ Phi(0x05) for rounds 0-13 (undoes the affine map before inverting), bytes for round 14.
+    R.InLo = LOAD(PsiLo);
+    R.InHi = LOAD(PsiHi);
+    for (int i = 0; i < 14; i++)
+        STORE(Ctx->PermKey + (15 + i)*16, _mm_xor_si128(transform(&R, LOAD(Ctx->DecKey + i*16)), PhiInvAff));
+    STORE(Ctx->PermKey + 29*16, LOAD(Ctx->DecKey + 14*16));
+    return;
+}
+
+
+//? Block functions
+
+/// @brief Encrypts one block held in a register.
+static VPERM_TARGET __m128i encrypt_one(const VPermRegs* R, const uint8_t* K, __m128i X)
+{
+    __m128i IO, JO;
+    X = _mm_xor_si128(transform(R, X), LOAD(K));
+    for (int i = 1; i < 14; i++)
+    {
+        invert(R, X, &IO, &JO);
+        __m128i S2 = lookup(R->Mid[0][0], R->Mid[0][1], IO, JO);
+        __m128i S = lookup(R->Mid[1][0], R->Mid[1][1], IO, JO);
+
+        //* ShiftRows and MixColumns: 2*a[r] ^ 3*a[r+1] ^ a[r+2] ^ a[r+3]
+        X = _mm_xor_si128(_mm_shuffle_epi8(S2, R->Rot[0]), _mm_shuffle_epi8(_mm_xor_si128(S2, S), R->Rot[1]));
+        X = _mm_xor_si128(X, _mm_xor_si128(_mm_shuffle_epi8(S, R->Rot[2]), _mm_shuffle_epi8(S, R->Rot[3])));
+        X = _mm_xor_si128(X, LOAD(K + i*16));
+    }
+    invert(R, X, &IO, &JO);
+    X = _mm_shuffle_epi8(lookup(R->Out1, R->Out2, IO, JO), R->Rot[0]);
+    return _mm_xor_si128(X, LOAD(K + 14*16));
+}
+
+/// @brief Decrypts one block held in a register (Equivalent Inverse Cipher).
+static VPERM_TARGET __m128i decrypt_one(const VPermRegs* R, const uint8_t* K, __m128i X)
+{
+    __m128i IO, JO;
+    X = _mm_xor_si128(transform(R, X), LOAD(K));
+    for (int i = 1; i < 14; i++)
+    {
+        invert(R, X, &IO, &JO);
+
+        //* InvShiftRows and InvMixColumns: 14*a[r] ^ 11*a[r+1] ^ 13*a[r+2] ^ 9*a[r+3]
+        X = _mm_shuffle_epi8(lookup(R->Mid[0][0], R->Mid[0][1], IO, JO), R->Rot[0]);
+        X = _mm_xor_si128(X, _mm_shuffle_epi8(lookup(R->Mid[1][0], R->Mid[1][1], IO, JO), R->Rot[1]));
+        X = _mm_xor_si128(X, _mm_shuffle_epi8(lookup(R->Mid[2][0], R->Mid[2][1], IO, JO), R->Rot[2]));
+        X = _mm_xor_si128(X, _mm_shuffle_epi8(lookup(R->Mid[3][0], R->Mid[3][1], IO, JO), R->Rot[3]));
+        X = _mm_xor_si128(X, LOAD(K + i*16));
+    }
+    invert(R, X, &IO, &JO);
+    X = _mm_shuffle_epi8(lookup(R->Out1, R->Out2, IO, JO), R->Rot[0]);
+    return _mm_xor_si128(X, LOAD(K + 14*16));
+}
+
+VPERM_TARGET void aes_vperm_enc(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks)
+{
+    VPermRegs R;
+    enc_regs(&R);
+    for (size_t i = 0; i < Blocks; i++)
+        STORE(Out + i*16, encrypt_one(&R, Ctx->PermKey, LOAD(In + i*16)));
+    return;
+}
+
+VPERM_TARGET void aes_vperm_dec(const AESKey* Ctx, const uint8_t* In, uint8_t* Out, size_t Blocks)
+{
+    VPermRegs R;
+    dec_regs(&R);
+    for (size_t i = 0; i < Blocks; i++)
+        STORE(Out + i*16, decrypt_one(&R, Ctx->PermKey + 15*16, LOAD(In + i*16)));
+    return;
+}
+
+#endif // CPU_X86_SIMD
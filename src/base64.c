@@ -1,124 +1,405 @@
+#include <string.h>
+#include <pthread.h>
 #include "../include/base64.h"
+#include "../include/base64_backend.h"
 
 char Base64Arr[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-uint8_t Base64Inv[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 62, 0, 0, 0, 63, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 0, 0, 0, 0, 0, 0, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 0, 0, 0, 0, 0};
-uint8_t InvalidBytes[] = {0x2C, 0x2D, 0x2E, 0x3A, 0x3B, 0x3C, 0x3E, 0x3F, 0x40, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F, 0x60};
 
-bool base64_validate(const char* B64String)
+//* Inverse of Base64Arr for every byte, 0xFF for characters outside the alphabet (so one lookup decodes and validates).
+static const uint8_t Base64Inv[256] =
 {
-    //? Find string size (excluding '\0').
-    size_t StrSize;
-    for (StrSize = 0; B64String[StrSize] != '\0'; StrSize++);
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+    0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
 
-    //? Check if the number of characters is a multiple of 4.
-    if (StrSize % 4 != 0)
-        return false;
+/// @brief Encodes Size bytes into 4 characters per 3 bytes (with '=' padding), no '\0'.
+static void base64_encode(const uint8_t* Array, size_t Size, char* Out);
+
+/// @brief Decodes and validates Len characters (a multiple of 4, no padding).
+/// @returns A boolean True/False, False on any character outside the alphabet.
+static bool base64_decode_body(const char* In, size_t Len, uint8_t* Out);
+
+/// @brief Decodes and validates the last 4 characters, which may end in "=" or "==".
+/// @param OutSize Set to the number of bytes written (1 to 3).
+/// @returns A boolean True/False.
+static bool base64_decode_last(const char* In, uint8_t* Out, size_t* OutSize);
+
+/// @brief Decodes a run of characters (no whitespace) for base64_dec_stream_update(), carrying a partial quartet in Ctx.
+/// @param OutSize Advanced by the number of bytes written at Out + *OutSize.
+/// @returns A boolean True/False, False on an invalid character or data after the padding.
+static bool base64_decode_run(Base64DecStream* Ctx, const char* In, size_t Len, uint8_t* Out, size_t* OutSize);
+
+/// @brief Checks for the whitespace and line breaks skipped by a SkipSpace stream.
+static bool base64_is_space(char C);
+
+/// @brief Runs the widest SIMD decoder the CPU supports.
+/// @returns Number of characters consumed, see base64_ssse3_dec().
+static size_t base64_decode_simd(const char* In, size_t Len, uint8_t* Out);
+
+/// @brief Runs the widest SIMD encoder the CPU supports.
+/// @returns Number of bytes consumed, see base64_ssse3_enc().
+static size_t base64_encode_simd(const uint8_t* In, size_t Size, char* Out);
+
+#ifdef CPU_X86_SIMD
+//* SIMD kernels the coders use: 2 for AVX2, 1 for SSSE3, 0 for neither. Resolved once through LevelOnce.
+static int Level;
+static pthread_once_t LevelOnce = PTHREAD_ONCE_INIT;
 
-    //? Checks for edge case "AA=A" where '=' is in the last 2, but still invalid.
-    if (B64String[StrSize-2] == '=' && B64String[StrSize-1] != '=')
+/// @brief Sets Level from the CPU features.
+static void base64_resolve_level(void);
+#endif
+
+
+bool base64_validate(const char* B64String)
+{
+    //? Find string size (excluding '\0'), it must be a non-zero multiple of 4.
+    size_t StrSize = strlen(B64String);
+    if (StrSize == 0 || StrSize % 4 != 0)
         return false;
 
-    for (size_t i = 0; i < StrSize; i++)
+    //? Decode into a small scratch buffer, validation happens in the same pass.
+    uint8_t Scratch[768];
+    size_t Body = StrSize - 4;
+    for (size_t i = 0; i < Body; i += 1024)
     {
-        //? Checks if the lower or upper bound is reached.
-        if ((0x2A >= B64String[i]) | (B64String[i] >= 0x7B))
-            return false;
-        
-        //? Checks if padding character '=' is out of place.
-        if (B64String[i] == '=' && i < (StrSize - 2))
+        size_t Len = (Body - i < 1024) ? Body - i : 1024;
+        if (!base64_decode_body(B64String + i, Len, Scratch))
             return false;
-
-        //? Check Invalid characters
-        for (uint8_t j = 0; j < sizeof(InvalidBytes); j++)
-        {
-            if (B64String[i] == InvalidBytes[j])
-                return false;
-        }
     }
 
-    return true;
+    size_t LastSize;
+    return base64_decode_last(B64String + Body, Scratch, &LastSize);
 }
 
 ErrorCode base64_convert_byte(const char* B64String, ByteArr *Ret)
 {
-    //? If not valid, return ErrorCode unknown
-    if (base64_validate(B64String) == false)
+    //? Find string size (excluding '\0') once, it must be a non-zero multiple of 4.
+    size_t CharSize = strlen(B64String);
+    if (CharSize == 0 || CharSize % 4 != 0)
         return unknown_error;
 
-    size_t CharSize;
-
-    //? Find string size (excluding '\0').
-    for (CharSize = 0; B64String[CharSize] != '\0'; CharSize++);
-    
-    //? Calculate size of ByteArr, then malloc
+    //? Exact size of ByteArr, from the padding.
     Ret->Size = (CharSize / 4)*3;
-    Ret->Arr = malloc(Ret->Size);
-    if (Ret->Arr == NULL)
-        return malloc_error;
-
-    for (size_t i = 0, j = 0; i < CharSize; i+=4)
-    {
-        Ret->Arr[j++] = (Base64Inv[B64String[i]] << 2) | (Base64Inv[B64String[i+1]] >> 4);                     //? First 6, Next 2
-        Ret->Arr[j++] = ((Base64Inv[B64String[i+1]] << 4) & 0b11110000) | ((Base64Inv[B64String[i+2]] >> 2));  //? Next 4,  Third 4
-        Ret->Arr[j++] = ((Base64Inv[B64String[i+2]] << 6) & 0b11000000) | Base64Inv[B64String[i+3]];           //? Third 2, Fourth 6
-    }
-    
-    //? Removes padding, if necessary.
     if (B64String[CharSize-2] == '=')
         Ret->Size -= 2;
     else if (B64String[CharSize-1] == '=')
         Ret->Size -= 1;
-    
-    //? Reallocates the array to account for padding.
-    uint8_t* Temp = realloc(Ret->Arr, Ret->Size);
-    if (Temp == NULL)
+    Ret->Arr = malloc(Ret->Size);
+    if (Ret->Arr == NULL)
+        return malloc_error;
+
+    ErrorCode TempError = base64_convert_byte_into(B64String, CharSize, Ret->Arr, &Ret->Size);
+    if (TempError != success)
     {
         free(Ret->Arr);
-        return malloc_error;
+        Ret->Arr = NULL;
     }
-
-    return success;
+    return TempError;
 }
 
 ErrorCode base64_convert_string(const uint8_t* Array, size_t Size, char** RetStr)
 {
-    //? Size of string generated in Malloc
-    size_t StringSize = 4*((Size + 2 - ((Size - 1) % 3))/3) + 1;
-    //! StringSize must have a better equation for this.
-
     //? The malloc string here is 4 characters per 3 bytes w/ pad, plus 1 '\0'.
+    size_t StringSize = BASE64_ENCODED_SIZE(Size) + 1;
     char* B64String = malloc(StringSize);
     if (B64String == NULL)
         return malloc_error;
 
-    //? This runs all but padding Base64 steps
-    for (size_t i = 0, j = 0; i < Size - (Size % 3); i+=3)
+    base64_encode(Array, Size, B64String);
+
+    //? Make B64String a valid string.
+    B64String[StringSize - 1] = '\0';
+
+    //* Set the outside string pointer to B64String pointer.
+    *RetStr = B64String;
+
+    return success;
+}
+
+ErrorCode base64_convert_byte_into(const char* B64String, size_t Len, uint8_t* Out, size_t* OutSize)
+{
+    if (Len % 4 != 0)
+        return unknown_error;
+
+    //* Empty text is empty data.
+    if (Len == 0)
+    {
+        *OutSize = 0;
+        return success;
+    }
+
+    //? Decode and validate in one pass, only the last quartet may hold padding.
+    size_t LastSize;
+    if (!base64_decode_body(B64String, Len - 4, Out) ||
+        !base64_decode_last(B64String + Len - 4, Out + (Len/4 - 1)*3, &LastSize))
+        return unknown_error;
+
+    *OutSize = (Len/4 - 1)*3 + LastSize;
+    return success;
+}
+
+ErrorCode base64_convert_string_into(const uint8_t* Array, size_t Size, char* Out, size_t* OutLen)
+{
+    base64_encode(Array, Size, Out);
+    *OutLen = BASE64_ENCODED_SIZE(Size);
+    return success;
+}
+
+
+//? Base64 streaming
+
+ErrorCode base64_dec_stream_init(Base64DecStream* Ctx, bool SkipSpace)
+{
+    Ctx->BufSize = 0;
+    Ctx->SkipSpace = SkipSpace;
+    Ctx->Finished = false;
+    return success;
+}
+
+ErrorCode base64_dec_stream_update(Base64DecStream* Ctx, const char* In, size_t Len, uint8_t* Out, size_t* OutSize)
+{
+    *OutSize = 0;
+
+    //* Without SkipSpace the whole chunk is one run, otherwise every run between whitespace is decoded straight from In.
+    size_t i = 0;
+    while (i < Len)
+    {
+        size_t End = Len;
+        if (Ctx->SkipSpace)
+            for (End = i; End < Len && !base64_is_space(In[End]); End++);
+
+        if (!base64_decode_run(Ctx, In + i, End - i, Out, OutSize))
+            return unknown_error;
+
+        i = End;
+        if (Ctx->SkipSpace)
+            for (; i < Len && base64_is_space(In[i]); i++);
+    }
+    return success;
+}
+
+ErrorCode base64_dec_stream_final(Base64DecStream* Ctx)
+{
+    ErrorCode TempError = (Ctx->BufSize == 0) ? success : unknown_error;
+    Ctx->BufSize = 0;
+    Ctx->Finished = true;
+    return TempError;
+}
+
+ErrorCode base64_enc_stream_init(Base64EncStream* Ctx)
+{
+    Ctx->BufSize = 0;
+    return success;
+}
+
+ErrorCode base64_enc_stream_update(Base64EncStream* Ctx, const uint8_t* Array, size_t Size, char* Out, size_t* OutLen)
+{
+    *OutLen = 0;
+
+    //* Complete the partial triplet from the last call first.
+    size_t i = 0;
+    if (Ctx->BufSize != 0)
+    {
+        for (; i < Size && Ctx->BufSize < 3; i++)
+            Ctx->Buffer[Ctx->BufSize++] = Array[i];
+        if (Ctx->BufSize < 3)
+            return success;
+
+        base64_encode(Ctx->Buffer, 3, Out);
+        Ctx->BufSize = 0;
+        *OutLen = 4;
+    }
+
+    //* Whole triplets straight from Array, then keep the rest.
+    size_t Whole = ((Size - i)/3)*3;
+    base64_encode(Array + i, Whole, Out + *OutLen);
+    *OutLen += (Whole/3)*4;
+    for (i += Whole; i < Size; i++)
+        Ctx->Buffer[Ctx->BufSize++] = Array[i];
+    return success;
+}
+
+ErrorCode base64_enc_stream_final(Base64EncStream* Ctx, char* Out, size_t* OutLen)
+{
+    base64_encode(Ctx->Buffer, Ctx->BufSize, Out);
+    *OutLen = BASE64_ENCODED_SIZE(Ctx->BufSize);
+    Ctx->BufSize = 0;
+    return success;
+}
+
+
+//? Encoding and decoding cores
+
+static void base64_encode(const uint8_t* Array, size_t Size, char* Out)
+{
+    //? Whole vector steps first, then the remaining whole triplets.
+    size_t i = base64_encode_simd(Array, Size, Out);
+    size_t j = (i/3)*4;
+    for (; i + 3 <= Size; i+=3)
     {
-        B64String[j++] = Base64Arr[(Array[i] >> 2)];
-        B64String[j++] = Base64Arr[((Array[i] & 0x03) << 4) | (Array[i+1] >> 4)];
-        B64String[j++] = Base64Arr[((Array[i+1] & 0x0F) << 2) | (Array[i+2] >> 6)];
-        B64String[j++] = Base64Arr[(Array[i+2] & 0x3F)];
+        Out[j++] = Base64Arr[(Array[i] >> 2)];
+        Out[j++] = Base64Arr[((Array[i] & 0x03) << 4) | (Array[i+1] >> 4)];
+        Out[j++] = Base64Arr[((Array[i+1] & 0x0F) << 2) | (Array[i+2] >> 6)];
+        Out[j++] = Base64Arr[(Array[i+2] & 0x3F)];
     }
 
+    //? Padding for the last 1 or 2 bytes.
     if ((Size % 3) == 1)
     {
-        B64String[StringSize - 5] = Base64Arr[(Array[Size - 1] >> 2)];
-        B64String[StringSize - 4] = Base64Arr[((Array[Size - 1] & 0x03) << 4) | 0];
-        B64String[StringSize - 3] = '=';
-        B64String[StringSize - 2] = '=';
+        Out[j++] = Base64Arr[(Array[Size - 1] >> 2)];
+        Out[j++] = Base64Arr[((Array[Size - 1] & 0x03) << 4) | 0];
+        Out[j++] = '=';
+        Out[j++] = '=';
     }
     else if ((Size % 3) == 2)
     {
-        B64String[StringSize - 5] = Base64Arr[(Array[Size - 2] >> 2)];
-        B64String[StringSize - 4] = Base64Arr[((Array[Size - 2] & 0x03) << 4) | (Array[Size - 1] >> 4)];
-        B64String[StringSize - 3] = Base64Arr[((Array[Size - 1] & 0x0F) << 2) | 0];
-        B64String[StringSize - 2] = '=';
+        Out[j++] = Base64Arr[(Array[Size - 2] >> 2)];
+        Out[j++] = Base64Arr[((Array[Size - 2] & 0x03) << 4) | (Array[Size - 1] >> 4)];
+        Out[j++] = Base64Arr[((Array[Size - 1] & 0x0F) << 2) | 0];
+        Out[j++] = '=';
     }
-    //? Make B64String a valid string.
-    B64String[StringSize - 1] = '\0';
+    return;
+}
 
-    //* Set the outside string pointer to B64String pointer.
-    *RetStr = B64String;
+static bool base64_decode_body(const char* In, size_t Len, uint8_t* Out)
+{
+    //? Whole vector steps first (they stop early on an invalid character), then one quartet at a time.
+    size_t i = base64_decode_simd(In, Len, Out);
+    for (size_t j = (i/4)*3; i < Len; i+=4)
+    {
+        uint8_t A = Base64Inv[(uint8_t) In[i]];
+        uint8_t B = Base64Inv[(uint8_t) In[i+1]];
+        uint8_t C = Base64Inv[(uint8_t) In[i+2]];
+        uint8_t D = Base64Inv[(uint8_t) In[i+3]];
+        if ((A | B | C | D) == 0xFF)
+            return false;
 
-    return success;
-}
\ No newline at end of file
+        Out[j++] = (A << 2) | (B >> 4);             //? First 6, Next 2
+        Out[j++] = ((B << 4) & 0xF0) | (C >> 2);    //? Next 4,  Third 4
+        Out[j++] = ((C << 6) & 0xC0) | D;           //? Third 2, Fourth 6
+    }
+    return true;
+}
+
+static bool base64_decode_last(const char* In, uint8_t* Out, size_t* OutSize)
+{
+    //* '=' may only replace the fourth character, or the third and fourth.
+    size_t Pad = (In[3] == '=') ? ((In[2] == '=') ? 2 : 1) : 0;
+    uint8_t A = Base64Inv[(uint8_t) In[0]];
+    uint8_t B = Base64Inv[(uint8_t) In[1]];
+    uint8_t C = (Pad == 2) ? 0 : Base64Inv[(uint8_t) In[2]];
+    uint8_t D = (Pad != 0) ? 0 : Base64Inv[(uint8_t) In[3]];
+    if ((A | B | C | D) == 0xFF)
+        return false;
+
+    Out[0] = (A << 2) | (B >> 4);
+    if (Pad < 2)
+        Out[1] = ((B << 4) & 0xF0) | (C >> 2);
+    if (Pad < 1)
+        Out[2] = ((C << 6) & 0xC0) | D;
+    *OutSize = 3 - Pad;
+    return true;
+}
+
+static bool base64_decode_run(Base64DecStream* Ctx, const char* In, size_t Len, uint8_t* Out, size_t* OutSize)
+{
+    if (Len != 0 && Ctx->Finished)
+        return false;
+
+    //* Complete the partial quartet from the last run first, it may be the padded one.
+    size_t LastSize;
+    while (Ctx->BufSize != 0 && Len != 0)
+    {
+        Ctx->Buffer[Ctx->BufSize++] = *In++;
+        Len--;
+        if (Ctx->BufSize < 4)
+            continue;
+
+        if (!base64_decode_last(Ctx->Buffer, Out + *OutSize, &LastSize))
+            return false;
+        *OutSize += LastSize;
+        Ctx->BufSize = 0;
+        Ctx->Finished = (LastSize < 3);
+        if (Len != 0 && Ctx->Finished)
+            return false;
+    }
+
+    //* Whole quartets straight from In. Only the last one can be padded, and then nothing may follow it.
+    size_t Whole = (Len/4)*4;
+    if (Whole != 0)
+    {
+        if (!base64_decode_body(In, Whole - 4, Out + *OutSize) ||
+            !base64_decode_last(In + Whole - 4, Out + *OutSize + (Whole/4 - 1)*3, &LastSize))
+            return false;
+        *OutSize += (Whole/4 - 1)*3 + LastSize;
+        Ctx->Finished = (LastSize < 3);
+        if (Len != Whole && Ctx->Finished)
+            return false;
+    }
+    for (size_t i = Whole; i < Len; i++)
+        Ctx->Buffer[Ctx->BufSize++] = In[i];
+    return true;
+}
+
+static bool base64_is_space(char C)
+{
+    return C == ' ' || C == '\t' || C == '\r' || C == '\n' || C == '\v' || C == '\f';
+}
+
+#ifdef CPU_X86_SIMD
+static void base64_resolve_level(void)
+{
+    Level = cpu_has_avx2() ? 2 : (cpu_has_ssse3() ? 1 : 0);
+    return;
+}
+#endif
+
+static size_t base64_decode_simd(const char* In, size_t Len, uint8_t* Out)
+{
+#ifdef CPU_X86_SIMD
+    //* Callers may decode and encode on several threads at once.
+    pthread_once(&LevelOnce, base64_resolve_level);
+
+    //* The AVX2 kernel leaves up to 31 characters, the SSSE3 one takes what it can of them.
+    size_t Done = 0;
+    if (Level == 2)
+        Done = base64_avx2_dec(In, Len, Out);
+    if (Level >= 1)
+        Done += base64_ssse3_dec(In + Done, Len - Done, Out + (Done/4)*3);
+    return Done;
+#else
+    (void) In, (void) Len, (void) Out;
+    return 0;
+#endif
+}
+
+static size_t base64_encode_simd(const uint8_t* In, size_t Size, char* Out)
+{
+#ifdef CPU_X86_SIMD
+    pthread_once(&LevelOnce, base64_resolve_level);
+
+    size_t Done = 0;
+    if (Level == 2)
+        Done = base64_avx2_enc(In, Size, Out);
+    if (Level >= 1)
+        Done += base64_ssse3_enc(In + Done, Size - Done, Out + (Done/3)*4);
+    return Done;
+#else
+    (void) In, (void) Size, (void) Out;
+    return 0;
+#endif
+}
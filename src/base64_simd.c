@@ -0,0 +1,168 @@
+#include <string.h>
+#include "../include/base64_backend.h"
+
+#ifdef CPU_X86_SIMD
+#include <immintrin.h>
+
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+//* Encoding spreads every 3 bytes into 4 6-bit values (one per byte), then adds the offset of each value's range:
+//* 0-25 'A', 26-51 'a', 52-61 '0', 62 '+', 63 '/'. The offset is a PSHUFB lookup on a saturated index.
+//* Decoding checks every character with two PSHUFB lookups (one per nibble) that share a bit only for invalid characters,
+//* then subtracts the offset of its range (looked up by high nibble, '/' moved to its own entry) and packs 4 values into 3 bytes.
+
+
+//? SSSE3, 12 <-> 16 bytes
+
+/// @brief Spreads the first 12 bytes of In into 16 6-bit values, one per byte.
+static SSSE3_TARGET __m128i enc_reshuffle128(__m128i In)
+{
+    In = _mm_shuffle_epi8(In, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    __m128i T0 = _mm_and_si128(In, _mm_set1_epi32(0x0FC0FC00));
+    __m128i T1 = _mm_mulhi_epu16(T0, _mm_set1_epi32(0x04000040));
+    __m128i T2 = _mm_and_si128(In, _mm_set1_epi32(0x003F03F0));
+    __m128i T3 = _mm_mullo_epi16(T2, _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(T1, T3);
+}
+
+/// @brief Translates 16 6-bit values into Base64 characters.
+static SSSE3_TARGET __m128i enc_translate128(__m128i In)
+{
+    const __m128i Lut = _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+    __m128i Index = _mm_subs_epu8(In, _mm_set1_epi8(51));
+    Index = _mm_sub_epi8(Index, _mm_cmpgt_epi8(In, _mm_set1_epi8(25)));
+    return _mm_add_epi8(In, _mm_shuffle_epi8(Lut, Index));
+}
+
+/// @brief Packs 16 6-bit values into 12 bytes at the start of the result.
+static SSSE3_TARGET __m128i dec_reshuffle128(__m128i In)
+{
+    __m128i Pairs = _mm_maddubs_epi16(In, _mm_set1_epi32(0x01400140));
+    __m128i Out = _mm_madd_epi16(Pairs, _mm_set1_epi32(0x00011000));
+    return _mm_shuffle_epi8(Out, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+SSSE3_TARGET size_t base64_ssse3_enc(const uint8_t* In, size_t Size, char* Out)
+{
+    size_t i = 0;
+    for (; i + 16 <= Size; i += 12, Out += 16)
+    {
+        __m128i Data = _mm_loadu_si128((const __m128i*) (In + i));
+        _mm_storeu_si128((__m128i*) Out, enc_translate128(enc_reshuffle128(Data)));
+    }
+    return i;
+}
+
+SSSE3_TARGET size_t base64_ssse3_dec(const char* In, size_t Len, uint8_t* Out)
+{
+    const __m128i LutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i LutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i LutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i Nibble = _mm_set1_epi8(0x0F);
+    const __m128i Slash = _mm_set1_epi8('/');
+
+    size_t i = 0;
+    for (; i + 16 <= Len; i += 16, Out += 12)
+    {
+        __m128i Str = _mm_loadu_si128((const __m128i*) (In + i));
+        __m128i HiNibbles = _mm_and_si128(_mm_srli_epi32(Str, 4), Nibble);
+        __m128i LoNibbles = _mm_and_si128(Str, Nibble);
+
+        //* Valid characters never share a bit between their two lookups.
+        __m128i Check = _mm_and_si128(_mm_shuffle_epi8(LutLo, LoNibbles), _mm_shuffle_epi8(LutHi, HiNibbles));
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(Check, _mm_setzero_si128())) != 0)
+            break;
+
+        __m128i Roll = _mm_shuffle_epi8(LutRoll, _mm_add_epi8(_mm_cmpeq_epi8(Str, Slash), HiNibbles));
+        __m128i Data = dec_reshuffle128(_mm_add_epi8(Str, Roll));
+
+        //* Exactly 12 bytes, so Out needs no slack.
+        _mm_storel_epi64((__m128i*) Out, Data);
+        int Last = _mm_cvtsi128_si32(_mm_srli_si128(Data, 8));
+        memcpy(Out + 8, &Last, 4);
+    }
+    return i;
+}
+
+
+//? AVX2, 24 <-> 32 bytes (the SSSE3 steps in both 128-bit lanes)
+
+static AVX2_TARGET __m256i enc_reshuffle256(__m256i In)
+{
+    In = _mm256_shuffle_epi8(In, _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                                  1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    __m256i T0 = _mm256_and_si256(In, _mm256_set1_epi32(0x0FC0FC00));
+    __m256i T1 = _mm256_mulhi_epu16(T0, _mm256_set1_epi32(0x04000040));
+    __m256i T2 = _mm256_and_si256(In, _mm256_set1_epi32(0x003F03F0));
+    __m256i T3 = _mm256_mullo_epi16(T2, _mm256_set1_epi32(0x01000010));
+    return _mm256_or_si256(T1, T3);
+}
+
+static AVX2_TARGET __m256i enc_translate256(__m256i In)
+{
+    const __m256i Lut = _mm256_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+                                         65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+    __m256i Index = _mm256_subs_epu8(In, _mm256_set1_epi8(51));
+    Index = _mm256_sub_epi8(Index, _mm256_cmpgt_epi8(In, _mm256_set1_epi8(25)));
+    return _mm256_add_epi8(In, _mm256_shuffle_epi8(Lut, Index));
+}
+
+static AVX2_TARGET __m256i dec_reshuffle256(__m256i In)
+{
+    __m256i Pairs = _mm256_maddubs_epi16(In, _mm256_set1_epi32(0x01400140));
+    __m256i Out = _mm256_madd_epi16(Pairs, _mm256_set1_epi32(0x00011000));
+    Out = _mm256_shuffle_epi8(Out, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                    2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+    //* Join the two 12-byte halves into the first 24 bytes.
+    return _mm256_permutevar8x32_epi32(Out, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+}
+
+AVX2_TARGET size_t base64_avx2_enc(const uint8_t* In, size_t Size, char* Out)
+{
+    size_t i = 0;
+    for (; i + 28 <= Size; i += 24, Out += 32)
+    {
+        //* 12 bytes into each lane.
+        __m128i Lo = _mm_loadu_si128((const __m128i*) (In + i));
+        __m128i Hi = _mm_loadu_si128((const __m128i*) (In + i + 12));
+        __m256i Data = _mm256_inserti128_si256(_mm256_castsi128_si256(Lo), Hi, 1);
+        _mm256_storeu_si256((__m256i*) Out, enc_translate256(enc_reshuffle256(Data)));
+    }
+    return i;
+}
+
+AVX2_TARGET size_t base64_avx2_dec(const char* In, size_t Len, uint8_t* Out)
+{
+    const __m256i LutLo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                                           0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i LutHi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                           0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i LutRoll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                             0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i Nibble = _mm256_set1_epi8(0x0F);
+    const __m256i Slash = _mm256_set1_epi8('/');
+
+    size_t i = 0;
+    for (; i + 32 <= Len; i += 32, Out += 24)
+    {
+        __m256i Str = _mm256_loadu_si256((const __m256i*) (In + i));
+        __m256i HiNibbles = _mm256_and_si256(_mm256_srli_epi32(Str, 4), Nibble);
+        __m256i LoNibbles = _mm256_and_si256(Str, Nibble);
+
+        __m256i Check = _mm256_and_si256(_mm256_shuffle_epi8(LutLo, LoNibbles), _mm256_shuffle_epi8(LutHi, HiNibbles));
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi8(Check, _mm256_setzero_si256())) != 0)
+            break;
+
+        __m256i Roll = _mm256_shuffle_epi8(LutRoll, _mm256_add_epi8(_mm256_cmpeq_epi8(Str, Slash), HiNibbles));
+        __m256i Data = dec_reshuffle256(_mm256_add_epi8(Str, Roll));
+
+        //* Exactly 24 bytes, so Out needs no slack.
+        _mm_storeu_si128((__m128i*) Out, _mm256_castsi256_si128(Data));
+        _mm_storel_epi64((__m128i*) (Out + 16), _mm256_extracti128_si256(Data, 1));
+    }
+    return i;
+}
+
+#endif // CPU_X86_SIMD
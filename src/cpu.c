@@ -0,0 +1,84 @@
+#include "../include/cpu.h"
+
+#ifdef CPU_X86_SIMD
+#include <cpuid.h>
+
+/// @brief Reads a single feature bit from CPUID leaf 1 (ECX).
+static bool cpuid_leaf1_ecx(unsigned int Bit)
+{
+    unsigned int EAX, EBX, ECX, EDX;
+    if (!__get_cpuid(1, &EAX, &EBX, &ECX, &EDX))
+        return false;
+    return (ECX >> Bit) & 1;
+}
+
+/// @brief Reads a single feature bit from CPUID leaf 1 (EDX).
+static bool cpuid_leaf1_edx(unsigned int Bit)
+{
+    unsigned int EAX, EBX, ECX, EDX;
+    if (!__get_cpuid(1, &EAX, &EBX, &ECX, &EDX))
+        return false;
+    return (EDX >> Bit) & 1;
+}
+
+/// @brief Reads a single feature bit from CPUID leaf 7, subleaf 0 (EBX).
+static bool cpuid_leaf7_ebx(unsigned int Bit)
+{
+    unsigned int EAX, EBX, ECX, EDX;
+    if (!__get_cpuid_count(7, 0, &EAX, &EBX, &ECX, &EDX))
+        return false;
+    return (EBX >> Bit) & 1;
+}
+#endif
+
+bool cpu_has_aesni(void)
+{
+#ifdef CPU_X86_SIMD
+    //* AES-NI is ECX bit 25, the backend also uses PSHUFB (SSSE3) for counter byte swaps.
+    return cpuid_leaf1_ecx(25) && cpuid_leaf1_ecx(9);
+#else
+    return false;
+#endif
+}
+
+bool cpu_has_ssse3(void)
+{
+#ifdef CPU_X86_SIMD
+    return cpuid_leaf1_ecx(9);
+#else
+    return false;
+#endif
+}
+
+bool cpu_has_pclmul(void)
+{
+#ifdef CPU_X86_SIMD
+    //* PCLMULQDQ is ECX bit 1, the GHASH backend also uses PSHUFB (SSSE3) for byte reversal.
+    return cpuid_leaf1_ecx(1) && cpuid_leaf1_ecx(9);
+#else
+    return false;
+#endif
+}
+
+bool cpu_has_sse2(void)
+{
+#ifdef CPU_X86_SIMD
+    return cpuid_leaf1_edx(26);
+#else
+    return false;
+#endif
+}
+
+bool cpu_has_avx2(void)
+{
+#ifdef CPU_X86_SIMD
+    //* AVX2 is leaf 7 EBX bit 5. The OS must also save the YMM registers: OSXSAVE (ECX bit 27), then XCR0 bits 1 and 2.
+    if (!cpuid_leaf1_ecx(27) || !cpuid_leaf7_ebx(5))
+        return false;
+    unsigned int XCR0Low, XCR0High;
+    __asm__ volatile ("xgetbv" : "=a" (XCR0Low), "=d" (XCR0High) : "c" (0));
+    return (XCR0Low & 0x6) == 0x6;
+#else
+    return false;
+#endif
+}
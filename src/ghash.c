@@ -0,0 +1,424 @@
+#include <pthread.h>
+#include "../include/aes_backend.h"
+#include "../include/wipe.h"
+
+//* GHASH backend chosen by ghash_key_init(), auto stands for AutoGHash.
+static GHashBackend DefaultGHash = ghash_backend_auto;
+
+//* Resolved once, keys may be initialized from several threads at once.
+static pthread_once_t AutoGHashOnce = PTHREAD_ONCE_INIT;
+static GHashBackend AutoGHash;
+
+
+//? GHASH backend selection
+
+/// @brief Checks whether Backend can run in this build and on this CPU.
+static bool ghash_supported(GHashBackend Backend)
+{
+    switch (Backend)
+    {
+        case ghash_backend_bitserial:
+        case ghash_backend_table4:
+        case ghash_backend_table8:
+            return true;
+#ifdef CPU_X86_SIMD
+        case ghash_backend_clmul:
+            return cpu_has_pclmul();
+#endif
+        default:
+            return false;
+    }
+}
+
+/// @brief Picks the fastest supported GHASH backend.
+static GHashBackend best_ghash(void)
+{
+    return ghash_supported(ghash_backend_clmul) ? ghash_backend_clmul : ghash_backend_table4;
+}
+
+/// @brief Sets AutoGHash, run once through AutoGHashOnce.
+static void resolve_auto_ghash(void)
+{
+    AutoGHash = best_ghash();
+    return;
+}
+
+ErrorCode aes_set_ghash_backend(GHashBackend Backend)
+{
+    if (Backend == ghash_backend_auto)
+        Backend = best_ghash();
+    if (!ghash_supported(Backend))
+        return unknown_error;
+
+    DefaultGHash = Backend;
+    return success;
+}
+
+GHashBackend aes_get_ghash_backend(void)
+{
+    if (DefaultGHash != ghash_backend_auto)
+        return DefaultGHash;
+    pthread_once(&AutoGHashOnce, resolve_auto_ghash);
+    return AutoGHash;
+}
+
+
+//? Bit-serial multiplication
+
+/// @brief X = X * H in GF(2^128), one bit of H at a time (GCM bit order: bit 0 is the MSB of byte 0).
+static void bitserial_mul(uint8_t* X, const uint8_t* H)
+{
+    uint8_t V[16];
+    uint8_t Z[16] = {0};
+    for (int i = 0; i < 16; i++)
+        V[i] = X[i];
+
+    for (int i = 0; i < 128; i++)
+    {
+        if ((H[i >> 3] >> (7 - (i & 7))) & 1)
+            for (int j = 0; j < 16; j++)
+                Z[j] ^= V[j];
+
+        //* V = V * x, reducing with R = 0xE1 || 0^120 when a bit falls off the end.
+        uint8_t Carry = V[15] & 1;
+        for (int j = 15; j > 0; j--)
+            V[j] = ((V[j-1] & 1) << 7) | (V[j] >> 1);
+        V[0] = (V[0] >> 1) ^ (Carry ? 0xE1 : 0x00);
+    }
+
+    for (int i = 0; i < 16; i++)
+        X[i] = Z[i];
+    return;
+}
+
+
+//? Table multiplication
+//* Blocks are held as two big endian words (Hi = bytes 0-7), so x^0 is the top bit of Hi and
+//* multiplying by x is a right shift, with R = 0xE1 << 56 folded back in for the bit shifted out.
+
+#define LOAD64BE(x) (((uint64_t) (x)[0] << 56) | ((uint64_t) (x)[1] << 48) | ((uint64_t) (x)[2] << 40) | ((uint64_t) (x)[3] << 32) \
+                   | ((uint64_t) (x)[4] << 24) | ((uint64_t) (x)[5] << 16) | ((uint64_t) (x)[6] << 8) | (uint64_t) (x)[7])
+#define LOAD64LE(x) (((uint64_t) (x)[7] << 56) | ((uint64_t) (x)[6] << 48) | ((uint64_t) (x)[5] << 40) | ((uint64_t) (x)[4] << 32) \
+                   | ((uint64_t) (x)[3] << 24) | ((uint64_t) (x)[2] << 16) | ((uint64_t) (x)[1] << 8) | (uint64_t) (x)[0])
+
+/// @brief Reduction of the 4 bits a 4-bit shift drops off the end: entry r is the Hi word of r (in Lo) times x^4.
+static const uint64_t Rem4[16] =
+{
+    0x0000000000000000, 0x1c20000000000000, 0x3840000000000000, 0x2460000000000000,
+    0x7080000000000000, 0x6ca0000000000000, 0x48c0000000000000, 0x54e0000000000000,
+    0xe100000000000000, 0xfd20000000000000, 0xd940000000000000, 0xc560000000000000,
+    0x9180000000000000, 0x8da0000000000000, 0xa9c0000000000000, 0xb5e0000000000000,
+};
+
+/// @brief Multiplies the word pair by x (no data-dependent branch).
+static void mul_x(uint64_t* Hi, uint64_t* Lo)
+{
+    uint64_t Carry = *Lo & 1;
+    *Lo = (*Lo >> 1) | (*Hi << 63);
+    *Hi = (*Hi >> 1) ^ ((0 - Carry) & 0xE100000000000000);
+    return;
+}
+
+/// @brief Loads a block as a word pair, byte reversed first for POLYVAL.
+static void load_block(const uint8_t* X, bool Polyval, uint64_t* Hi, uint64_t* Lo)
+{
+    if (Polyval)
+    {
+        *Hi = LOAD64LE(X + 8);
+        *Lo = LOAD64LE(X);
+    }
+    else
+    {
+        *Hi = LOAD64BE(X);
+        *Lo = LOAD64BE(X + 8);
+    }
+    return;
+}
+
+/// @brief Stores a word pair back as 16 bytes (inverse of load_block()).
+static void store_block(uint8_t* X, bool Polyval, uint64_t Hi, uint64_t Lo)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        if (Polyval)
+        {
+            X[15 - i] = Hi >> (56 - 8*i);
+            X[7 - i] = Lo >> (56 - 8*i);
+        }
+        else
+        {
+            X[i] = Hi >> (56 - 8*i);
+            X[i + 8] = Lo >> (56 - 8*i);
+        }
+    }
+    return;
+}
+
+/// @brief A = A * B on word pairs, one bit of A at a time (masks instead of branches).
+static void word_mul(uint64_t* AHi, uint64_t* ALo, uint64_t BHi, uint64_t BLo)
+{
+    uint64_t ZHi = 0, ZLo = 0;
+    for (int i = 0; i < 128; i++)
+    {
+        uint64_t Bit = (i < 64) ? (*AHi >> (63 - i)) & 1 : (*ALo >> (127 - i)) & 1;
+        ZHi ^= (0 - Bit) & BHi;
+        ZLo ^= (0 - Bit) & BLo;
+        mul_x(&BHi, &BLo);
+    }
+    *AHi = ZHi;
+    *ALo = ZLo;
+    return;
+}
+
+/// @brief Builds Key->Table4: entry n is the nibble n (top bit = x^0) times H.
+static void table4_init(GHashKey* Key)
+{
+    uint64_t Hi = LOAD64BE(Key->H), Lo = LOAD64BE(Key->H + 8);
+    Key->Table4[0][0] = 0;
+    Key->Table4[0][1] = 0;
+    for (int Bit = 8; Bit > 0; Bit >>= 1)
+    {
+        Key->Table4[Bit][0] = Hi;
+        Key->Table4[Bit][1] = Lo;
+        mul_x(&Hi, &Lo);
+    }
+    for (int n = 3; n < 16; n++)
+    {
+        //* Every other entry is the XOR of its single-bit entries.
+        int Low = n & -n;
+        Key->Table4[n][0] = Key->Table4[n ^ Low][0] ^ Key->Table4[Low][0];
+        Key->Table4[n][1] = Key->Table4[n ^ Low][1] ^ Key->Table4[Low][1];
+    }
+    return;
+}
+
+/// @brief Y = Y * H with Shoup's method: Horner over the 32 nibbles, from x^127 down.
+static void table4_mul(const GHashKey* Key, uint64_t* Hi, uint64_t* Lo)
+{
+    uint64_t ZHi = 0, ZLo = 0;
+    for (int i = 15; i >= 0; i--)
+    {
+        uint8_t Byte = (i < 8) ? *Hi >> (56 - 8*i) : *Lo >> (56 - 8*(i - 8));
+        uint8_t Nibble[2] = {Byte & 0x0F, Byte >> 4};
+        for (int j = 0; j < 2; j++)
+        {
+            //* Z = Z * x^4 + Nibble * H
+            uint64_t Rem = ZLo & 0x0F;
+            ZLo = (ZLo >> 4) | (ZHi << 60);
+            ZHi = (ZHi >> 4) ^ Rem4[Rem];
+            ZHi ^= Key->Table4[Nibble[j]][0];
+            ZLo ^= Key->Table4[Nibble[j]][1];
+        }
+    }
+    *Hi = ZHi;
+    *Lo = ZLo;
+    return;
+}
+
+/// @brief Allocates and builds Key->Table8: entry [p][b] is byte b at byte position p times H.
+static ErrorCode table8_init(GHashKey* Key)
+{
+    Key->Table8 = malloc(16 * sizeof(*Key->Table8));
+    if (Key->Table8 == NULL)
+        return malloc_error;
+
+    uint64_t Hi = LOAD64BE(Key->H), Lo = LOAD64BE(Key->H + 8);
+    for (int p = 0; p < 16; p++)
+    {
+        Key->Table8[p][0][0] = 0;
+        Key->Table8[p][0][1] = 0;
+        for (int Bit = 0x80; Bit > 0; Bit >>= 1)
+        {
+            Key->Table8[p][Bit][0] = Hi;
+            Key->Table8[p][Bit][1] = Lo;
+            mul_x(&Hi, &Lo);
+        }
+        for (int b = 3; b < 256; b++)
+        {
+            int Low = b & -b;
+            Key->Table8[p][b][0] = Key->Table8[p][b ^ Low][0] ^ Key->Table8[p][Low][0];
+            Key->Table8[p][b][1] = Key->Table8[p][b ^ Low][1] ^ Key->Table8[p][Low][1];
+        }
+    }
+    return success;
+}
+
+/// @brief Y = Y * H as the XOR of one table entry per byte (no shifts or reduction).
+static void table8_mul(const GHashKey* Key, uint64_t* Hi, uint64_t* Lo)
+{
+    uint64_t ZHi = 0, ZLo = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        uint8_t A = *Hi >> (56 - 8*i);
+        uint8_t B = *Lo >> (56 - 8*i);
+        ZHi ^= Key->Table8[i][A][0] ^ Key->Table8[i + 8][B][0];
+        ZLo ^= Key->Table8[i][A][1] ^ Key->Table8[i + 8][B][1];
+    }
+    *Hi = ZHi;
+    *Lo = ZLo;
+    return;
+}
+
+
+//? GHASH key and update
+
+/// @brief Copies H into Key and precomputes it for Backend.
+static ErrorCode key_init(GHashKey* Key, const uint8_t* H, GHashBackend Backend)
+{
+    for (int i = 0; i < 16; i++)
+        Key->H[i] = H[i];
+    Key->Table8 = NULL;
+    Key->Backend = Backend;
+
+    switch (Key->Backend)
+    {
+#ifdef CPU_X86_SIMD
+        case ghash_backend_clmul:
+            ghash_clmul_init(Key);
+            break;
+#endif
+        case ghash_backend_table4:
+            table4_init(Key);
+            break;
+        case ghash_backend_table8:
+            return table8_init(Key);
+        default:
+            break;
+    }
+    return success;
+}
+
+ErrorCode ghash_key_init(GHashKey* Key, const uint8_t* H)
+{
+    return key_init(Key, H, aes_get_ghash_backend());
+}
+
+ErrorCode polyval_key_init(GHashKey* Key, const uint8_t* H)
+{
+    //* POLYVAL(H, X) = ByteReverse(GHASH(H * x, ByteReverse(X))), with H reversed into GCM order.
+    uint64_t Hi, Lo;
+    uint8_t GH[16];
+    load_block(H, true, &Hi, &Lo);
+    mul_x(&Hi, &Lo);
+    store_block(GH, false, Hi, Lo);
+
+    GHashBackend Backend = aes_get_ghash_backend();
+    if (Backend == ghash_backend_table8)
+        Backend = ghash_backend_table4;
+    ErrorCode TempError = key_init(Key, GH, Backend);
+
+    for (int i = 0; i < 16; i++)
+        GH[i] = 0;
+    return TempError;
+}
+
+void ghash_key_clear(GHashKey* Key)
+{
+    if (Key->Table8 != NULL)
+    {
+        wipe_bytes(Key->Table8, 16 * sizeof(*Key->Table8));
+        free(Key->Table8);
+    }
+    wipe_bytes(Key, sizeof(GHashKey));
+    return;
+}
+
+/// @brief Absorbs Blocks full 16-byte blocks with the key's backend (Polyval: blocks and Y are byte reversed).
+static void update_blocks(const GHashKey* Key, uint8_t* Y, const uint8_t* Data, size_t Blocks, bool Polyval)
+{
+#ifdef CPU_X86_SIMD
+    if (Key->Backend == ghash_backend_clmul)
+    {
+        if (Polyval)
+            polyval_clmul_update(Key, Y, Data, Blocks);
+        else
+            ghash_clmul_update(Key, Y, Data, Blocks);
+        return;
+    }
+#endif
+
+    //* Keep Y in words for the whole run.
+    uint64_t Hi, Lo;
+    load_block(Y, Polyval, &Hi, &Lo);
+    for (size_t i = 0; i < Blocks; i++)
+    {
+        uint64_t XHi, XLo;
+        load_block(Data + i*16, Polyval, &XHi, &XLo);
+        Hi ^= XHi;
+        Lo ^= XLo;
+
+        if (Key->Backend == ghash_backend_table8)
+            table8_mul(Key, &Hi, &Lo);
+        else if (Key->Backend == ghash_backend_table4)
+            table4_mul(Key, &Hi, &Lo);
+        else
+        {
+            uint8_t Z[16];
+            store_block(Z, false, Hi, Lo);
+            bitserial_mul(Z, Key->H);
+            load_block(Z, false, &Hi, &Lo);
+        }
+    }
+    store_block(Y, Polyval, Hi, Lo);
+    return;
+}
+
+/// @brief Absorbs Size bytes, padding a final incomplete block with 0's.
+static void update(const GHashKey* Key, uint8_t* Y, const uint8_t* Data, size_t Size, bool Polyval)
+{
+    update_blocks(Key, Y, Data, Size >> 4, Polyval);
+
+    //* If final Block is incomplete, pad with 0's first
+    if (Size % 16 != 0)
+    {
+        uint8_t Last[16] = {0};
+        for (size_t j = 0; j < Size % 16; j++)
+            Last[j] = Data[Size - (Size % 16) + j];
+        update_blocks(Key, Y, Last, 1, Polyval);
+    }
+    return;
+}
+
+void ghash_update(const GHashKey* Key, uint8_t* Y, const uint8_t* Data, size_t Size)
+{
+    update(Key, Y, Data, Size, false);
+    return;
+}
+
+void polyval_update(const GHashKey* Key, uint8_t* Y, const uint8_t* Data, size_t Size)
+{
+    update(Key, Y, Data, Size, true);
+    return;
+}
+
+/// @brief Y = Y * H^Blocks ^ Part, with H^Blocks by square and multiply.
+static void combine(const GHashKey* Key, uint8_t* Y, const uint8_t* Part, uint64_t Blocks, bool Polyval)
+{
+    uint64_t PHi = 0x8000000000000000, PLo = 0;
+    uint64_t SHi = LOAD64BE(Key->H), SLo = LOAD64BE(Key->H + 8);
+    for (; Blocks != 0; Blocks >>= 1)
+    {
+        if (Blocks & 1)
+            word_mul(&PHi, &PLo, SHi, SLo);
+        word_mul(&SHi, &SLo, SHi, SLo);
+    }
+
+    uint64_t Hi, Lo, XHi, XLo;
+    load_block(Y, Polyval, &Hi, &Lo);
+    load_block(Part, Polyval, &XHi, &XLo);
+    word_mul(&Hi, &Lo, PHi, PLo);
+    store_block(Y, Polyval, Hi ^ XHi, Lo ^ XLo);
+    return;
+}
+
+void ghash_combine(const GHashKey* Key, uint8_t* Y, const uint8_t* Part, uint64_t Blocks)
+{
+    combine(Key, Y, Part, Blocks, false);
+    return;
+}
+
+void polyval_combine(const GHashKey* Key, uint8_t* Y, const uint8_t* Part, uint64_t Blocks)
+{
+    combine(Key, Y, Part, Blocks, true);
+    return;
+}
@@ -0,0 +1,126 @@
+#include "../include/aes_backend.h"
+#include "../include/cpu.h"
+
+#ifdef CPU_X86_SIMD
+#include <immintrin.h>
+
+#define CLMUL_TARGET __attribute__((target("pclmul,ssse3")))
+
+//* Blocks are byte reversed on load, so the GCM bit order becomes a reflected 128-bit integer. The
+//* carry-less product of two reflected values is then the reflected product shifted right by one,
+//* fixed up (with the reduction modulo x^128 + x^7 + x^2 + x + 1) in reduce().
+
+
+//? Field arithmetic
+
+/// @brief Accumulates the unreduced Karatsuba product A*B into Lo, Mid and Hi (3 carry-less multiplies).
+static CLMUL_TARGET void mul_acc(__m128i A, __m128i B, __m128i* Lo, __m128i* Mid, __m128i* Hi)
+{
+    __m128i AK = _mm_xor_si128(A, _mm_shuffle_epi32(A, 0x4E));
+    __m128i BK = _mm_xor_si128(B, _mm_shuffle_epi32(B, 0x4E));
+    *Lo = _mm_xor_si128(*Lo, _mm_clmulepi64_si128(A, B, 0x00));
+    *Hi = _mm_xor_si128(*Hi, _mm_clmulepi64_si128(A, B, 0x11));
+    *Mid = _mm_xor_si128(*Mid, _mm_clmulepi64_si128(AK, BK, 0x00));
+    return;
+}
+
+/// @brief Reduces an accumulated 256-bit product to 128 bits (shift by one, then modulo the GCM polynomial).
+static CLMUL_TARGET __m128i reduce(__m128i Lo, __m128i Mid, __m128i Hi)
+{
+    //* Karatsuba: the middle term is (a0^a1)(b0^b1) ^ a0b0 ^ a1b1, split across both halves.
+    Mid = _mm_xor_si128(Mid, _mm_xor_si128(Lo, Hi));
+    Lo = _mm_xor_si128(Lo, _mm_slli_si128(Mid, 8));
+    Hi = _mm_xor_si128(Hi, _mm_srli_si128(Mid, 8));
+
+    //* Shift the 256-bit value Hi:Lo left by one bit.
+    __m128i LoCarry = _mm_srli_epi32(Lo, 31);
+    __m128i HiCarry = _mm_srli_epi32(Hi, 31);
+    Lo = _mm_slli_epi32(Lo, 1);
+    Hi = _mm_slli_epi32(Hi, 1);
+    __m128i Cross = _mm_srli_si128(LoCarry, 12);
+    HiCarry = _mm_slli_si128(HiCarry, 4);
+    LoCarry = _mm_slli_si128(LoCarry, 4);
+    Lo = _mm_or_si128(Lo, LoCarry);
+    Hi = _mm_or_si128(Hi, _mm_or_si128(HiCarry, Cross));
+
+    //* Fold Lo (the x^128..x^255 terms) into Hi with x^128 = x^7 + x^2 + x + 1, in two phases.
+    __m128i A = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(Lo, 31), _mm_slli_epi32(Lo, 30)), _mm_slli_epi32(Lo, 25));
+    __m128i B = _mm_srli_si128(A, 4);
+    Lo = _mm_xor_si128(Lo, _mm_slli_si128(A, 12));
+    __m128i C = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(Lo, 1), _mm_srli_epi32(Lo, 2)), _mm_srli_epi32(Lo, 7));
+    C = _mm_xor_si128(C, B);
+    Lo = _mm_xor_si128(Lo, C);
+    return _mm_xor_si128(Hi, Lo);
+}
+
+/// @brief A*B in GF(2^128), both byte reversed.
+static CLMUL_TARGET __m128i gf_mul(__m128i A, __m128i B)
+{
+    __m128i Lo = _mm_setzero_si128(), Mid = _mm_setzero_si128(), Hi = _mm_setzero_si128();
+    mul_acc(A, B, &Lo, &Mid, &Hi);
+    return reduce(Lo, Mid, Hi);
+}
+
+
+//? GHASH
+
+CLMUL_TARGET void ghash_clmul_init(GHashKey* Key)
+{
+    const __m128i Reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m128i H = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) Key->H), Reverse);
+    __m128i P = H;
+    _mm_storeu_si128((__m128i*) Key->Pow[0], P);
+    for (int i = 1; i < 8; i++)
+    {
+        P = gf_mul(P, H);
+        _mm_storeu_si128((__m128i*) Key->Pow[i], P);
+    }
+    return;
+}
+
+/// @brief Absorbs Blocks full blocks into Y, loading every block (and Y) through the byte shuffle Order.
+static CLMUL_TARGET void clmul_update(const GHashKey* Key, uint8_t* Y, const uint8_t* Data, size_t Blocks, __m128i Order)
+{
+    __m128i Pow[8];
+    for (int i = 0; i < 8; i++)
+        Pow[i] = _mm_loadu_si128((const __m128i*) Key->Pow[i]);
+    __m128i Acc = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) Y), Order);
+
+    //* Aggregated reduction: Y' = (Y ^ X1)*H^8 ^ X2*H^7 ^ ... ^ X8*H, summed unreduced and reduced once.
+    size_t i = 0;
+    for (; i + 8 <= Blocks; i += 8)
+    {
+        __m128i Lo = _mm_setzero_si128(), Mid = _mm_setzero_si128(), Hi = _mm_setzero_si128();
+        __m128i X = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (Data + i*16)), Order);
+        mul_acc(_mm_xor_si128(Acc, X), Pow[7], &Lo, &Mid, &Hi);
+        for (int j = 1; j < 8; j++)
+        {
+            X = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (Data + (i + j)*16)), Order);
+            mul_acc(X, Pow[7 - j], &Lo, &Mid, &Hi);
+        }
+        Acc = reduce(Lo, Mid, Hi);
+    }
+    for (; i < Blocks; i++)
+    {
+        __m128i X = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (Data + i*16)), Order);
+        Acc = gf_mul(_mm_xor_si128(Acc, X), Pow[0]);
+    }
+
+    _mm_storeu_si128((__m128i*) Y, _mm_shuffle_epi8(Acc, Order));
+    return;
+}
+
+CLMUL_TARGET void ghash_clmul_update(const GHashKey* Key, uint8_t* Y, const uint8_t* Data, size_t Blocks)
+{
+    clmul_update(Key, Y, Data, Blocks, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    return;
+}
+
+CLMUL_TARGET void polyval_clmul_update(const GHashKey* Key, uint8_t* Y, const uint8_t* Data, size_t Blocks)
+{
+    //* POLYVAL blocks are GHASH blocks byte reversed, which cancels the reversal GHASH needs.
+    clmul_update(Key, Y, Data, Blocks, _mm_set_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+    return;
+}
+
+#endif // CPU_X86_SIMD
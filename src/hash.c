@@ -1,4 +1,9 @@
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
 #include "../include/hash.h"
+#include "../include/hash_backend.h"
+#include "../include/wipe.h"
 
 //* Byte = most significant bit first
 //* Word = 32-bit collection of 4 bytes, 
@@ -10,7 +15,7 @@
 #define I(X,Y,Z) ((Y) ^ ((X) | ~(Z)))
 #define Rot(X,Y) (((uint32_t) (X) << (Y)) | ((uint32_t) (X) >> (32 - (Y))))
 
-const uint32_t T[64] = 
+const uint32_t MD5T[64] = 
 {
     0XD76AA478, 0XE8C7B756, 0X242070DB, 0XC1BDCEEE, 
     0XF57C0FAF, 0X4787C62A, 0XA8304613, 0XFD469501, 
@@ -30,46 +35,254 @@ const uint32_t T[64] =
     0XF7537E82, 0XBD3AF235, 0X2AD7D2BB, 0XEB86D391
 };
 
-//! Needs error detection, Needs entire revise tbh
-ErrorCode hash_md5(void* Data, size_t Size, uint8_t* RetArr)
+/// @brief One message in flight in hash_md5_batch().
+/// @param In The next whole block of the message to hash.
+/// @param Blocks Blocks left before the padded ones (or the padded blocks left once Padded is set).
+/// @param PadBlocks Number of padded blocks in Last (1 or 2).
+/// @param Padded True once only the padded final blocks (Last) are left.
+/// @param Last The final bytes of the message, 0x80, zeros and the size in bits.
+typedef struct
 {
-    //? Calculate and assign variables.
+    MD5Job* Job;
+    const uint8_t* In;
+    size_t Blocks;
+    size_t PadBlocks;
+    bool Padded;
+    uint8_t Last[128];
+} MD5Lane;
 
-    uint8_t Pad = (120 - (Size % 64)) % 64;
-    uint8_t* NewData  = (uint8_t *) calloc((Size + Pad + 8), sizeof(uint8_t));
-    uint32_t* NewWord = (uint32_t*) NewData;
+/// @brief Hashes Blocks 64-byte blocks from Data into State (A, B, C, D).
+static void md5_blocks(uint32_t* State, const uint8_t* Data, size_t Blocks);
 
-    //? Create a copy of the data to modify.
+/// @brief Builds the padded tail of a message, then sets Lane up to hash its whole blocks.
+static void md5_lane_start(MD5Lane* Lane, uint32_t* State, MD5Job* Job);
+
+/// @brief Hashes Blocks blocks in each of Lanes messages, with the widest SIMD kernel the CPU supports.
+static void md5_lanes(uint32_t (*State)[4], const uint8_t* const* In, int Lanes, size_t Blocks);
+
+/// @brief Writes State as the 16-byte hash, each word lowest order byte first.
+static void md5_output(const uint32_t* State, uint8_t* RetArr);
+
+#ifdef CPU_X86_SIMD
+//* SIMD kernel md5_lanes() uses: 2 for AVX2, 1 for SSE2, 0 for neither. Resolved once through LevelOnce.
+static int Level;
+static pthread_once_t LevelOnce = PTHREAD_ONCE_INIT;
+
+/// @brief Sets Level from the CPU features.
+static void md5_resolve_level(void);
+#endif
+
+ErrorCode hash_md5(const void* Data, size_t Size, uint8_t* RetArr)
+{
+    MD5Ctx Ctx;
+    hash_md5_init(&Ctx);
+    hash_md5_update(&Ctx, Data, Size);
+    return hash_md5_final(&Ctx, RetArr);
+}
+
+ErrorCode hash_md5_init(MD5Ctx* Ctx)
 {
-    size_t i;
-    for (i = 0; i < Size; i++)
+    // Beginning values for (A, B, C, D)
+    Ctx->State[0] = 0x67452301;
+    Ctx->State[1] = 0xefcdab89;
+    Ctx->State[2] = 0x98badcfe;
+    Ctx->State[3] = 0x10325476;
+    Ctx->BufSize = 0;
+    Ctx->Length = 0;
+    return success;
+}
+
+ErrorCode hash_md5_update(MD5Ctx* Ctx, const void* Data, size_t Size)
+{
+    const uint8_t* In = (const uint8_t*) Data;
+    Ctx->Length += Size;
+
+    //* Complete the partial block from the last call first.
+    if (Ctx->BufSize != 0)
     {
-        NewData[i] = ((uint8_t *) Data)[i];
+        size_t Fill = 64 - Ctx->BufSize;
+        if (Size < Fill)
+            Fill = Size;
+        memcpy(Ctx->Buffer + Ctx->BufSize, In, Fill);
+        Ctx->BufSize += Fill;
+        In += Fill;
+        Size -= Fill;
+        if (Ctx->BufSize < 64)
+            return success;
+
+        md5_blocks(Ctx->State, Ctx->Buffer, 1);
+        Ctx->BufSize = 0;
     }
-    NewData[i] = 0x80;
-    i++;
+
+    //* Whole blocks straight from the caller's memory, then keep the rest.
+    md5_blocks(Ctx->State, In, Size/64);
+    memcpy(Ctx->Buffer, In + (Size & ~(size_t) 63), Size%64);
+    Ctx->BufSize = Size%64;
+    return success;
 }
-    //? Append Size (before padding)
 
-    // Append the size of the original Data (in bits) as two 32-bit words (low order first).
-    NewWord[(Size+Pad+0) >> 2] = (uint32_t) ((Size * 8) & 0xFFFFFFFF);
-    NewWord[(Size+Pad+4) >> 2] = (uint32_t) ((Size * 8) >> 32);
+ErrorCode hash_md5_final(MD5Ctx* Ctx, uint8_t* RetArr)
+{
+    //? Append 0x80, zeros up to 56 (mod 64), then the size in bits (low order first).
+    //* At most 55 buffered bytes fit in one block, otherwise the padding spills into a second one.
+    uint8_t Pad[128] = {0};
+    size_t Blocks = (Ctx->BufSize < 56) ? 1 : 2;
+    memcpy(Pad, Ctx->Buffer, Ctx->BufSize);
+    Pad[Ctx->BufSize] = 0x80;
 
-    //? Calculate the Hash
+    uint64_t Bits = Ctx->Length * 8;
+    for (int i = 0; i < 8; i++)
+        Pad[Blocks*64 - 8 + i] = (uint8_t) (Bits >> (8*i));
+    md5_blocks(Ctx->State, Pad, Blocks);
 
-    //! If I change ABCD to State[4], there might be code Size optimization to be had.
-    // Beginning values for (A, B, C, D)
-    uint32_t A = 0x67452301;
-    uint32_t B = 0xefcdab89;
-    uint32_t C = 0x98badcfe;
-    uint32_t D = 0x10325476;
+    md5_output(Ctx->State, RetArr);
+    wipe_bytes(Ctx, sizeof(MD5Ctx));
+    wipe_bytes(Pad, sizeof(Pad));
+    return success;
+}
+
+ErrorCode hash_md5_batch(MD5Job* Jobs, size_t Count)
+{
+    MD5Lane Lanes[MD5_LANES];
+    uint32_t State[MD5_LANES][4];
+    int Active = 0;
+    size_t Next = 0;
+
+    while (true)
+    {
+        //* Refill every free lane with the next message.
+        while (Active < MD5_LANES && Next < Count)
+        {
+            md5_lane_start(&Lanes[Active], State[Active], &Jobs[Next]);
+            Active++;
+            Next++;
+        }
+        if (Active == 0)
+            break;
+
+        //* Run every lane until the shortest one reaches the end of its whole blocks (or its padded blocks).
+        const uint8_t* In[MD5_LANES];
+        size_t Steps = Lanes[0].Blocks;
+        for (int l = 0; l < Active; l++)
+        {
+            In[l] = Lanes[l].Padded ? Lanes[l].Last + (Lanes[l].PadBlocks - Lanes[l].Blocks)*64 : Lanes[l].In;
+            if (Lanes[l].Blocks < Steps)
+                Steps = Lanes[l].Blocks;
+        }
+        md5_lanes(State, In, Active, Steps);
+
+        for (int l = 0; l < Active; l++)
+        {
+            MD5Lane* Lane = &Lanes[l];
+            Lane->In += Steps*64;
+            Lane->Blocks -= Steps;
+            if (Lane->Blocks != 0)
+                continue;
+
+            if (!Lane->Padded)
+            {
+                Lane->Padded = true;
+                Lane->Blocks = Lane->PadBlocks;
+                continue;
+            }
 
-   for (size_t i = 0; i < (Size+Pad+8)/64; i++)
-   {
+            //* Finished, move the last active lane into this one.
+            md5_output(State[l], Lane->Job->RetArr);
+            Active--;
+            if (l != Active)
+            {
+                Lanes[l] = Lanes[Active];
+                memcpy(State[l], State[Active], 16);
+                l--;
+            }
+        }
+    }
+    return success;
+}
+
+static void md5_lane_start(MD5Lane* Lane, uint32_t* State, MD5Job* Job)
+{
+    const uint8_t* Data = (const uint8_t*) Job->Data;
+    size_t Tail = Job->Size - (Job->Size%64);
+
+    //? Same padding as hash_md5_final(), built once up front.
+    memset(Lane->Last, 0, sizeof(Lane->Last));
+    memcpy(Lane->Last, Data + Tail, Job->Size%64);
+    Lane->Last[Job->Size%64] = 0x80;
+    Lane->PadBlocks = (Job->Size%64 < 56) ? 1 : 2;
+    uint64_t Bits = (uint64_t) Job->Size * 8;
+    for (int i = 0; i < 8; i++)
+        Lane->Last[Lane->PadBlocks*64 - 8 + i] = (uint8_t) (Bits >> (8*i));
+
+    State[0] = 0x67452301;
+    State[1] = 0xefcdab89;
+    State[2] = 0x98badcfe;
+    State[3] = 0x10325476;
+
+    Lane->Job = Job;
+    Lane->In = Data;
+    Lane->Blocks = Tail/64;
+    Lane->Padded = (Lane->Blocks == 0);
+    if (Lane->Padded)
+        Lane->Blocks = Lane->PadBlocks;
+    return;
+}
+
+#ifdef CPU_X86_SIMD
+static void md5_resolve_level(void)
+{
+    Level = cpu_has_avx2() ? 2 : (cpu_has_sse2() ? 1 : 0);
+    return;
+}
+#endif
+
+static void md5_lanes(uint32_t (*State)[4], const uint8_t* const* In, int Lanes, size_t Blocks)
+{
+#ifdef CPU_X86_SIMD
+    //* md5sum hashes batches from several threads at once.
+    pthread_once(&LevelOnce, md5_resolve_level);
+
+    //* A single lane is faster on the scalar code (it has a rotate instruction), half a batch fits the SSE2 kernel.
+    if (Lanes > 4 && Level == 2)
+    {
+        md5_avx2_lanes(State, In, Lanes, Blocks);
+        return;
+    }
+    if (Lanes > 1 && Level >= 1)
+    {
+        for (int l = 0; l < Lanes; l += 4)
+            md5_sse2_lanes(State + l, In + l, (Lanes - l < 4) ? Lanes - l : 4, Blocks);
+        return;
+    }
+#endif
+    for (int l = 0; l < Lanes; l++)
+        md5_blocks(State[l], In[l], Blocks);
+    return;
+}
+
+static void md5_output(const uint32_t* State, uint8_t* RetArr)
+{
+    //* The hash is (A, B, C, D), each word lowest order byte first.
+    for (int i = 0; i < 16; i++)
+        RetArr[i] = (uint8_t) (State[i/4] >> (8*(i%4)));
+    return;
+}
+
+static void md5_blocks(uint32_t* State, const uint8_t* Data, size_t Blocks)
+{
+    uint32_t A = State[0];
+    uint32_t B = State[1];
+    uint32_t C = State[2];
+    uint32_t D = State[3];
+
+    for (size_t i = 0; i < Blocks; i++, Data += 64)
+    {
+        //* Words are read lowest order byte first, independent of the host byte order.
         uint32_t X[16];
         for (int j = 0; j < 16; j++)
         {
-            X[j] = NewWord[i*16+j];
+            X[j] = (uint32_t) Data[4*j] | ((uint32_t) Data[4*j+1] << 8) |
+                ((uint32_t) Data[4*j+2] << 16) | ((uint32_t) Data[4*j+3] << 24);
         }
         uint32_t AA = A;
         uint32_t BB = B;
@@ -77,93 +290,86 @@ ErrorCode hash_md5(void* Data, size_t Size, uint8_t* RetArr)
         uint32_t DD = D;
 
         // Round 1
-        A = B + (Rot((A + F(B,C,D) + X[0] + T[0]), 7));
-        D = A + (Rot((D + F(A,B,C) + X[1] + T[1]), 12));
-        C = D + (Rot((C + F(D,A,B) + X[2] + T[2]), 17));
-        B = C + (Rot((B + F(C,D,A) + X[3] + T[3]), 22));
-        A = B + (Rot((A + F(B,C,D) + X[4] + T[4]), 7));
-        D = A + (Rot((D + F(A,B,C) + X[5] + T[5]), 12));
-        C = D + (Rot((C + F(D,A,B) + X[6] + T[6]), 17));
-        B = C + (Rot((B + F(C,D,A) + X[7] + T[7]), 22));
-        A = B + (Rot((A + F(B,C,D) + X[8] + T[8]), 7));
-        D = A + (Rot((D + F(A,B,C) + X[9] + T[9]), 12));
-        C = D + (Rot((C + F(D,A,B) + X[10] + T[10]), 17));
-        B = C + (Rot((B + F(C,D,A) + X[11] + T[11]), 22));
-        A = B + (Rot((A + F(B,C,D) + X[12] + T[12]), 7));
-        D = A + (Rot((D + F(A,B,C) + X[13] + T[13]), 12));
-        C = D + (Rot((C + F(D,A,B) + X[14] + T[14]), 17));
-        B = C + (Rot((B + F(C,D,A) + X[15] + T[15]), 22));
+        A = B + (Rot((A + F(B,C,D) + X[0] + MD5T[0]), 7));
+        D = A + (Rot((D + F(A,B,C) + X[1] + MD5T[1]), 12));
+        C = D + (Rot((C + F(D,A,B) + X[2] + MD5T[2]), 17));
+        B = C + (Rot((B + F(C,D,A) + X[3] + MD5T[3]), 22));
+        A = B + (Rot((A + F(B,C,D) + X[4] + MD5T[4]), 7));
+        D = A + (Rot((D + F(A,B,C) + X[5] + MD5T[5]), 12));
+        C = D + (Rot((C + F(D,A,B) + X[6] + MD5T[6]), 17));
+        B = C + (Rot((B + F(C,D,A) + X[7] + MD5T[7]), 22));
+        A = B + (Rot((A + F(B,C,D) + X[8] + MD5T[8]), 7));
+        D = A + (Rot((D + F(A,B,C) + X[9] + MD5T[9]), 12));
+        C = D + (Rot((C + F(D,A,B) + X[10] + MD5T[10]), 17));
+        B = C + (Rot((B + F(C,D,A) + X[11] + MD5T[11]), 22));
+        A = B + (Rot((A + F(B,C,D) + X[12] + MD5T[12]), 7));
+        D = A + (Rot((D + F(A,B,C) + X[13] + MD5T[13]), 12));
+        C = D + (Rot((C + F(D,A,B) + X[14] + MD5T[14]), 17));
+        B = C + (Rot((B + F(C,D,A) + X[15] + MD5T[15]), 22));
 
         // Round 2
-        A = B + (Rot((A + G(B,C,D) + X[1] + T[16]), 5));
-        D = A + (Rot((D + G(A,B,C) + X[6] + T[17]), 9));
-        C = D + (Rot((C + G(D,A,B) + X[11] + T[18]), 14));
-        B = C + (Rot((B + G(C,D,A) + X[0] + T[19]), 20));
-        A = B + (Rot((A + G(B,C,D) + X[5] + T[20]), 5));
-        D = A + (Rot((D + G(A,B,C) + X[10] + T[21]), 9));
-        C = D + (Rot((C + G(D,A,B) + X[15] + T[22]), 14));
-        B = C + (Rot((B + G(C,D,A) + X[4] + T[23]), 20));
-        A = B + (Rot((A + G(B,C,D) + X[9] + T[24]), 5));
-        D = A + (Rot((D + G(A,B,C) + X[14] + T[25]), 9));
-        C = D + (Rot((C + G(D,A,B) + X[3] + T[26]), 14));
-        B = C + (Rot((B + G(C,D,A) + X[8] + T[27]), 20));
-        A = B + (Rot((A + G(B,C,D) + X[13] + T[28]), 5));
-        D = A + (Rot((D + G(A,B,C) + X[2] + T[29]), 9));
-        C = D + (Rot((C + G(D,A,B) + X[7] + T[30]), 14));
-        B = C + (Rot((B + G(C,D,A) + X[12] + T[31]), 20));
+        A = B + (Rot((A + G(B,C,D) + X[1] + MD5T[16]), 5));
+        D = A + (Rot((D + G(A,B,C) + X[6] + MD5T[17]), 9));
+        C = D + (Rot((C + G(D,A,B) + X[11] + MD5T[18]), 14));
+        B = C + (Rot((B + G(C,D,A) + X[0] + MD5T[19]), 20));
+        A = B + (Rot((A + G(B,C,D) + X[5] + MD5T[20]), 5));
+        D = A + (Rot((D + G(A,B,C) + X[10] + MD5T[21]), 9));
+        C = D + (Rot((C + G(D,A,B) + X[15] + MD5T[22]), 14));
+        B = C + (Rot((B + G(C,D,A) + X[4] + MD5T[23]), 20));
+        A = B + (Rot((A + G(B,C,D) + X[9] + MD5T[24]), 5));
+        D = A + (Rot((D + G(A,B,C) + X[14] + MD5T[25]), 9));
+        C = D + (Rot((C + G(D,A,B) + X[3] + MD5T[26]), 14));
+        B = C + (Rot((B + G(C,D,A) + X[8] + MD5T[27]), 20));
+        A = B + (Rot((A + G(B,C,D) + X[13] + MD5T[28]), 5));
+        D = A + (Rot((D + G(A,B,C) + X[2] + MD5T[29]), 9));
+        C = D + (Rot((C + G(D,A,B) + X[7] + MD5T[30]), 14));
+        B = C + (Rot((B + G(C,D,A) + X[12] + MD5T[31]), 20));
 
         // Round 3
-        A = B + (Rot((A + H(B,C,D) + X[5] + T[32]), 4));
-        D = A + (Rot((D + H(A,B,C) + X[8] + T[33]), 11));
-        C = D + (Rot((C + H(D,A,B) + X[11] + T[34]), 16));
-        B = C + (Rot((B + H(C,D,A) + X[14] + T[35]), 23));
-        A = B + (Rot((A + H(B,C,D) + X[1] + T[36]), 4));
-        D = A + (Rot((D + H(A,B,C) + X[4] + T[37]), 11));
-        C = D + (Rot((C + H(D,A,B) + X[7] + T[38]), 16));
-        B = C + (Rot((B + H(C,D,A) + X[10] + T[39]), 23));
-        A = B + (Rot((A + H(B,C,D) + X[13] + T[40]), 4));
-        D = A + (Rot((D + H(A,B,C) + X[0] + T[41]), 11));
-        C = D + (Rot((C + H(D,A,B) + X[3] + T[42]), 16));
-        B = C + (Rot((B + H(C,D,A) + X[6] + T[43]), 23));
-        A = B + (Rot((A + H(B,C,D) + X[9] + T[44]), 4));
-        D = A + (Rot((D + H(A,B,C) + X[12] + T[45]), 11));
-        C = D + (Rot((C + H(D,A,B) + X[15] + T[46]), 16));
-        B = C + (Rot((B + H(C,D,A) + X[2] + T[47]), 23));
+        A = B + (Rot((A + H(B,C,D) + X[5] + MD5T[32]), 4));
+        D = A + (Rot((D + H(A,B,C) + X[8] + MD5T[33]), 11));
+        C = D + (Rot((C + H(D,A,B) + X[11] + MD5T[34]), 16));
+        B = C + (Rot((B + H(C,D,A) + X[14] + MD5T[35]), 23));
+        A = B + (Rot((A + H(B,C,D) + X[1] + MD5T[36]), 4));
+        D = A + (Rot((D + H(A,B,C) + X[4] + MD5T[37]), 11));
+        C = D + (Rot((C + H(D,A,B) + X[7] + MD5T[38]), 16));
+        B = C + (Rot((B + H(C,D,A) + X[10] + MD5T[39]), 23));
+        A = B + (Rot((A + H(B,C,D) + X[13] + MD5T[40]), 4));
+        D = A + (Rot((D + H(A,B,C) + X[0] + MD5T[41]), 11));
+        C = D + (Rot((C + H(D,A,B) + X[3] + MD5T[42]), 16));
+        B = C + (Rot((B + H(C,D,A) + X[6] + MD5T[43]), 23));
+        A = B + (Rot((A + H(B,C,D) + X[9] + MD5T[44]), 4));
+        D = A + (Rot((D + H(A,B,C) + X[12] + MD5T[45]), 11));
+        C = D + (Rot((C + H(D,A,B) + X[15] + MD5T[46]), 16));
+        B = C + (Rot((B + H(C,D,A) + X[2] + MD5T[47]), 23));
 
         // Round 4
-        A = B + (Rot((A + I(B,C,D) + X[0] + T[48]), 6));
-        D = A + (Rot((D + I(A,B,C) + X[7] + T[49]), 10));
-        C = D + (Rot((C + I(D,A,B) + X[14] + T[50]), 15));
-        B = C + (Rot((B + I(C,D,A) + X[5] + T[51]), 21));
-        A = B + (Rot((A + I(B,C,D) + X[12] + T[52]), 6));
-        D = A + (Rot((D + I(A,B,C) + X[3] + T[53]), 10));
-        C = D + (Rot((C + I(D,A,B) + X[10] + T[54]), 15));
-        B = C + (Rot((B + I(C,D,A) + X[1] + T[55]), 21));
-        A = B + (Rot((A + I(B,C,D) + X[8] + T[56]), 6));
-        D = A + (Rot((D + I(A,B,C) + X[15] + T[57]), 10));
-        C = D + (Rot((C + I(D,A,B) + X[6] + T[58]), 15));
-        B = C + (Rot((B + I(C,D,A) + X[13] + T[59]), 21));
-        A = B + (Rot((A + I(B,C,D) + X[4] + T[60]), 6));
-        D = A + (Rot((D + I(A,B,C) + X[11] + T[61]), 10));
-        C = D + (Rot((C + I(D,A,B) + X[2] + T[62]), 15));
-        B = C + (Rot((B + I(C,D,A) + X[9] + T[63]), 21));
+        A = B + (Rot((A + I(B,C,D) + X[0] + MD5T[48]), 6));
+        D = A + (Rot((D + I(A,B,C) + X[7] + MD5T[49]), 10));
+        C = D + (Rot((C + I(D,A,B) + X[14] + MD5T[50]), 15));
+        B = C + (Rot((B + I(C,D,A) + X[5] + MD5T[51]), 21));
+        A = B + (Rot((A + I(B,C,D) + X[12] + MD5T[52]), 6));
+        D = A + (Rot((D + I(A,B,C) + X[3] + MD5T[53]), 10));
+        C = D + (Rot((C + I(D,A,B) + X[10] + MD5T[54]), 15));
+        B = C + (Rot((B + I(C,D,A) + X[1] + MD5T[55]), 21));
+        A = B + (Rot((A + I(B,C,D) + X[8] + MD5T[56]), 6));
+        D = A + (Rot((D + I(A,B,C) + X[15] + MD5T[57]), 10));
+        C = D + (Rot((C + I(D,A,B) + X[6] + MD5T[58]), 15));
+        B = C + (Rot((B + I(C,D,A) + X[13] + MD5T[59]), 21));
+        A = B + (Rot((A + I(B,C,D) + X[4] + MD5T[60]), 6));
+        D = A + (Rot((D + I(A,B,C) + X[11] + MD5T[61]), 10));
+        C = D + (Rot((C + I(D,A,B) + X[2] + MD5T[62]), 15));
+        B = C + (Rot((B + I(C,D,A) + X[9] + MD5T[63]), 21));
 
         A = A + AA;
         B = B + BB;
         C = C + CC;
         D = D + DD;
-   }
-
-    //* TempHash will be 16 bytes (4 words). Set as (ABCD) with A being the lowest order byte
-    uint8_t TempHash[16];
-    // Treat TempHash as if it is an array of 4 words, instead of 16 bytes.
-    //! A majority of this program is probably little-endian dependant (especially here)
-    ((uint32_t*) RetArr)[0] = A;
-    ((uint32_t*) RetArr)[1] = B;
-    ((uint32_t*) RetArr)[2] = C;
-    ((uint32_t*) RetArr)[3] = D;
-
-    // Free the Malloc
-    free(NewData);
-    return 0;
-}
\ No newline at end of file
+    }
+
+    State[0] = A;
+    State[1] = B;
+    State[2] = C;
+    State[3] = D;
+    return;
+}
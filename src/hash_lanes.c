@@ -0,0 +1,179 @@
+#include "../include/hash_backend.h"
+
+#ifdef CPU_X86_SIMD
+#include <immintrin.h>
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+//* The 64 steps of one MD5 block, S(Function, a, b, c, d, Word, Constant, Shift) for a = b + Rot(a + Function(b,c,d) + X[Word] + T[Constant], Shift).
+#define MD5_STEPS(S) \
+    S(F, A, B, C, D, 0, 0, 7) S(F, D, A, B, C, 1, 1, 12) S(F, C, D, A, B, 2, 2, 17) S(F, B, C, D, A, 3, 3, 22) \
+    S(F, A, B, C, D, 4, 4, 7) S(F, D, A, B, C, 5, 5, 12) S(F, C, D, A, B, 6, 6, 17) S(F, B, C, D, A, 7, 7, 22) \
+    S(F, A, B, C, D, 8, 8, 7) S(F, D, A, B, C, 9, 9, 12) S(F, C, D, A, B, 10, 10, 17) S(F, B, C, D, A, 11, 11, 22) \
+    S(F, A, B, C, D, 12, 12, 7) S(F, D, A, B, C, 13, 13, 12) S(F, C, D, A, B, 14, 14, 17) S(F, B, C, D, A, 15, 15, 22) \
+    S(G, A, B, C, D, 1, 16, 5) S(G, D, A, B, C, 6, 17, 9) S(G, C, D, A, B, 11, 18, 14) S(G, B, C, D, A, 0, 19, 20) \
+    S(G, A, B, C, D, 5, 20, 5) S(G, D, A, B, C, 10, 21, 9) S(G, C, D, A, B, 15, 22, 14) S(G, B, C, D, A, 4, 23, 20) \
+    S(G, A, B, C, D, 9, 24, 5) S(G, D, A, B, C, 14, 25, 9) S(G, C, D, A, B, 3, 26, 14) S(G, B, C, D, A, 8, 27, 20) \
+    S(G, A, B, C, D, 13, 28, 5) S(G, D, A, B, C, 2, 29, 9) S(G, C, D, A, B, 7, 30, 14) S(G, B, C, D, A, 12, 31, 20) \
+    S(H, A, B, C, D, 5, 32, 4) S(H, D, A, B, C, 8, 33, 11) S(H, C, D, A, B, 11, 34, 16) S(H, B, C, D, A, 14, 35, 23) \
+    S(H, A, B, C, D, 1, 36, 4) S(H, D, A, B, C, 4, 37, 11) S(H, C, D, A, B, 7, 38, 16) S(H, B, C, D, A, 10, 39, 23) \
+    S(H, A, B, C, D, 13, 40, 4) S(H, D, A, B, C, 0, 41, 11) S(H, C, D, A, B, 3, 42, 16) S(H, B, C, D, A, 6, 43, 23) \
+    S(H, A, B, C, D, 9, 44, 4) S(H, D, A, B, C, 12, 45, 11) S(H, C, D, A, B, 15, 46, 16) S(H, B, C, D, A, 2, 47, 23) \
+    S(I, A, B, C, D, 0, 48, 6) S(I, D, A, B, C, 7, 49, 10) S(I, C, D, A, B, 14, 50, 15) S(I, B, C, D, A, 5, 51, 21) \
+    S(I, A, B, C, D, 12, 52, 6) S(I, D, A, B, C, 3, 53, 10) S(I, C, D, A, B, 10, 54, 15) S(I, B, C, D, A, 1, 55, 21) \
+    S(I, A, B, C, D, 8, 56, 6) S(I, D, A, B, C, 15, 57, 10) S(I, C, D, A, B, 6, 58, 15) S(I, B, C, D, A, 13, 59, 21) \
+    S(I, A, B, C, D, 4, 60, 6) S(I, D, A, B, C, 11, 61, 10) S(I, C, D, A, B, 2, 62, 15) S(I, B, C, D, A, 9, 63, 21)
+
+//? SSE2, 4 lanes
+
+//* F, G and I rewritten with one fewer operation (and no NOT for F and G), H as is.
+#define F128(X,Y,Z) _mm_xor_si128((Z), _mm_and_si128((X), _mm_xor_si128((Y), (Z))))
+#define G128(X,Y,Z) _mm_xor_si128((Y), _mm_and_si128((Z), _mm_xor_si128((X), (Y))))
+#define H128(X,Y,Z) _mm_xor_si128((X), _mm_xor_si128((Y), (Z)))
+#define I128(X,Y,Z) _mm_xor_si128((Y), _mm_or_si128((X), _mm_xor_si128((Z), Ones)))
+#define Rot128(X,Y) _mm_or_si128(_mm_slli_epi32((X), (Y)), _mm_srli_epi32((X), 32 - (Y)))
+
+#define STEP128(Fn, a, b, c, d, k, t, s) \
+    a = _mm_add_epi32(b, Rot128(_mm_add_epi32(_mm_add_epi32(a, Fn##128(b, c, d)), _mm_add_epi32(X[k], _mm_set1_epi32(MD5T[t]))), s));
+
+SSE2_TARGET void md5_sse2_lanes(uint32_t (*State)[4], const uint8_t* const* In, int Lanes, size_t Blocks)
+{
+    //* Unused lanes hash lane 0 again, their result is dropped.
+    const uint8_t* Ptr[4];
+    uint32_t Words[4][4] = {{0}};
+    for (int l = 0; l < 4; l++)
+    {
+        Ptr[l] = In[(l < Lanes) ? l : 0];
+        for (int w = 0; w < 4; w++)
+            Words[w][l] = State[(l < Lanes) ? l : 0][w];
+    }
+
+    const __m128i Ones = _mm_set1_epi32(-1);
+    __m128i A = _mm_loadu_si128((const __m128i*) Words[0]);
+    __m128i B = _mm_loadu_si128((const __m128i*) Words[1]);
+    __m128i C = _mm_loadu_si128((const __m128i*) Words[2]);
+    __m128i D = _mm_loadu_si128((const __m128i*) Words[3]);
+
+    for (size_t i = 0; i < Blocks; i++)
+    {
+        //* Transpose 4 words of each lane at a time, so X[j] holds word j of every lane.
+        __m128i X[16];
+        for (int j = 0; j < 16; j += 4)
+        {
+            __m128i R0 = _mm_loadu_si128((const __m128i*) (Ptr[0] + i*64 + j*4));
+            __m128i R1 = _mm_loadu_si128((const __m128i*) (Ptr[1] + i*64 + j*4));
+            __m128i R2 = _mm_loadu_si128((const __m128i*) (Ptr[2] + i*64 + j*4));
+            __m128i R3 = _mm_loadu_si128((const __m128i*) (Ptr[3] + i*64 + j*4));
+            __m128i T0 = _mm_unpacklo_epi32(R0, R1);
+            __m128i T1 = _mm_unpackhi_epi32(R0, R1);
+            __m128i T2 = _mm_unpacklo_epi32(R2, R3);
+            __m128i T3 = _mm_unpackhi_epi32(R2, R3);
+            X[j+0] = _mm_unpacklo_epi64(T0, T2);
+            X[j+1] = _mm_unpackhi_epi64(T0, T2);
+            X[j+2] = _mm_unpacklo_epi64(T1, T3);
+            X[j+3] = _mm_unpackhi_epi64(T1, T3);
+        }
+        __m128i AA = A;
+        __m128i BB = B;
+        __m128i CC = C;
+        __m128i DD = D;
+
+        MD5_STEPS(STEP128)
+
+        A = _mm_add_epi32(A, AA);
+        B = _mm_add_epi32(B, BB);
+        C = _mm_add_epi32(C, CC);
+        D = _mm_add_epi32(D, DD);
+    }
+
+    _mm_storeu_si128((__m128i*) Words[0], A);
+    _mm_storeu_si128((__m128i*) Words[1], B);
+    _mm_storeu_si128((__m128i*) Words[2], C);
+    _mm_storeu_si128((__m128i*) Words[3], D);
+    for (int l = 0; l < Lanes; l++)
+        for (int w = 0; w < 4; w++)
+            State[l][w] = Words[w][l];
+    return;
+}
+
+
+//? AVX2, 8 lanes
+
+#define F256(X,Y,Z) _mm256_xor_si256((Z), _mm256_and_si256((X), _mm256_xor_si256((Y), (Z))))
+#define G256(X,Y,Z) _mm256_xor_si256((Y), _mm256_and_si256((Z), _mm256_xor_si256((X), (Y))))
+#define H256(X,Y,Z) _mm256_xor_si256((X), _mm256_xor_si256((Y), (Z)))
+#define I256(X,Y,Z) _mm256_xor_si256((Y), _mm256_or_si256((X), _mm256_xor_si256((Z), Ones)))
+#define Rot256(X,Y) _mm256_or_si256(_mm256_slli_epi32((X), (Y)), _mm256_srli_epi32((X), 32 - (Y)))
+
+#define STEP256(Fn, a, b, c, d, k, t, s) \
+    a = _mm256_add_epi32(b, Rot256(_mm256_add_epi32(_mm256_add_epi32(a, Fn##256(b, c, d)), _mm256_add_epi32(X[k], _mm256_set1_epi32(MD5T[t]))), s));
+
+AVX2_TARGET void md5_avx2_lanes(uint32_t (*State)[4], const uint8_t* const* In, int Lanes, size_t Blocks)
+{
+    const uint8_t* Ptr[8];
+    uint32_t Words[4][8] = {{0}};
+    for (int l = 0; l < 8; l++)
+    {
+        Ptr[l] = In[(l < Lanes) ? l : 0];
+        for (int w = 0; w < 4; w++)
+            Words[w][l] = State[(l < Lanes) ? l : 0][w];
+    }
+
+    const __m256i Ones = _mm256_set1_epi32(-1);
+    __m256i A = _mm256_loadu_si256((const __m256i*) Words[0]);
+    __m256i B = _mm256_loadu_si256((const __m256i*) Words[1]);
+    __m256i C = _mm256_loadu_si256((const __m256i*) Words[2]);
+    __m256i D = _mm256_loadu_si256((const __m256i*) Words[3]);
+
+    for (size_t i = 0; i < Blocks; i++)
+    {
+        //* 8x8 transpose of each half block: 32-bit then 64-bit unpacks within 128-bit halves, then swap the halves.
+        __m256i X[16];
+        for (int j = 0; j < 16; j += 8)
+        {
+            __m256i R[8], T[8], U[8];
+            for (int l = 0; l < 8; l++)
+                R[l] = _mm256_loadu_si256((const __m256i*) (Ptr[l] + i*64 + j*4));
+            for (int l = 0; l < 8; l += 2)
+            {
+                T[l] = _mm256_unpacklo_epi32(R[l], R[l+1]);
+                T[l+1] = _mm256_unpackhi_epi32(R[l], R[l+1]);
+            }
+            for (int l = 0; l < 8; l += 4)
+            {
+                U[l+0] = _mm256_unpacklo_epi64(T[l], T[l+2]);
+                U[l+1] = _mm256_unpackhi_epi64(T[l], T[l+2]);
+                U[l+2] = _mm256_unpacklo_epi64(T[l+1], T[l+3]);
+                U[l+3] = _mm256_unpackhi_epi64(T[l+1], T[l+3]);
+            }
+            for (int w = 0; w < 4; w++)
+            {
+                X[j+w] = _mm256_permute2x128_si256(U[w], U[w+4], 0x20);
+                X[j+w+4] = _mm256_permute2x128_si256(U[w], U[w+4], 0x31);
+            }
+        }
+        __m256i AA = A;
+        __m256i BB = B;
+        __m256i CC = C;
+        __m256i DD = D;
+
+        MD5_STEPS(STEP256)
+
+        A = _mm256_add_epi32(A, AA);
+        B = _mm256_add_epi32(B, BB);
+        C = _mm256_add_epi32(C, CC);
+        D = _mm256_add_epi32(D, DD);
+    }
+
+    _mm256_storeu_si256((__m256i*) Words[0], A);
+    _mm256_storeu_si256((__m256i*) Words[1], B);
+    _mm256_storeu_si256((__m256i*) Words[2], C);
+    _mm256_storeu_si256((__m256i*) Words[3], D);
+    for (int l = 0; l < Lanes; l++)
+        for (int w = 0; w < 4; w++)
+            State[l][w] = Words[w][l];
+    return;
+}
+
+#endif // CPU_X86_SIMD
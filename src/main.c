@@ -4,16 +4,22 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdint.h>
-#include "../include/AES.h"
-#include "../include/Base64.h"
+#include <string.h>
+#include "../include/aes.h"
+#include "../include/base64.h"
 #include "../include/hash.h"
+#include "../include/md5sum.h"
 #include "../include/error.h"
 
 void PrintInfo(uint8_t* Array, size_t Size, bool isString);
 void StrToHex(char *Str);
 
-int main()
-{   
+int main(int Argc, char** Argv)
+{
+    //* "FullCrypto md5sum ..." hashes files, anything else runs the demo below.
+    if (Argc > 1 && strcmp(Argv[1], "md5sum") == 0)
+        return md5sum_run(Argc - 1, Argv + 1);
+
     //^ TODO
     //^ Refactor code to look nice (Reprogram the entire thing)
     //* Add error detection / reporting (Malloc, failure to encrypt/decrypt, etc).
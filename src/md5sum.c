@@ -0,0 +1,588 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <setjmp.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../include/md5sum.h"
+#include "../include/hash.h"
+#include "../include/thread.h"
+
+//* Files a worker takes at once, one hash_md5_batch() worth (one per AVX2 lane).
+#define SUM_GROUP 8
+
+//* Read size for files that cannot be mapped (pipes, stdin).
+#define SUM_CHUNK (1 << 20)
+
+/// @brief One file to hash (or check).
+/// @param Path The path as given (or found by walking a directory), "-" for stdin.
+/// @param Hash Set by the workers.
+/// @param Expected The hash read from the checksum list (check mode only).
+/// @param Error The errno of a failed open or read, 0 on success.
+typedef struct
+{
+    char* Path;
+    uint8_t Hash[16];
+    uint8_t Expected[16];
+    int Error;
+} SumFile;
+
+/// @brief A growable array of SumFile.
+typedef struct
+{
+    SumFile* Files;
+    size_t Count;
+    size_t Cap;
+} SumList;
+
+/// @brief One worker thread of sum_hash_all(), every worker shares List and Next.
+typedef struct
+{
+    SumList* List;
+    atomic_size_t* Next;
+} SumWorker;
+
+/// @brief An open file: mapped (Fd is -1) or left to be read in chunks.
+typedef struct
+{
+    const uint8_t* Data;
+    size_t Size;
+    bool Mapped;
+    int Fd;
+} SumMap;
+
+
+/// @brief Appends a copy of Path to List.
+/// @returns ErrorCode (success, malloc_error)
+static ErrorCode sum_add(SumList* List, const char* Path)
+{
+    if (List->Count == List->Cap)
+    {
+        size_t Cap = (List->Cap == 0) ? 64 : List->Cap*2;
+        SumFile* Files = realloc(List->Files, Cap*sizeof(SumFile));
+        if (Files == NULL)
+            return malloc_error;
+        List->Files = Files;
+        List->Cap = Cap;
+    }
+
+    SumFile* File = &List->Files[List->Count];
+    memset(File, 0, sizeof(SumFile));
+    File->Path = strdup(Path);
+    if (File->Path == NULL)
+        return malloc_error;
+    List->Count++;
+    return success;
+}
+
+/// @brief Adds Path to List, or every regular file below it (in name order) if it is a directory.
+/// @returns ErrorCode (success, malloc_error)
+static ErrorCode sum_collect(SumList* List, const char* Path)
+{
+    struct stat St;
+    if (strcmp(Path, "-") == 0 || stat(Path, &St) != 0 || !S_ISDIR(St.st_mode))
+        return sum_add(List, Path);    // Errors are reported when the file is opened.
+
+    struct dirent** Entries;
+    int Count = scandir(Path, &Entries, NULL, alphasort);
+    if (Count < 0)
+        return sum_add(List, Path);
+
+    ErrorCode TempError = success;
+    for (int i = 0; i < Count; i++)
+    {
+        const char* Name = Entries[i]->d_name;
+        if (TempError == success && strcmp(Name, ".") != 0 && strcmp(Name, "..") != 0)
+        {
+            size_t Len = strlen(Path) + strlen(Name) + 2;
+            char* Child = malloc(Len);
+            if (Child == NULL)
+                TempError = malloc_error;
+            else
+            {
+                snprintf(Child, Len, (Path[strlen(Path) - 1] == '/') ? "%s%s" : "%s/%s", Path, Name);
+
+                //* Directories are walked, symbolic links only followed to regular files (no loops).
+                if (lstat(Child, &St) == 0)
+                {
+                    if (S_ISDIR(St.st_mode))
+                        TempError = sum_collect(List, Child);
+                    else if (S_ISREG(St.st_mode) || (S_ISLNK(St.st_mode) && stat(Child, &St) == 0 && S_ISREG(St.st_mode)))
+                        TempError = sum_add(List, Child);
+                }
+                free(Child);
+            }
+        }
+        free(Entries[i]);
+    }
+    free(Entries);
+    return TempError;
+}
+
+/// @brief Opens Path and maps it if it is a regular file.
+/// @returns 0, or the errno of the failed open.
+static int sum_open(const char* Path, SumMap* Map)
+{
+    Map->Data = (const uint8_t*) "";
+    Map->Size = 0;
+    Map->Mapped = false;
+    Map->Fd = -1;
+
+    int Fd = (strcmp(Path, "-") == 0) ? STDIN_FILENO : open(Path, O_RDONLY);
+    if (Fd < 0)
+        return errno;
+
+    struct stat St;
+    if (fstat(Fd, &St) != 0)
+    {
+        int Error = errno;
+        if (Fd != STDIN_FILENO)
+            close(Fd);
+        return Error;
+    }
+    if (S_ISDIR(St.st_mode))
+    {
+        if (Fd != STDIN_FILENO)
+            close(Fd);
+        return EISDIR;
+    }
+
+    //* Regular files are hashed straight from the page cache, everything else (and files too large to map) is read.
+    if (S_ISREG(St.st_mode) && (uint64_t) St.st_size <= SIZE_MAX)
+    {
+        if (St.st_size == 0)
+        {
+            if (Fd != STDIN_FILENO)
+                close(Fd);
+            return 0;
+        }
+
+        void* Data = mmap(NULL, (size_t) St.st_size, PROT_READ, MAP_PRIVATE, Fd, 0);
+        if (Data != MAP_FAILED)
+        {
+            posix_madvise(Data, (size_t) St.st_size, POSIX_MADV_SEQUENTIAL);
+            Map->Data = Data;
+            Map->Size = (size_t) St.st_size;
+            Map->Mapped = true;
+            if (Fd != STDIN_FILENO)
+                close(Fd);
+            return 0;
+        }
+    }
+    Map->Fd = Fd;
+    return 0;
+}
+
+/// @brief Hashes an unmapped file in SUM_CHUNK reads, then closes it.
+/// @param Buffer The worker's read buffer, allocated on first use.
+/// @returns 0, or the errno of the failed read.
+static int sum_stream(SumMap* Map, uint8_t** Buffer, uint8_t* Hash)
+{
+    int Error = 0;
+    if (*Buffer == NULL)
+        *Buffer = malloc(SUM_CHUNK);
+    if (*Buffer == NULL)
+        Error = ENOMEM;
+
+    MD5Ctx Ctx;
+    hash_md5_init(&Ctx);
+    while (Error == 0)
+    {
+        ssize_t Got = read(Map->Fd, *Buffer, SUM_CHUNK);
+        if (Got == 0)
+            break;
+        if (Got < 0 && errno != EINTR)
+            Error = errno;
+        if (Got > 0)
+            hash_md5_update(&Ctx, *Buffer, (size_t) Got);
+    }
+    hash_md5_final(&Ctx, Hash);
+
+    if (Map->Fd != STDIN_FILENO)
+        close(Map->Fd);
+    Map->Fd = -1;
+    return Error;
+}
+
+//* Where a worker thread returns to if a mapped file is truncated under it, NULL outside hash_md5_batch().
+static _Thread_local sigjmp_buf* SumJump = NULL;
+
+/// @brief SIGBUS handler: a mapped page past the new end of a truncated file was touched.
+static void sum_sigbus(int Signal)
+{
+    //! Not from a mapped file being hashed, so a real fault: die of it as if there were no handler.
+    if (SumJump == NULL)
+    {
+        signal(Signal, SIG_DFL);
+        return;
+    }
+    siglongjmp(*SumJump, 1);
+}
+
+/// @brief Hashes a file again with read(), for a group whose mapped batch was cut short by SIGBUS.
+/// @returns 0, or the errno of the failed open or read.
+static int sum_reread(const char* Path, uint8_t** Buffer, uint8_t* Hash)
+{
+    SumMap Map = {NULL, 0, false, open(Path, O_RDONLY)};
+    if (Map.Fd < 0)
+        return errno;
+    return sum_stream(&Map, Buffer, Hash);
+}
+
+/// @brief hash_md5_batch() on mapped files, guarded against SIGBUS.
+/// @returns A boolean True/False, False if a file was truncated under its mapping and the hashes are unusable.
+static bool sum_batch(MD5Job* Jobs, size_t Count)
+{
+    sigjmp_buf Jump;
+    if (sigsetjmp(Jump, 1) != 0)
+    {
+        SumJump = NULL;
+        return false;
+    }
+    SumJump = &Jump;
+    hash_md5_batch(Jobs, Count);
+    SumJump = NULL;
+    return true;
+}
+
+/// @brief Worker loop: takes SUM_GROUP files at a time, maps them and hashes the mapped ones together.
+static void sum_worker(void* Arg)
+{
+    SumWorker* Worker = Arg;
+    SumList* List = Worker->List;
+    uint8_t* Buffer = NULL;
+
+    size_t First;
+    while ((First = atomic_fetch_add(Worker->Next, SUM_GROUP)) < List->Count)
+    {
+        size_t Count = (List->Count - First < SUM_GROUP) ? List->Count - First : SUM_GROUP;
+        SumMap Maps[SUM_GROUP];
+        MD5Job Jobs[SUM_GROUP];
+        size_t Mapped = 0;
+
+        for (size_t i = 0; i < Count; i++)
+        {
+            SumFile* File = &List->Files[First + i];
+            File->Error = sum_open(File->Path, &Maps[i]);
+            if (File->Error != 0)
+                continue;
+
+            if (Maps[i].Fd < 0)
+            {
+                Jobs[Mapped].Data = Maps[i].Data;
+                Jobs[Mapped].Size = Maps[i].Size;
+                Jobs[Mapped].RetArr = File->Hash;
+                Mapped++;
+            }
+            else
+                File->Error = sum_stream(&Maps[i], &Buffer, File->Hash);
+        }
+
+        //* A file truncated after mmap() raises SIGBUS on the lost pages, then every mapped file of the group is read instead.
+        if (!sum_batch(Jobs, Mapped))
+        {
+            for (size_t i = 0; i < Count; i++)
+            {
+                SumFile* File = &List->Files[First + i];
+                if (File->Error == 0 && Maps[i].Mapped)
+                    File->Error = sum_reread(File->Path, &Buffer, File->Hash);
+            }
+        }
+
+        for (size_t i = 0; i < Count; i++)
+            if (Maps[i].Mapped)
+                munmap((void*) Maps[i].Data, Maps[i].Size);
+    }
+    free(Buffer);
+    return;
+}
+
+/// @brief Hashes every file in List on Threads worker threads.
+static void sum_hash_all(SumList* List, unsigned Threads)
+{
+    size_t Groups = (List->Count + SUM_GROUP - 1) / SUM_GROUP;
+    if (Threads > THREAD_MAX)
+        Threads = THREAD_MAX;
+    if (Threads > Groups)
+        Threads = (unsigned) Groups;
+    if (Threads == 0)
+        return;
+
+    struct sigaction Guard, Old;
+    memset(&Guard, 0, sizeof(Guard));
+    Guard.sa_handler = sum_sigbus;
+    sigemptyset(&Guard.sa_mask);
+    sigaction(SIGBUS, &Guard, &Old);
+
+    atomic_size_t Next = 0;
+    SumWorker Workers[THREAD_MAX];
+    for (unsigned i = 0; i < Threads; i++)
+    {
+        Workers[i].List = List;
+        Workers[i].Next = &Next;
+    }
+    thread_run(sum_worker, Workers, sizeof(SumWorker), Threads);
+    sigaction(SIGBUS, &Old, NULL);
+    return;
+}
+
+/// @brief Parses 32 hex digits into a 16-byte hash.
+/// @returns A boolean True/False, False if Str does not start with 32 hex digits.
+static bool sum_parse_hex(const char* Str, uint8_t* Hash)
+{
+    for (int i = 0; i < 32; i++)
+    {
+        char C = Str[i];
+        int Nibble;
+        if (C >= '0' && C <= '9')
+            Nibble = C - '0';
+        else if (C >= 'a' && C <= 'f')
+            Nibble = C - 'a' + 10;
+        else if (C >= 'A' && C <= 'F')
+            Nibble = C - 'A' + 10;
+        else
+            return false;
+        Hash[i/2] = (i%2 == 0) ? (uint8_t) (Nibble << 4) : (uint8_t) (Hash[i/2] | Nibble);
+    }
+    return true;
+}
+
+/// @brief Checks whether Path has to be escaped on output (GNU md5sum: it holds a backslash or a newline).
+static bool sum_needs_escape(const char* Path)
+{
+    return strpbrk(Path, "\\\n") != NULL;
+}
+
+/// @brief Prints Path to stdout, with every backslash and newline escaped (as \\ and \n) if Escape is True.
+static void sum_print_path(const char* Path, bool Escape)
+{
+    if (!Escape)
+    {
+        fputs(Path, stdout);
+        return;
+    }
+    for (const char* C = Path; *C != '\0'; C++)
+    {
+        if (*C == '\\')
+            fputs("\\\\", stdout);
+        else if (*C == '\n')
+            fputs("\\n", stdout);
+        else
+            putchar(*C);
+    }
+    return;
+}
+
+/// @brief Undoes sum_print_path() in place.
+/// @returns A boolean True/False, False if Path holds a backslash that is not followed by a backslash or 'n'.
+static bool sum_unescape(char* Path)
+{
+    char* Out = Path;
+    for (const char* C = Path; *C != '\0'; C++)
+    {
+        if (*C != '\\')
+        {
+            *Out++ = *C;
+            continue;
+        }
+        C++;
+        if (*C == '\\')
+            *Out++ = '\\';
+        else if (*C == 'n')
+            *Out++ = '\n';
+        else
+            return false;
+    }
+    *Out = '\0';
+    return true;
+}
+
+/// @brief Reads "HASH  PATH" (or "HASH *PATH") lines from ListPath into List, "\\HASH  PATH" lines with PATH escaped.
+/// @param Bad Incremented for every improperly formatted line.
+/// @returns ErrorCode (success, unknown_error if ListPath cannot be read, malloc_error)
+static ErrorCode sum_read_list(SumList* List, const char* ListPath, size_t* Bad)
+{
+    FILE* Stream = (strcmp(ListPath, "-") == 0) ? stdin : fopen(ListPath, "r");
+    if (Stream == NULL)
+    {
+        fprintf(stderr, "FullCrypto: %s: %s\n", ListPath, strerror(errno));
+        return unknown_error;
+    }
+
+    ErrorCode TempError = success;
+    char* Line = NULL;
+    size_t Cap = 0;
+    ssize_t Len;
+    while (TempError == success && (Len = getline(&Line, &Cap, Stream)) >= 0)
+    {
+        while (Len > 0 && (Line[Len - 1] == '\n' || Line[Len - 1] == '\r'))
+            Line[--Len] = '\0';
+
+        //* A leading backslash marks a line whose path has its backslashes and newlines escaped.
+        char* Entry = Line;
+        bool Escaped = (Line[0] == '\\');
+        if (Escaped)
+        {
+            Entry++;
+            Len--;
+        }
+
+        uint8_t Expected[16];
+        if (Len < 35 || !sum_parse_hex(Entry, Expected) || Entry[32] != ' ' || (Entry[33] != ' ' && Entry[33] != '*')
+            || (Escaped && !sum_unescape(Entry + 34)))
+        {
+            (*Bad)++;
+            continue;
+        }
+        TempError = sum_add(List, Entry + 34);
+        if (TempError == success)
+            memcpy(List->Files[List->Count - 1].Expected, Expected, 16);
+    }
+    free(Line);
+    if (Stream != stdin)
+        fclose(Stream);
+    return TempError;
+}
+
+/// @brief Prints the usage line to stderr.
+static void sum_usage(void)
+{
+    fprintf(stderr, "Usage: FullCrypto md5sum [-c] [--quiet] [-j THREADS] [FILE|DIRECTORY]...\n");
+    return;
+}
+
+int md5sum_run(int Argc, char** Argv)
+{
+    bool Check = false, Quiet = false, Options = true;
+    unsigned Threads = thread_cores();
+    SumList List = {NULL, 0, 0};
+    SumList Args = {NULL, 0, 0};
+    ErrorCode TempError = success;
+
+    //? Options first (until "--"), everything else is a path.
+    for (int i = 1; i < Argc && TempError == success; i++)
+    {
+        const char* Arg = Argv[i];
+        if (Options && strcmp(Arg, "--") == 0)
+            Options = false;
+        else if (Options && (strcmp(Arg, "-c") == 0 || strcmp(Arg, "--check") == 0))
+            Check = true;
+        else if (Options && strcmp(Arg, "--quiet") == 0)
+            Quiet = true;
+        else if (Options && strncmp(Arg, "-j", 2) == 0)
+        {
+            const char* Count = (Arg[2] != '\0') ? Arg + 2 : ((i + 1 < Argc) ? Argv[++i] : "");
+            char* End;
+            long Value = strtol(Count, &End, 10);
+            if (*Count == '\0' || *End != '\0' || Value < 1)
+            {
+                sum_usage();
+                TempError = unknown_error;
+            }
+            else
+                Threads = (Value > THREAD_MAX) ? THREAD_MAX : (unsigned) Value;
+        }
+        else if (Options && Arg[0] == '-' && Arg[1] != '\0')
+        {
+            sum_usage();
+            TempError = unknown_error;
+        }
+        else
+            TempError = sum_add(&Args, Arg);
+    }
+    if (TempError == success && Args.Count == 0)
+        TempError = sum_add(&Args, "-");
+
+    //? Gather the files: walk the paths, or read the checksum lists.
+    size_t Bad = 0;
+    bool Failed = false;
+    for (size_t i = 0; i < Args.Count && TempError == success; i++)
+    {
+        if (!Check)
+            TempError = sum_collect(&List, Args.Files[i].Path);
+        else if (sum_read_list(&List, Args.Files[i].Path, &Bad) != success)
+            Failed = true;
+    }
+    if (TempError == malloc_error)
+        fprintf(stderr, "FullCrypto: out of memory\n");
+
+    if (TempError == success)
+        sum_hash_all(&List, Threads);
+
+    //? Report in input order.
+    size_t Unread = 0, Mismatch = 0;
+    //* Like GNU md5sum, a path with a backslash or a newline is escaped, and its line starts with a backslash.
+    for (size_t i = 0; i < List.Count && TempError == success; i++)
+    {
+        SumFile* File = &List.Files[i];
+        bool Escape = sum_needs_escape(File->Path);
+        const char* Status = NULL;
+        if (File->Error != 0)
+        {
+            fprintf(stderr, "FullCrypto: %s: %s\n", File->Path, strerror(File->Error));
+            Unread++;
+            if (Check)
+                Status = "FAILED open or read";
+        }
+        else if (!Check)
+        {
+            if (Escape)
+                putchar('\\');
+            for (int j = 0; j < 16; j++)
+                printf("%.2x", File->Hash[j]);
+            fputs("  ", stdout);
+            sum_print_path(File->Path, Escape);
+            putchar('\n');
+        }
+        else if (memcmp(File->Hash, File->Expected, 16) != 0)
+        {
+            Status = "FAILED";
+            Mismatch++;
+        }
+        else if (!Quiet)
+            Status = "OK";
+
+        if (Status != NULL)
+        {
+            if (Escape)
+                putchar('\\');
+            sum_print_path(File->Path, Escape);
+            printf(": %s\n", Status);
+        }
+    }
+
+    if (Check && TempError == success)
+    {
+        if (Bad != 0)
+            fprintf(stderr, "FullCrypto: WARNING: %zu line%s improperly formatted\n", Bad, (Bad == 1) ? " is" : "s are");
+        if (Unread != 0)
+            fprintf(stderr, "FullCrypto: WARNING: %zu listed file%s could not be read\n", Unread, (Unread == 1) ? "" : "s");
+        if (Mismatch != 0)
+            fprintf(stderr, "FullCrypto: WARNING: %zu computed checksum%s did NOT match\n", Mismatch, (Mismatch == 1) ? "" : "s");
+        if (List.Count == 0 && !Failed)
+        {
+            fprintf(stderr, "FullCrypto: no properly formatted MD5 checksum lines found\n");
+            Failed = true;
+        }
+    }
+
+    for (size_t i = 0; i < List.Count; i++)
+        free(List.Files[i].Path);
+    for (size_t i = 0; i < Args.Count; i++)
+        free(Args.Files[i].Path);
+    free(List.Files);
+    free(Args.Files);
+
+    fflush(stdout);
+    return (TempError != success || Failed || Unread != 0 || Mismatch != 0) ? 1 : 0;
+}
@@ -0,0 +1,59 @@
+#include <pthread.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include "../include/thread.h"
+
+/// @brief A job handed to pthread_create(), which needs a void* (void*) entry point.
+typedef struct
+{
+    void (*Func)(void*);
+    void* Arg;
+} ThreadJob;
+
+/// @brief pthread entry point, runs one ThreadJob.
+static void* thread_entry(void* Arg)
+{
+    ThreadJob* Job = Arg;
+    Job->Func(Job->Arg);
+    return NULL;
+}
+
+void thread_run(void (*Func)(void*), void* Jobs, size_t ArgSize, unsigned Count)
+{
+    pthread_t Threads[THREAD_MAX];
+    ThreadJob Entry[THREAD_MAX];
+    bool Started[THREAD_MAX];
+    if (Count > THREAD_MAX)
+        Count = THREAD_MAX;
+    if (Count == 0)
+        return;
+
+    //* Jobs 0..Count-2 on new threads, the last one on the caller while they run.
+    for (unsigned i = 0; i + 1 < Count; i++)
+    {
+        Entry[i].Func = Func;
+        Entry[i].Arg = (char*) Jobs + i*ArgSize;
+        Started[i] = (pthread_create(&Threads[i], NULL, thread_entry, &Entry[i]) == 0);
+    }
+    Func((char*) Jobs + (Count - 1)*ArgSize);
+
+    //* A thread that failed to start runs its job here instead.
+    for (unsigned i = 0; i + 1 < Count; i++)
+    {
+        if (Started[i])
+            pthread_join(Threads[i], NULL);
+        else
+            Func(Entry[i].Arg);
+    }
+    return;
+}
+
+unsigned thread_cores(void)
+{
+    long Cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (Cores < 1)
+        return 1;
+    if (Cores > THREAD_MAX)
+        return THREAD_MAX;
+    return (unsigned) Cores;
+}
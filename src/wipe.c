@@ -0,0 +1,19 @@
+#include <stdint.h>
+#include "../include/wipe.h"
+
+void wipe_bytes(void* Data, size_t Size)
+{
+    //* Volatile prevents the compiler from removing the wipe as a dead store.
+    //* 8 bytes per store while Data is 8-byte aligned, then one byte at a time.
+    size_t i = 0;
+    if ((uintptr_t) Data % 8 == 0)
+    {
+        volatile uint64_t* Words = (volatile uint64_t*) Data;
+        for (; i + 8 <= Size; i += 8)
+            Words[i/8] = 0;
+    }
+    volatile uint8_t* Bytes = (volatile uint8_t*) Data;
+    for (; i < Size; i++)
+        Bytes[i] = 0;
+    return;
+}
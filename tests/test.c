@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <string.h>
+#include "../include/aes.h"
+#include "test.h"
+
+char Config[96];
+static unsigned Failures = 0;
+
+void check(bool Passed, const char* Name, int Line)
+{
+    if (Passed)
+        return;
+    Failures++;
+    printf("FAIL [%s] %s (line %d)\n", Config, Name, Line);
+}
+
+size_t hex_bytes(const char* Hex, uint8_t* Out)
+{
+    size_t Size = strlen(Hex) / 2;
+    for (size_t i = 0; i < Size; i++)
+    {
+        unsigned Byte;
+        sscanf(Hex + 2*i, "%2x", &Byte);
+        Out[i] = (uint8_t) Byte;
+    }
+    return Size;
+}
+
+bool is_zero(const uint8_t* Data, size_t Size)
+{
+    for (size_t i = 0; i < Size; i++)
+        if (Data[i] != 0)
+            return false;
+    return true;
+}
+
+void fill_random(uint8_t* Data, size_t Size, uint32_t Seed)
+{
+    uint32_t State = Seed | 1;
+    for (size_t i = 0; i < Size; i++)
+    {
+        State ^= State << 13;
+        State ^= State >> 17;
+        State ^= State << 5;
+        Data[i] = (uint8_t) State;
+    }
+}
+
+
+//? Known answer vectors
+
+const AEADVector GCMVectors[] =
+{
+    {
+        "0000000000000000000000000000000000000000000000000000000000000000", "000000000000000000000000", "",
+        "",
+        "",
+        "530f8afbc74536b9a963b4f1c4cb738b"
+    },
+    {
+        "0000000000000000000000000000000000000000000000000000000000000000", "000000000000000000000000", "",
+        "00000000000000000000000000000000",
+        "cea7403d4d606b6e074ec5d3baf39d18",
+        "d0d1c8a799996bf0265b98b5d48ab919"
+    },
+    {
+        "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888", "",
+        "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b391aafd255",
+        "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662898015ad",
+        "b094dac5d93471bdec1a502270e3cc6c"
+    },
+    {
+        "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888", "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+        "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+        "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662",
+        "76fc6ece0f4e1768cddf8853bb2d551b"
+    },
+};
+const size_t GCMVectorCount = sizeof(GCMVectors) / sizeof(GCMVectors[0]);
+
+//* The counter of the last two (appendix C.3) starts at 0xFFFFFFFF.
+const AEADVector SIVVectors[] =
+{
+    {
+        "0100000000000000000000000000000000000000000000000000000000000000", "030000000000000000000000", "",
+        "",
+        "",
+        "07f5f4169bbf55a8400cd47ea6fd400f"
+    },
+    {
+        "0100000000000000000000000000000000000000000000000000000000000000", "030000000000000000000000", "",
+        "0100000000000000",
+        "c2ef328e5c71c83b",
+        "843122130f7364b761e0b97427e3df28"
+    },
+    {
+        "0100000000000000000000000000000000000000000000000000000000000000", "030000000000000000000000", "",
+        "010000000000000000000000",
+        "9aab2aeb3faa0a34aea8e2b1",
+        "8ca50da9ae6559e48fd10f6e5c9ca17e"
+    },
+    {
+        "0100000000000000000000000000000000000000000000000000000000000000", "030000000000000000000000", "",
+        "01000000000000000000000000000000",
+        "85a01b63025ba19b7fd3ddfc033b3e76",
+        "c9eac6fa700942702e90862383c6c366"
+    },
+    {
+        "0100000000000000000000000000000000000000000000000000000000000000", "030000000000000000000000", "",
+        "0100000000000000000000000000000002000000000000000000000000000000",
+        "4a6a9db4c8c6549201b9edb53006cba821ec9cf850948a7c86c68ac7539d027f",
+        "e819e63abcd020b006a976397632eb5d"
+    },
+    {
+        "0100000000000000000000000000000000000000000000000000000000000000", "030000000000000000000000", "01",
+        "0200000000000000",
+        "1de22967237a8132",
+        "91213f267e3b452f02d01ae33e4ec854"
+    },
+    {
+        "0000000000000000000000000000000000000000000000000000000000000000", "000000000000000000000000", "",
+        "000000000000000000000000000000004db923dc793ee6497c76dcc03a98e108",
+        "f3f80f2cf0cb2dd9c5984fcda908456cc537703b5ba70324a6793a7bf218d3ea",
+        "ffffffff000000000000000000000000"
+    },
+    {
+        "0000000000000000000000000000000000000000000000000000000000000000", "000000000000000000000000", "",
+        "eb3640277c7ffd1303c7a542d02d3e4c0000000000000000",
+        "18ce4f0b8cb4d0cac65fea8f79257b20888e53e72299e56d",
+        "ffffffff000000000000000000000000"
+    },
+};
+const size_t SIVVectorCount = sizeof(SIVVectors) / sizeof(SIVVectors[0]);
+
+void load_vector(const AEADVector* V, AEADCase* T)
+{
+    hex_bytes(V->Key, T->Key);
+    hex_bytes(V->IV, T->IV);
+    T->ASize = hex_bytes(V->AAD, T->AAD);
+    T->Size = hex_bytes(V->Plaintext, T->P);
+    hex_bytes(V->Ciphertext, T->C);
+    hex_bytes(V->Tag, T->Tag);
+    memcpy(T->Bad, T->Tag, 16);
+    T->Bad[15] ^= 0x01;
+}
+
+
+//? Configurations
+
+static const AESBackend Backends[] = {aes_backend_bytewise, aes_backend_ttable, aes_backend_aesni, aes_backend_bitslice, aes_backend_vperm};
+static const char* BackendNames[] = {"bytewise", "ttable", "aesni", "bitslice", "vperm"};
+static const GHashBackend GHashes[] = {ghash_backend_bitserial, ghash_backend_clmul, ghash_backend_table4, ghash_backend_table8};
+static const char* GHashNames[] = {"bitserial", "clmul", "table4", "table8"};
+static const unsigned ThreadCounts[] = {1, 4};
+
+unsigned test_configs(void (*Run)(void), unsigned Flags)
+{
+    size_t BackendCount = (Flags & TEST_AES_BACKENDS) ? sizeof(Backends) / sizeof(Backends[0]) : 1;
+    size_t GHashCount = (Flags & TEST_GHASH_BACKENDS) ? sizeof(GHashes) / sizeof(GHashes[0]) : 1;
+    size_t ThreadCount = (Flags & TEST_THREADS) ? sizeof(ThreadCounts) / sizeof(ThreadCounts[0]) : 1;
+    unsigned Configs = 0;
+
+    for (size_t b = 0; b < BackendCount; b++)
+    {
+        if ((Flags & TEST_AES_BACKENDS) && aes_set_backend(Backends[b]) != success)
+        {
+            printf("skip %s (not supported)\n", BackendNames[b]);
+            continue;
+        }
+        for (size_t g = 0; g < GHashCount; g++)
+        {
+            if ((Flags & TEST_GHASH_BACKENDS) && aes_set_ghash_backend(GHashes[g]) != success)
+            {
+                printf("skip %s (not supported)\n", GHashNames[g]);
+                continue;
+            }
+            for (size_t t = 0; t < ThreadCount; t++)
+            {
+                //* Threshold 0: every message large enough for two THREAD_MIN_PART ranges is split.
+                if (Flags & TEST_THREADS)
+                    aes_set_threads(ThreadCounts[t], (ThreadCounts[t] == 1) ? AES_THREAD_THRESHOLD : 0);
+                snprintf(Config, sizeof(Config), "%s, %s, %u threads", (Flags & TEST_AES_BACKENDS) ? BackendNames[b] : "default",
+                         (Flags & TEST_GHASH_BACKENDS) ? GHashNames[g] : "default", aes_get_threads());
+                Run();
+                Configs++;
+            }
+        }
+    }
+    aes_set_backend(aes_backend_auto);
+    aes_set_ghash_backend(ghash_backend_auto);
+    aes_set_threads(1, AES_THREAD_THRESHOLD);
+    return Configs;
+}
+
+int test_result(unsigned Configs)
+{
+    printf("%u configurations, %u failures\n", Configs, Failures);
+    return (Failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//* Shared helpers of the ctest programs in tests/, each program exits with 1 if any CHECK failed.
+
+/// @brief Name of the configuration under test, printed with every failure.
+extern char Config[96];
+
+/// @brief Counts a failure and prints Name and the line if Cond is false.
+#define CHECK(Cond, Name) check((Cond), (Name), __LINE__)
+
+void check(bool Passed, const char* Name, int Line);
+
+/// @brief Decodes a hex string into Out, returns the number of bytes.
+size_t hex_bytes(const char* Hex, uint8_t* Out);
+
+/// @brief Checks whether all Size bytes of Data are 0.
+bool is_zero(const uint8_t* Data, size_t Size);
+
+/// @brief Fills Data with deterministic pseudo random bytes (xorshift32), so every configuration sees the same data.
+void fill_random(uint8_t* Data, size_t Size, uint32_t Seed);
+
+/// @brief An AEAD known answer test, all fields hex.
+typedef struct
+{
+    const char* Key;
+    const char* IV;
+    const char* AAD;
+    const char* Plaintext;
+    const char* Ciphertext;
+    const char* Tag;
+} AEADVector;
+
+/// @brief A decoded AEADVector, Bad is Tag with one bit flipped.
+typedef struct
+{
+    uint8_t Key[32], IV[12], AAD[32], P[64], C[64], Tag[16], Bad[16];
+    size_t ASize, Size;
+} AEADCase;
+
+/// @brief AES-256 GCM: test cases 13 to 16 of McGrew and Viega, "The Galois/Counter Mode of Operation (GCM)".
+extern const AEADVector GCMVectors[];
+extern const size_t GCMVectorCount;
+
+/// @brief AES-256-GCM-SIV: RFC 8452 appendix C.2, and the two counter wrap tests of appendix C.3.
+extern const AEADVector SIVVectors[];
+extern const size_t SIVVectorCount;
+
+void load_vector(const AEADVector* V, AEADCase* T);
+
+//* What test_configs() iterates over.
+#define TEST_AES_BACKENDS 0x01
+#define TEST_GHASH_BACKENDS 0x02
+#define TEST_THREADS 0x04
+
+/// @brief Runs Run once per configuration, with Config naming it. Backends this CPU does not support are skipped.
+/// @param Flags TEST_ flags for the settings to iterate over, 0 runs once on the defaults.
+/// @returns The number of configurations run.
+unsigned test_configs(void (*Run)(void), unsigned Flags);
+
+/// @brief Prints the summary line.
+/// @returns The exit code of the test program, 1 if anything failed.
+int test_result(unsigned Configs);
+
+#endif // TEST_H
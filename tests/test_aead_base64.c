@@ -0,0 +1,162 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/aes.h"
+#include "../include/base64.h"
+#include "test.h"
+
+//* The fused Base64 GCM and GCM-SIV functions: the known answers as Base64, every size around the 3 KiB staging piece and
+//* the thread split against encrypting then encoding, and a bad Tag or invalid Base64 anywhere zeroing the Plaintext.
+
+//* Around the partial block, the staging piece (3072 bytes), and the thread split (THREAD_MIN_PART is 64 KiB).
+static const size_t Sizes[] = {0, 1, 2, 3, 16, 17, 3071, 3072, 3073, 6143, 6144, 6145, 131089, 262167};
+#define SIZE_COUNT (sizeof(Sizes) / sizeof(Sizes[0]))
+
+static void test_vectors(void)
+{
+    char B64[BASE64_ENCODED_SIZE(64)], Expect[BASE64_ENCODED_SIZE(64)];
+    uint8_t Out[BASE64_DECODED_MAX(BASE64_ENCODED_SIZE(64))], Tag[16];
+    size_t Len, ExpectLen, Size;
+
+    for (size_t v = 0; v < GCMVectorCount; v++)
+    {
+        AEADCase T;
+        load_vector(&GCMVectors[v], &T);
+        AESGCMKey Ctx;
+        aes_gcm_key_init(&Ctx, T.Key);
+
+        base64_convert_string_into(T.C, T.Size, Expect, &ExpectLen);
+        CHECK(aes_gcm_enc_base64_ctx(T.P, T.Size, T.AAD, T.ASize, &Ctx, T.IV, B64, &Len, Tag) == success, "gcm enc base64");
+        CHECK(Len == ExpectLen && memcmp(B64, Expect, Len) == 0 && memcmp(Tag, T.Tag, 16) == 0, "gcm enc base64 vector");
+        CHECK(aes_gcm_dec_base64_ctx(B64, Len, T.AAD, T.ASize, &Ctx, T.IV, T.Tag, Out, &Size) == success, "gcm dec base64");
+        CHECK(Size == T.Size && memcmp(Out, T.P, T.Size) == 0, "gcm dec base64 vector");
+        memset(Out, 0x55, sizeof(Out));
+        CHECK(aes_gcm_dec_base64_ctx(B64, Len, T.AAD, T.ASize, &Ctx, T.IV, T.Bad, Out, &Size) == unknown_error, "gcm dec base64 bad tag");
+        CHECK(is_zero(Out, T.Size), "gcm dec base64 bad tag zeroes Plaintext");
+        aes_gcm_key_clear(&Ctx);
+    }
+
+    for (size_t v = 0; v < SIVVectorCount; v++)
+    {
+        AEADCase T;
+        load_vector(&SIVVectors[v], &T);
+        AESKey Ctx;
+        aes_key_init(&Ctx, T.Key);
+
+        base64_convert_string_into(T.C, T.Size, Expect, &ExpectLen);
+        CHECK(aes_siv_enc_base64_ctx(T.P, T.Size, T.AAD, T.ASize, &Ctx, T.IV, B64, &Len, Tag) == success, "siv enc base64");
+        CHECK(Len == ExpectLen && memcmp(B64, Expect, Len) == 0 && memcmp(Tag, T.Tag, 16) == 0, "siv enc base64 vector");
+        CHECK(aes_siv_dec_base64_ctx(B64, Len, T.AAD, T.ASize, &Ctx, T.IV, T.Tag, Out, &Size) == success, "siv dec base64");
+        CHECK(Size == T.Size && memcmp(Out, T.P, T.Size) == 0, "siv dec base64 vector");
+        memset(Out, 0x55, sizeof(Out));
+        CHECK(aes_siv_dec_base64_ctx(B64, Len, T.AAD, T.ASize, &Ctx, T.IV, T.Bad, Out, &Size) == unknown_error, "siv dec base64 bad tag");
+        CHECK(is_zero(Out, T.Size), "siv dec base64 bad tag zeroes Plaintext");
+        aes_key_clear(&Ctx);
+    }
+}
+
+/// @brief Opens B64 with the GCM (Siv false) or GCM-SIV function.
+static ErrorCode dec_base64(bool Siv, const char* B64, size_t Len, const uint8_t* AAD, const AESGCMKey* GCM, const AESKey* SIV,
+                            const uint8_t* IV, const uint8_t* Tag, uint8_t* Out, size_t* OutSize)
+{
+    if (Siv)
+        return aes_siv_dec_base64_ctx(B64, Len, AAD, 21, SIV, IV, Tag, Out, OutSize);
+    return aes_gcm_dec_base64_ctx(B64, Len, AAD, 21, GCM, IV, Tag, Out, OutSize);
+}
+
+static void test_sizes(void)
+{
+    uint8_t Key[32], IV[12], AAD[21], Tag[16], RefTag[16];
+    fill_random(Key, 32, 40);
+    fill_random(IV, 12, 41);
+    fill_random(AAD, 21, 42);
+    AESGCMKey GCM;
+    AESKey SIV;
+    aes_gcm_key_init(&GCM, Key);
+    aes_key_init(&SIV, Key);
+
+    size_t Max = Sizes[SIZE_COUNT - 1];
+    uint8_t* P = malloc(Max + 1);
+    uint8_t* C = malloc(Max + 1);
+    uint8_t* Out = malloc(Max + 1);
+    char* Expect = malloc(BASE64_ENCODED_SIZE(Max) + 1);
+    char* B64 = malloc(BASE64_ENCODED_SIZE(Max) + 1);
+
+    for (size_t s = 0; s < SIZE_COUNT; s++)
+    {
+        size_t Size = Sizes[s], Len, ExpectLen, OutSize;
+        fill_random(P, Size, 43 + (uint32_t) s);
+
+        for (int m = 0; m < 2; m++)
+        {
+            bool Siv = (m == 1);
+            memcpy(C, P, Size);
+            if (Siv)
+                aes_siv_enc_ctx(C, Size, AAD, sizeof(AAD), &SIV, IV, RefTag);
+            else
+                aes_gcm_enc_ctx(C, Size, AAD, sizeof(AAD), &GCM, IV, RefTag);
+            base64_convert_string_into(C, Size, Expect, &ExpectLen);
+
+            ErrorCode Sealed = Siv ? aes_siv_enc_base64_ctx(P, Size, AAD, sizeof(AAD), &SIV, IV, B64, &Len, Tag)
+                                   : aes_gcm_enc_base64_ctx(P, Size, AAD, sizeof(AAD), &GCM, IV, B64, &Len, Tag);
+            CHECK(Sealed == success && Len == ExpectLen && memcmp(B64, Expect, Len) == 0, "enc base64 matches encoding the Ciphertext");
+            CHECK(memcmp(Tag, RefTag, 16) == 0, "enc base64 Tag matches");
+
+            memset(Out, 0x55, Size + 1);
+            CHECK(dec_base64(Siv, B64, Len, AAD, &GCM, &SIV, IV, Tag, Out, &OutSize) == success, "dec base64");
+            CHECK(OutSize == Size && memcmp(Out, P, Size) == 0, "dec base64 round trip");
+
+            //* A bad Tag, then an invalid character in the first, a middle and the last staging piece.
+            Tag[15] ^= 0x40;
+            memset(Out, 0x55, Size + 1);
+            CHECK(dec_base64(Siv, B64, Len, AAD, &GCM, &SIV, IV, Tag, Out, &OutSize) == unknown_error && is_zero(Out, Size), "dec base64 bad tag zeroes Plaintext");
+            Tag[15] ^= 0x40;
+            if (Len == 0)
+                continue;
+            size_t Where[] = {0, Len/2, Len - 2};
+            for (size_t w = 0; w < sizeof(Where) / sizeof(Where[0]); w++)
+            {
+                char Saved = B64[Where[w]];
+                B64[Where[w]] = '!';
+                memset(Out, 0x55, Size + 1);
+                CHECK(dec_base64(Siv, B64, Len, AAD, &GCM, &SIV, IV, Tag, Out, &OutSize) == unknown_error && is_zero(Out, Size), "dec base64 invalid character zeroes Plaintext");
+                B64[Where[w]] = Saved;
+            }
+
+            //* Not a whole number of quartets.
+            CHECK(dec_base64(Siv, B64, Len - 1, AAD, &GCM, &SIV, IV, Tag, Out, &OutSize) == unknown_error, "dec base64 partial quartet");
+        }
+    }
+
+    //* Padding in the middle of the text: two padded encodings back to back.
+    char Twice[16];
+    size_t OutSize;
+    memcpy(Twice, "QUJDRA==QUJDRA==", 16);
+    CHECK(aes_gcm_dec_base64_ctx(Twice, 16, NULL, 0, &GCM, IV, Tag, Out, &OutSize) == unknown_error && is_zero(Out, 8), "gcm dec base64 padding in the middle");
+    CHECK(aes_siv_dec_base64_ctx(Twice, 16, NULL, 0, &SIV, IV, Tag, Out, &OutSize) == unknown_error && is_zero(Out, 8), "siv dec base64 padding in the middle");
+
+    //* Invalid Base64 in a later quartet, after the first ones decoded.
+    uint8_t Plain[9];
+    memset(Plain, 0x55, sizeof(Plain));
+    CHECK(aes_siv_dec_base64_ctx("QUJDQU!DQUJD", 12, NULL, 0, &SIV, IV, Tag, Plain, &OutSize) == unknown_error && is_zero(Plain, sizeof(Plain)), "siv dec base64 invalid zeroes Plaintext");
+    memset(Plain, 0x55, sizeof(Plain));
+    CHECK(aes_gcm_dec_base64_ctx("QUJDQU!DQUJD", 12, NULL, 0, &GCM, IV, Tag, Plain, &OutSize) == unknown_error && is_zero(Plain, sizeof(Plain)), "gcm dec base64 invalid zeroes Plaintext");
+
+    aes_gcm_key_clear(&GCM);
+    aes_key_clear(&SIV);
+    free(P);
+    free(C);
+    free(Out);
+    free(Expect);
+    free(B64);
+}
+
+static void test_aead_base64(void)
+{
+    test_vectors();
+    test_sizes();
+}
+
+int main(void)
+{
+    return test_result(test_configs(test_aead_base64, TEST_AES_BACKENDS | TEST_GHASH_BACKENDS | TEST_THREADS));
+}
@@ -0,0 +1,202 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/aes.h"
+#include "test.h"
+
+//* The GCM and GCM-SIV batch functions against sealing and opening each message on its own: the known answers as a
+//* batch of one, packet sized batches with every AAD and IV different, and a batch of large messages partly in place
+//* with one bad Tag, which must only fail (and zero) its own message.
+
+static void test_vectors(void)
+{
+    uint8_t Buf[64], Tag[16];
+
+    for (size_t v = 0; v < GCMVectorCount; v++)
+    {
+        AEADCase T;
+        load_vector(&GCMVectors[v], &T);
+        AESGCMKey Ctx;
+        aes_gcm_key_init(&Ctx, T.Key);
+
+        //* Batch of one, Out aliasing In.
+        memcpy(Buf, T.P, T.Size);
+        AESAEADJob Job = {T.IV, T.AAD, T.ASize, Buf, T.Size, Buf, Tag, unknown_error};
+        CHECK(aes_gcm_enc_batch(&Ctx, &Job, 1) == success && Job.Result == success, "gcm enc batch");
+        CHECK(memcmp(Buf, T.C, T.Size) == 0 && memcmp(Tag, T.Tag, 16) == 0, "gcm enc batch vector");
+        CHECK(aes_gcm_dec_batch(&Ctx, &Job, 1) == success && Job.Result == success && memcmp(Buf, T.P, T.Size) == 0, "gcm dec batch");
+        memcpy(Buf, T.C, T.Size);
+        Job.Tag = T.Bad;
+        CHECK(aes_gcm_dec_batch(&Ctx, &Job, 1) == unknown_error && Job.Result == unknown_error && is_zero(Buf, T.Size), "gcm dec batch bad tag");
+        CHECK(aes_gcm_enc_batch(&Ctx, NULL, 0) == success && aes_gcm_dec_batch(&Ctx, NULL, 0) == success, "gcm batch of none");
+        aes_gcm_key_clear(&Ctx);
+    }
+
+    for (size_t v = 0; v < SIVVectorCount; v++)
+    {
+        AEADCase T;
+        load_vector(&SIVVectors[v], &T);
+        AESKey Ctx;
+        aes_key_init(&Ctx, T.Key);
+
+        memcpy(Buf, T.P, T.Size);
+        AESAEADJob Job = {T.IV, T.AAD, T.ASize, Buf, T.Size, Buf, Tag, unknown_error};
+        CHECK(aes_siv_enc_batch(&Ctx, &Job, 1) == success && Job.Result == success, "siv enc batch");
+        CHECK(memcmp(Buf, T.C, T.Size) == 0 && memcmp(Tag, T.Tag, 16) == 0, "siv enc batch vector");
+        CHECK(aes_siv_dec_batch(&Ctx, &Job, 1) == success && Job.Result == success && memcmp(Buf, T.P, T.Size) == 0, "siv dec batch");
+        memcpy(Buf, T.C, T.Size);
+        Job.Tag = T.Bad;
+        CHECK(aes_siv_dec_batch(&Ctx, &Job, 1) == unknown_error && Job.Result == unknown_error && is_zero(Buf, T.Size), "siv dec batch bad tag");
+        CHECK(aes_siv_enc_batch(&Ctx, NULL, 0) == success && aes_siv_dec_batch(&Ctx, NULL, 0) == success, "siv batch of none");
+        aes_key_clear(&Ctx);
+    }
+}
+
+//* Packet sized messages (0 to 1500 bytes) with their own IV and AAD (0 to 40 bytes).
+#define PACKETS 37
+#define PACKET_MAX 1500
+
+static void test_packets(void)
+{
+    uint8_t Key[32], Sizes[2*PACKETS];
+    fill_random(Key, 32, 50);
+    fill_random(Sizes, sizeof(Sizes), 51);
+    AESGCMKey GCM;
+    AESKey SIV;
+    aes_gcm_key_init(&GCM, Key);
+    aes_key_init(&SIV, Key);
+
+    static uint8_t P[PACKETS][PACKET_MAX], Out[PACKETS][PACKET_MAX], Expect[PACKETS][PACKET_MAX];
+    static uint8_t IV[PACKETS][12], AAD[PACKETS][40], Tags[PACKETS][16], ExpectTags[PACKETS][16];
+    AESAEADJob Jobs[PACKETS];
+    for (size_t i = 0; i < PACKETS; i++)
+    {
+        size_t Size = (i == 0) ? 0 : (size_t) (Sizes[2*i] | (Sizes[2*i + 1] << 8)) % (PACKET_MAX + 1);
+        size_t ASize = Sizes[2*i + 1] % 41;
+        fill_random(P[i], Size, 52 + (uint32_t) i);
+        fill_random(IV[i], 12, 200 + (uint32_t) i);
+        fill_random(AAD[i], ASize, 300 + (uint32_t) i);
+        Jobs[i] = (AESAEADJob) {IV[i], AAD[i], ASize, P[i], Size, Out[i], Tags[i], unknown_error};
+    }
+
+    for (int m = 0; m < 2; m++)
+    {
+        bool Siv = (m == 1);
+        for (size_t i = 0; i < PACKETS; i++)
+        {
+            memcpy(Expect[i], P[i], Jobs[i].Size);
+            if (Siv)
+                aes_siv_enc_ctx(Expect[i], Jobs[i].Size, AAD[i], Jobs[i].ASize, &SIV, IV[i], ExpectTags[i]);
+            else
+                aes_gcm_enc_ctx(Expect[i], Jobs[i].Size, AAD[i], Jobs[i].ASize, &GCM, IV[i], ExpectTags[i]);
+            Jobs[i].In = P[i];
+            Jobs[i].Out = Out[i];
+        }
+
+        ErrorCode Sealed = Siv ? aes_siv_enc_batch(&SIV, Jobs, PACKETS) : aes_gcm_enc_batch(&GCM, Jobs, PACKETS);
+        CHECK(Sealed == success, "packet batch seal");
+        for (size_t i = 0; i < PACKETS; i++)
+        {
+            CHECK(Jobs[i].Result == success, "packet batch seal Result");
+            CHECK(memcmp(Out[i], Expect[i], Jobs[i].Size) == 0 && memcmp(Tags[i], ExpectTags[i], 16) == 0, "packet batch seal matches one at a time");
+            Jobs[i].In = Out[i];
+            Jobs[i].Out = Out[i];
+        }
+
+        ErrorCode Opened = Siv ? aes_siv_dec_batch(&SIV, Jobs, PACKETS) : aes_gcm_dec_batch(&GCM, Jobs, PACKETS);
+        CHECK(Opened == success, "packet batch open in place");
+        for (size_t i = 0; i < PACKETS; i++)
+            CHECK(Jobs[i].Result == success && memcmp(Out[i], P[i], Jobs[i].Size) == 0, "packet batch open in place matches");
+    }
+
+    aes_gcm_key_clear(&GCM);
+    aes_key_clear(&SIV);
+}
+
+//* Sizes around the partial block, GCM_STITCH_SIZE (4 KiB), and the thread split (THREAD_MIN_PART is 64 KiB).
+static const size_t LargeSizes[] = {0, 1, 15, 16, 17, 4095, 4096, 4111, 131089, 262167};
+#define LARGE_COUNT (sizeof(LargeSizes) / sizeof(LargeSizes[0]))
+
+static void test_large(void)
+{
+    uint8_t Key[32], IV[12], AAD[21];
+    fill_random(Key, 32, 1);
+    fill_random(IV, 12, 2);
+    fill_random(AAD, 21, 3);
+    AESGCMKey GCM;
+    AESKey SIV;
+    aes_gcm_key_init(&GCM, Key);
+    aes_key_init(&SIV, Key);
+
+    AESAEADJob Jobs[LARGE_COUNT];
+    uint8_t* Msgs[LARGE_COUNT];
+    uint8_t* Outs[LARGE_COUNT];
+    uint8_t* Refs[LARGE_COUNT];
+    uint8_t Tags[LARGE_COUNT][16], RefTags[LARGE_COUNT][16];
+    for (size_t s = 0; s < LARGE_COUNT; s++)
+    {
+        Msgs[s] = malloc(LargeSizes[s] + 1);
+        Outs[s] = malloc(LargeSizes[s] + 1);
+        Refs[s] = malloc(LargeSizes[s] + 1);
+        Jobs[s] = (AESAEADJob) {IV, AAD, sizeof(AAD), Msgs[s], LargeSizes[s], Outs[s], Tags[s], unknown_error};
+    }
+
+    //* Every size in one batch, odd messages in place, one Tag of each batch corrupted before opening.
+    uint8_t* Expect = malloc(LargeSizes[LARGE_COUNT - 1] + 1);
+    for (int m = 0; m < 2; m++)
+    {
+        bool Siv = (m == 1);
+        size_t Bad = Siv ? 4 : 3;
+        for (size_t s = 0; s < LARGE_COUNT; s++)
+        {
+            fill_random(Refs[s], LargeSizes[s], 0x5EED + (uint32_t) s);
+            if (Siv)
+                aes_siv_enc_ctx(Refs[s], LargeSizes[s], AAD, sizeof(AAD), &SIV, IV, RefTags[s]);
+            else
+                aes_gcm_enc_ctx(Refs[s], LargeSizes[s], AAD, sizeof(AAD), &GCM, IV, RefTags[s]);
+            fill_random(Msgs[s], LargeSizes[s], 0x5EED + (uint32_t) s);
+            Jobs[s].In = Msgs[s];
+            Jobs[s].Out = (s % 2 == 1) ? Msgs[s] : Outs[s];
+        }
+        ErrorCode Sealed = Siv ? aes_siv_enc_batch(&SIV, Jobs, LARGE_COUNT) : aes_gcm_enc_batch(&GCM, Jobs, LARGE_COUNT);
+        CHECK(Sealed == success, "large batch seal");
+        for (size_t s = 0; s < LARGE_COUNT; s++)
+        {
+            CHECK(Jobs[s].Result == success && memcmp(Jobs[s].Out, Refs[s], LargeSizes[s]) == 0 && memcmp(Tags[s], RefTags[s], 16) == 0, "large batch seal matches one at a time");
+            Jobs[s].In = Jobs[s].Out;
+        }
+
+        Tags[Bad][0] ^= 0x01;
+        ErrorCode Opened = Siv ? aes_siv_dec_batch(&SIV, Jobs, LARGE_COUNT) : aes_gcm_dec_batch(&GCM, Jobs, LARGE_COUNT);
+        CHECK(Opened == unknown_error, "large batch open with a bad tag");
+        for (size_t s = 0; s < LARGE_COUNT; s++)
+        {
+            fill_random(Expect, LargeSizes[s], 0x5EED + (uint32_t) s);
+            if (s == Bad)
+                CHECK(Jobs[s].Result == unknown_error && is_zero(Jobs[s].Out, LargeSizes[s]), "large batch bad tag zeroes Out");
+            else
+                CHECK(Jobs[s].Result == success && memcmp(Jobs[s].Out, Expect, LargeSizes[s]) == 0, "large batch open");
+        }
+    }
+
+    free(Expect);
+    for (size_t s = 0; s < LARGE_COUNT; s++)
+    {
+        free(Msgs[s]);
+        free(Outs[s]);
+        free(Refs[s]);
+    }
+    aes_gcm_key_clear(&GCM);
+    aes_key_clear(&SIV);
+}
+
+static void test_aead_batch(void)
+{
+    test_vectors();
+    test_packets();
+    test_large();
+}
+
+int main(void)
+{
+    return test_result(test_configs(test_aead_batch, TEST_AES_BACKENDS | TEST_GHASH_BACKENDS | TEST_THREADS));
+}
@@ -0,0 +1,188 @@
+//* Built with aes.c itself instead of linking it, to reach its counter functions.
+#include "../src/aes.c"
+
+#include "test.h"
+
+//* Counter mode against a counter written out block by block: partial passes, the partial last block and the
+//* 32-bit wraparound, for the GCM and GCM-SIV counter layouts under every AES backend and thread setting.
+
+//* Bytewise key of Key, the reference every backend is compared against.
+static uint8_t Key[32];
+static AESKey Ref;
+
+
+//? Reference
+
+/// @brief CTR with a counter written out block by block (32 bits, wrapping), through single block encryption only.
+/// @param Type The counter layout: GCM (last 4 bytes, big endian) or GCM-SIV (first 4 bytes, little endian).
+/// @param ICB The 16-byte Initial Counter Block.
+static void reference_ctr(uint8_t* Data, size_t Size, AESCounter Type, const uint8_t* ICB)
+{
+    bool Siv = (Type == aes_counter_siv);
+    uint32_t Start = Siv ? ((uint32_t) ICB[0] | ((uint32_t) ICB[1] << 8) | ((uint32_t) ICB[2] << 16) | ((uint32_t) ICB[3] << 24))
+                         : (((uint32_t) ICB[12] << 24) | ((uint32_t) ICB[13] << 16) | ((uint32_t) ICB[14] << 8) | ICB[15]);
+    for (size_t i = 0; i < Size; i += 16)
+    {
+        uint32_t Counter = Start + (uint32_t) (i / 16);
+        uint8_t Stream[16];
+        memcpy(Stream, ICB, 16);
+        for (int j = 0; j < 4; j++)
+        {
+            if (Siv)
+                Stream[j] = (uint8_t) (Counter >> (8*j));
+            else
+                Stream[15 - j] = (uint8_t) (Counter >> (8*j));
+        }
+        aes_std_enc_ctx(Stream, &Ref);
+        for (size_t j = 0; j < 16 && i + j < Size; j++)
+            Data[i + j] ^= Stream[j];
+    }
+}
+
+/// @brief Fills ICB with random bytes, then sets its counter so that it reaches 0 at block WrapAt (0: no wrap).
+static void make_icb(uint8_t* ICB, AESCounter Type, uint32_t WrapAt, uint32_t Seed)
+{
+    fill_random(ICB, 16, Seed);
+    uint32_t Start = WrapAt ? 0U - WrapAt : 1;
+    for (int j = 0; j < 4; j++)
+    {
+        if (Type == aes_counter_siv)
+            ICB[j] = (uint8_t) (Start >> (8*j));
+        else
+            ICB[15 - j] = (uint8_t) (Start >> (8*j));
+    }
+}
+
+
+//? Single pass core
+
+static void test_ctr_xor(void)
+{
+    //* Sizes around one CTR_BLOCKS pass and the partial block, the counter wraps before, inside and after a pass.
+    static const size_t Sizes[] = {0, 1, 15, 16, 17, CTR_BLOCKS*16 - 1, CTR_BLOCKS*16, CTR_BLOCKS*16 + 1, CTR_BLOCKS*48 + 5};
+    static const uint32_t WrapAt[] = {0, 1, 15, 16, 17, CTR_BLOCKS + 1};
+    enum { MaxSize = CTR_BLOCKS*48 + 5 };
+    uint8_t Msg[MaxSize], Expect[MaxSize], Out[MaxSize], ICB[16];
+    AESKey Ctx;
+    aes_key_init(&Ctx, Key);
+    fill_random(Msg, MaxSize, 11);
+
+    for (int t = 0; t < 2; t++)
+    {
+        AESCounter Type = t ? aes_counter_siv : aes_counter_gcm;
+        for (size_t w = 0; w < sizeof(WrapAt) / sizeof(WrapAt[0]); w++)
+        {
+            make_icb(ICB, Type, WrapAt[w], 100 + (uint32_t) w);
+            if (Type == aes_counter_siv)
+                ICB[15] |= 0x80;
+            for (size_t s = 0; s < sizeof(Sizes) / sizeof(Sizes[0]); s++)
+            {
+                memcpy(Expect, Msg, Sizes[s]);
+                reference_ctr(Expect, Sizes[s], Type, ICB);
+                memcpy(Out, Msg, Sizes[s]);
+                ctr_xor(Out, Sizes[s], &Ctx, Type, ICB);
+                CHECK(memcmp(Out, Expect, Sizes[s]) == 0, t ? "siv ctr_xor" : "gcm ctr_xor");
+            }
+        }
+    }
+    aes_key_clear(&Ctx);
+}
+
+
+//? Split across threads
+
+//* 4 ranges of 4097 blocks when split across 4 threads (THREAD_MIN_PART is 64 KiB), the last one partial.
+#define WRAP_SIZE 262167
+
+//* The counter reaches 0 at once, at the start of the second range and inside the fourth.
+static const uint32_t RangeWrapAt[] = {1, 4097, 12300};
+
+static void test_gcm_run(void)
+{
+    uint8_t* Msg = malloc(WRAP_SIZE);
+    uint8_t* Expect = malloc(WRAP_SIZE);
+    uint8_t* Out = malloc(WRAP_SIZE);
+    fill_random(Msg, WRAP_SIZE, 7);
+    AESGCMKey GCM;
+    aes_gcm_key_init(&GCM, Key);
+
+    for (size_t w = 0; w < sizeof(RangeWrapAt) / sizeof(RangeWrapAt[0]); w++)
+    {
+        uint8_t ICB[16], Hash[16] = {0};
+        make_icb(ICB, aes_counter_gcm, RangeWrapAt[w], 200 + (uint32_t) w);
+        memcpy(Expect, Msg, WRAP_SIZE);
+        reference_ctr(Expect, WRAP_SIZE, aes_counter_gcm, ICB);
+
+        gcm_run(&GCM, Msg, Out, WRAP_SIZE, ICB, NULL, gcm_job_ctr);
+        CHECK(memcmp(Out, Expect, WRAP_SIZE) == 0, "gcm ctr wraparound");
+        gcm_run(&GCM, Msg, Out, WRAP_SIZE, ICB, Hash, gcm_job_encrypt);
+        CHECK(memcmp(Out, Expect, WRAP_SIZE) == 0, "gcm stitched wraparound");
+        memcpy(Out, Msg, WRAP_SIZE);
+        gcm_run(&GCM, Out, Out, WRAP_SIZE, ICB, NULL, gcm_job_ctr);
+        CHECK(memcmp(Out, Expect, WRAP_SIZE) == 0, "gcm ctr wraparound in place");
+    }
+
+    aes_gcm_key_clear(&GCM);
+    free(Msg);
+    free(Expect);
+    free(Out);
+}
+
+
+static void test_siv_run(void)
+{
+    uint8_t* Msg = malloc(WRAP_SIZE);
+    uint8_t* Expect = malloc(WRAP_SIZE);
+    uint8_t* Out = malloc(WRAP_SIZE);
+    fill_random(Msg, WRAP_SIZE, 7);
+    AESKey Cipher;
+    GHashKey Auth;
+    uint8_t H[16] = {0x42};
+    aes_key_init(&Cipher, Key);
+    polyval_key_init(&Auth, H);
+
+    for (size_t w = 0; w < sizeof(RangeWrapAt) / sizeof(RangeWrapAt[0]); w++)
+    {
+        //* The top bit of the last byte set, as by the Tag.
+        uint8_t ICB[16], Hash[16] = {0};
+        make_icb(ICB, aes_counter_siv, RangeWrapAt[w], 300 + (uint32_t) w);
+        ICB[15] |= 0x80;
+        memcpy(Expect, Msg, WRAP_SIZE);
+        reference_ctr(Expect, WRAP_SIZE, aes_counter_siv, ICB);
+
+        siv_run(&Cipher, NULL, Msg, Out, WRAP_SIZE, ICB, NULL, siv_job_ctr);
+        CHECK(memcmp(Out, Expect, WRAP_SIZE) == 0, "siv ctr wraparound");
+        siv_run(&Cipher, &Auth, Msg, Out, WRAP_SIZE, ICB, Hash, siv_job_decrypt);
+        CHECK(memcmp(Out, Expect, WRAP_SIZE) == 0, "siv stitched wraparound");
+        memcpy(Out, Msg, WRAP_SIZE);
+        siv_run(&Cipher, NULL, Out, Out, WRAP_SIZE, ICB, NULL, siv_job_ctr);
+        CHECK(memcmp(Out, Expect, WRAP_SIZE) == 0, "siv ctr wraparound in place");
+    }
+
+    ghash_key_clear(&Auth);
+    aes_key_clear(&Cipher);
+    free(Msg);
+    free(Expect);
+    free(Out);
+}
+
+
+//? Configurations
+
+static void run(void)
+{
+    test_ctr_xor();
+    test_gcm_run();
+    test_siv_run();
+}
+
+int main(void)
+{
+    fill_random(Key, 32, 3);
+    aes_set_backend(aes_backend_bytewise);
+    aes_key_init(&Ref, Key);
+
+    int Result = test_result(test_configs(run, TEST_AES_BACKENDS | TEST_THREADS));
+    aes_key_clear(&Ref);
+    return Result;
+}
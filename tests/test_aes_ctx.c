@@ -0,0 +1,145 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/aes.h"
+#include "test.h"
+
+//* Known answer tests through the raw key functions and their pre-expanded AESKey (_ctx) counterparts, under every AES and GHASH backend.
+
+
+//? Block modes
+
+static void test_block_vectors(void)
+{
+    //* FIPS-197 appendix C.3.
+    uint8_t Key[32], Block[16], Plain[16], Expect[16];
+    AESKey Ctx;
+    hex_bytes("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f", Key);
+    hex_bytes("00112233445566778899aabbccddeeff", Plain);
+    hex_bytes("8ea2b7ca516745bfeafc49904b496089", Expect);
+    CHECK(aes_key_init(&Ctx, Key) == success, "key init");
+    memcpy(Block, Plain, 16);
+    CHECK(aes_std_enc(Block, Key) == success && memcmp(Block, Expect, 16) == 0, "std enc vector");
+    CHECK(aes_std_dec(Block, Key) == success && memcmp(Block, Plain, 16) == 0, "std dec vector");
+    aes_std_enc_ctx(Block, &Ctx);
+    CHECK(memcmp(Block, Expect, 16) == 0, "std enc_ctx vector");
+    aes_std_dec_ctx(Block, &Ctx);
+    CHECK(memcmp(Block, Plain, 16) == 0, "std dec_ctx vector");
+    aes_key_clear(&Ctx);
+    CHECK(is_zero((const uint8_t*) &Ctx, sizeof(Ctx)), "key clear");
+
+    //* SP 800-38A F.1.5 and F.2.5, the padding block follows the 4 blocks.
+    uint8_t IV[16], P[64], C[64];
+    ByteArr Ret, Back;
+    hex_bytes("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4", Key);
+    hex_bytes("000102030405060708090a0b0c0d0e0f", IV);
+    hex_bytes("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+              "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710", P);
+    aes_key_init(&Ctx, Key);
+
+    hex_bytes("f3eed1bdb5d2a03c064b5a7e3db181f8591ccb10d410ed26dc5ba74a31362870"
+              "b6ed21b99ca6f4f9f153e7b1beafed1d23304b7a39f9f3ff067d8d8f9e24ecc7", C);
+    CHECK(aes_ecb_enc(P, 64, Key, &Ret) == success && Ret.Size == 80 && memcmp(Ret.Arr, C, 64) == 0, "ecb enc vector");
+    CHECK(aes_ecb_dec(Ret.Arr, Ret.Size, Key, &Back) == success && Back.Size == 64 && memcmp(Back.Arr, P, 64) == 0, "ecb dec vector");
+    free(Back.Arr);
+    CHECK(aes_ecb_dec_ctx(Ret.Arr, Ret.Size, &Ctx, &Back) == success && Back.Size == 64 && memcmp(Back.Arr, P, 64) == 0, "ecb dec_ctx vector");
+    free(Back.Arr);
+    free(Ret.Arr);
+    CHECK(aes_ecb_enc_ctx(P, 64, &Ctx, &Ret) == success && Ret.Size == 80 && memcmp(Ret.Arr, C, 64) == 0, "ecb enc_ctx vector");
+    free(Ret.Arr);
+
+    hex_bytes("f58c4c04d6e5f1ba779eabfb5f7bfbd69cfc4e967edb808d679f777bc6702c7d"
+              "39f23369a9d9bacfa530e26304231461b2eb05e2c39be9fcda6c19078c6a9d1b", C);
+    CHECK(aes_cbc_enc(P, 64, Key, IV, &Ret) == success && Ret.Size == 80 && memcmp(Ret.Arr, C, 64) == 0, "cbc enc vector");
+    CHECK(aes_cbc_dec(Ret.Arr, Ret.Size, Key, IV, &Back) == success && Back.Size == 64 && memcmp(Back.Arr, P, 64) == 0, "cbc dec vector");
+    free(Back.Arr);
+    CHECK(aes_cbc_dec_ctx(Ret.Arr, Ret.Size, &Ctx, IV, &Back) == success && Back.Size == 64 && memcmp(Back.Arr, P, 64) == 0, "cbc dec_ctx vector");
+    free(Back.Arr);
+    free(Ret.Arr);
+    CHECK(aes_cbc_enc_ctx(P, 64, &Ctx, IV, &Ret) == success && Ret.Size == 80 && memcmp(Ret.Arr, C, 64) == 0, "cbc enc_ctx vector");
+    free(Ret.Arr);
+    aes_key_clear(&Ctx);
+}
+
+
+//? AEAD modes
+
+static void test_gcm_vectors(void)
+{
+    for (size_t v = 0; v < GCMVectorCount; v++)
+    {
+        AEADCase T;
+        load_vector(&GCMVectors[v], &T);
+        AESGCMKey Ctx;
+        uint8_t Buf[64], Tag[16];
+        CHECK(aes_gcm_key_init(&Ctx, T.Key) == success, "gcm key init");
+
+        memcpy(Buf, T.P, T.Size);
+        CHECK(aes_gcm_enc(Buf, T.Size, T.AAD, T.ASize, T.Key, T.IV, Tag) == success, "gcm enc");
+        CHECK(memcmp(Buf, T.C, T.Size) == 0 && memcmp(Tag, T.Tag, 16) == 0, "gcm enc vector");
+        memcpy(Buf, T.P, T.Size);
+        CHECK(aes_gcm_enc_ctx(Buf, T.Size, T.AAD, T.ASize, &Ctx, T.IV, Tag) == success, "gcm enc_ctx");
+        CHECK(memcmp(Buf, T.C, T.Size) == 0 && memcmp(Tag, T.Tag, 16) == 0, "gcm enc_ctx vector");
+
+        memcpy(Buf, T.C, T.Size);
+        CHECK(aes_gcm_dec(Buf, T.Size, T.AAD, T.ASize, T.Key, T.IV, T.Tag) == success && memcmp(Buf, T.P, T.Size) == 0, "gcm dec vector");
+        memcpy(Buf, T.C, T.Size);
+        CHECK(aes_gcm_dec_ctx(Buf, T.Size, T.AAD, T.ASize, &Ctx, T.IV, T.Tag) == success && memcmp(Buf, T.P, T.Size) == 0, "gcm dec_ctx vector");
+
+        //* Invalid Tag: in place decryption leaves the Ciphertext alone.
+        memcpy(Buf, T.C, T.Size);
+        CHECK(aes_gcm_dec(Buf, T.Size, T.AAD, T.ASize, T.Key, T.IV, T.Bad) == unknown_error, "gcm dec bad tag");
+        CHECK(memcmp(Buf, T.C, T.Size) == 0, "gcm dec bad tag leaves Ciphertext");
+        CHECK(aes_gcm_dec_ctx(Buf, T.Size, T.AAD, T.ASize, &Ctx, T.IV, T.Bad) == unknown_error, "gcm dec_ctx bad tag");
+        CHECK(memcmp(Buf, T.C, T.Size) == 0, "gcm dec_ctx bad tag leaves Ciphertext");
+
+        aes_gcm_key_clear(&Ctx);
+    }
+}
+
+static void test_siv_vectors(void)
+{
+    for (size_t v = 0; v < SIVVectorCount; v++)
+    {
+        AEADCase T;
+        load_vector(&SIVVectors[v], &T);
+        AESKey Ctx;
+        uint8_t Buf[64], Tag[16];
+        CHECK(aes_key_init(&Ctx, T.Key) == success, "siv key init");
+
+        memcpy(Buf, T.P, T.Size);
+        CHECK(aes_siv_enc(Buf, T.Size, T.AAD, T.ASize, T.Key, T.IV, Tag) == success, "siv enc");
+        CHECK(memcmp(Buf, T.C, T.Size) == 0 && memcmp(Tag, T.Tag, 16) == 0, "siv enc vector");
+        memcpy(Buf, T.P, T.Size);
+        CHECK(aes_siv_enc_ctx(Buf, T.Size, T.AAD, T.ASize, &Ctx, T.IV, Tag) == success, "siv enc_ctx");
+        CHECK(memcmp(Buf, T.C, T.Size) == 0 && memcmp(Tag, T.Tag, 16) == 0, "siv enc_ctx vector");
+
+        memcpy(Buf, T.C, T.Size);
+        CHECK(aes_siv_dec(Buf, T.Size, T.AAD, T.ASize, T.Key, T.IV, T.Tag) == success && memcmp(Buf, T.P, T.Size) == 0, "siv dec vector");
+        memcpy(Buf, T.C, T.Size);
+        CHECK(aes_siv_dec_ctx(Buf, T.Size, T.AAD, T.ASize, &Ctx, T.IV, T.Tag) == success && memcmp(Buf, T.P, T.Size) == 0, "siv dec_ctx vector");
+
+        //* Invalid Tag: in place decryption gives the Ciphertext back.
+        memcpy(Buf, T.C, T.Size);
+        CHECK(aes_siv_dec(Buf, T.Size, T.AAD, T.ASize, T.Key, T.IV, T.Bad) == unknown_error, "siv dec bad tag");
+        CHECK(memcmp(Buf, T.C, T.Size) == 0, "siv dec bad tag restores Ciphertext");
+        CHECK(aes_siv_dec_ctx(Buf, T.Size, T.AAD, T.ASize, &Ctx, T.IV, T.Bad) == unknown_error, "siv dec_ctx bad tag");
+        CHECK(memcmp(Buf, T.C, T.Size) == 0, "siv dec_ctx bad tag restores Ciphertext");
+
+        aes_key_clear(&Ctx);
+    }
+}
+
+
+//? Configurations
+
+static void run(void)
+{
+    test_block_vectors();
+    test_gcm_vectors();
+    test_siv_vectors();
+}
+
+int main(void)
+{
+    return test_result(test_configs(run, TEST_AES_BACKENDS | TEST_GHASH_BACKENDS));
+}
@@ -0,0 +1,171 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/aes.h"
+#include "test.h"
+
+//* Messages split across threads give the same results as on one thread, under every AES and GHASH backend.
+
+//* One THREAD_MIN_PART (64 KiB) range and a bit, two ranges, and four ranges with the last one partial.
+static const size_t Sizes[] = {65553, 131072, 131089, 262167};
+#define SIZE_COUNT (sizeof(Sizes) / sizeof(Sizes[0]))
+
+static uint8_t Key[32], IV[12], AAD[21];
+
+//* Results of the first configuration (bytewise, bitserial, one thread), every later one must match them.
+static uint8_t* RefGCM[SIZE_COUNT];
+static uint8_t RefGCMTag[SIZE_COUNT][16];
+static uint8_t* RefSIV[SIZE_COUNT];
+static uint8_t RefSIVTag[SIZE_COUNT][16];
+
+
+//? GCM
+
+static void test_gcm_threads(void)
+{
+    AESGCMKey Ctx;
+    aes_gcm_key_init(&Ctx, Key);
+    for (size_t s = 0; s < SIZE_COUNT; s++)
+    {
+        size_t Size = Sizes[s];
+        uint8_t* P = malloc(Size);
+        uint8_t* Buf = malloc(Size);
+        uint8_t* Out = malloc(Size);
+        uint8_t Tag[16];
+        fill_random(P, Size, 0x5EED + (uint32_t) s);
+
+        memcpy(Buf, P, Size);
+        aes_gcm_enc_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, Tag);
+        if (RefGCM[s] == NULL)
+        {
+            RefGCM[s] = malloc(Size);
+            memcpy(RefGCM[s], Buf, Size);
+            memcpy(RefGCMTag[s], Tag, 16);
+        }
+        CHECK(memcmp(Buf, RefGCM[s], Size) == 0 && memcmp(Tag, RefGCMTag[s], 16) == 0, "gcm matches one thread");
+        CHECK(aes_gcm_dec_into_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, Tag, Out) == success && memcmp(Out, P, Size) == 0, "gcm dec_into_ctx");
+
+        //* A flipped bit in the middle range: into zeroes every range, in place leaves the Ciphertext.
+        Buf[Size / 2] ^= 0x01;
+        memset(Out, 0x55, Size);
+        CHECK(aes_gcm_dec_into_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, Tag, Out) == unknown_error && is_zero(Out, Size), "gcm dec_into_ctx tampered zeroes Plaintext");
+        CHECK(aes_gcm_dec_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, Tag) == unknown_error, "gcm dec_ctx tampered");
+        Buf[Size / 2] ^= 0x01;
+        CHECK(memcmp(Buf, RefGCM[s], Size) == 0, "gcm dec_ctx tampered leaves Ciphertext");
+        CHECK(aes_gcm_dec_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, Tag) == success && memcmp(Buf, P, Size) == 0, "gcm dec_ctx");
+
+        free(P);
+        free(Buf);
+        free(Out);
+    }
+    aes_gcm_key_clear(&Ctx);
+}
+
+
+//? GCM-SIV
+
+static void test_siv_threads(void)
+{
+    AESKey Ctx;
+    aes_key_init(&Ctx, Key);
+    for (size_t s = 0; s < SIZE_COUNT; s++)
+    {
+        size_t Size = Sizes[s];
+        uint8_t* P = malloc(Size);
+        uint8_t* Buf = malloc(Size);
+        uint8_t* Out = malloc(Size);
+        uint8_t Tag[16];
+        fill_random(P, Size, 0x5EED + (uint32_t) s);
+
+        memcpy(Buf, P, Size);
+        aes_siv_enc_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, Tag);
+        if (RefSIV[s] == NULL)
+        {
+            RefSIV[s] = malloc(Size);
+            memcpy(RefSIV[s], Buf, Size);
+            memcpy(RefSIVTag[s], Tag, 16);
+        }
+        CHECK(memcmp(Buf, RefSIV[s], Size) == 0 && memcmp(Tag, RefSIVTag[s], 16) == 0, "siv matches one thread");
+        CHECK(aes_siv_dec_into_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, Tag, Out) == success && memcmp(Out, P, Size) == 0, "siv dec_into_ctx");
+
+        //* A flipped bit in the last range: into zeroes every range, in place restores the Ciphertext.
+        Buf[Size - 1] ^= 0x01;
+        memset(Out, 0x55, Size);
+        CHECK(aes_siv_dec_into_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, Tag, Out) == unknown_error && is_zero(Out, Size), "siv dec_into_ctx tampered zeroes Plaintext");
+        CHECK(aes_siv_dec_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, Tag) == unknown_error, "siv dec_ctx tampered");
+        Buf[Size - 1] ^= 0x01;
+        CHECK(memcmp(Buf, RefSIV[s], Size) == 0, "siv dec_ctx tampered restores Ciphertext");
+        CHECK(aes_siv_dec_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, Tag) == success && memcmp(Buf, P, Size) == 0, "siv dec_ctx");
+
+        free(P);
+        free(Buf);
+        free(Out);
+    }
+    aes_key_clear(&Ctx);
+}
+
+
+//? ECB and CBC decryption
+
+static void test_block_threads(void)
+{
+    uint8_t CBCIV[16];
+    fill_random(CBCIV, 16, 5);
+    AESKey Ctx;
+    aes_key_init(&Ctx, Key);
+    for (size_t s = 0; s < SIZE_COUNT; s++)
+    {
+        size_t Size = Sizes[s], OutSize, BackSize;
+        uint8_t* P = malloc(Size);
+        uint8_t* Buf = malloc(AES_PADDED_SIZE(Size));
+        uint8_t* Out = malloc(AES_PADDED_SIZE(Size));
+        ByteArr C, Back;
+        fill_random(P, Size, 0xB10C + (uint32_t) s);
+
+        //* CBC encryption is serial, so its Ciphertext is the same on every setting.
+        CHECK(aes_cbc_enc_ctx(P, Size, &Ctx, CBCIV, &C) == success && C.Size == AES_PADDED_SIZE(Size), "cbc enc_ctx");
+        CHECK(aes_cbc_dec_into_ctx(C.Arr, C.Size, &Ctx, CBCIV, Out, &OutSize) == success && OutSize == Size && memcmp(Out, P, Size) == 0, "cbc dec_into_ctx");
+        memcpy(Buf, C.Arr, C.Size);
+        CHECK(aes_cbc_dec_into_ctx(Buf, C.Size, &Ctx, CBCIV, Buf, &OutSize) == success && OutSize == Size && memcmp(Buf, P, Size) == 0, "cbc dec_into_ctx in place");
+        CHECK(aes_cbc_dec_ctx(C.Arr, C.Size, &Ctx, CBCIV, &Back) == success && Back.Size == Size && memcmp(Back.Arr, P, Size) == 0, "cbc dec_ctx");
+        free(Back.Arr);
+        free(C.Arr);
+
+        CHECK(aes_ecb_enc_ctx(P, Size, &Ctx, &C) == success, "ecb enc_ctx");
+        memcpy(Buf, P, Size);
+        CHECK(aes_ecb_enc_into_ctx(Buf, Size, &Ctx, Buf, &OutSize) == success && OutSize == C.Size && memcmp(Buf, C.Arr, C.Size) == 0, "ecb enc_into_ctx in place");
+        CHECK(aes_ecb_dec_into_ctx(Buf, OutSize, &Ctx, Buf, &BackSize) == success && BackSize == Size && memcmp(Buf, P, Size) == 0, "ecb dec_into_ctx in place");
+        CHECK(aes_ecb_dec_ctx(C.Arr, C.Size, &Ctx, &Back) == success && Back.Size == Size && memcmp(Back.Arr, P, Size) == 0, "ecb dec_ctx");
+        free(Back.Arr);
+        free(C.Arr);
+
+        free(P);
+        free(Buf);
+        free(Out);
+    }
+    aes_key_clear(&Ctx);
+}
+
+
+//? Configurations
+
+static void run(void)
+{
+    test_gcm_threads();
+    test_siv_threads();
+    test_block_threads();
+}
+
+int main(void)
+{
+    fill_random(Key, 32, 1);
+    fill_random(IV, 12, 2);
+    fill_random(AAD, sizeof(AAD), 3);
+
+    int Result = test_result(test_configs(run, TEST_AES_BACKENDS | TEST_GHASH_BACKENDS | TEST_THREADS));
+    for (size_t s = 0; s < SIZE_COUNT; s++)
+    {
+        free(RefGCM[s]);
+        free(RefSIV[s]);
+    }
+    return Result;
+}
@@ -0,0 +1,101 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/base64.h"
+#include "test.h"
+
+//* The SIMD Base64 coders against a scalar reference: every size from 0 to 100 bytes (and the AVX2 and SSSE3 steps
+//* beyond), and invalid characters at every position of a vector step and of the scalar tail.
+
+static const char Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/// @brief RFC 4648 encoding, 3 bytes at a time.
+static size_t reference_encode(const uint8_t* In, size_t Size, char* Out)
+{
+    size_t Len = 0;
+    for (size_t i = 0; i < Size; i += 3)
+    {
+        uint32_t Triplet = (uint32_t) In[i] << 16;
+        if (i + 1 < Size)
+            Triplet |= (uint32_t) In[i + 1] << 8;
+        if (i + 2 < Size)
+            Triplet |= In[i + 2];
+        Out[Len++] = Alphabet[(Triplet >> 18) & 63];
+        Out[Len++] = Alphabet[(Triplet >> 12) & 63];
+        Out[Len++] = (i + 1 < Size) ? Alphabet[(Triplet >> 6) & 63] : '=';
+        Out[Len++] = (i + 2 < Size) ? Alphabet[Triplet & 63] : '=';
+    }
+    return Len;
+}
+
+static void test_sizes(void)
+{
+    //* 0 to 100, then around the 24 byte (32 character) AVX2 and 12 byte (16 character) SSSE3 steps.
+    static const size_t Large[] = {191, 192, 193, 1023, 1024, 1025, 4096};
+    uint8_t Data[4096], Decoded[4096];
+    char Expect[BASE64_ENCODED_SIZE(4096)], Out[BASE64_ENCODED_SIZE(4096)];
+    fill_random(Data, sizeof(Data), 20);
+
+    for (size_t n = 0; n < 101 + sizeof(Large) / sizeof(Large[0]); n++)
+    {
+        size_t Size = (n <= 100) ? n : Large[n - 101];
+        size_t ExpectLen = reference_encode(Data, Size, Expect), Len = 0, OutSize = 0;
+        CHECK(ExpectLen == BASE64_ENCODED_SIZE(Size), "base64 encoded size");
+
+        memset(Out, 0, sizeof(Out));
+        CHECK(base64_convert_string_into(Data, Size, Out, &Len) == success, "base64 encode");
+        CHECK(Len == ExpectLen && memcmp(Out, Expect, Len) == 0, "base64 encode matches reference");
+
+        char* Str = NULL;
+        CHECK(base64_convert_string(Data, Size, &Str) == success && Str != NULL, "base64 encode allocated");
+        CHECK(Str != NULL && strlen(Str) == ExpectLen && memcmp(Str, Expect, ExpectLen) == 0, "base64 encode allocated matches reference");
+        free(Str);
+
+        CHECK(base64_convert_byte_into(Expect, ExpectLen, Decoded, &OutSize) == success, "base64 decode");
+        CHECK(OutSize == Size && memcmp(Decoded, Data, Size) == 0, "base64 decode round trip");
+    }
+}
+
+static void test_invalid(void)
+{
+    //* Lengths with a tail only, one and two SSSE3 steps, one AVX2 step, and both with a tail behind.
+    static const size_t Lengths[] = {8, 16, 20, 32, 36, 48, 64, 68, 100, 200};
+    static const uint8_t Bad[] = {'!', '=', '\n', 0x80, 0xFF};
+    uint8_t Data[150], Decoded[150];
+    char Valid[201], Str[201];
+    fill_random(Data, sizeof(Data), 21);
+
+    for (size_t l = 0; l < sizeof(Lengths) / sizeof(Lengths[0]); l++)
+    {
+        //* Whole triplets, so the valid string has no padding.
+        size_t Len = Lengths[l], Size = 0;
+        reference_encode(Data, (Len/4)*3, Valid);
+        Valid[Len] = '\0';
+        CHECK(base64_convert_byte_into(Valid, Len, Decoded, &Size) == success && Size == (Len/4)*3, "base64 valid input");
+        CHECK(base64_validate(Valid), "base64 validate valid input");
+
+        for (size_t b = 0; b < sizeof(Bad); b++)
+        {
+            for (size_t p = 0; p < Len; p++)
+            {
+                //* '=' in the last place is padding.
+                if (Bad[b] == '=' && p == Len - 1)
+                    continue;
+                memcpy(Str, Valid, Len + 1);
+                Str[p] = (char) Bad[b];
+                CHECK(base64_convert_byte_into(Str, Len, Decoded, &Size) == unknown_error, "base64 invalid character rejected");
+                CHECK(!base64_validate(Str), "base64 validate invalid character");
+            }
+        }
+    }
+}
+
+static void test_base64_simd(void)
+{
+    test_sizes();
+    test_invalid();
+}
+
+int main(void)
+{
+    return test_result(test_configs(test_base64_simd, 0));
+}
@@ -0,0 +1,278 @@
+#include <string.h>
+#include "../include/base64.h"
+#include "test.h"
+
+//* The Base64 stream coders under random chunk splits (with and without whitespace) against the one-shot functions,
+//* the partial quartet carried between calls, padding split across calls and whitespace, and the input they must reject.
+//* Also the length-explicit one-shot functions on their edge cases.
+
+#define MAX_SIZE 300
+#define MAX_TEXT (4*BASE64_ENCODED_SIZE(MAX_SIZE))
+
+//* Chunk sizes for a split: 0 to 40 characters (or bytes), empty chunks included.
+static uint8_t Cuts[4096];
+
+/// @brief Decodes Len characters in chunks from Cuts (starting at Seed), then finishes the decode.
+/// @returns The first error of an update or the final call.
+static ErrorCode decode_chunked(const char* Text, size_t Len, bool SkipSpace, size_t Seed, uint8_t* Out, size_t* OutSize)
+{
+    Base64DecStream Ctx;
+    base64_dec_stream_init(&Ctx, SkipSpace);
+    *OutSize = 0;
+    for (size_t i = 0, c = Seed; i < Len; c++)
+    {
+        size_t Chunk = Cuts[c % sizeof(Cuts)] % 41;
+        if (Chunk > Len - i)
+            Chunk = Len - i;
+        size_t Part = 0;
+        if (base64_dec_stream_update(&Ctx, Text + i, Chunk, Out + *OutSize, &Part) != success)
+            return unknown_error;
+        *OutSize += Part;
+        i += Chunk;
+    }
+    return base64_dec_stream_final(&Ctx);
+}
+
+/// @brief Decodes the pieces of a NULL terminated list, one update each, then finishes the decode.
+/// @returns The first error of an update or the final call.
+static ErrorCode decode_pieces(const char* const* Pieces, bool SkipSpace, uint8_t* Out, size_t* OutSize)
+{
+    Base64DecStream Ctx;
+    base64_dec_stream_init(&Ctx, SkipSpace);
+    *OutSize = 0;
+    for (size_t p = 0; Pieces[p] != NULL; p++)
+    {
+        size_t Part = 0;
+        if (base64_dec_stream_update(&Ctx, Pieces[p], strlen(Pieces[p]), Out + *OutSize, &Part) != success)
+            return unknown_error;
+        *OutSize += Part;
+    }
+    return base64_dec_stream_final(&Ctx);
+}
+
+/// @brief Copies Len characters of Text with a whitespace run in front and after every Every characters.
+/// @returns The length of Spaced.
+static size_t add_space(const char* Text, size_t Len, size_t Every, char* Spaced)
+{
+    static const char* Runs[] = {"\r\n", " ", "\n", "\t", "\v\f ", "  \n"};
+    size_t n = 0, r = 0;
+    for (size_t i = 0; i <= Len; i++)
+    {
+        if (i % Every == 0)
+        {
+            const char* Run = Runs[r++ % (sizeof(Runs) / sizeof(Runs[0]))];
+            memcpy(Spaced + n, Run, strlen(Run));
+            n += strlen(Run);
+        }
+        if (i < Len)
+            Spaced[n++] = Text[i];
+    }
+    return n;
+}
+
+static void test_chunks(void)
+{
+    static const size_t Every[] = {1, 3, 4, 5, 64, 76};
+    uint8_t Data[MAX_SIZE], Out[MAX_SIZE];
+    char Text[MAX_TEXT], Spaced[MAX_TEXT];
+    fill_random(Data, sizeof(Data), 30);
+
+    for (size_t Size = 0; Size <= MAX_SIZE; Size += (Size < 80) ? 1 : 37)
+    {
+        size_t Len = 0, OutSize = 0;
+        base64_convert_string_into(Data, Size, Text, &Len);
+
+        for (size_t Seed = 0; Seed < 8; Seed++)
+        {
+            CHECK(decode_chunked(Text, Len, false, Seed*97 + Size, Out, &OutSize) == success, "base64 stream decode chunks");
+            CHECK(OutSize == Size && memcmp(Out, Data, Size) == 0, "base64 stream decode chunks matches");
+            CHECK(decode_chunked(Text, Len, true, Seed*89 + Size, Out, &OutSize) == success, "base64 stream decode chunks SkipSpace");
+            CHECK(OutSize == Size && memcmp(Out, Data, Size) == 0, "base64 stream decode chunks SkipSpace matches");
+        }
+
+        for (size_t e = 0; e < sizeof(Every) / sizeof(Every[0]); e++)
+        {
+            size_t SpacedLen = add_space(Text, Len, Every[e], Spaced);
+            for (size_t Seed = 0; Seed < 4; Seed++)
+            {
+                CHECK(decode_chunked(Spaced, SpacedLen, true, Seed*71 + e, Out, &OutSize) == success, "base64 stream decode whitespace");
+                CHECK(OutSize == Size && memcmp(Out, Data, Size) == 0, "base64 stream decode whitespace matches");
+            }
+            CHECK(decode_chunked(Spaced, SpacedLen, false, e, Out, &OutSize) == unknown_error, "base64 stream whitespace without SkipSpace");
+        }
+    }
+}
+
+static void test_carry(void)
+{
+    //* "ABCD", "ABCDE", "ABCDEF" and "ABCDEFGHI": two, one and no padding characters, then two whole quartets.
+    static const char* Texts[] = {"QUJDRA==", "QUJDREU=", "QUJDREVG", "QUJDREVGR0hJ"};
+    static const char* Plain[] = {"ABCD", "ABCDE", "ABCDEF", "ABCDEFGHI"};
+    uint8_t Out[16];
+    size_t OutSize;
+
+    for (size_t t = 0; t < sizeof(Texts) / sizeof(Texts[0]); t++)
+    {
+        size_t Len = strlen(Texts[t]);
+        char A[16], B[16], C[16];
+
+        //* Every two and three piece split, so 1 to 3 characters are carried into the next call.
+        for (size_t i = 0; i <= Len; i++)
+        {
+            for (size_t j = i; j <= Len; j++)
+            {
+                memcpy(A, Texts[t], i);
+                A[i] = '\0';
+                memcpy(B, Texts[t] + i, j - i);
+                B[j - i] = '\0';
+                memcpy(C, Texts[t] + j, Len - j);
+                C[Len - j] = '\0';
+                const char* Pieces[] = {A, B, C, NULL};
+                CHECK(decode_pieces(Pieces, false, Out, &OutSize) == success, "base64 stream carry");
+                CHECK(OutSize == strlen(Plain[t]) && memcmp(Out, Plain[t], OutSize) == 0, "base64 stream carry matches");
+                CHECK(decode_pieces(Pieces, true, Out, &OutSize) == success, "base64 stream carry SkipSpace");
+                CHECK(OutSize == strlen(Plain[t]) && memcmp(Out, Plain[t], OutSize) == 0, "base64 stream carry SkipSpace matches");
+            }
+        }
+    }
+
+    //* The carried characters and the output of one call.
+    Base64DecStream Ctx;
+    size_t Part;
+    base64_dec_stream_init(&Ctx, false);
+    CHECK(base64_dec_stream_update(&Ctx, "QUJDR", 5, Out, &Part) == success && Part == 3 && memcmp(Out, "ABC", 3) == 0, "base64 stream carry first quartet");
+    CHECK(Ctx.BufSize == 1, "base64 stream carries the partial quartet");
+    CHECK(base64_dec_stream_update(&Ctx, "E", 1, Out, &Part) == success && Part == 0 && Ctx.BufSize == 2, "base64 stream carry grows");
+    CHECK(base64_dec_stream_update(&Ctx, "VGR0", 4, Out, &Part) == success && Part == 3 && memcmp(Out, "DEF", 3) == 0, "base64 stream carry completed");
+    CHECK(base64_dec_stream_final(&Ctx) == unknown_error, "base64 stream final with the carried characters");
+}
+
+static void test_padding(void)
+{
+    uint8_t Out[16];
+    size_t OutSize;
+
+    //* The padded quartet split across calls and across whitespace.
+    static const char* const Split1[] = {"QUJDRA=", "=", NULL};
+    static const char* const Split2[] = {"QUJDR", "A", "=", "=", NULL};
+    static const char* const Split3[] = {"QUJDRA", "=\n", " =", "\r\n", NULL};
+    static const char* const Split4[] = {"QUJDREU", "\n", "=", NULL};
+    CHECK(decode_pieces(Split1, false, Out, &OutSize) == success && OutSize == 4 && memcmp(Out, "ABCD", 4) == 0, "base64 stream padding split");
+    CHECK(decode_pieces(Split2, false, Out, &OutSize) == success && OutSize == 4 && memcmp(Out, "ABCD", 4) == 0, "base64 stream padding split per character");
+    CHECK(decode_pieces(Split3, true, Out, &OutSize) == success && OutSize == 4 && memcmp(Out, "ABCD", 4) == 0, "base64 stream padding split by whitespace");
+    CHECK(decode_pieces(Split3, false, Out, &OutSize) == unknown_error, "base64 stream padding whitespace without SkipSpace");
+    CHECK(decode_pieces(Split4, true, Out, &OutSize) == success && OutSize == 5 && memcmp(Out, "ABCDE", 5) == 0, "base64 stream single padding split by whitespace");
+
+    //* Nothing but whitespace may follow the padding, in the same call or a later one.
+    static const char* const After1[] = {"QUJDRA==QUJD", NULL};
+    static const char* const After2[] = {"QUJDRA==", "QUJD", NULL};
+    static const char* const After3[] = {"QUJDRA=", "=Q", NULL};
+    static const char* const After4[] = {"QUJDRA==\n", "QUJD", NULL};
+    static const char* const After5[] = {"QUJDREU=", "Q", NULL};
+    static const char* const After6[] = {"QUJDRA==", "\r\n", " ", NULL};
+    static const char* const After7[] = {"QUJDRA==", "=", NULL};
+    CHECK(decode_pieces(After1, false, Out, &OutSize) == unknown_error, "base64 stream data after padding");
+    CHECK(decode_pieces(After2, false, Out, &OutSize) == unknown_error, "base64 stream data after padding next call");
+    CHECK(decode_pieces(After3, false, Out, &OutSize) == unknown_error, "base64 stream data after split padding");
+    CHECK(decode_pieces(After4, true, Out, &OutSize) == unknown_error, "base64 stream data after padding and whitespace");
+    CHECK(decode_pieces(After5, true, Out, &OutSize) == unknown_error, "base64 stream data after single padding");
+    CHECK(decode_pieces(After6, true, Out, &OutSize) == success && OutSize == 4, "base64 stream whitespace after padding");
+    CHECK(decode_pieces(After7, false, Out, &OutSize) == unknown_error, "base64 stream padding after padding");
+
+    //* '=' anywhere but the end of a quartet.
+    static const char* const Early1[] = {"QU=D", NULL};
+    static const char* const Early2[] = {"Q", "===", NULL};
+    CHECK(decode_pieces(Early1, false, Out, &OutSize) == unknown_error, "base64 stream padding inside a quartet");
+    CHECK(decode_pieces(Early2, false, Out, &OutSize) == unknown_error, "base64 stream three padding characters");
+}
+
+static void test_final(void)
+{
+    uint8_t Out[16];
+    size_t OutSize;
+
+    //* The input stops inside a quartet.
+    static const char* Partial[] = {"Q", "QU", "QUJ", "QUJDR", "QUJDRA="};
+    for (size_t p = 0; p < sizeof(Partial) / sizeof(Partial[0]); p++)
+    {
+        const char* Pieces[] = {Partial[p], NULL};
+        CHECK(decode_pieces(Pieces, true, Out, &OutSize) == unknown_error, "base64 stream final partial quartet");
+    }
+
+    //* Nothing, or only whitespace, is an empty message.
+    static const char* const Empty[] = {NULL};
+    static const char* const Blank[] = {" \r\n", "\t", NULL};
+    static const char* const Nothing[] = {"", "", NULL};
+    CHECK(decode_pieces(Empty, false, Out, &OutSize) == success && OutSize == 0, "base64 stream empty input");
+    CHECK(decode_pieces(Blank, true, Out, &OutSize) == success && OutSize == 0, "base64 stream whitespace only");
+    CHECK(decode_pieces(Nothing, false, Out, &OutSize) == success && OutSize == 0, "base64 stream empty chunks");
+
+    //* Invalid characters in a carried quartet and in a whole one.
+    static const char* const Bad1[] = {"QU", "!D", NULL};
+    static const char* const Bad2[] = {"QUJDQU!DQUJD", NULL};
+    CHECK(decode_pieces(Bad1, false, Out, &OutSize) == unknown_error, "base64 stream invalid carried character");
+    CHECK(decode_pieces(Bad2, true, Out, &OutSize) == unknown_error, "base64 stream invalid character");
+}
+
+static void test_encode(void)
+{
+    uint8_t Data[MAX_SIZE];
+    char Expect[MAX_TEXT], Out[MAX_TEXT];
+    fill_random(Data, sizeof(Data), 31);
+
+    for (size_t Size = 0; Size <= MAX_SIZE; Size += (Size < 80) ? 1 : 37)
+    {
+        size_t ExpectLen = 0;
+        base64_convert_string_into(Data, Size, Expect, &ExpectLen);
+
+        for (size_t Seed = 0; Seed < 8; Seed++)
+        {
+            Base64EncStream Ctx;
+            size_t Len = 0, Part = 0;
+            base64_enc_stream_init(&Ctx);
+            for (size_t i = 0, c = Seed*53 + Size; i < Size; c++)
+            {
+                size_t Chunk = Cuts[c % sizeof(Cuts)] % 41;
+                if (Chunk > Size - i)
+                    Chunk = Size - i;
+                base64_enc_stream_update(&Ctx, Data + i, Chunk, Out + Len, &Part);
+                Len += Part;
+                i += Chunk;
+            }
+            CHECK(base64_enc_stream_final(&Ctx, Out + Len, &Part) == success, "base64 stream encode final");
+            Len += Part;
+            CHECK(Len == ExpectLen && memcmp(Out, Expect, Len) == 0, "base64 stream encode chunks matches");
+        }
+    }
+}
+
+static void test_into(void)
+{
+    uint8_t Out[8] = {0x55};
+    char Text[8];
+    size_t Size = 1;
+    CHECK(base64_convert_byte_into("", 0, Out, &Size) == success && Size == 0, "base64 empty input");
+    CHECK(base64_convert_byte_into("QUJD", 3, Out, &Size) == unknown_error, "base64 partial quartet");
+    CHECK(base64_convert_byte_into("QUJDR", 5, Out, &Size) == unknown_error, "base64 partial second quartet");
+    CHECK(base64_convert_byte_into("QU!D", 4, Out, &Size) == unknown_error, "base64 invalid character");
+    CHECK(base64_convert_byte_into("QUJDRA==QUJD", 12, Out, &Size) == unknown_error, "base64 data after padding");
+    CHECK(base64_convert_byte_into("QUJDxxxx", 4, Out, &Size) == success && Size == 3 && memcmp(Out, "ABC", 3) == 0, "base64 decode reads Len characters only");
+    Size = 1;
+    CHECK(base64_convert_string_into(Out, 0, Text, &Size) == success && Size == 0, "base64 encode empty input");
+}
+
+static void test_base64_stream(void)
+{
+    fill_random(Cuts, sizeof(Cuts), 32);
+    test_chunks();
+    test_carry();
+    test_padding();
+    test_final();
+    test_encode();
+    test_into();
+}
+
+int main(void)
+{
+    return test_result(test_configs(test_base64_stream, 0));
+}
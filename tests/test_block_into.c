@@ -0,0 +1,136 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/aes.h"
+#include "test.h"
+
+//* ECB and CBC into caller buffers, in place and streamed, against the allocating functions, under every AES backend.
+
+static uint8_t Key[32], IV[16];
+
+/// @brief Streams Size bytes of In through Ctx in pieces of 1 to Max bytes, returns the bytes written to Out.
+static size_t stream_cbc(AESCBCStream* Ctx, const uint8_t* In, size_t Size, size_t Max, uint8_t* Out, uint32_t Seed)
+{
+    size_t Total = 0, Part;
+    uint8_t Step;
+    for (size_t i = 0; i < Size;)
+    {
+        fill_random(&Step, 1, Seed++);
+        size_t Len = 1 + Step % Max;
+        if (Len > Size - i)
+            Len = Size - i;
+        aes_cbc_stream_update(Ctx, In + i, Len, Out + Total, &Part);
+        Total += Part;
+        i += Len;
+    }
+    return Total;
+}
+
+static void test_vectors(void)
+{
+    //* SP 800-38A F.1.5 and F.2.5 (first two blocks, the padding block follows).
+    uint8_t P[32], C[32], Out[48], Back[48];
+    size_t Size, BackSize;
+    hex_bytes("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51", P);
+    hex_bytes("f3eed1bdb5d2a03c064b5a7e3db181f8591ccb10d410ed26dc5ba74a31362870", C);
+    CHECK(aes_ecb_enc_into(P, 32, Key, Out, &Size) == success && Size == 48 && memcmp(Out, C, 32) == 0, "ecb enc_into vector");
+    CHECK(aes_ecb_dec_into(Out, 48, Key, Out, &BackSize) == success && BackSize == 32 && memcmp(Out, P, 32) == 0, "ecb dec_into in place");
+    hex_bytes("f58c4c04d6e5f1ba779eabfb5f7bfbd69cfc4e967edb808d679f777bc6702c7d", C);
+    CHECK(aes_cbc_enc_into(P, 32, Key, IV, Out, &Size) == success && Size == 48 && memcmp(Out, C, 32) == 0, "cbc enc_into vector");
+    CHECK(aes_cbc_dec_into(Out, 48, Key, IV, Back, &BackSize) == success && BackSize == 32 && memcmp(Back, P, 32) == 0, "cbc dec_into");
+}
+
+static void test_sizes(void)
+{
+    //* Every size around the padding: the allocating, into, in place and streaming paths agree.
+    AESKey Ctx;
+    aes_key_init(&Ctx, Key);
+    uint8_t Msg[80], Out[96], Buf[96], Stream[112];
+    size_t Size, BackSize, Part;
+    ByteArr Empty;
+    CHECK(aes_cbc_enc_ctx(Msg, 0, &Ctx, IV, &Empty) == unknown_error && aes_ecb_enc_into_ctx(Msg, 0, &Ctx, Out, &Size) == unknown_error, "empty Plaintext");
+
+    for (size_t n = 1; n <= 64; n++)
+    {
+        fill_random(Msg, n, 0xC0FFEE + (uint32_t) n);
+        ByteArr Ret;
+        CHECK(aes_cbc_enc_ctx(Msg, n, &Ctx, IV, &Ret) == success && Ret.Size == AES_PADDED_SIZE(n), "cbc enc_ctx");
+        CHECK(aes_cbc_enc_into_ctx(Msg, n, &Ctx, IV, Out, &Size) == success && Size == Ret.Size && memcmp(Out, Ret.Arr, Size) == 0, "cbc enc_into_ctx");
+        memcpy(Buf, Msg, n);
+        aes_cbc_enc_into_ctx(Buf, n, &Ctx, IV, Buf, &Size);
+        CHECK(memcmp(Buf, Ret.Arr, Size) == 0, "cbc enc_into_ctx in place");
+        CHECK(aes_cbc_dec_into_ctx(Buf, Size, &Ctx, IV, Buf, &BackSize) == success && BackSize == n && memcmp(Buf, Msg, n) == 0, "cbc dec_into_ctx in place");
+
+        //* Streamed in random pieces up to 1, 11 and 40 bytes.
+        static const size_t Max[] = {1, 11, 40};
+        for (size_t m = 0; m < sizeof(Max) / sizeof(Max[0]); m++)
+        {
+            AESCBCStream S;
+            aes_cbc_stream_init(&S, &Ctx, IV, true);
+            size_t Total = stream_cbc(&S, Msg, n, Max[m], Stream, (uint32_t) (n * 3 + m));
+            CHECK(aes_cbc_stream_final(&S, Stream + Total, &Part) == success && Part == 16, "cbc stream final");
+            CHECK(Total + Part == Ret.Size && memcmp(Stream, Ret.Arr, Ret.Size) == 0, "cbc stream encrypt");
+            CHECK(is_zero((const uint8_t*) &S, sizeof(S)), "cbc stream final wipes the stream");
+
+            aes_cbc_stream_init(&S, &Ctx, IV, false);
+            Total = stream_cbc(&S, Ret.Arr, Ret.Size, Max[m], Stream, (uint32_t) (n * 5 + m));
+            CHECK(aes_cbc_stream_final(&S, Stream + Total, &Part) == success && Total + Part == n && memcmp(Stream, Msg, n) == 0, "cbc stream decrypt");
+            CHECK(is_zero((const uint8_t*) &S, sizeof(S)), "cbc stream decrypt final wipes the stream");
+        }
+        free(Ret.Arr);
+
+        CHECK(aes_ecb_enc_ctx(Msg, n, &Ctx, &Ret) == success, "ecb enc_ctx");
+        CHECK(aes_ecb_enc_into_ctx(Msg, n, &Ctx, Out, &Size) == success && Size == Ret.Size && memcmp(Out, Ret.Arr, Size) == 0, "ecb enc_into_ctx");
+        memcpy(Buf, Msg, n);
+        aes_ecb_enc_into_ctx(Buf, n, &Ctx, Buf, &Size);
+        CHECK(Size == Ret.Size && memcmp(Buf, Ret.Arr, Size) == 0, "ecb enc_into_ctx in place");
+        CHECK(aes_ecb_dec_into_ctx(Buf, Size, &Ctx, Buf, &BackSize) == success && BackSize == n && memcmp(Buf, Msg, n) == 0, "ecb dec_into_ctx in place");
+        free(Ret.Arr);
+    }
+    aes_key_clear(&Ctx);
+}
+
+static void test_invalid(void)
+{
+    AESKey Ctx;
+    AESCBCStream S;
+    aes_key_init(&Ctx, Key);
+    uint8_t Buf[32] = {0}, Out[48];
+    size_t Size, Part;
+
+    //* Partial blocks and broken padding.
+    CHECK(aes_ecb_dec_into_ctx(Buf, 15, &Ctx, Out, &Size) == unknown_error, "ecb dec partial block");
+    CHECK(aes_cbc_dec_into_ctx(Buf, 17, &Ctx, IV, Out, &Size) == unknown_error, "cbc dec partial block");
+    aes_ecb_enc_into_ctx(Buf, 16, &Ctx, Buf, &Size);
+    Buf[31] ^= 0x01;
+    CHECK(aes_ecb_dec_into_ctx(Buf, 32, &Ctx, Out, &Size) == unknown_error, "ecb dec bad padding");
+
+    memset(Buf, 0, 32);
+    aes_cbc_enc_into_ctx(Buf, 16, &Ctx, IV, Buf, &Size);
+    Buf[15] ^= 0x01;
+    CHECK(aes_cbc_dec_into_ctx(Buf, 32, &Ctx, IV, Out, &Size) == unknown_error, "cbc dec bad padding");
+    aes_cbc_stream_init(&S, &Ctx, IV, false);
+    aes_cbc_stream_update(&S, Buf, 32, Out, &Size);
+    CHECK(aes_cbc_stream_final(&S, Out + Size, &Part) == unknown_error, "cbc stream bad padding");
+    CHECK(is_zero((const uint8_t*) &S, sizeof(S)), "cbc stream bad padding wipes the stream");
+    aes_cbc_stream_init(&S, &Ctx, IV, false);
+    aes_cbc_stream_update(&S, Buf, 20, Out, &Size);
+    CHECK(aes_cbc_stream_final(&S, Out + Size, &Part) == unknown_error, "cbc stream partial block");
+    aes_key_clear(&Ctx);
+}
+
+
+//? Configurations
+
+static void run(void)
+{
+    test_vectors();
+    test_sizes();
+    test_invalid();
+}
+
+int main(void)
+{
+    hex_bytes("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4", Key);
+    hex_bytes("000102030405060708090a0b0c0d0e0f", IV);
+    return test_result(test_configs(run, TEST_AES_BACKENDS));
+}
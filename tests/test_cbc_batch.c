@@ -0,0 +1,68 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/aes.h"
+#include "test.h"
+
+//* Multi-buffer CBC encryption against aes_cbc_enc_into_ctx(), one message at a time, under every AES backend.
+
+//* Batches below, at and above the 8 lanes, with lanes finishing at different blocks.
+static const size_t Counts[] = {1, 3, 8, 9, 17};
+#define MAX_COUNT 17
+#define MAX_SIZE 200
+
+static void test_cbc_batch(void)
+{
+    uint8_t Keys[3][32], IVs[MAX_COUNT][16];
+    uint8_t Msgs[MAX_COUNT][MAX_SIZE], Outs[MAX_COUNT][AES_PADDED_SIZE(MAX_SIZE)], Expect[AES_PADDED_SIZE(MAX_SIZE)];
+    AESKey Ctx[3];
+    AESCBCJob Jobs[MAX_COUNT];
+    for (int k = 0; k < 3; k++)
+    {
+        fill_random(Keys[k], 32, 40 + (uint32_t) k);
+        aes_key_init(&Ctx[k], Keys[k]);
+    }
+
+    for (size_t c = 0; c < sizeof(Counts) / sizeof(Counts[0]); c++)
+    {
+        size_t Count = Counts[c];
+
+        //* Sizes from 1 byte to 12 blocks, three keys, odd messages encrypted in place.
+        for (size_t i = 0; i < Count; i++)
+        {
+            size_t Size = 1 + (i * 37 + c * 11) % MAX_SIZE;
+            fill_random(Msgs[i], Size, 0xCBC + (uint32_t) (c * MAX_COUNT + i));
+            fill_random(IVs[i], 16, 0x1F + (uint32_t) i);
+            if (i % 2 == 1)
+                memcpy(Outs[i], Msgs[i], Size);
+            Jobs[i] = (AESCBCJob) {(i % 2 == 1) ? Outs[i] : Msgs[i], Size, &Ctx[i % 3], IVs[i], Outs[i], 0};
+        }
+        CHECK(aes_cbc_enc_batch(Jobs, Count) == success, "cbc enc batch");
+
+        for (size_t i = 0; i < Count; i++)
+        {
+            size_t Size;
+            CHECK(aes_cbc_enc_into_ctx(Msgs[i], Jobs[i].Size, &Ctx[i % 3], IVs[i], Expect, &Size) == success, "cbc enc_into_ctx");
+            CHECK(Jobs[i].OutSize == Size && memcmp(Outs[i], Expect, Size) == 0, "cbc enc batch matches enc_into_ctx");
+        }
+    }
+
+    //* An empty message fails the whole batch before anything is written.
+    for (size_t i = 0; i < 3; i++)
+    {
+        memset(Outs[i], 0x55, 16);
+        Jobs[i] = (AESCBCJob) {Msgs[i], (i == 2) ? 0 : 16, &Ctx[0], IVs[i], Outs[i], 0};
+    }
+    CHECK(aes_cbc_enc_batch(Jobs, 3) == unknown_error, "cbc enc batch empty message");
+    CHECK(Outs[0][0] == 0x55 && Outs[0][15] == 0x55, "cbc enc batch empty message writes nothing");
+
+    for (int k = 0; k < 3; k++)
+        aes_key_clear(&Ctx[k]);
+}
+
+
+//? Configurations
+
+int main(void)
+{
+    return test_result(test_configs(test_cbc_batch, TEST_AES_BACKENDS));
+}
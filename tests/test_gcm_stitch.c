@@ -0,0 +1,129 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/aes.h"
+#include "../include/aes_backend.h"
+#include "test.h"
+
+//* Stitched GCM (CTR and GHASH in one pass, 4 KiB at a time) against a GCM built from single block encryption and
+//* ghash_update(), for sizes around the stitch size, in place and into a separate buffer, under every backend.
+
+//* Sizes around the partial block and GCM_STITCH_SIZE (4 KiB).
+static const size_t Sizes[] = {0, 1, 15, 16, 17, 4095, 4096, 4097, 4111, 8209, 12293};
+#define SIZE_COUNT (sizeof(Sizes) / sizeof(Sizes[0]))
+#define MAX_SIZE 12293
+
+static uint8_t Key[32], IV[12], AAD[21];
+static uint8_t Msg[MAX_SIZE];
+static uint8_t* RefC[SIZE_COUNT];
+static uint8_t RefTag[SIZE_COUNT][16];
+
+
+//? Reference
+
+/// @brief GCM of Msg[0..Size) written out from its definition (SP 800-38D): CTR from inc32(J0), then GHASH over
+/// the padded AAD, the padded Ciphertext and their bit lengths.
+static void reference_gcm(size_t Size, uint8_t* C, uint8_t* Tag)
+{
+    AESKey Ctx;
+    GHashKey Auth;
+    uint8_t H[16] = {0}, J0[16], Block[16], Y[16] = {0}, Lengths[16];
+    aes_key_init(&Ctx, Key);
+    aes_std_enc_ctx(H, &Ctx);
+    ghash_key_init(&Auth, H);
+
+    memcpy(J0, IV, 12);
+    for (size_t i = 0; i < Size; i += 16)
+    {
+        uint32_t Counter = 2 + (uint32_t) (i / 16);
+        memcpy(Block, IV, 12);
+        Block[12] = (uint8_t) (Counter >> 24);
+        Block[13] = (uint8_t) (Counter >> 16);
+        Block[14] = (uint8_t) (Counter >> 8);
+        Block[15] = (uint8_t) Counter;
+        aes_std_enc_ctx(Block, &Ctx);
+        for (size_t j = 0; j < 16 && i + j < Size; j++)
+            C[i + j] = Msg[i + j] ^ Block[j];
+    }
+
+    uint64_t ABits = (uint64_t) sizeof(AAD) * 8, CBits = (uint64_t) Size * 8;
+    for (int j = 0; j < 8; j++)
+    {
+        Lengths[7 - j] = (uint8_t) (ABits >> (8*j));
+        Lengths[15 - j] = (uint8_t) (CBits >> (8*j));
+    }
+    ghash_update(&Auth, Y, AAD, sizeof(AAD));
+    ghash_update(&Auth, Y, C, Size);
+    ghash_update(&Auth, Y, Lengths, 16);
+
+    J0[12] = J0[13] = J0[14] = 0;
+    J0[15] = 1;
+    aes_std_enc_ctx(J0, &Ctx);
+    for (int j = 0; j < 16; j++)
+        Tag[j] = Y[j] ^ J0[j];
+
+    ghash_key_clear(&Auth);
+    aes_key_clear(&Ctx);
+}
+
+
+//? Stitched GCM
+
+static void test_stitch(void)
+{
+    AESGCMKey Ctx;
+    aes_gcm_key_init(&Ctx, Key);
+    uint8_t* Buf = malloc(MAX_SIZE);
+    uint8_t* Out = malloc(MAX_SIZE);
+    uint8_t Tag[16];
+
+    for (size_t s = 0; s < SIZE_COUNT; s++)
+    {
+        size_t Size = Sizes[s];
+        memcpy(Buf, Msg, Size);
+        CHECK(aes_gcm_enc_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, Tag) == success, "gcm enc_ctx");
+        CHECK(memcmp(Buf, RefC[s], Size) == 0 && memcmp(Tag, RefTag[s], 16) == 0, "gcm enc_ctx matches reference");
+
+        CHECK(aes_gcm_dec_into_ctx(RefC[s], Size, AAD, sizeof(AAD), &Ctx, IV, RefTag[s], Out) == success, "gcm dec_into_ctx");
+        CHECK(memcmp(Out, Msg, Size) == 0, "gcm dec_into_ctx Plaintext");
+        CHECK(aes_gcm_dec_into(RefC[s], Size, AAD, sizeof(AAD), Key, IV, RefTag[s], Out) == success && memcmp(Out, Msg, Size) == 0, "gcm dec_into");
+        CHECK(aes_gcm_dec_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, RefTag[s]) == success && memcmp(Buf, Msg, Size) == 0, "gcm dec_ctx in place");
+
+        //* A flipped bit in the last stitch piece: into zeroes the Plaintext, in place leaves the Ciphertext.
+        if (Size == 0)
+            continue;
+        memcpy(Buf, RefC[s], Size);
+        Buf[Size - 1] ^= 0x80;
+        memset(Out, 0x55, Size);
+        CHECK(aes_gcm_dec_into_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, RefTag[s], Out) == unknown_error && is_zero(Out, Size), "gcm dec_into_ctx tampered zeroes Plaintext");
+        CHECK(aes_gcm_dec_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, RefTag[s]) == unknown_error, "gcm dec_ctx tampered");
+        Buf[Size - 1] ^= 0x80;
+        CHECK(memcmp(Buf, RefC[s], Size) == 0, "gcm dec_ctx tampered leaves Ciphertext");
+    }
+
+    free(Buf);
+    free(Out);
+    aes_gcm_key_clear(&Ctx);
+}
+
+
+//? Configurations
+
+int main(void)
+{
+    fill_random(Key, 32, 1);
+    fill_random(IV, 12, 2);
+    fill_random(AAD, sizeof(AAD), 3);
+    fill_random(Msg, MAX_SIZE, 4);
+    aes_set_backend(aes_backend_bytewise);
+    aes_set_ghash_backend(ghash_backend_bitserial);
+    for (size_t s = 0; s < SIZE_COUNT; s++)
+    {
+        RefC[s] = malloc(Sizes[s] + 1);
+        reference_gcm(Sizes[s], RefC[s], RefTag[s]);
+    }
+
+    int Result = test_result(test_configs(test_stitch, TEST_AES_BACKENDS | TEST_GHASH_BACKENDS));
+    for (size_t s = 0; s < SIZE_COUNT; s++)
+        free(RefC[s]);
+    return Result;
+}
@@ -0,0 +1,129 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/aes.h"
+#include "test.h"
+
+//* Streaming GCM against the one call functions: AAD and data in pieces of every size, misuse of the stream, and
+//* the wipe at the end, under every AES and GHASH backend.
+
+#define STREAM_SIZE 5000
+
+/// @brief Streams Size bytes of Data through Ctx, in pieces of 1 to Max bytes (Max 0: one piece).
+static void stream_data(AESGCMStream* Ctx, uint8_t* Data, size_t Size, size_t Max, uint32_t Seed)
+{
+    uint8_t Step;
+    for (size_t i = 0; i < Size;)
+    {
+        fill_random(&Step, 1, Seed++);
+        size_t Len = Max ? 1 + Step % Max : Size;
+        if (Len > Size - i)
+            Len = Size - i;
+        aes_gcm_stream_update(Ctx, Data + i, Len);
+        i += Len;
+    }
+}
+
+static void test_stream_vectors(void)
+{
+    for (size_t v = 0; v < GCMVectorCount; v++)
+    {
+        AEADCase T;
+        load_vector(&GCMVectors[v], &T);
+        AESGCMKey Ctx;
+        AESGCMStream Stream;
+        uint8_t Buf[64], Tag[16];
+        aes_gcm_key_init(&Ctx, T.Key);
+
+        //* Every fixed piece size, AAD in pieces of the same size.
+        for (size_t Piece = 1; Piece <= 17; Piece++)
+        {
+            memcpy(Buf, T.P, T.Size);
+            CHECK(aes_gcm_stream_init(&Stream, &Ctx, T.IV, true) == success, "gcm stream init");
+            for (size_t i = 0; i < T.ASize; i += Piece)
+                CHECK(aes_gcm_stream_aad(&Stream, T.AAD + i, (T.ASize - i < Piece) ? T.ASize - i : Piece) == success, "gcm stream aad");
+            for (size_t i = 0; i < T.Size; i += Piece)
+                CHECK(aes_gcm_stream_update(&Stream, Buf + i, (T.Size - i < Piece) ? T.Size - i : Piece) == success, "gcm stream update");
+            CHECK(aes_gcm_stream_final(&Stream, Tag) == success, "gcm stream final");
+            CHECK(memcmp(Buf, T.C, T.Size) == 0 && memcmp(Tag, T.Tag, 16) == 0, "gcm stream vector");
+            CHECK(is_zero((const uint8_t*) &Stream, sizeof(Stream)), "gcm stream final wipes the stream");
+
+            aes_gcm_stream_init(&Stream, &Ctx, T.IV, false);
+            aes_gcm_stream_aad(&Stream, T.AAD, T.ASize);
+            for (size_t i = 0; i < T.Size; i += Piece)
+                aes_gcm_stream_update(&Stream, Buf + i, (T.Size - i < Piece) ? T.Size - i : Piece);
+            CHECK(aes_gcm_stream_verify(&Stream, T.Tag) == success && memcmp(Buf, T.P, T.Size) == 0, "gcm stream decrypt vector");
+            CHECK(is_zero((const uint8_t*) &Stream, sizeof(Stream)), "gcm stream verify wipes the stream");
+        }
+
+        memcpy(Buf, T.C, T.Size);
+        aes_gcm_stream_init(&Stream, &Ctx, T.IV, false);
+        aes_gcm_stream_aad(&Stream, T.AAD, T.ASize);
+        aes_gcm_stream_update(&Stream, Buf, T.Size);
+        CHECK(aes_gcm_stream_verify(&Stream, T.Bad) == unknown_error, "gcm stream bad tag");
+        CHECK(is_zero((const uint8_t*) &Stream, sizeof(Stream)), "gcm stream bad tag wipes the stream");
+
+        aes_gcm_key_clear(&Ctx);
+    }
+}
+
+static void test_stream_random(void)
+{
+    uint8_t Key[32], IV[12], AAD[300], Tag[16], Expect[16];
+    uint8_t* P = malloc(STREAM_SIZE);
+    uint8_t* C = malloc(STREAM_SIZE);
+    uint8_t* Buf = malloc(STREAM_SIZE);
+    fill_random(Key, 32, 1);
+    fill_random(IV, 12, 2);
+    fill_random(AAD, sizeof(AAD), 3);
+    fill_random(P, STREAM_SIZE, 4);
+    AESGCMKey Ctx;
+    AESGCMStream Stream;
+    aes_gcm_key_init(&Ctx, Key);
+    memcpy(C, P, STREAM_SIZE);
+    aes_gcm_enc_ctx(C, STREAM_SIZE, AAD, sizeof(AAD), &Ctx, IV, Expect);
+
+    //* Random pieces up to 1, 16, 100 and 4100 bytes (across the stitched passes) and one piece, AAD in two uneven pieces.
+    static const size_t Max[] = {1, 16, 100, 4100, 0};
+    for (size_t m = 0; m < sizeof(Max) / sizeof(Max[0]); m++)
+    {
+        memcpy(Buf, P, STREAM_SIZE);
+        aes_gcm_stream_init(&Stream, &Ctx, IV, true);
+        aes_gcm_stream_aad(&Stream, AAD, 77);
+        aes_gcm_stream_aad(&Stream, AAD + 77, sizeof(AAD) - 77);
+        stream_data(&Stream, Buf, STREAM_SIZE, Max[m], 50 + (uint32_t) m);
+        aes_gcm_stream_final(&Stream, Tag);
+        CHECK(memcmp(Buf, C, STREAM_SIZE) == 0 && memcmp(Tag, Expect, 16) == 0, "gcm stream matches enc_ctx");
+
+        aes_gcm_stream_init(&Stream, &Ctx, IV, false);
+        aes_gcm_stream_aad(&Stream, AAD, sizeof(AAD));
+        stream_data(&Stream, Buf, STREAM_SIZE, Max[m], 60 + (uint32_t) m);
+        CHECK(aes_gcm_stream_verify(&Stream, Expect) == success && memcmp(Buf, P, STREAM_SIZE) == 0, "gcm stream decrypt matches");
+    }
+
+    //* AAD after data, and finishing a stream the wrong way.
+    aes_gcm_stream_init(&Stream, &Ctx, IV, true);
+    aes_gcm_stream_update(&Stream, Buf, 5);
+    CHECK(aes_gcm_stream_aad(&Stream, AAD, 1) == unknown_error, "gcm stream aad after data");
+    CHECK(aes_gcm_stream_verify(&Stream, Expect) == unknown_error, "gcm stream verify on an encryption stream");
+    aes_gcm_stream_init(&Stream, &Ctx, IV, false);
+    CHECK(aes_gcm_stream_final(&Stream, Tag) == unknown_error, "gcm stream final on a decryption stream");
+
+    aes_gcm_key_clear(&Ctx);
+    free(P);
+    free(C);
+    free(Buf);
+}
+
+
+//? Configurations
+
+static void run(void)
+{
+    test_stream_vectors();
+    test_stream_random();
+}
+
+int main(void)
+{
+    return test_result(test_configs(run, TEST_AES_BACKENDS | TEST_GHASH_BACKENDS));
+}
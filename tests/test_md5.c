@@ -0,0 +1,97 @@
+#include <string.h>
+#include "../include/hash.h"
+#include "test.h"
+
+//* MD5 known answers (RFC 1321 appendix A.5) through hash_md5() and the streaming functions, and streamed messages
+//* split at every offset around the padding and block boundaries.
+
+typedef struct
+{
+    const char* Message;
+    const char* Digest;
+} MD5Vector;
+
+static const MD5Vector Vectors[] =
+{
+    {"", "d41d8cd98f00b204e9800998ecf8427e"},
+    {"a", "0cc175b9c0f1b6a831c399e269772661"},
+    {"abc", "900150983cd24fb0d6963f7d28e17f72"},
+    {"message digest", "f96b697d7cb7938d525a2f31aaf161d0"},
+    {"abcdefghijklmnopqrstuvwxyz", "c3fcd3d76192e4007dfb496cca67e13b"},
+    {"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789", "d174ab98d277d9f5a5611c2c9f419d9f"},
+    {"12345678901234567890123456789012345678901234567890123456789012345678901234567890", "57edf4a22be3c955ac49da2e2107b67a"},
+};
+
+static void test_vectors(void)
+{
+    for (size_t v = 0; v < sizeof(Vectors) / sizeof(Vectors[0]); v++)
+    {
+        const char* Msg = Vectors[v].Message;
+        size_t Size = strlen(Msg);
+        uint8_t Expect[16], Digest[16];
+        hex_bytes(Vectors[v].Digest, Expect);
+
+        CHECK(hash_md5(Msg, Size, Digest) == success && memcmp(Digest, Expect, 16) == 0, "md5 vector");
+
+        MD5Ctx Ctx;
+        CHECK(hash_md5_init(&Ctx) == success, "md5 init");
+        for (size_t i = 0; i < Size; i++)
+            hash_md5_update(&Ctx, Msg + i, 1);
+        CHECK(hash_md5_final(&Ctx, Digest) == success && memcmp(Digest, Expect, 16) == 0, "md5 stream vector byte by byte");
+        CHECK(is_zero((const uint8_t*) &Ctx, sizeof(Ctx)), "md5 final wipes the context");
+    }
+}
+
+static void test_splits(void)
+{
+    //* Around the last byte that still fits the length in the same block (55/56), and the block ends.
+    static const size_t Sizes[] = {55, 56, 57, 63, 64, 65, 119, 120, 121, 127, 128, 129, 200};
+    static const size_t Cuts[] = {0, 1, 54, 55, 56, 57, 63, 64, 65, 118, 119, 120, 121, 127, 128, 129};
+    uint8_t Data[200], Expect[16], Digest[16];
+    fill_random(Data, sizeof(Data), 17);
+
+    for (size_t s = 0; s < sizeof(Sizes) / sizeof(Sizes[0]); s++)
+    {
+        size_t Size = Sizes[s];
+        MD5Ctx Ctx;
+        hash_md5(Data, Size, Expect);
+
+        //* Two pieces, cut at every offset.
+        for (size_t Cut = 0; Cut <= Size; Cut++)
+        {
+            hash_md5_init(&Ctx);
+            hash_md5_update(&Ctx, Data, Cut);
+            hash_md5_update(&Ctx, Data + Cut, Size - Cut);
+            hash_md5_final(&Ctx, Digest);
+            CHECK(memcmp(Digest, Expect, 16) == 0, "md5 in two pieces");
+        }
+
+        //* Three pieces, both cuts around the boundaries.
+        for (size_t a = 0; a < sizeof(Cuts) / sizeof(Cuts[0]); a++)
+            for (size_t b = a; b < sizeof(Cuts) / sizeof(Cuts[0]); b++)
+            {
+                if (Cuts[b] > Size)
+                    break;
+                hash_md5_init(&Ctx);
+                hash_md5_update(&Ctx, Data, Cuts[a]);
+                hash_md5_update(&Ctx, Data + Cuts[a], Cuts[b] - Cuts[a]);
+                hash_md5_update(&Ctx, Data + Cuts[b], Size - Cuts[b]);
+                hash_md5_final(&Ctx, Digest);
+                CHECK(memcmp(Digest, Expect, 16) == 0, "md5 in three pieces");
+            }
+    }
+}
+
+
+//? Configurations
+
+static void run(void)
+{
+    test_vectors();
+    test_splits();
+}
+
+int main(void)
+{
+    return test_result(test_configs(run, 0));
+}
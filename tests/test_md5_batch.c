@@ -0,0 +1,52 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/hash.h"
+#include "test.h"
+
+//* Multi-buffer MD5 against hash_md5(), one message at a time. Batches of 2 to 4 messages run on the SSE2 kernel,
+//* larger ones on AVX2 when the CPU has it, with lanes refilled as messages finish.
+
+static const size_t Counts[] = {1, 3, 4, 5, 8, 9, 17};
+#define MAX_COUNT 17
+
+//* Empty, around the padding and block sizes, and large enough to outlast several refills.
+static const size_t Sizes[] = {0, 1, 55, 56, 64, 65, 5000};
+#define SIZE_COUNT (sizeof(Sizes) / sizeof(Sizes[0]))
+
+static void test_batch(void)
+{
+    uint8_t* Data = malloc(MAX_COUNT * 5000);
+    fill_random(Data, MAX_COUNT * 5000, 18);
+    MD5Job Jobs[MAX_COUNT];
+    uint8_t Digests[MAX_COUNT][16], Expect[16];
+
+    for (size_t c = 0; c < sizeof(Counts) / sizeof(Counts[0]); c++)
+    {
+        //* Each batch starts at a different size, so every lane sees every size over the batches.
+        for (size_t Shift = 0; Shift < SIZE_COUNT; Shift++)
+        {
+            size_t Count = Counts[c];
+            for (size_t i = 0; i < Count; i++)
+            {
+                memset(Digests[i], 0, 16);
+                Jobs[i] = (MD5Job) {Data + i * 5000, Sizes[(i + Shift) % SIZE_COUNT], Digests[i]};
+            }
+            CHECK(hash_md5_batch(Jobs, Count) == success, "md5 batch");
+            for (size_t i = 0; i < Count; i++)
+            {
+                hash_md5(Jobs[i].Data, Jobs[i].Size, Expect);
+                CHECK(memcmp(Digests[i], Expect, 16) == 0, "md5 batch matches hash_md5");
+            }
+        }
+    }
+    CHECK(hash_md5_batch(Jobs, 0) == success, "md5 empty batch");
+    free(Data);
+}
+
+
+//? Configurations
+
+int main(void)
+{
+    return test_result(test_configs(test_batch, 0));
+}
@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../include/md5sum.h"
+#include "test.h"
+
+//* The md5sum mode end to end: a generated directory hashed on 4 workers and compared line by line with known digests
+//* (including GNU style escaped names), then -c on that list as written, and with one corrupted entry and one missing file.
+
+#define OUT_MAX 8192
+
+typedef struct
+{
+    const char* Name;
+    const char* Content;
+    const char* Digest;
+} SumEntry;
+
+//* In the order the directory walk prints them (byte order of the names).
+static const SumEntry Entries[] =
+{
+    {"a.txt", "abc", "900150983cd24fb0d6963f7d28e17f72"},
+    {"back\\slash", "a", "0cc175b9c0f1b6a831c399e269772661"},
+    {"empty", "", "d41d8cd98f00b204e9800998ecf8427e"},
+    {"new\nline", "abcdefghijklmnopqrstuvwxyz", "c3fcd3d76192e4007dfb496cca67e13b"},
+    {"sub/msg", "message digest", "f96b697d7cb7938d525a2f31aaf161d0"},
+};
+
+//* n00 to n19, more than two groups of 8 so several workers map and batch files.
+#define NUMBERED 20
+static const char* NumberedContent = "12345678901234567890123456789012345678901234567890123456789012345678901234567890";
+static const char* NumberedDigest = "57edf4a22be3c955ac49da2e2107b67a";
+
+static char Dir[64];
+
+static void write_file(const char* Name, const char* Content)
+{
+    char Path[256];
+    snprintf(Path, sizeof(Path), "%s/%s", Dir, Name);
+    FILE* File = fopen(Path, "wb");
+    CHECK(File != NULL, "create test file");
+    if (File == NULL)
+        return;
+    fputs(Content, File);
+    fclose(File);
+}
+
+/// @brief Runs md5sum_run() with stdout captured into Out (NUL terminated) and stderr silenced.
+/// @returns The exit status of md5sum_run().
+static int run_sum(int Argc, char** Argv, char* Out)
+{
+    char Path[96];
+    snprintf(Path, sizeof(Path), "%s.out", Dir);
+    int Fd = open(Path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    int Null = open("/dev/null", O_WRONLY);
+    fflush(stdout);
+    fflush(stderr);
+    int SavedOut = dup(STDOUT_FILENO), SavedErr = dup(STDERR_FILENO);
+    dup2(Fd, STDOUT_FILENO);
+    dup2(Null, STDERR_FILENO);
+
+    int Status = md5sum_run(Argc, Argv);
+
+    fflush(stdout);
+    fflush(stderr);
+    dup2(SavedOut, STDOUT_FILENO);
+    dup2(SavedErr, STDERR_FILENO);
+    close(SavedOut);
+    close(SavedErr);
+    close(Null);
+
+    ssize_t Got = pread(Fd, Out, OUT_MAX - 1, 0);
+    Out[(Got > 0) ? Got : 0] = '\0';
+    close(Fd);
+    unlink(Path);
+    return Status;
+}
+
+/// @brief Appends the checksum line md5sum prints for Name in Dir, escaped like GNU md5sum.
+static void expect_line(char* Expect, const char* Digest, const char* Name)
+{
+    bool Escape = strpbrk(Name, "\\\n") != NULL;
+    char* End = Expect + strlen(Expect);
+    if (Escape)
+        *End++ = '\\';
+    End += sprintf(End, "%s  %s/", Digest, Dir);
+    for (const char* C = Name; *C != '\0'; C++)
+    {
+        if (*C == '\\')
+            End += sprintf(End, "\\\\");
+        else if (*C == '\n')
+            End += sprintf(End, "\\n");
+        else
+            *End++ = *C;
+    }
+    *End++ = '\n';
+    *End = '\0';
+}
+
+static void test_md5sum(void)
+{
+    snprintf(Dir, sizeof(Dir), "/tmp/test_md5sum.XXXXXX");
+    CHECK(mkdtemp(Dir) != NULL, "mkdtemp");
+    char Path[256];
+    snprintf(Path, sizeof(Path), "%s/sub", Dir);
+    mkdir(Path, 0700);
+
+    char* Expect = calloc(1, OUT_MAX);
+    char* Out = malloc(OUT_MAX);
+    size_t Count = sizeof(Entries) / sizeof(Entries[0]);
+    for (size_t i = 0; i < Count; i++)
+    {
+        write_file(Entries[i].Name, Entries[i].Content);
+        //* The numbered files sort between "empty" and "new\nline".
+        if (strcmp(Entries[i].Name, "empty") == 0)
+        {
+            for (int n = 0; n < NUMBERED; n++)
+            {
+                char Name[8];
+                snprintf(Name, sizeof(Name), "n%02d", n);
+                write_file(Name, NumberedContent);
+            }
+        }
+    }
+    for (size_t i = 0; i < Count; i++)
+    {
+        expect_line(Expect, Entries[i].Digest, Entries[i].Name);
+        for (int n = 0; n < NUMBERED && strcmp(Entries[i].Name, "empty") == 0; n++)
+        {
+            char Name[8];
+            snprintf(Name, sizeof(Name), "n%02d", n);
+            expect_line(Expect, NumberedDigest, Name);
+        }
+    }
+
+    //? Hash the directory.
+    char* HashArgs[] = {"md5sum", "-j", "4", Dir};
+    CHECK(run_sum(4, HashArgs, Out) == 0, "md5sum exit status");
+    CHECK(strcmp(Out, Expect) == 0, "md5sum lines");
+
+    //? Check the list as written, escaped names included.
+    char List[96];
+    snprintf(List, sizeof(List), "%s.md5", Dir);
+    FILE* File = fopen(List, "wb");
+    CHECK(File != NULL, "create list");
+    if (File != NULL)
+    {
+        fputs(Expect, File);
+        fclose(File);
+    }
+    char* CheckArgs[] = {"md5sum", "-c", "--quiet", List};
+    CHECK(run_sum(4, CheckArgs, Out) == 0, "md5sum -c exit status");
+    CHECK(Out[0] == '\0', "md5sum -c --quiet prints nothing");
+
+    //? Corrupt the first entry (a.txt) and add a missing file.
+    File = fopen(List, "wb");
+    if (File != NULL)
+    {
+        fputs((Expect[0] == '0') ? "1" : "0", File);
+        fputs(Expect + 1, File);
+        fprintf(File, "%s  %s/missing\n", Entries[0].Digest, Dir);
+        fclose(File);
+    }
+    char* FailArgs[] = {"md5sum", "-c", List};
+    CHECK(run_sum(3, FailArgs, Out) == 1, "md5sum -c failure exit status");
+
+    char Line[160];
+    snprintf(Line, sizeof(Line), "%s/a.txt: FAILED\n", Dir);
+    CHECK(strncmp(Out, Line, strlen(Line)) == 0, "md5sum -c corrupted entry FAILED");
+    snprintf(Line, sizeof(Line), "%s/n00: OK\n", Dir);
+    CHECK(strstr(Out, Line) != NULL, "md5sum -c other entries OK");
+    snprintf(Line, sizeof(Line), "\\%s/new\\nline: OK\n", Dir);
+    CHECK(strstr(Out, Line) != NULL, "md5sum -c escaped entry OK");
+    snprintf(Line, sizeof(Line), "%s/missing: FAILED open or read\n", Dir);
+    size_t LineSize = strlen(Line), OutSize = strlen(Out);
+    CHECK(OutSize >= LineSize && strcmp(Out + OutSize - LineSize, Line) == 0, "md5sum -c missing file FAILED open or read");
+
+    //? Clean up.
+    unlink(List);
+    for (size_t i = 0; i < Count; i++)
+    {
+        snprintf(Path, sizeof(Path), "%s/%s", Dir, Entries[i].Name);
+        unlink(Path);
+    }
+    for (int n = 0; n < NUMBERED; n++)
+    {
+        snprintf(Path, sizeof(Path), "%s/n%02d", Dir, n);
+        unlink(Path);
+    }
+    snprintf(Path, sizeof(Path), "%s/sub", Dir);
+    rmdir(Path);
+    rmdir(Dir);
+    free(Expect);
+    free(Out);
+}
+
+int main(void)
+{
+    return test_result(test_configs(test_md5sum, 0));
+}
@@ -0,0 +1,64 @@
+#include <string.h>
+#include "../include/aes.h"
+#include "../include/aes_backend.h"
+#include "test.h"
+
+//* POLYVAL on the GHASH engine under every GHASH backend: the RFC 8452 vector, and random data hashed in
+//* uneven pieces against the bitserial result.
+
+//* Sizes around the partial block, the 8 block aggregation of clmul, and several of its passes.
+static const size_t Sizes[] = {0, 1, 15, 16, 17, 127, 128, 129, 300, 1000};
+#define SIZE_COUNT (sizeof(Sizes) / sizeof(Sizes[0]))
+
+//* Hashes of the first configuration (bitserial), every later one must match them.
+static uint8_t RefHash[SIZE_COUNT][16];
+static bool RefReady = false;
+
+static void test_polyval(void)
+{
+    //* RFC 8452 appendix A.
+    uint8_t H[16], X[32], Expect[16], Y[16] = {0};
+    GHashKey Key;
+    hex_bytes("25629347589242761d31f826ba4b757b", H);
+    hex_bytes("4f4f95668c83dfb6401762bb2d01a262d1a24ddd2721d006bbe45f20d3c9f362", X);
+    hex_bytes("f7a3b47b846119fae5b7866cf5e5b77e", Expect);
+    CHECK(polyval_key_init(&Key, H) == success, "polyval key init");
+    polyval_update(&Key, Y, X, 32);
+    CHECK(memcmp(Y, Expect, 16) == 0, "polyval vector");
+    memset(Y, 0, 16);
+    polyval_update(&Key, Y, X, 16);
+    polyval_update(&Key, Y, X + 16, 16);
+    CHECK(memcmp(Y, Expect, 16) == 0, "polyval vector in two updates");
+    ghash_key_clear(&Key);
+
+    //* Random data, one call and whole blocks in uneven pieces.
+    uint8_t Data[1000];
+    fill_random(H, 16, 21);
+    fill_random(Data, sizeof(Data), 22);
+    polyval_key_init(&Key, H);
+    for (size_t s = 0; s < SIZE_COUNT; s++)
+    {
+        memset(Y, 0, 16);
+        polyval_update(&Key, Y, Data, Sizes[s]);
+        if (!RefReady)
+            memcpy(RefHash[s], Y, 16);
+        CHECK(memcmp(Y, RefHash[s], 16) == 0, "polyval matches bitserial");
+
+        uint8_t Split[16] = {0};
+        size_t i = 0;
+        for (size_t Step = 16; i + Step < Sizes[s]; i += Step, Step = (Step % 48) + 16)
+            polyval_update(&Key, Split, Data + i, Step);
+        polyval_update(&Key, Split, Data + i, Sizes[s] - i);
+        CHECK(memcmp(Split, Y, 16) == 0, "polyval in pieces");
+    }
+    RefReady = true;
+    ghash_key_clear(&Key);
+}
+
+
+//? Configurations
+
+int main(void)
+{
+    return test_result(test_configs(test_polyval, TEST_GHASH_BACKENDS));
+}
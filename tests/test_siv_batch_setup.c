@@ -0,0 +1,82 @@
+//* Built with aes.c itself instead of linking it, to make polyval_key_init() fail on demand.
+#define polyval_key_init failing_polyval_key_init
+#include "../src/aes.c"
+#undef polyval_key_init
+
+#include "test.h"
+
+//* Key setup failures in the batched GCM-SIV functions: the messages already finished keep their result, every other
+//* one gets the error, and an open never leaves unauthenticated Plaintext behind (in place included).
+
+ErrorCode polyval_key_init(GHashKey* Key, const uint8_t* H);
+
+/// @brief polyval_key_init() that fails with malloc_error on call number PolyvalFailAt (counting from 0), -1 never fails.
+static int PolyvalCalls = 0;
+static int PolyvalFailAt = -1;
+
+ErrorCode failing_polyval_key_init(GHashKey* Key, const uint8_t* H)
+{
+    if (PolyvalCalls++ == PolyvalFailAt)
+        return malloc_error;
+    return polyval_key_init(Key, H);
+}
+
+static void test_setup_failure(void)
+{
+    //* 20 messages are 3 groups of AES_LANES, failing call 11 is lane 3 of the second group.
+    enum { Count = 20, Size = 50, FailAt = 11 };
+    uint8_t Key[32], P[Count][Size], C[Count][Size], IV[Count][12], Tag[Count][16];
+    AESAEADJob Jobs[Count];
+    AESKey Ctx;
+    fill_random(Key, 32, 3);
+    aes_key_init(&Ctx, Key);
+
+    for (int i = 0; i < Count; i++)
+    {
+        memset(P[i], i + 1, Size);
+        memset(IV[i], i, 12);
+        Jobs[i] = (AESAEADJob) {IV[i], NULL, 0, P[i], Size, C[i], Tag[i], unknown_error};
+    }
+    PolyvalCalls = 0;
+    PolyvalFailAt = FailAt;
+    CHECK(aes_siv_enc_batch(&Ctx, Jobs, Count) == malloc_error, "siv seal batch setup error");
+    for (int i = 0; i < Count; i++)
+        CHECK(Jobs[i].Result == ((i < AES_LANES) ? success : malloc_error), "siv seal batch setup error Result");
+
+    //* Seal again without failures, then open with one: every unfinished message is zeroed, the finished ones are kept.
+    PolyvalFailAt = -1;
+    CHECK(aes_siv_enc_batch(&Ctx, Jobs, Count) == success, "siv seal batch");
+    for (int i = 0; i < Count; i++)
+    {
+        Jobs[i].In = C[i];
+        Jobs[i].Out = P[i];
+        memset(P[i], 0x55, Size);
+    }
+    PolyvalCalls = 0;
+    PolyvalFailAt = FailAt;
+    CHECK(aes_siv_dec_batch(&Ctx, Jobs, Count) == malloc_error, "siv open batch setup error");
+    for (int i = 0; i < Count; i++)
+    {
+        if (i < AES_LANES)
+            CHECK(Jobs[i].Result == success && P[i][0] == i + 1 && P[i][Size - 1] == i + 1, "siv open batch keeps finished messages");
+        else
+            CHECK(Jobs[i].Result == malloc_error && is_zero(P[i], Size), "siv open batch setup error zeroes Out");
+    }
+
+    //* In place open, nothing of the unfinished messages may be left as it was.
+    for (int i = 0; i < Count; i++)
+        Jobs[i].Out = C[i];
+    PolyvalCalls = 0;
+    PolyvalFailAt = 0;
+    CHECK(aes_siv_dec_batch(&Ctx, Jobs, Count) == malloc_error, "siv open batch in place setup error");
+    for (int i = 0; i < Count; i++)
+        CHECK(Jobs[i].Result == malloc_error && is_zero(C[i], Size), "siv open batch in place setup error zeroes Out");
+
+    PolyvalFailAt = -1;
+    aes_key_clear(&Ctx);
+}
+
+int main(void)
+{
+    return test_result(test_configs(test_setup_failure, TEST_AES_BACKENDS | TEST_THREADS));
+}
@@ -0,0 +1,98 @@
+//* Built with aes.c itself instead of linking it, to reach the GCM-SIV key derivation.
+//* Called with a variable Count, siv_derive_keys_batch() is no longer inlined and GCC cannot tell its blocks are all set.
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include "../src/aes.c"
+
+#include "test.h"
+
+//* GCM-SIV key derivation for many nonces at once: siv_derive_keys_batch() against siv_derive_keys() one nonce at a
+//* time for 1 to AES_LANES nonces, and the batch functions across more than AES_LANES messages against one at a time.
+
+static void test_derive(void)
+{
+    uint8_t Key[32], IVs[AES_LANES][12];
+    uint8_t EncKeys[AES_LANES*32], AuthKeys[AES_LANES*16], EncKey[32], AuthKey[16];
+    const uint8_t* IVList[AES_LANES];
+    fill_random(Key, 32, 60);
+    fill_random((uint8_t*) IVs, sizeof(IVs), 61);
+    AESKey Master;
+    aes_key_init(&Master, Key);
+
+    //* Two lanes with the same nonce must get the same keys.
+    memcpy(IVs[5], IVs[2], 12);
+    for (int n = 0; n < AES_LANES; n++)
+        IVList[n] = IVs[n];
+
+    for (int Count = 1; Count <= AES_LANES; Count++)
+    {
+        memset(EncKeys, 0x55, sizeof(EncKeys));
+        memset(AuthKeys, 0x55, sizeof(AuthKeys));
+        siv_derive_keys_batch(&Master, IVList, Count, EncKeys, AuthKeys);
+        for (int n = 0; n < Count; n++)
+        {
+            siv_derive_keys(&Master, IVs[n], EncKey, AuthKey);
+            CHECK(memcmp(EncKeys + n*32, EncKey, 32) == 0, "siv derive batch EncKey");
+            CHECK(memcmp(AuthKeys + n*16, AuthKey, 16) == 0, "siv derive batch AuthKey");
+        }
+        //* Nothing past the last nonce is written.
+        CHECK(Count == AES_LANES || (EncKeys[Count*32] == 0x55 && AuthKeys[Count*16] == 0x55), "siv derive batch stays in Count");
+    }
+    aes_key_clear(&Master);
+}
+
+static void test_groups(void)
+{
+    //* Around one and several groups of AES_LANES, sizes and AAD varying per message.
+    static const size_t Counts[] = {1, AES_LANES - 1, AES_LANES, AES_LANES + 1, 2*AES_LANES + 3, 3*AES_LANES};
+    enum { Max = 3*AES_LANES, MaxSize = 100 };
+    uint8_t Key[32], P[Max][MaxSize], C[Max][MaxSize], Expect[MaxSize], IV[Max][12], AAD[Max][16];
+    uint8_t Tag[Max][16], ExpectTag[16];
+    AESAEADJob Jobs[Max];
+    fill_random(Key, 32, 62);
+    fill_random((uint8_t*) P, sizeof(P), 63);
+    fill_random((uint8_t*) IV, sizeof(IV), 64);
+    fill_random((uint8_t*) AAD, sizeof(AAD), 65);
+    AESKey Ctx;
+    aes_key_init(&Ctx, Key);
+
+    for (size_t c = 0; c < sizeof(Counts) / sizeof(Counts[0]); c++)
+    {
+        size_t Count = Counts[c];
+        for (size_t i = 0; i < Count; i++)
+            Jobs[i] = (AESAEADJob) {IV[i], AAD[i], i % 17, P[i], (i*37 + c) % (MaxSize + 1), C[i], Tag[i], unknown_error};
+
+        CHECK(aes_siv_enc_batch(&Ctx, Jobs, Count) == success, "siv enc batch groups");
+        for (size_t i = 0; i < Count; i++)
+        {
+            memcpy(Expect, P[i], Jobs[i].Size);
+            aes_siv_enc_ctx(Expect, Jobs[i].Size, AAD[i], Jobs[i].ASize, &Ctx, IV[i], ExpectTag);
+            CHECK(Jobs[i].Result == success && memcmp(C[i], Expect, Jobs[i].Size) == 0 && memcmp(Tag[i], ExpectTag, 16) == 0, "siv enc batch groups matches one at a time");
+            Jobs[i].In = C[i];
+        }
+
+        //* Open in place, with the Tag of the last message of the second group (if any) corrupted.
+        size_t Bad = (Count > AES_LANES) ? ((Count < 2*AES_LANES) ? Count : 2*AES_LANES) - 1 : Count;
+        if (Bad < Count)
+            Tag[Bad][7] ^= 0x10;
+        CHECK(aes_siv_dec_batch(&Ctx, Jobs, Count) == ((Bad < Count) ? unknown_error : success), "siv dec batch groups");
+        for (size_t i = 0; i < Count; i++)
+        {
+            if (i == Bad)
+                CHECK(Jobs[i].Result == unknown_error && is_zero(C[i], Jobs[i].Size), "siv dec batch groups bad tag zeroes Out");
+            else
+                CHECK(Jobs[i].Result == success && memcmp(C[i], P[i], Jobs[i].Size) == 0, "siv dec batch groups matches");
+        }
+    }
+    aes_key_clear(&Ctx);
+}
+
+static void test_siv_derive(void)
+{
+    test_derive();
+    test_groups();
+}
+
+int main(void)
+{
+    return test_result(test_configs(test_siv_derive, TEST_AES_BACKENDS | TEST_GHASH_BACKENDS));
+}
@@ -0,0 +1,130 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/aes.h"
+#include "test.h"
+
+//* GCM-SIV into caller buffers: the known answers through every seal and open variant (raw key and expanded, in place and
+//* into a separate buffer), then sizes around the partial block and the thread split. An invalid Tag restores the
+//* Ciphertext of an in place open and zeroes the Plaintext of an open into a separate buffer.
+
+static void test_vectors(void)
+{
+    for (size_t v = 0; v < SIVVectorCount; v++)
+    {
+        AEADCase T;
+        load_vector(&SIVVectors[v], &T);
+        AESKey Ctx;
+        CHECK(aes_key_init(&Ctx, T.Key) == success, "siv key init");
+        uint8_t Buf[64], Out[64], Tag[16];
+
+        //* Seal in place and into a separate buffer.
+        memcpy(Buf, T.P, T.Size);
+        CHECK(aes_siv_enc(Buf, T.Size, T.AAD, T.ASize, T.Key, T.IV, Tag) == success, "siv enc");
+        CHECK(memcmp(Buf, T.C, T.Size) == 0 && memcmp(Tag, T.Tag, 16) == 0, "siv enc vector");
+        memset(Tag, 0, 16);
+        CHECK(aes_siv_enc_into(T.P, T.Size, T.AAD, T.ASize, T.Key, T.IV, Out, Tag) == success, "siv enc_into");
+        CHECK(memcmp(Out, T.C, T.Size) == 0 && memcmp(Tag, T.Tag, 16) == 0, "siv enc_into vector");
+        memset(Tag, 0, 16);
+        CHECK(aes_siv_enc_into_ctx(T.P, T.Size, T.AAD, T.ASize, &Ctx, T.IV, Out, Tag) == success, "siv enc_into_ctx");
+        CHECK(memcmp(Out, T.C, T.Size) == 0 && memcmp(Tag, T.Tag, 16) == 0, "siv enc_into_ctx vector");
+        memcpy(Buf, T.P, T.Size);
+        CHECK(aes_siv_enc_into_ctx(Buf, T.Size, T.AAD, T.ASize, &Ctx, T.IV, Buf, Tag) == success, "siv enc_into_ctx in place");
+        CHECK(memcmp(Buf, T.C, T.Size) == 0 && memcmp(Tag, T.Tag, 16) == 0, "siv enc_into_ctx in place vector");
+
+        //* Open in place and into a separate buffer.
+        memcpy(Buf, T.C, T.Size);
+        CHECK(aes_siv_dec(Buf, T.Size, T.AAD, T.ASize, T.Key, T.IV, T.Tag) == success && memcmp(Buf, T.P, T.Size) == 0, "siv dec vector");
+        memset(Out, 0x55, sizeof(Out));
+        CHECK(aes_siv_dec_into(T.C, T.Size, T.AAD, T.ASize, T.Key, T.IV, T.Tag, Out) == success && memcmp(Out, T.P, T.Size) == 0, "siv dec_into vector");
+        memset(Out, 0x55, sizeof(Out));
+        CHECK(aes_siv_dec_into_ctx(T.C, T.Size, T.AAD, T.ASize, &Ctx, T.IV, T.Tag, Out) == success && memcmp(Out, T.P, T.Size) == 0, "siv dec_into_ctx vector");
+        memcpy(Buf, T.C, T.Size);
+        CHECK(aes_siv_dec_into_ctx(Buf, T.Size, T.AAD, T.ASize, &Ctx, T.IV, T.Tag, Buf) == success && memcmp(Buf, T.P, T.Size) == 0, "siv dec_into_ctx in place vector");
+
+        //* Invalid Tag: in place restores the Ciphertext, into zeroes the Plaintext.
+        memcpy(Buf, T.C, T.Size);
+        CHECK(aes_siv_dec(Buf, T.Size, T.AAD, T.ASize, T.Key, T.IV, T.Bad) == unknown_error, "siv dec bad tag");
+        CHECK(memcmp(Buf, T.C, T.Size) == 0, "siv dec bad tag restores Ciphertext");
+        memcpy(Buf, T.C, T.Size);
+        CHECK(aes_siv_dec_ctx(Buf, T.Size, T.AAD, T.ASize, &Ctx, T.IV, T.Bad) == unknown_error, "siv dec_ctx bad tag");
+        CHECK(memcmp(Buf, T.C, T.Size) == 0, "siv dec_ctx bad tag restores Ciphertext");
+        memset(Out, 0x55, sizeof(Out));
+        CHECK(aes_siv_dec_into(T.C, T.Size, T.AAD, T.ASize, T.Key, T.IV, T.Bad, Out) == unknown_error, "siv dec_into bad tag");
+        CHECK(is_zero(Out, T.Size), "siv dec_into bad tag zeroes Plaintext");
+        memset(Out, 0x55, sizeof(Out));
+        CHECK(aes_siv_dec_into_ctx(T.C, T.Size, T.AAD, T.ASize, &Ctx, T.IV, T.Bad, Out) == unknown_error, "siv dec_into_ctx bad tag");
+        CHECK(is_zero(Out, T.Size), "siv dec_into_ctx bad tag zeroes Plaintext");
+        CHECK(T.Size == sizeof(Out) || Out[T.Size] == 0x55, "siv dec_into_ctx bad tag stays in CSize");
+
+        aes_key_clear(&Ctx);
+    }
+}
+
+//* Sizes around the partial block and the thread split (THREAD_MIN_PART is 64 KiB).
+static const size_t Sizes[] = {0, 1, 15, 16, 17, 4095, 4096, 4111, 131089, 262167};
+#define SIZE_COUNT (sizeof(Sizes) / sizeof(Sizes[0]))
+
+static void test_sizes(void)
+{
+    uint8_t Key[32], IV[12], AAD[21], Tag[16], RefTag[16];
+    fill_random(Key, 32, 70);
+    fill_random(IV, 12, 71);
+    fill_random(AAD, 21, 72);
+    AESKey Ctx;
+    aes_key_init(&Ctx, Key);
+
+    size_t Max = Sizes[SIZE_COUNT - 1];
+    uint8_t* P = malloc(Max + 1);
+    uint8_t* Ref = malloc(Max + 1);
+    uint8_t* Buf = malloc(Max + 1);
+    uint8_t* Out = malloc(Max + 1);
+
+    for (size_t s = 0; s < SIZE_COUNT; s++)
+    {
+        size_t Size = Sizes[s];
+        fill_random(P, Size, 73 + (uint32_t) s);
+        memcpy(Ref, P, Size);
+        aes_siv_enc_ctx(Ref, Size, AAD, sizeof(AAD), &Ctx, IV, RefTag);
+
+        //* Out of place seal leaves the Plaintext alone, and matches sealing in place.
+        CHECK(aes_siv_enc_into_ctx(P, Size, AAD, sizeof(AAD), &Ctx, IV, Buf, Tag) == success, "siv large enc_into_ctx");
+        CHECK(memcmp(Buf, Ref, Size) == 0 && memcmp(Tag, RefTag, 16) == 0, "siv large enc_into_ctx matches in place");
+        fill_random(Out, Size, 73 + (uint32_t) s);
+        CHECK(memcmp(P, Out, Size) == 0, "siv large enc_into_ctx leaves Plaintext");
+
+        memset(Out, 0x55, Size + 1);
+        CHECK(aes_siv_dec_into_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, Tag, Out) == success && memcmp(Out, P, Size) == 0, "siv large dec_into_ctx");
+        CHECK(Out[Size] == 0x55, "siv large dec_into_ctx stays in CSize");
+        CHECK(memcmp(Buf, Ref, Size) == 0, "siv large dec_into_ctx leaves Ciphertext");
+        if (Size == 0)
+            continue;
+
+        //* A flipped bit in the Ciphertext, opened into a separate buffer and in place.
+        Buf[Size/2] ^= 0x01;
+        memset(Out, 0x55, Size + 1);
+        CHECK(aes_siv_dec_into_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, Tag, Out) == unknown_error && is_zero(Out, Size), "siv large tampered zeroes Plaintext");
+        memcpy(Out, Buf, Size);
+        CHECK(aes_siv_dec_into_ctx(Out, Size, AAD, sizeof(AAD), &Ctx, IV, Tag, Out) == unknown_error && memcmp(Out, Buf, Size) == 0, "siv large tampered in place into restores Ciphertext");
+        CHECK(aes_siv_dec_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, Tag) == unknown_error, "siv large tampered in place");
+        Buf[Size/2] ^= 0x01;
+        CHECK(memcmp(Buf, Ref, Size) == 0, "siv large tampered in place restores Ciphertext");
+        CHECK(aes_siv_dec_ctx(Buf, Size, AAD, sizeof(AAD), &Ctx, IV, Tag) == success && memcmp(Buf, P, Size) == 0, "siv large dec_ctx");
+    }
+
+    aes_key_clear(&Ctx);
+    free(P);
+    free(Ref);
+    free(Buf);
+    free(Out);
+}
+
+static void test_siv_into(void)
+{
+    test_vectors();
+    test_sizes();
+}
+
+int main(void)
+{
+    return test_result(test_configs(test_siv_into, TEST_AES_BACKENDS | TEST_GHASH_BACKENDS | TEST_THREADS));
+}
@@ -0,0 +1,51 @@
+//* Built with aes.c itself instead of linking it, to make polyval_key_init() fail on demand.
+#define polyval_key_init failing_polyval_key_init
+#include "../src/aes.c"
+#undef polyval_key_init
+
+#include "test.h"
+
+//* Key setup failures in the single message GCM-SIV functions: they fail before writing anything to the output.
+
+ErrorCode polyval_key_init(GHashKey* Key, const uint8_t* H);
+
+static bool PolyvalFails = false;
+
+ErrorCode failing_polyval_key_init(GHashKey* Key, const uint8_t* H)
+{
+    if (PolyvalFails)
+        return malloc_error;
+    return polyval_key_init(Key, H);
+}
+
+static void test_setup_failure(void)
+{
+    enum { Size = 50 };
+    uint8_t Key[32], IV[12], P[Size], C[Size], Out[Size], Tag[16];
+    size_t OutSize;
+    fill_random(Key, 32, 3);
+    fill_random(IV, 12, 4);
+    fill_random(P, Size, 5);
+    AESKey Ctx;
+    aes_key_init(&Ctx, Key);
+    aes_siv_enc_into_ctx(P, Size, NULL, 0, &Ctx, IV, C, Tag);
+
+    PolyvalFails = true;
+    memset(Out, 0x55, Size);
+    CHECK(aes_siv_dec_into_ctx(C, Size, NULL, 0, &Ctx, IV, Tag, Out) == malloc_error, "siv dec_into_ctx setup error");
+    CHECK(Out[0] == 0x55 && Out[Size - 1] == 0x55, "siv dec_into_ctx setup error writes nothing");
+    CHECK(aes_siv_enc_into_ctx(P, Size, NULL, 0, &Ctx, IV, Out, Tag) == malloc_error, "siv enc_into_ctx setup error");
+    CHECK(Out[0] == 0x55 && Out[Size - 1] == 0x55, "siv enc_into_ctx setup error writes nothing");
+    memcpy(Out, C, Size);
+    CHECK(aes_siv_dec_ctx(Out, Size, NULL, 0, &Ctx, IV, Tag) == malloc_error && memcmp(Out, C, Size) == 0, "siv dec_ctx setup error leaves Ciphertext");
+    CHECK(aes_siv_dec_base64_ctx("QUJD", 4, NULL, 0, &Ctx, IV, Tag, Out, &OutSize) == malloc_error, "siv dec base64 setup error");
+    PolyvalFails = false;
+
+    CHECK(aes_siv_dec_into_ctx(C, Size, NULL, 0, &Ctx, IV, Tag, Out) == success && memcmp(Out, P, Size) == 0, "siv dec_into_ctx after setup error");
+    aes_key_clear(&Ctx);
+}
+
+int main(void)
+{
+    return test_result(test_configs(test_setup_failure, 0));
+}